@@ -4,8 +4,9 @@
 /// \bug No known bugs.
 
 #include "NetworkSerializer.hpp"
-#include "Common/Utility/ChecksumUtilities.hpp"
-#include "Common/Utility/ChronoUtilities.hpp"
+#include "Base/Utility/ChecksumUtilities.hpp"
+#include "Base/Utility/ChronoUtilities.hpp"
+#include "Base/Utility/HugePageArena.hpp"
 
 namespace {
 
@@ -76,6 +77,31 @@ namespace {
     constexpr int CHUNK_SLAVE_DATA_MAX_SIZE {
         CHUNK_MAX_SIZE - CHUNK_SLAVE_HEADER_SIZE
     };
+
+    /// Grows a frame buffer, advising large ones for huge pages.
+    /// \details Key frames span megabytes, and every reassembled frame is
+    /// streamed through by the decoder, so a fresh allocation is advised
+    /// before its chunks are written.
+    /// \param[in,out]  data    Frame buffer.
+    /// \param[in]      size    Required size in bytes.
+    /// \param[in]      resize  Indicates whether the size changes too, or
+    ///                         only the capacity.
+    void growFrame(QByteArray& data, int size, bool resize = true) {
+        auto capacity = data.capacity();
+
+        if (resize) {
+            if (data.size() >= size) return;
+            data.resize(size);
+        }
+        else {
+            data.reserve(size);
+        }
+
+        if (data.capacity() != capacity &&
+            static_cast<std::size_t>(size) >= Common::Utility::HUGE_PAGE_SIZE)
+            Common::Utility::HugePageArena::advise(
+                data.data(), static_cast<std::size_t>(data.capacity()));
+    }
 }
 
 /// A namespace that contains common classes and functions for data
@@ -131,7 +157,7 @@ namespace Common::Serialization {
             frame_.task = partialFrame.task;
             frame_.flow = partialFrame.flow;
 
-            if (frame_.data.size() < frameSize) frame_.data.resize(frameSize);
+            growFrame(frame_.data, frameSize);
             frame_.data.replace(0, partialFrame.data.size(), partialFrame.data);
 
             collectedChunks_ = 1, detectedChunks_ = getChunkNumber(frameSize);
@@ -145,7 +171,7 @@ namespace Common::Serialization {
 
             frame_.number = partialFrame.number;
 
-            if (frame_.data.size() < frameSize) frame_.data.resize(frameSize);
+            growFrame(frame_.data, frameSize);
             frame_.data.replace(0, partialFrame.data.size(), partialFrame.data);
 
             ++collectedChunks_;
@@ -160,7 +186,7 @@ namespace Common::Serialization {
         frame_.task = partialFrame.task;
         frame_.flow = partialFrame.flow;
 
-        frame_.data.reserve(frameSize);
+        growFrame(frame_.data, frameSize, false);
         frame_.data.append(partialFrame.data.data(), partialFrame.data.size());
 
         collectedChunks_ = 1, detectedChunks_ = getChunkNumber(frameSize);
@@ -203,7 +229,7 @@ namespace Common::Serialization {
             frame_.flow = partialFrame.flow;
         }
 
-        if (frame_.data.size() < frameSize) frame_.data.resize(frameSize);
+        growFrame(frame_.data, frameSize);
 
         frame_.data.replace(frameOffset,
                             partialFrame.data.size(),
@@ -1,6 +1,86 @@
+/// \file IOService.cpp
+/// \brief Contains definitions of classes and functions to support system I/O
+/// services.
+/// \bug No known bugs.
+
 #include "IOService.hpp"
 
-IOService::IOService(QObject *parent) : QObject(parent)
-{
+#include "Base/Utility/ThreadAffinity.hpp"
+
+/// A namespace that contains common classes and functions to support system
+/// services.
+namespace Common::System {
+
+    /// Constructs an I/O service.
+    /// \param[in]  parent  Parent object.
+    IOService::IOService(QObject* parent) :
+        QObject(parent)
+    {
+    }
+
+    /// Destroys the I/O service.
+    /// \details Stops the service threads.
+    IOService::~IOService() {
+        stop();
+    }
+
+    /// Returns the context sockets are created on.
+    /// \return I/O context.
+    asio::io_context& IOService::context() {
+        return context_;
+    }
+
+    /// Indicates whether the service threads run.
+    /// \retval true if the service is started.
+    /// \retval false otherwise.
+    bool IOService::isRunning() const {
+        return !threads_.empty();
+    }
+
+    /// Starts the service threads.
+    /// \details Does nothing if the service is already started.
+    /// \param[in]  threadCount Number of threads.
+    void IOService::start(int threadCount) {
+        if (isRunning()) return;
+
+        context_.restart();
+        work_ = std::make_unique<
+            asio::executor_work_guard<asio::io_context::executor_type>>(
+                context_.get_executor());
+
+        for (auto thread = 0; thread < qMax(1, threadCount); ++thread)
+            threads_.emplace_back([this] { run(); });
+    }
+
+    /// Stops the service threads.
+    /// \details Pending operations are abandoned. Returns once the threads
+    /// have exited.
+    void IOService::stop() {
+        if (!isRunning()) return;
+
+        work_.reset();
+        context_.stop();
+
+        for (auto& thread : threads_)
+            thread.join();
+
+        threads_.clear();
+    }
+
+    /// Runs the context until the service is stopped.
+    /// \details The thread runs in the IO role for its lifetime, so the
+    /// affinity policy places it with the other network threads. Handlers
+    /// that throw are dropped, and the thread keeps serving the context.
+    void IOService::run() {
+        Common::Utility::ScopedThreadRole role(
+            Common::Utility::ThreadRole::Io);
 
+        while (!context_.stopped()) {
+            try {
+                context_.run();
+            }
+            catch (const std::exception&) {
+            }
+        }
+    }
 }
@@ -9,18 +9,69 @@
 #include <QObject>
 #include <asio.hpp>
 
+#include <memory>
+#include <thread>
+#include <vector>
+
 /// A namespace that contains common classes and functions to support system
 /// services.
 namespace Common::System {
 
-    class IOService : public QObject
-    {
+    /// A class that runs asynchronous I/O on its own threads.
+    /// \details Sockets created on the context of the service complete their
+    /// operations on the service threads, never on the GUI thread. The
+    /// threads run in the IO thread role until the service is stopped, even
+    /// without pending work.
+    class IOService : public QObject {
+
         Q_OBJECT
+
+    public:
+
+        /// Constructs an I/O service.
+        /// \param[in]  parent  Parent object.
+        explicit IOService(QObject* parent = nullptr);
+
+        /// Destroys the I/O service.
+        /// \details Stops the service threads.
+        virtual ~IOService();
+
     public:
-        explicit IOService(QObject *parent = nullptr);
 
-    signals:
+        /// Returns the context sockets are created on.
+        /// \return I/O context.
+        asio::io_context& context();
+
+        /// Indicates whether the service threads run.
+        /// \retval true if the service is started.
+        /// \retval false otherwise.
+        bool isRunning() const;
+
+        /// Starts the service threads.
+        /// \param[in]  threadCount Number of threads.
+        void start(int threadCount = 1);
+
+        /// Stops the service threads.
+        /// \details Pending operations are abandoned. Returns once the
+        /// threads have exited.
+        void stop();
+
+    private:
+
+        /// Runs the context until the service is stopped.
+        void run();
+
+    private:
+
+        /// I/O context.
+        asio::io_context context_;
+
+        /// Keeps the context running without pending work.
+        std::unique_ptr<
+            asio::executor_work_guard<asio::io_context::executor_type>> work_;
 
+        /// Service threads.
+        std::vector<std::thread> threads_;
     };
 }
 
@@ -1,6 +1,142 @@
+/// \file UdpSocket.cpp
+/// \brief Contains definitions of classes and functions for receiving
+/// datagrams.
+/// \bug No known bugs.
+
 #include "UdpSocket.hpp"
 
-UdpSocket::UdpSocket(QObject *parent) : QObject(parent)
-{
+namespace {
+
+    /// Requested socket receive buffer size in bytes.
+    /// \details Holds a burst of key frame datagrams of several streams
+    /// while the service thread is busy reassembling.
+    constexpr int RECEIVE_BUFFER_SIZE { 8 * 1024 * 1024 };
+}
+
+/// A namespace that contains common classes and functions to support system
+/// services.
+namespace Common::System {
+
+    /// Constructs a UDP socket.
+    /// \param[in]  service I/O service the socket runs on.
+    /// \param[in]  parent  Parent object.
+    UdpSocket::UdpSocket(IOService& service, QObject* parent) :
+        QObject(parent),
+        service_(service),
+        socket_(service.context())
+    {
+    }
+
+    /// Destroys the UDP socket.
+    /// \details Closes the socket.
+    UdpSocket::~UdpSocket() {
+        close();
+    }
+
+    /// Sets the function that handles received datagrams.
+    /// \details Must be called while the socket is closed.
+    /// \param[in]  handler Datagram handler.
+    void UdpSocket::setDatagramHandler(DatagramHandler handler) {
+        handler_ = std::move(handler);
+    }
+
+    /// Binds the socket to a port and starts receiving.
+    /// \details Asks for a large receive buffer, which the system may cap.
+    /// \param[in]  port    Local port, zero for any free port.
+    /// \retval true on success.
+    /// \retval false on error.
+    bool UdpSocket::open(quint16 port) {
+        close();
+
+        asio::error_code error;
+        socket_.open(asio::ip::udp::v4(), error);
+
+        if (!error) {
+            socket_.set_option(
+                asio::socket_base::receive_buffer_size(RECEIVE_BUFFER_SIZE),
+                error);
+            socket_.bind(asio::ip::udp::endpoint(asio::ip::udp::v4(), port),
+                         error);
+        }
+
+        if (error) {
+            emit onError(QString::fromStdString(error.message()));
+
+            asio::error_code ignored;
+            socket_.close(ignored);
+            return false;
+        }
+
+        receiveStopped_ = std::promise<void>();
+        receive();
+        return true;
+    }
+
+    /// Stops receiving and closes the socket.
+    /// \details The socket is closed on a service thread, so it never races
+    /// with a receive that is being handled. Returns once the pending
+    /// receive has finished, so the socket can be destroyed.
+    void UdpSocket::close() {
+        if (!socket_.is_open()) return;
+
+        if (!service_.isRunning()) {
+            asio::error_code ignored;
+            socket_.close(ignored);
+            return;
+        }
+
+        auto stopped = receiveStopped_.get_future();
+        asio::post(socket_.get_executor(), [this] {
+            asio::error_code ignored;
+            socket_.close(ignored);
+        });
+
+        stopped.wait();
+    }
+
+    /// Indicates whether the socket is open.
+    /// \retval true if the socket is open.
+    /// \retval false otherwise.
+    bool UdpSocket::isOpen() const {
+        return socket_.is_open();
+    }
+
+    /// Returns the local port.
+    /// \return Local port, zero if closed.
+    quint16 UdpSocket::port() const {
+        asio::error_code error;
+        auto endpoint = socket_.local_endpoint(error);
+        return error ? 0 : endpoint.port();
+    }
+
+    /// Returns the number of received datagrams.
+    /// \details Can be called from any thread.
+    /// \return Number of received datagrams.
+    quint64 UdpSocket::receivedDatagrams() const {
+        return receivedDatagrams_.load(std::memory_order_relaxed);
+    }
+
+    /// Starts the next receive.
+    /// \details Receiving stops once the socket is closed. Other errors,
+    /// such as an ICMP port unreachable of an earlier send, skip a datagram.
+    void UdpSocket::receive() {
+        socket_.async_receive_from(
+            asio::buffer(buffer_), sender_,
+            [this](const asio::error_code& error, std::size_t size) {
+                if (error == asio::error::operation_aborted ||
+                    !socket_.is_open()) {
+                    receiveStopped_.set_value();
+                    return;
+                }
+
+                if (!error) {
+                    receivedDatagrams_.fetch_add(1, std::memory_order_relaxed);
+
+                    if (handler_)
+                        handler_(buffer_.data(), static_cast<int>(size));
+                }
 
+                receive();
+            });
+    }
 }
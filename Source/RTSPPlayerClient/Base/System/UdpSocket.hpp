@@ -1,16 +1,117 @@
+/// \file UdpSocket.hpp
+/// \brief Contains declarations of classes and functions for receiving
+/// datagrams.
+/// \bug No known bugs.
+
 #ifndef UDPSOCKET_HPP
 #define UDPSOCKET_HPP
 
+#include "IOService.hpp"
+
 #include <QObject>
+#include <QString>
+
+#include <array>
+#include <atomic>
+#include <functional>
+#include <future>
+
+/// A namespace that contains common classes and functions to support system
+/// services.
+namespace Common::System {
+
+    /// A class that receives datagrams on the threads of an I/O service.
+    /// \details Keeps one receive pending, so datagrams of a socket are
+    /// handled one at a time, in order, even when the service runs several
+    /// threads.
+    class UdpSocket : public QObject {
+
+        Q_OBJECT
+
+    public:
+
+        /// A function that handles a received datagram.
+        /// \details Called on a service thread. The data is only valid for
+        /// the call.
+        using DatagramHandler =
+            std::function<void(const char* data, int size)>;
+
+    public:
+
+        /// Constructs a UDP socket.
+        /// \param[in]  service I/O service the socket runs on.
+        /// \param[in]  parent  Parent object.
+        explicit UdpSocket(IOService& service, QObject* parent = nullptr);
+
+        /// Destroys the UDP socket.
+        /// \details Closes the socket.
+        virtual ~UdpSocket();
+
+    public:
+
+        /// Sets the function that handles received datagrams.
+        /// \details Must be called while the socket is closed.
+        /// \param[in]  handler Datagram handler.
+        void setDatagramHandler(DatagramHandler handler);
+
+        /// Binds the socket to a port and starts receiving.
+        /// \param[in]  port    Local port, zero for any free port.
+        /// \retval true on success.
+        /// \retval false on error.
+        bool open(quint16 port);
+
+        /// Stops receiving and closes the socket.
+        /// \details Must be called before the service stops.
+        void close();
+
+        /// Indicates whether the socket is open.
+        /// \retval true if the socket is open.
+        /// \retval false otherwise.
+        bool isOpen() const;
+
+        /// Returns the local port.
+        /// \return Local port, zero if closed.
+        quint16 port() const;
+
+        /// Returns the number of received datagrams.
+        /// \details Can be called from any thread.
+        /// \return Number of received datagrams.
+        quint64 receivedDatagrams() const;
+
+    signals:
+
+        /// Signals a socket error.
+        /// \param[in]  message Error message.
+        void onError(const QString& message);
+
+    private:
+
+        /// Starts the next receive.
+        void receive();
+
+    private:
+
+        /// I/O service the socket runs on.
+        IOService& service_;
+
+        /// Socket.
+        asio::ip::udp::socket socket_;
+
+        /// Sender of the last datagram.
+        asio::ip::udp::endpoint sender_;
+
+        /// Receive buffer.
+        std::array<char, 65536> buffer_;
 
-class UdpSocket : public QObject
-{
-    Q_OBJECT
-public:
-    explicit UdpSocket(QObject *parent = nullptr);
+        /// Datagram handler.
+        DatagramHandler handler_;
 
-signals:
+        /// Number of received datagrams.
+        std::atomic<quint64> receivedDatagrams_ { 0 };
 
-};
+        /// Fulfilled once the pending receive has finished after a close.
+        std::promise<void> receiveStopped_;
+    };
+}
 
-#endif // UDPSOCKET_HPP
+#endif
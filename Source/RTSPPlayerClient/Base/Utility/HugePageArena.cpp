@@ -0,0 +1,401 @@
+/// \file HugePageArena.cpp
+/// \brief Contains definitions of utility classes and functions for
+/// allocating large buffers on transparent huge pages.
+/// \bug No known bugs.
+
+#include "HugePageArena.hpp"
+
+#include <QFile>
+
+#include <iterator>
+#include <utility>
+
+#if defined (Q_OS_UNIX)
+    #include <sys/mman.h>
+#endif
+
+namespace {
+
+    /// Smallest request the arena serves in bytes.
+    /// \details Smaller buffers would waste most of their huge page.
+    constexpr std::size_t MINIMUM_SIZE { Common::Utility::HUGE_PAGE_SIZE / 2 };
+
+    /// Default cache limit in bytes.
+    /// \details Holds a few 4K frames per stream of a small layout.
+    constexpr quint64 DEFAULT_CACHE_LIMIT { 128 * 1024 * 1024 };
+
+    /// Largest cached buffer handed out, in multiples of the request.
+    constexpr std::size_t MAXIMUM_REUSE_FACTOR { 2 };
+
+    /// File that selects the transparent huge page mode.
+    constexpr char THP_MODE_FILENAME[] {
+        "/sys/kernel/mm/transparent_hugepage/enabled"
+    };
+
+    /// Rounds a size up to whole huge pages.
+    /// \param[in]  size    Size in bytes.
+    /// \return Rounded size in bytes.
+    constexpr std::size_t roundToHugePages(std::size_t size) noexcept {
+        return (size + Common::Utility::HUGE_PAGE_SIZE - 1) /
+               Common::Utility::HUGE_PAGE_SIZE * Common::Utility::HUGE_PAGE_SIZE;
+    }
+
+    /// Maps memory aligned to a huge page.
+    /// \details Maps one huge page more than asked and unmaps the unaligned
+    /// head and tail.
+    /// \param[in]  size    Size in whole huge pages.
+    /// \return Mapping, or null on error.
+    void* mapAligned(std::size_t size) noexcept {
+#if defined (Q_OS_UNIX)
+        auto mappedSize = size + Common::Utility::HUGE_PAGE_SIZE;
+        auto mapping = mmap(nullptr,
+                            mappedSize,
+                            PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE | MAP_ANONYMOUS,
+                            -1,
+                            0);
+
+        if (mapping == MAP_FAILED) return nullptr;
+
+        auto start = reinterpret_cast<quintptr>(mapping);
+        auto aligned = (start + Common::Utility::HUGE_PAGE_SIZE - 1) /
+                       Common::Utility::HUGE_PAGE_SIZE *
+                       Common::Utility::HUGE_PAGE_SIZE;
+        auto head = aligned - start;
+        auto tail = mappedSize - head - size;
+
+        if (head > 0) munmap(mapping, head);
+        if (tail > 0) munmap(reinterpret_cast<void*>(aligned + size), tail);
+
+        return reinterpret_cast<void*>(aligned);
+#else
+        Q_UNUSED(size)
+        return nullptr;
+#endif
+    }
+
+    /// Unmaps memory mapped by mapAligned().
+    /// \param[in]  data    Mapping.
+    /// \param[in]  size    Size in bytes.
+    void unmap(void* data, std::size_t size) noexcept {
+#if defined (Q_OS_UNIX)
+        munmap(data, size);
+#else
+        Q_UNUSED(data)
+        Q_UNUSED(size)
+#endif
+    }
+
+    /// Advises a range for huge pages.
+    /// \param[in]  data    Range aligned to a huge page.
+    /// \param[in]  size    Size in whole huge pages.
+    /// \retval true if the system accepted the advice.
+    /// \retval false otherwise.
+    bool adviseHugePages(void* data, std::size_t size) noexcept {
+#if defined (MADV_HUGEPAGE)
+        return madvise(data, size, MADV_HUGEPAGE) == 0;
+#else
+        Q_UNUSED(data)
+        Q_UNUSED(size)
+        return false;
+#endif
+    }
+
+    /// Keeps a range on small pages.
+    /// \details Overrides the \c always mode of the system, so a disabled
+    /// arena really uses small pages.
+    /// \param[in]  data    Range aligned to a huge page.
+    /// \param[in]  size    Size in whole huge pages.
+    void adviseSmallPages(void* data, std::size_t size) noexcept {
+#if defined (MADV_NOHUGEPAGE)
+        madvise(data, size, MADV_NOHUGEPAGE);
+#else
+        Q_UNUSED(data)
+        Q_UNUSED(size)
+#endif
+    }
+}
+
+/// A namespace that contains common utility classes and functions.
+namespace Common::Utility {
+
+    /// Returns the arena of the process.
+    /// \details The arena is never destroyed, since images may release
+    /// their buffers while static objects are destroyed.
+    /// \return Huge page arena.
+    HugePageArena& HugePageArena::instance() {
+        static auto arena = new HugePageArena;
+        return *arena;
+    }
+
+    /// Indicates whether the system provides transparent huge pages.
+    /// \details Huge pages are available when the system mode is \c always
+    /// or \c madvise. The mode is read once.
+    /// \retval true if mappings can be advised for huge pages.
+    /// \retval false otherwise.
+    bool HugePageArena::isSupported() noexcept {
+        static const auto supported = [] {
+#if defined (MADV_HUGEPAGE)
+            QFile file(THP_MODE_FILENAME);
+            if (!file.open(QIODevice::ReadOnly)) return false;
+
+            auto mode = file.readAll();
+            return mode.contains("[always]") || mode.contains("[madvise]");
+#else
+            return false;
+#endif
+        }();
+
+        return supported;
+    }
+
+    /// Advises an existing allocation for huge pages.
+    /// \details Only the huge pages that lie entirely within the allocation
+    /// are advised, so neighbouring allocations are left alone. Pages the
+    /// allocation already touched are collapsed later by the kernel, if at
+    /// all, so advise before the first write.
+    /// \param[in]  data    Start of the allocation.
+    /// \param[in]  size    Size of the allocation in bytes.
+    void HugePageArena::advise(void* data, std::size_t size) noexcept {
+        if (!data || size < HUGE_PAGE_SIZE || !isSupported()) return;
+
+        auto start = reinterpret_cast<quintptr>(data);
+        auto first = (start + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+        auto last = (start + size) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+
+        if (last > first)
+            adviseHugePages(reinterpret_cast<void*>(first), last - first);
+    }
+
+    /// Constructs the arena.
+    /// \details Huge pages are enabled where supported, with the default
+    /// cache limit.
+    HugePageArena::HugePageArena()
+        : cacheLimit_(DEFAULT_CACHE_LIMIT) {
+    }
+
+    /// Destroys the arena.
+    /// \details Unmaps cached buffers. Buffers in use stay mapped.
+    HugePageArena::~HugePageArena() {
+        trim();
+    }
+
+    /// Allocates a buffer.
+    /// \details Takes the smallest cached buffer that fits, if it is at most
+    /// MAXIMUM_REUSE_FACTOR times the request, and maps a new buffer
+    /// otherwise. A mapping the system refuses huge pages for is still
+    /// used on small pages.
+    /// \param[in]  size    Size in bytes.
+    /// \return Buffer aligned to HUGE_PAGE_SIZE, or null if the arena
+    /// does not serve the request.
+    void* HugePageArena::allocate(std::size_t size) noexcept {
+        if (size < MINIMUM_SIZE) return nullptr;
+
+        auto mappedSize = roundToHugePages(size);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        try {
+            auto cached = cache_.lower_bound(mappedSize);
+
+            if (cached != cache_.end() &&
+                cached->first <= mappedSize * MAXIMUM_REUSE_FACTOR) {
+
+                auto data = cached->second;
+                buffers_.emplace(data, cached->first);
+
+                statistics_.cachedBytes -= cached->first;
+                ++statistics_.allocations;
+                ++statistics_.reuses;
+
+                cache_.erase(cached);
+                return data;
+            }
+
+            auto data = mapAligned(mappedSize);
+            if (!data) return nullptr;
+
+            if (hugePagesEnabled_ && isSupported() &&
+                adviseHugePages(data, mappedSize)) {
+                ++statistics_.hugePageMappings;
+            }
+            else {
+                adviseSmallPages(data, mappedSize);
+                ++statistics_.smallPageMappings;
+            }
+
+            buffers_.emplace(data, mappedSize);
+
+            statistics_.mappedBytes += mappedSize;
+            ++statistics_.allocations;
+
+            return data;
+        }
+        catch (...) {
+            return nullptr;
+        }
+    }
+
+    /// Releases a buffer allocated by allocate().
+    /// \details The buffer is cached for reuse, and older cached buffers are
+    /// unmapped while the cache exceeds its limit.
+    /// \param[in]  data    Buffer, or null.
+    void HugePageArena::release(void* data) noexcept {
+        if (!data) return;
+
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        auto buffer = buffers_.find(data);
+        if (buffer == buffers_.end()) return;
+
+        auto mappedSize = buffer->second;
+        buffers_.erase(buffer);
+
+        try {
+            cache_.emplace(mappedSize, data);
+            statistics_.cachedBytes += mappedSize;
+        }
+        catch (...) {
+            unmap(data, mappedSize);
+            statistics_.mappedBytes -= mappedSize;
+            return;
+        }
+
+        shrink(cacheLimit_);
+    }
+
+    /// Indicates whether new buffers are advised for huge pages.
+    /// \retval true if huge pages are used where supported.
+    /// \retval false if new buffers use small pages.
+    bool HugePageArena::hugePagesEnabled() const noexcept {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return hugePagesEnabled_;
+    }
+
+    /// Enables or disables huge pages for new buffers.
+    /// \details Cached buffers are unmapped, so buffers handed out from now
+    /// on follow the setting. Buffers in use keep their pages.
+    /// \param[in]  enabled Indicates whether huge pages are used.
+    void HugePageArena::setHugePagesEnabled(bool enabled) noexcept {
+        std::lock_guard<std::mutex> lock(mutex_);
+        hugePagesEnabled_ = enabled;
+        shrink(0);
+    }
+
+    /// Returns the cache limit.
+    /// \return Limit in bytes.
+    quint64 HugePageArena::cacheLimit() const noexcept {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return cacheLimit_;
+    }
+
+    /// Sets the cache limit.
+    /// \param[in]  bytes   Limit in bytes, zero to cache nothing.
+    void HugePageArena::setCacheLimit(quint64 bytes) noexcept {
+        std::lock_guard<std::mutex> lock(mutex_);
+        cacheLimit_ = bytes;
+        shrink(cacheLimit_);
+    }
+
+    /// Unmaps cached buffers.
+    void HugePageArena::trim() noexcept {
+        std::lock_guard<std::mutex> lock(mutex_);
+        shrink(0);
+    }
+
+    /// Returns arena statistics.
+    /// \return Statistics.
+    HugePageArena::Statistics HugePageArena::statistics() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return statistics_;
+    }
+
+    /// Unmaps cached buffers until the cache fits a limit.
+    /// \details Unmaps the largest buffers first, as they are the least
+    /// likely to match the next request.
+    /// \param[in]  limit   Limit in bytes.
+    void HugePageArena::shrink(quint64 limit) noexcept {
+        while (statistics_.cachedBytes > limit && !cache_.empty()) {
+            auto cached = std::prev(cache_.end());
+
+            unmap(cached->second, cached->first);
+            statistics_.cachedBytes -= cached->first;
+            statistics_.mappedBytes -= cached->first;
+
+            cache_.erase(cached);
+        }
+    }
+
+    /// Allocates a buffer.
+    /// \details Falls back to the heap when the arena refuses the request.
+    /// \param[in]  size    Size in bytes.
+    HugePageBuffer::HugePageBuffer(std::size_t size)
+        : size_(size) {
+
+        if (size == 0) return;
+
+        data_ = static_cast<uchar*>(HugePageArena::instance().allocate(size));
+        mapped_ = data_ != nullptr;
+
+        if (!data_) data_ = new uchar[size];
+    }
+
+    /// Releases the buffer.
+    HugePageBuffer::~HugePageBuffer() {
+        reset();
+    }
+
+    /// Moves a buffer.
+    /// \param[in,out]  other   Buffer left empty.
+    HugePageBuffer::HugePageBuffer(HugePageBuffer&& other) noexcept
+        : data_(std::exchange(other.data_, nullptr)),
+          size_(std::exchange(other.size_, 0)),
+          mapped_(std::exchange(other.mapped_, false)) {
+    }
+
+    /// Moves a buffer, releasing the current one.
+    /// \param[in,out]  other   Buffer left empty.
+    /// \return This buffer.
+    HugePageBuffer& HugePageBuffer::operator=(HugePageBuffer&& other) noexcept {
+        if (this != &other) {
+            reset();
+
+            data_ = std::exchange(other.data_, nullptr);
+            size_ = std::exchange(other.size_, 0);
+            mapped_ = std::exchange(other.mapped_, false);
+        }
+
+        return *this;
+    }
+
+    /// Returns the buffer.
+    /// \return Buffer, or null if empty.
+    uchar* HugePageBuffer::data() const noexcept {
+        return data_;
+    }
+
+    /// Returns the buffer size.
+    /// \return Size in bytes.
+    std::size_t HugePageBuffer::size() const noexcept {
+        return size_;
+    }
+
+    /// Indicates whether the buffer comes from the huge page arena.
+    /// \retval true if the buffer is mapped by the arena.
+    /// \retval false if it is empty or on the heap.
+    bool HugePageBuffer::isMapped() const noexcept {
+        return mapped_;
+    }
+
+    /// Releases the buffer.
+    void HugePageBuffer::reset() noexcept {
+        if (mapped_)
+            HugePageArena::instance().release(data_);
+        else
+            delete[] data_;
+
+        data_ = nullptr;
+        size_ = 0;
+        mapped_ = false;
+    }
+}
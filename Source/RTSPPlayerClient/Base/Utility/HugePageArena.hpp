@@ -0,0 +1,202 @@
+/// \file HugePageArena.hpp
+/// \brief Contains declarations of utility classes and functions for
+/// allocating large buffers on transparent huge pages.
+/// \bug No known bugs.
+
+#ifndef HUGEPAGEARENA_HPP
+#define HUGEPAGEARENA_HPP
+
+#include <QtGlobal>
+
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+
+/// A namespace that contains common utility classes and functions.
+namespace Common::Utility {
+
+    /// Size of a huge page in bytes.
+    constexpr std::size_t HUGE_PAGE_SIZE { 2 * 1024 * 1024 };
+
+    /// A class that allocates large buffers on transparent huge pages.
+    /// \details Buffers are mapped in multiples of HUGE_PAGE_SIZE on huge
+    /// page boundaries and advised for huge pages, so a streaming pass over
+    /// a 4K frame touches a few dozen TLB entries instead of thousands.
+    /// Released buffers are kept for reuse up to a cache limit, which also
+    /// spares the page faults and zeroing of a fresh mapping per frame.
+    /// Where transparent huge pages are disabled, buffers are still mapped
+    /// and reused on small pages. Requests below half a huge page, and all
+    /// requests on systems without anonymous mappings, are refused, so
+    /// callers fall back to their usual allocator.
+    class HugePageArena {
+    public:
+
+        /// A structure that contains arena statistics.
+        struct Statistics {
+
+            /// Number of buffers handed out.
+            quint64 allocations = 0;
+
+            /// Number of buffers handed out from the cache.
+            quint64 reuses = 0;
+
+            /// Number of buffers mapped on huge pages.
+            quint64 hugePageMappings = 0;
+
+            /// Number of buffers mapped on small pages.
+            quint64 smallPageMappings = 0;
+
+            /// Bytes mapped in use or cached.
+            quint64 mappedBytes = 0;
+
+            /// Bytes cached for reuse.
+            quint64 cachedBytes = 0;
+        };
+
+    public:
+
+        /// Returns the arena of the process.
+        /// \return Huge page arena.
+        static HugePageArena& instance();
+
+        /// Indicates whether the system provides transparent huge pages.
+        /// \retval true if mappings can be advised for huge pages.
+        /// \retval false otherwise.
+        static bool isSupported() noexcept;
+
+        /// Advises an existing allocation for huge pages.
+        /// \param[in]  data    Start of the allocation.
+        /// \param[in]  size    Size of the allocation in bytes.
+        static void advise(void* data, std::size_t size) noexcept;
+
+    public:
+
+        HugePageArena(const HugePageArena&) = delete;
+        HugePageArena& operator=(const HugePageArena&) = delete;
+
+        /// Allocates a buffer.
+        /// \param[in]  size    Size in bytes.
+        /// \return Buffer aligned to HUGE_PAGE_SIZE, or null if the arena
+        /// does not serve the request.
+        void* allocate(std::size_t size) noexcept;
+
+        /// Releases a buffer allocated by allocate().
+        /// \param[in]  data    Buffer, or null.
+        void release(void* data) noexcept;
+
+        /// Indicates whether new buffers are advised for huge pages.
+        /// \retval true if huge pages are used where supported.
+        /// \retval false if new buffers use small pages.
+        bool hugePagesEnabled() const noexcept;
+
+        /// Enables or disables huge pages for new buffers.
+        /// \details Cached buffers are unmapped.
+        /// \param[in]  enabled Indicates whether huge pages are used.
+        void setHugePagesEnabled(bool enabled) noexcept;
+
+        /// Returns the cache limit.
+        /// \return Limit in bytes.
+        quint64 cacheLimit() const noexcept;
+
+        /// Sets the cache limit.
+        /// \param[in]  bytes   Limit in bytes, zero to cache nothing.
+        void setCacheLimit(quint64 bytes) noexcept;
+
+        /// Unmaps cached buffers.
+        void trim() noexcept;
+
+        /// Returns arena statistics.
+        /// \return Statistics.
+        Statistics statistics() const;
+
+    private:
+
+        /// Constructs the arena.
+        HugePageArena();
+
+        /// Destroys the arena.
+        ~HugePageArena();
+
+        /// Unmaps cached buffers until the cache fits a limit.
+        /// \details Expects the mutex to be held.
+        /// \param[in]  limit   Limit in bytes.
+        void shrink(quint64 limit) noexcept;
+
+    private:
+
+        /// Guards the buffers and the statistics.
+        mutable std::mutex mutex_;
+
+        /// Mapped sizes of buffers in use.
+        std::unordered_map<void*, std::size_t> buffers_;
+
+        /// Cached buffers by mapped size.
+        std::multimap<std::size_t, void*> cache_;
+
+        /// Indicates whether new buffers are advised for huge pages.
+        bool hugePagesEnabled_ = true;
+
+        /// Cache limit in bytes.
+        quint64 cacheLimit_ = 0;
+
+        /// Arena statistics.
+        Statistics statistics_;
+    };
+
+    /// A class that owns a large buffer.
+    /// \details Takes the buffer from the huge page arena and falls back to
+    /// the heap when the arena refuses it. Contents are uninitialized.
+    class HugePageBuffer {
+    public:
+
+        /// Constructs an empty buffer.
+        HugePageBuffer() noexcept = default;
+
+        /// Allocates a buffer.
+        /// \param[in]  size    Size in bytes.
+        explicit HugePageBuffer(std::size_t size);
+
+        /// Releases the buffer.
+        ~HugePageBuffer();
+
+        HugePageBuffer(HugePageBuffer&& other) noexcept;
+        HugePageBuffer& operator=(HugePageBuffer&& other) noexcept;
+
+        HugePageBuffer(const HugePageBuffer&) = delete;
+        HugePageBuffer& operator=(const HugePageBuffer&) = delete;
+
+    public:
+
+        /// Returns the buffer.
+        /// \return Buffer, or null if empty.
+        uchar* data() const noexcept;
+
+        /// Returns the buffer size.
+        /// \return Size in bytes.
+        std::size_t size() const noexcept;
+
+        /// Indicates whether the buffer comes from the huge page arena.
+        /// \retval true if the buffer is mapped by the arena.
+        /// \retval false if it is empty or on the heap.
+        bool isMapped() const noexcept;
+
+    private:
+
+        /// Releases the buffer.
+        void reset() noexcept;
+
+    private:
+
+        /// Buffer.
+        uchar* data_ = nullptr;
+
+        /// Buffer size in bytes.
+        std::size_t size_ = 0;
+
+        /// Indicates whether the buffer comes from the huge page arena.
+        bool mapped_ = false;
+    };
+}
+
+#endif
@@ -0,0 +1,383 @@
+/// \file MemoryBudget.cpp
+/// \brief Contains definitions of utility classes and functions for bounding
+/// the memory held by streams.
+/// \bug No known bugs.
+
+#include "MemoryBudget.hpp"
+#include "ChronoUtilities.hpp"
+
+#include <algorithm>
+
+#if defined (Q_OS_UNIX)
+    #include <unistd.h>
+#endif
+
+namespace {
+
+    /// Minimum interval between enforcements in microseconds.
+    /// \details Stages free memory on their next frame, so enforcing more
+    /// often would reclaim the same bytes twice.
+    constexpr quint64 ENFORCEMENT_INTERVAL { 250000 };
+
+    /// Usage below which degraded streams are restored, in percent of the
+    /// limit.
+    constexpr quint64 RESTORE_PERCENT { 75 };
+
+    /// Maximum degradation level.
+    /// \details Level two scales output images to a quarter of their size.
+    constexpr int MAXIMUM_DEGRADATION { 2 };
+
+    /// Returns the default limit of the process.
+    /// \details Half of the physical memory where it is known.
+    /// \return Limit in bytes, zero if unlimited.
+    quint64 defaultGlobalLimit() noexcept {
+#if defined (Q_OS_UNIX)
+        auto pages = sysconf(_SC_PHYS_PAGES);
+        auto pageSize = sysconf(_SC_PAGESIZE);
+
+        if (pages > 0 && pageSize > 0)
+            return static_cast<quint64>(pages) *
+                   static_cast<quint64>(pageSize) / 2;
+#endif
+        return 0;
+    }
+}
+
+/// A namespace that contains common utility classes and functions.
+namespace Common::Utility {
+
+    /// Returns the name of a memory stage.
+    /// \details Names are meant for monitors and logs.
+    /// \param[in]  stage   Memory stage.
+    /// \return Stage name.
+    const char* memoryStageName(MemoryStage stage) noexcept {
+        switch (stage) {
+        case MemoryStage::Decoding:
+            return "decoding";
+        case MemoryStage::Conversion:
+            return "conversion";
+        case MemoryStage::Presentation:
+            return "presentation";
+        case MemoryStage::Texture:
+            return "texture";
+        }
+
+        return "";
+    }
+
+    /// Constructs an account.
+    /// \details Accounts are created by MemoryBudget::createAccount().
+    /// \param[in]  budget  Budget the account reports to.
+    /// \param[in]  name    Stream name.
+    MemoryAccount::MemoryAccount(MemoryBudget& budget, const QString& name)
+        : budget_(budget),
+          name_(name) {
+    }
+
+    /// Destroys the account, removing its usage from the budget.
+    MemoryAccount::~MemoryAccount() noexcept {
+        budget_.remove(this);
+    }
+
+    /// Returns the stream name.
+    /// \return Stream name.
+    const QString& MemoryAccount::name() const noexcept {
+        return name_;
+    }
+
+    /// Sets the memory held by a stage.
+    /// \details Stages report what they hold after each change, so a stage
+    /// never needs to remember what it reported before.
+    /// \param[in]  stage   Memory stage.
+    /// \param[in]  bytes   Number of bytes.
+    void MemoryAccount::setUsage(MemoryStage stage, quint64 bytes) noexcept {
+        auto previous = usage_[static_cast<int>(stage)].exchange(bytes, relaxed);
+        if (previous == bytes) return;
+
+        auto delta = static_cast<qint64>(bytes - previous);
+        totalUsage_.fetch_add(static_cast<quint64>(delta), relaxed);
+
+        budget_.update(*this, delta);
+    }
+
+    /// Returns the memory held by a stage.
+    /// \param[in]  stage   Memory stage.
+    /// \return Number of bytes.
+    quint64 MemoryAccount::usage(MemoryStage stage) const noexcept {
+        return usage_[static_cast<int>(stage)].load(relaxed);
+    }
+
+    /// Returns the memory held by all stages.
+    /// \return Number of bytes.
+    quint64 MemoryAccount::totalUsage() const noexcept {
+        return totalUsage_.load(relaxed);
+    }
+
+    /// Indicates whether the stream is hidden.
+    /// \retval true if the stream is hidden.
+    /// \retval false otherwise.
+    bool MemoryAccount::isHidden() const noexcept {
+        return hidden_.load(relaxed);
+    }
+
+    /// Marks the stream hidden or visible.
+    /// \details Hidden streams are asked to evict their caches before any
+    /// visible stream is degraded.
+    /// \param[in]  hidden  Indicates whether the stream is hidden.
+    void MemoryAccount::setHidden(bool hidden) noexcept {
+        hidden_.store(hidden, relaxed);
+    }
+
+    /// Returns the degradation level.
+    /// \details Output images are scaled to half the width and height per
+    /// level.
+    /// \return Number of times output images are halved in size.
+    int MemoryAccount::degradation() const noexcept {
+        return degradation_.load(relaxed);
+    }
+
+    /// Returns the number of evictions requested.
+    /// \details A stage that sees the count change drops what it only keeps
+    /// to resume quickly.
+    /// \return Number of evictions.
+    quint64 MemoryAccount::evictionCount() const noexcept {
+        return evictions_.load(relaxed);
+    }
+
+    /// Returns the budget of the process.
+    /// \return Memory budget.
+    MemoryBudget& MemoryBudget::instance() {
+        static MemoryBudget budget;
+        return budget;
+    }
+
+    /// Constructs a memory budget.
+    /// \details The process may hold half of the physical memory where it
+    /// is known and is unlimited otherwise. Streams are unlimited.
+    MemoryBudget::MemoryBudget()
+        : globalLimit_(defaultGlobalLimit()) {
+    }
+
+    /// Creates the account of a stream.
+    /// \param[in]  name    Stream name.
+    /// \return Account, removed from the budget when destroyed.
+    std::shared_ptr<MemoryAccount> MemoryBudget::createAccount(const QString& name) {
+        std::shared_ptr<MemoryAccount> account(new MemoryAccount(*this, name));
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        accounts_.push_back(account.get());
+
+        return account;
+    }
+
+    /// Returns the limit of the process.
+    /// \return Limit in bytes, zero if unlimited.
+    quint64 MemoryBudget::globalLimit() const noexcept {
+        return globalLimit_.load(relaxed);
+    }
+
+    /// Sets the limit of the process.
+    /// \param[in]  bytes   Limit in bytes, zero if unlimited.
+    void MemoryBudget::setGlobalLimit(quint64 bytes) noexcept {
+        globalLimit_.store(bytes, relaxed);
+    }
+
+    /// Returns the limit per stream.
+    /// \return Limit in bytes, zero if unlimited.
+    quint64 MemoryBudget::streamLimit() const noexcept {
+        return streamLimit_.load(relaxed);
+    }
+
+    /// Sets the limit per stream.
+    /// \param[in]  bytes   Limit in bytes, zero if unlimited.
+    void MemoryBudget::setStreamLimit(quint64 bytes) noexcept {
+        streamLimit_.store(bytes, relaxed);
+    }
+
+    /// Returns the memory held by all streams.
+    /// \return Number of bytes.
+    quint64 MemoryBudget::totalUsage() const noexcept {
+        return totalUsage_.load(relaxed);
+    }
+
+    /// Returns a breakdown of the memory held per stage and per stream.
+    /// \details Reads relaxed atomic counters, so the breakdown may be
+    /// slightly inconsistent across streams.
+    /// \return Budget breakdown.
+    MemoryBudget::Snapshot MemoryBudget::snapshot() const {
+        Snapshot snapshot;
+        snapshot.totalBytes = totalUsage_.load(relaxed);
+        snapshot.globalLimit = globalLimit_.load(relaxed);
+        snapshot.streamLimit = streamLimit_.load(relaxed);
+        snapshot.evictions = evictions_.load(relaxed);
+        snapshot.degradations = degradations_.load(relaxed);
+        snapshot.restorations = restorations_.load(relaxed);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        snapshot.streams.reserve(accounts_.size());
+
+        for (auto account : accounts_) {
+            StreamUsage usage;
+            usage.name = account->name();
+            usage.totalBytes = account->totalUsage();
+            usage.hidden = account->isHidden();
+            usage.degradation = account->degradation();
+
+            for (auto stage = 0; stage < MEMORY_STAGE_COUNT; ++stage) {
+                usage.bytes[stage] = account->usage_[stage].load(relaxed);
+                snapshot.bytes[stage] += usage.bytes[stage];
+            }
+
+            snapshot.streams.push_back(usage);
+        }
+
+        return snapshot;
+    }
+
+    /// Accounts a change of the usage of a stream.
+    /// \details Enforces the limits if either is exceeded or a degraded
+    /// stream may be restored. Enforcement is skipped while another thread
+    /// enforces or if the last one was less than ENFORCEMENT_INTERVAL ago,
+    /// so reporting threads never wait for each other.
+    /// \param[in]  account Stream account.
+    /// \param[in]  delta   Change in bytes.
+    void MemoryBudget::update(MemoryAccount& account, qint64 delta) noexcept {
+        auto total = totalUsage_.fetch_add(static_cast<quint64>(delta), relaxed) +
+                     static_cast<quint64>(delta);
+
+        auto globalLimit = globalLimit_.load(relaxed);
+        auto streamLimit = streamLimit_.load(relaxed);
+
+        auto exceeded = (globalLimit > 0 && total > globalLimit) ||
+                        (streamLimit > 0 && account.totalUsage() > streamLimit);
+
+        if (!exceeded && degradedStreams_.load(relaxed) == 0) return;
+
+        auto now = timestampMicroseconds64();
+        auto last = enforcementTime_.load(relaxed);
+
+        if (now - last < ENFORCEMENT_INTERVAL ||
+            !enforcementTime_.compare_exchange_strong(last, now, relaxed))
+            return;
+
+        std::unique_lock<std::mutex> lock(mutex_, std::try_to_lock);
+        if (lock) enforce();
+    }
+
+    /// Removes an account.
+    /// \details Its usage is taken off the total without enforcement.
+    /// \param[in]  account Stream account.
+    void MemoryBudget::remove(MemoryAccount* account) noexcept {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            accounts_.erase(std::remove(accounts_.begin(), accounts_.end(), account),
+                            accounts_.end());
+        }
+
+        totalUsage_.fetch_sub(account->totalUsage(), relaxed);
+
+        if (account->degradation() > 0)
+            degradedStreams_.fetch_sub(1, relaxed);
+    }
+
+    /// Evicts and degrades streams to stay within the limits.
+    /// \details Streams over their own limit give memory back first. If the
+    /// process is still over its limit, streams give memory back until the
+    /// expected savings cover the excess: hidden streams before visible
+    /// ones, larger streams before smaller ones. When nothing had to be
+    /// reclaimed and usage is below RESTORE_PERCENT of the limits, the most
+    /// degraded stream is restored by one level. Expects the mutex to be
+    /// held.
+    void MemoryBudget::enforce() noexcept {
+        auto globalLimit = globalLimit_.load(relaxed);
+        auto streamLimit = streamLimit_.load(relaxed);
+        auto reclaimed = false;
+
+        if (streamLimit > 0) {
+            for (auto account : accounts_) {
+                if (account->totalUsage() > streamLimit) {
+                    reclaim(*account);
+                    reclaimed = true;
+                }
+            }
+        }
+
+        auto total = totalUsage_.load(relaxed);
+
+        if (globalLimit > 0 && total > globalLimit) {
+            auto candidates = accounts_;
+
+            std::stable_sort(candidates.begin(), candidates.end(),
+                             [](const MemoryAccount* left, const MemoryAccount* right) {
+                                 if (left->isHidden() != right->isHidden())
+                                     return left->isHidden();
+
+                                 return left->totalUsage() > right->totalUsage();
+                             });
+
+            auto excess = total - globalLimit;
+            quint64 freed = 0;
+
+            for (auto account : candidates) {
+                if (freed >= excess) break;
+                freed += reclaim(*account);
+            }
+
+            reclaimed = true;
+        }
+
+        if (reclaimed || degradedStreams_.load(relaxed) == 0) return;
+
+        if (globalLimit > 0 && total > globalLimit / 100 * RESTORE_PERCENT)
+            return;
+
+        MemoryAccount* restored = nullptr;
+
+        for (auto account : accounts_) {
+            if (account->degradation() == 0) continue;
+
+            if (streamLimit > 0 &&
+                account->totalUsage() > streamLimit / 100 * RESTORE_PERCENT)
+                continue;
+
+            if (!restored || account->degradation() > restored->degradation())
+                restored = account;
+        }
+
+        if (!restored) return;
+
+        if (restored->degradation_.fetch_sub(1, relaxed) == 1)
+            degradedStreams_.fetch_sub(1, relaxed);
+
+        restorations_.fetch_add(1, relaxed);
+    }
+
+    /// Asks a stream to give memory back.
+    /// \details Hidden streams evict their caches: converted and queued
+    /// images. Visible streams are degraded
+    /// by one level, which shrinks their images and textures to a quarter
+    /// once the next frame is converted. Expects the mutex to be held.
+    /// \param[in]  account Stream account.
+    /// \return Number of bytes expected to be freed.
+    quint64 MemoryBudget::reclaim(MemoryAccount& account) noexcept {
+        auto images = account.usage(MemoryStage::Conversion) +
+                      account.usage(MemoryStage::Presentation);
+
+        if (account.isHidden()) {
+            if (images == 0) return 0;
+
+            account.evictions_.fetch_add(1, relaxed);
+            evictions_.fetch_add(1, relaxed);
+            return images;
+        }
+
+        auto level = account.degradation();
+        if (level >= MAXIMUM_DEGRADATION) return 0;
+
+        account.degradation_.store(level + 1, relaxed);
+        if (level == 0) degradedStreams_.fetch_add(1, relaxed);
+
+        degradations_.fetch_add(1, relaxed);
+        return (images + account.usage(MemoryStage::Texture)) / 4 * 3;
+    }
+}
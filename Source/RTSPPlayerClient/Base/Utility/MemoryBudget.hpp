@@ -0,0 +1,289 @@
+/// \file MemoryBudget.hpp
+/// \brief Contains declarations of utility classes and functions for bounding
+/// the memory held by streams.
+/// \bug No known bugs.
+
+#ifndef MEMORYBUDGET_HPP
+#define MEMORYBUDGET_HPP
+
+#include <QString>
+#include <QtGlobal>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/// A namespace that contains common utility classes and functions.
+namespace Common::Utility {
+
+    class MemoryBudget;
+
+    /// Stages that hold stream memory.
+    enum class MemoryStage {
+        Decoding        ,   ///< Decoder pictures and references.
+        Conversion      ,   ///< Converted output images.
+        Presentation    ,   ///< Images queued for presentation.
+        Texture         ,   ///< Textures and pixel unpack buffers.
+    };
+
+    /// Number of memory stages.
+    constexpr int MEMORY_STAGE_COUNT { 4 };
+
+    /// Returns the name of a memory stage.
+    /// \param[in]  stage   Memory stage.
+    /// \return Stage name.
+    const char* memoryStageName(MemoryStage stage) noexcept;
+
+    /// A class that accounts the memory of one stream.
+    /// \details Written by the stages a stream passes, on whatever thread
+    /// they run, and read by the budget and by monitors. Usage is kept in
+    /// relaxed atomics, so reporting never waits. Stages also read back what
+    /// the budget asks of the stream: a degradation level to scale output
+    /// images down by, and an eviction count that grows whenever the stream
+    /// should drop what it only keeps to resume quickly.
+    class MemoryAccount {
+    public:
+
+        /// Destroys the account, removing its usage from the budget.
+        ~MemoryAccount() noexcept;
+
+        MemoryAccount(const MemoryAccount&) = delete;
+        MemoryAccount& operator=(const MemoryAccount&) = delete;
+
+    public:
+
+        /// Returns the stream name.
+        /// \return Stream name.
+        const QString& name() const noexcept;
+
+        /// Sets the memory held by a stage.
+        /// \param[in]  stage   Memory stage.
+        /// \param[in]  bytes   Number of bytes.
+        void setUsage(MemoryStage stage, quint64 bytes) noexcept;
+
+        /// Returns the memory held by a stage.
+        /// \param[in]  stage   Memory stage.
+        /// \return Number of bytes.
+        quint64 usage(MemoryStage stage) const noexcept;
+
+        /// Returns the memory held by all stages.
+        /// \return Number of bytes.
+        quint64 totalUsage() const noexcept;
+
+        /// Indicates whether the stream is hidden.
+        /// \retval true if the stream is hidden.
+        /// \retval false otherwise.
+        bool isHidden() const noexcept;
+
+        /// Marks the stream hidden or visible.
+        /// \param[in]  hidden  Indicates whether the stream is hidden.
+        void setHidden(bool hidden) noexcept;
+
+        /// Returns the degradation level.
+        /// \return Number of times output images are halved in size.
+        int degradation() const noexcept;
+
+        /// Returns the number of evictions requested.
+        /// \return Number of evictions.
+        quint64 evictionCount() const noexcept;
+
+    private:
+
+        friend class MemoryBudget;
+
+        /// Constructs an account.
+        /// \param[in]  budget  Budget the account reports to.
+        /// \param[in]  name    Stream name.
+        MemoryAccount(MemoryBudget& budget, const QString& name);
+
+    private:
+
+        /// Memory order used by counters.
+        static constexpr auto relaxed = std::memory_order_relaxed;
+
+        /// Budget the account reports to.
+        MemoryBudget& budget_;
+
+        /// Stream name.
+        QString name_;
+
+        /// Bytes held per stage.
+        std::atomic<quint64> usage_[MEMORY_STAGE_COUNT] { };
+
+        /// Bytes held by all stages.
+        std::atomic<quint64> totalUsage_ { 0 };
+
+        /// Indicates whether the stream is hidden.
+        std::atomic<bool> hidden_ { false };
+
+        /// Number of times output images are halved in size.
+        std::atomic<int> degradation_ { 0 };
+
+        /// Number of evictions requested.
+        std::atomic<quint64> evictions_ { 0 };
+    };
+
+    /// A class that bounds the memory held by streams.
+    /// \details Streams report the bytes each stage holds to their accounts,
+    /// and the budget enforces a limit per stream and one for the process.
+    /// A stream over its limit, or the largest streams while the process is
+    /// over its limit, are reclaimed in two steps: hidden streams are asked
+    /// to evict their caches first, then visible streams are degraded to
+    /// half and quarter size output. Degraded streams are restored one
+    /// level at a time once usage falls well below the limits. Enforcement
+    /// runs on the thread that reported the usage, at most once per
+    /// ENFORCEMENT_INTERVAL, and only sets the levels stages read back, as
+    /// stages free memory themselves on their next frame.
+    class MemoryBudget {
+    public:
+
+        /// A structure that contains the usage of a stream.
+        struct StreamUsage {
+
+            /// Stream name.
+            QString name;
+
+            /// Bytes held per stage.
+            quint64 bytes[MEMORY_STAGE_COUNT] { };
+
+            /// Bytes held by all stages.
+            quint64 totalBytes = 0;
+
+            /// Indicates whether the stream is hidden.
+            bool hidden = false;
+
+            /// Number of times output images are halved in size.
+            int degradation = 0;
+        };
+
+        /// A structure that contains a breakdown of the budget.
+        struct Snapshot {
+
+            /// Bytes held per stage by all streams.
+            quint64 bytes[MEMORY_STAGE_COUNT] { };
+
+            /// Bytes held by all streams.
+            quint64 totalBytes = 0;
+
+            /// Limit of the process in bytes, zero if unlimited.
+            quint64 globalLimit = 0;
+
+            /// Limit per stream in bytes, zero if unlimited.
+            quint64 streamLimit = 0;
+
+            /// Number of evictions requested.
+            quint64 evictions = 0;
+
+            /// Number of degradations requested.
+            quint64 degradations = 0;
+
+            /// Number of restored degradation levels.
+            quint64 restorations = 0;
+
+            /// Usage per stream.
+            std::vector<StreamUsage> streams;
+        };
+
+    public:
+
+        /// Returns the budget of the process.
+        /// \return Memory budget.
+        static MemoryBudget& instance();
+
+    public:
+
+        /// Creates the account of a stream.
+        /// \param[in]  name    Stream name.
+        /// \return Account, removed from the budget when destroyed.
+        std::shared_ptr<MemoryAccount> createAccount(const QString& name);
+
+        /// Returns the limit of the process.
+        /// \return Limit in bytes, zero if unlimited.
+        quint64 globalLimit() const noexcept;
+
+        /// Sets the limit of the process.
+        /// \param[in]  bytes   Limit in bytes, zero if unlimited.
+        void setGlobalLimit(quint64 bytes) noexcept;
+
+        /// Returns the limit per stream.
+        /// \return Limit in bytes, zero if unlimited.
+        quint64 streamLimit() const noexcept;
+
+        /// Sets the limit per stream.
+        /// \param[in]  bytes   Limit in bytes, zero if unlimited.
+        void setStreamLimit(quint64 bytes) noexcept;
+
+        /// Returns the memory held by all streams.
+        /// \return Number of bytes.
+        quint64 totalUsage() const noexcept;
+
+        /// Returns a breakdown of the memory held per stage and per stream.
+        /// \return Budget breakdown.
+        Snapshot snapshot() const;
+
+    private:
+
+        friend class MemoryAccount;
+
+        /// Constructs a memory budget.
+        MemoryBudget();
+
+        /// Accounts a change of the usage of a stream.
+        /// \param[in]  account Stream account.
+        /// \param[in]  delta   Change in bytes.
+        void update(MemoryAccount& account, qint64 delta) noexcept;
+
+        /// Removes an account.
+        /// \param[in]  account Stream account.
+        void remove(MemoryAccount* account) noexcept;
+
+        /// Evicts and degrades streams to stay within the limits.
+        /// \details Expects the mutex to be held.
+        void enforce() noexcept;
+
+        /// Asks a stream to give memory back.
+        /// \details Hidden streams evict their caches, visible streams are
+        /// degraded by one level. Expects the mutex to be held.
+        /// \param[in]  account Stream account.
+        /// \return Number of bytes expected to be freed.
+        quint64 reclaim(MemoryAccount& account) noexcept;
+
+    private:
+
+        /// Memory order used by counters.
+        static constexpr auto relaxed = std::memory_order_relaxed;
+
+        /// Guards the accounts and enforcement.
+        mutable std::mutex mutex_;
+
+        /// Accounts of all streams.
+        std::vector<MemoryAccount*> accounts_;
+
+        /// Bytes held by all streams.
+        std::atomic<quint64> totalUsage_ { 0 };
+
+        /// Limit of the process in bytes, zero if unlimited.
+        std::atomic<quint64> globalLimit_ { 0 };
+
+        /// Limit per stream in bytes, zero if unlimited.
+        std::atomic<quint64> streamLimit_ { 0 };
+
+        /// Number of degraded streams.
+        std::atomic<int> degradedStreams_ { 0 };
+
+        /// Time of the last enforcement in microseconds.
+        std::atomic<quint64> enforcementTime_ { 0 };
+
+        /// Number of evictions requested.
+        std::atomic<quint64> evictions_ { 0 };
+
+        /// Number of degradations requested.
+        std::atomic<quint64> degradations_ { 0 };
+
+        /// Number of restored degradation levels.
+        std::atomic<quint64> restorations_ { 0 };
+    };
+}
+
+#endif
@@ -0,0 +1,465 @@
+/// \file ThreadAffinity.cpp
+/// \brief Contains definitions of utility classes and functions for placing
+/// threads on processors by their role.
+/// \bug No known bugs.
+
+#include "ThreadAffinity.hpp"
+
+#include <QByteArray>
+#include <QFile>
+#include <QThread>
+
+#include <algorithm>
+#include <map>
+#include <set>
+#include <thread>
+
+#if defined (Q_OS_LINUX)
+    #include <pthread.h>
+    #include <sched.h>
+#endif
+
+namespace {
+
+    /// Directory that describes the processors.
+    constexpr char PROCESSOR_DIRECTORY[] { "/sys/devices/system/cpu/" };
+
+    /// Minimum number of physical cores for the GUI and render threads to
+    /// get their own.
+    /// \details Leaves at least one core to decoding.
+    constexpr std::size_t MINIMUM_RESERVED_CORES { 3 };
+
+    /// Minimum number of physical cores for IO threads to get their own when
+    /// no processor is isolated.
+    constexpr std::size_t MINIMUM_IO_CORES { 4 };
+
+    /// Reads a processor list such as "0-3,8,10-11".
+    /// \param[in]  fileName    File that contains the list.
+    /// \return Processors in ascending order, empty if unknown.
+    std::vector<int> readProcessorList(const QString& fileName) {
+        std::set<int> processors;
+
+        QFile file(fileName);
+        if (!file.open(QIODevice::ReadOnly)) return { };
+
+        for (const auto& range : file.readAll().trimmed().split(',')) {
+            if (range.isEmpty()) continue;
+
+            auto bounds = range.split('-');
+            auto ok = false, lastOk = false;
+            auto first = bounds.front().toInt(&ok);
+            auto last = bounds.size() > 1 ? bounds[1].toInt(&lastOk) : first;
+
+            if (!ok || (bounds.size() > 1 && !lastOk) || first < 0)
+                continue;
+
+            for (auto processor = first; processor <= last; ++processor)
+                processors.insert(processor);
+        }
+
+        return { processors.begin(), processors.end() };
+    }
+
+    /// Returns the processors the process may run on.
+    /// \return Processors in ascending order.
+    std::vector<int> allowedProcessors() {
+        std::vector<int> processors;
+
+#if defined (Q_OS_LINUX)
+        cpu_set_t set;
+        CPU_ZERO(&set);
+
+        if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+            for (auto processor = 0; processor < CPU_SETSIZE; ++processor) {
+                if (CPU_ISSET(processor, &set))
+                    processors.push_back(processor);
+            }
+        }
+#endif
+
+        if (processors.empty()) {
+            auto count = QThread::idealThreadCount();
+
+            for (auto processor = 0; processor < count; ++processor)
+                processors.push_back(processor);
+        }
+
+        return processors;
+    }
+
+    /// Groups processors by the physical core they belong to.
+    /// \details Processors of unknown topology count as cores of their own.
+    /// \param[in]  processors  Processors in ascending order.
+    /// \return Hardware threads per core, ordered by their first thread.
+    std::vector<std::vector<int>> groupCores(
+        const std::vector<int>& processors) {
+        std::map<int, std::vector<int>> cores;
+
+        for (auto processor : processors) {
+            auto siblings = readProcessorList(
+                QString("%1cpu%2/topology/thread_siblings_list")
+                    .arg(PROCESSOR_DIRECTORY)
+                    .arg(processor));
+
+            auto core = siblings.empty() ? processor : siblings.front();
+            cores[core].push_back(processor);
+        }
+
+        std::vector<std::vector<int>> groups;
+        for (auto& core : cores)
+            groups.push_back(std::move(core.second));
+
+        return groups;
+    }
+}
+
+/// A namespace that contains common utility classes and functions.
+namespace Common::Utility {
+
+    /// A structure that contains the state of a registered thread.
+    struct ThreadAffinity::Thread {
+
+        /// Thread identifier.
+        std::thread::id id;
+
+        /// Entered roles, the current one last.
+        std::vector<ThreadRole> roles;
+
+        /// Indicates whether the affinity was changed.
+        bool placed = false;
+
+        /// Indicates whether SCHED_FIFO scheduling was granted.
+        bool realtime = false;
+
+#if defined (Q_OS_LINUX)
+        /// Thread handle.
+        pthread_t handle;
+
+        /// Affinity before the first role.
+        cpu_set_t affinity;
+
+        /// Scheduling policy before the first role.
+        int schedulingPolicy = SCHED_OTHER;
+
+        /// Scheduling parameters before the first role.
+        sched_param schedulingParameters { };
+#endif
+    };
+
+    /// Returns the name of a thread role.
+    /// \details Names are meant for monitors and logs.
+    /// \param[in]  role    Thread role.
+    /// \return Role name.
+    const char* threadRoleName(ThreadRole role) noexcept {
+        switch (role) {
+        case ThreadRole::Io:
+            return "io";
+        case ThreadRole::Decoding:
+            return "decoding";
+        case ThreadRole::Render:
+            return "render";
+        case ThreadRole::Gui:
+            return "gui";
+        }
+
+        return "";
+    }
+
+    /// Returns the registry of the process.
+    /// \details The registry is never destroyed, since pool threads may
+    /// leave their roles while static objects are destroyed.
+    /// \return Thread affinity registry.
+    ThreadAffinity& ThreadAffinity::instance() {
+        static auto affinity = new ThreadAffinity;
+        return *affinity;
+    }
+
+    /// Builds a policy from the processor topology.
+    /// \details IO threads get the isolated processors, or the last physical
+    /// core when none is isolated and there are enough cores. The GUI thread
+    /// gets the first core and the render thread its second hardware thread,
+    /// or the next core without simultaneous multithreading, so both share
+    /// caches. Decoding gets one hardware thread on each remaining core, so
+    /// decoding threads never compete for the execution units of a core.
+    /// With too few cores only decoding is pinned.
+    /// \return Enabled policy.
+    AffinityPolicy ThreadAffinity::detectPolicy() {
+        AffinityPolicy policy;
+        policy.enabled = true;
+
+        auto& io = policy.processors[static_cast<int>(ThreadRole::Io)];
+        auto& decoding =
+            policy.processors[static_cast<int>(ThreadRole::Decoding)];
+        auto& render = policy.processors[static_cast<int>(ThreadRole::Render)];
+        auto& gui = policy.processors[static_cast<int>(ThreadRole::Gui)];
+
+        auto directory = QString(PROCESSOR_DIRECTORY);
+        auto isolated = readProcessorList(directory + "isolated");
+        auto online = readProcessorList(directory + "online");
+
+        for (auto processor : isolated) {
+            if (online.empty() ||
+                std::binary_search(online.begin(), online.end(), processor))
+                io.push_back(processor);
+        }
+
+        std::vector<int> shared;
+        for (auto processor : allowedProcessors()) {
+            if (!std::binary_search(io.begin(), io.end(), processor))
+                shared.push_back(processor);
+        }
+
+        auto cores = groupCores(shared);
+
+        if (io.empty() && cores.size() >= MINIMUM_IO_CORES) {
+            io.push_back(cores.back().front());
+            cores.pop_back();
+        }
+
+        if (cores.size() >= MINIMUM_RESERVED_CORES) {
+            gui.push_back(cores.front().front());
+
+            if (cores.front().size() > 1) {
+                render.push_back(cores.front()[1]);
+            }
+            else {
+                render.push_back(cores[1].front());
+                cores.erase(cores.begin() + 1);
+            }
+
+            cores.erase(cores.begin());
+        }
+
+        for (const auto& core : cores)
+            decoding.push_back(core.front());
+
+        return policy;
+    }
+
+    /// Returns the processor the calling thread runs on.
+    /// \details Meant for counting migrations.
+    /// \return Processor index, or -1 if unknown.
+    int ThreadAffinity::currentProcessor() noexcept {
+#if defined (Q_OS_LINUX)
+        return sched_getcpu();
+#else
+        return -1;
+#endif
+    }
+
+    /// Constructs the registry.
+    /// \details Threads float until a policy is set.
+    ThreadAffinity::ThreadAffinity() = default;
+
+    /// Destroys the registry.
+    ThreadAffinity::~ThreadAffinity() = default;
+
+    /// Returns the policy.
+    /// \return Affinity policy.
+    AffinityPolicy ThreadAffinity::policy() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return policy_;
+    }
+
+    /// Sets the policy and places registered threads again.
+    /// \details Threads of roles the policy leaves floating, and all threads
+    /// if it is disabled, get their original affinity back.
+    /// \param[in]  policy  Affinity policy.
+    void ThreadAffinity::setPolicy(const AffinityPolicy& policy) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        policy_ = policy;
+
+        for (auto& thread : threads_)
+            place(thread);
+    }
+
+    /// Makes the calling thread enter a role.
+    /// \details The first role also saves the affinity and scheduling the
+    /// thread had, so leaving its last role restores them.
+    /// \param[in]  role    Thread role.
+    /// \retval true if the thread is placed as the policy asks.
+    /// \retval false if the policy is disabled or placement failed.
+    bool ThreadAffinity::enter(ThreadRole role) {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        auto id = std::this_thread::get_id();
+        auto thread = std::find_if(threads_.begin(), threads_.end(),
+                                   [id](const Thread& thread) {
+                                       return thread.id == id;
+                                   });
+
+        if (thread == threads_.end()) {
+            Thread state;
+            state.id = id;
+
+#if defined (Q_OS_LINUX)
+            state.handle = pthread_self();
+            CPU_ZERO(&state.affinity);
+
+            if (pthread_getaffinity_np(state.handle,
+                                       sizeof(state.affinity),
+                                       &state.affinity) != 0) {
+                for (auto processor : allowedProcessors())
+                    CPU_SET(processor, &state.affinity);
+            }
+
+            pthread_getschedparam(state.handle,
+                                  &state.schedulingPolicy,
+                                  &state.schedulingParameters);
+#endif
+
+            threads_.push_back(state);
+            thread = threads_.end() - 1;
+        }
+        else {
+            --statistics_.threads[static_cast<int>(thread->roles.back())];
+        }
+
+        thread->roles.push_back(role);
+        ++statistics_.threads[static_cast<int>(role)];
+
+        return place(*thread);
+    }
+
+    /// Makes the calling thread leave its last entered role.
+    /// \details The thread is placed for its previous role, or gets its
+    /// original affinity and scheduling back after its last role.
+    void ThreadAffinity::leave() {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        auto id = std::this_thread::get_id();
+        auto thread = std::find_if(threads_.begin(), threads_.end(),
+                                   [id](const Thread& thread) {
+                                       return thread.id == id;
+                                   });
+
+        if (thread == threads_.end()) return;
+
+        --statistics_.threads[static_cast<int>(thread->roles.back())];
+        thread->roles.pop_back();
+
+        if (!thread->roles.empty()) {
+            ++statistics_.threads[static_cast<int>(thread->roles.back())];
+            place(*thread);
+            return;
+        }
+
+        restore(*thread);
+        threads_.erase(thread);
+    }
+
+    /// Returns placement statistics.
+    /// \return Statistics.
+    ThreadAffinity::Statistics ThreadAffinity::statistics() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return statistics_;
+    }
+
+    /// Places a thread for its current role.
+    /// \details A disabled policy or a floating role restores the thread.
+    /// SCHED_FIFO needs privileges most desktop sessions lack, so a refusal
+    /// is counted and the thread keeps its scheduling.
+    /// \param[in,out]  thread  Registered thread.
+    /// \retval true if the thread is placed as the policy asks.
+    /// \retval false if the policy is disabled or placement failed.
+    bool ThreadAffinity::place(Thread& thread) noexcept {
+        auto role = thread.roles.back();
+        const auto& processors = policy_.processors[static_cast<int>(role)];
+
+        if (!policy_.enabled || processors.empty()) {
+            restore(thread);
+            return false;
+        }
+
+#if defined (Q_OS_LINUX)
+        cpu_set_t set;
+        CPU_ZERO(&set);
+
+        for (auto processor : processors) {
+            if (processor >= 0 && processor < CPU_SETSIZE)
+                CPU_SET(processor, &set);
+        }
+
+        auto placed = CPU_COUNT(&set) > 0 &&
+                      pthread_setaffinity_np(thread.handle,
+                                             sizeof(set),
+                                             &set) == 0;
+
+        if (placed) {
+            thread.placed = true;
+            ++statistics_.placements;
+        }
+        else {
+            ++statistics_.failures;
+        }
+
+        auto realtime = role == ThreadRole::Io && policy_.realtimeIo;
+
+        if (realtime && !thread.realtime) {
+            sched_param parameters { };
+            parameters.sched_priority =
+                qBound(sched_get_priority_min(SCHED_FIFO),
+                       policy_.realtimePriority,
+                       sched_get_priority_max(SCHED_FIFO));
+
+            if (pthread_setschedparam(thread.handle,
+                                      SCHED_FIFO,
+                                      &parameters) == 0) {
+                thread.realtime = true;
+                ++statistics_.realtimeThreads;
+            }
+            else {
+                ++statistics_.realtimeDenials;
+            }
+        }
+        else if (!realtime && thread.realtime) {
+            pthread_setschedparam(thread.handle,
+                                  thread.schedulingPolicy,
+                                  &thread.schedulingParameters);
+
+            thread.realtime = false;
+            --statistics_.realtimeThreads;
+        }
+
+        return placed;
+#else
+        ++statistics_.failures;
+        return false;
+#endif
+    }
+
+    /// Gives a thread its original affinity and scheduling back.
+    /// \param[in,out]  thread  Registered thread.
+    void ThreadAffinity::restore(Thread& thread) noexcept {
+#if defined (Q_OS_LINUX)
+        if (thread.placed) {
+            pthread_setaffinity_np(thread.handle,
+                                   sizeof(thread.affinity),
+                                   &thread.affinity);
+            thread.placed = false;
+        }
+
+        if (thread.realtime) {
+            pthread_setschedparam(thread.handle,
+                                  thread.schedulingPolicy,
+                                  &thread.schedulingParameters);
+
+            thread.realtime = false;
+            --statistics_.realtimeThreads;
+        }
+#else
+        Q_UNUSED(thread)
+#endif
+    }
+
+    /// Makes the calling thread enter a role.
+    /// \param[in]  role    Thread role.
+    ScopedThreadRole::ScopedThreadRole(ThreadRole role) {
+        ThreadAffinity::instance().enter(role);
+    }
+
+    /// Makes the calling thread leave the role.
+    ScopedThreadRole::~ScopedThreadRole() {
+        ThreadAffinity::instance().leave();
+    }
+}
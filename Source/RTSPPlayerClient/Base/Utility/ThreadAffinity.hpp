@@ -0,0 +1,172 @@
+/// \file ThreadAffinity.hpp
+/// \brief Contains declarations of utility classes and functions for placing
+/// threads on processors by their role.
+/// \bug No known bugs.
+
+#ifndef THREADAFFINITY_HPP
+#define THREADAFFINITY_HPP
+
+#include <QtGlobal>
+
+#include <mutex>
+#include <vector>
+
+/// A namespace that contains common utility classes and functions.
+namespace Common::Utility {
+
+    /// Roles of threads placed by the affinity policy.
+    enum class ThreadRole {
+        Io          ,   ///< Network receive and send threads.
+        Decoding    ,   ///< Decoding and conversion workers.
+        Render      ,   ///< Render thread.
+        Gui         ,   ///< GUI thread.
+    };
+
+    /// Number of thread roles.
+    constexpr int THREAD_ROLE_COUNT { 4 };
+
+    /// Returns the name of a thread role.
+    /// \param[in]  role    Thread role.
+    /// \return Role name.
+    const char* threadRoleName(ThreadRole role) noexcept;
+
+    /// A structure that defines where threads of each role run.
+    struct AffinityPolicy {
+
+        /// Indicates whether threads are pinned at all.
+        bool enabled = false;
+
+        /// Processors per role, empty to leave the role floating.
+        std::vector<int> processors[THREAD_ROLE_COUNT];
+
+        /// Indicates whether IO threads ask for SCHED_FIFO scheduling.
+        bool realtimeIo = false;
+
+        /// SCHED_FIFO priority of IO threads.
+        int realtimePriority = 10;
+    };
+
+    /// A class that places threads on processors by their role.
+    /// \details Threads enter a role to be placed and leave it before they
+    /// exit. Roles nest: a thread that enters another role for a while is
+    /// placed back once it leaves it, and a thread that leaves its last role
+    /// gets its original affinity and scheduling back. Changing the policy
+    /// places every registered thread again. Placement uses the Linux
+    /// affinity and scheduling calls; elsewhere threads are only counted.
+    class ThreadAffinity {
+    public:
+
+        /// A structure that contains placement statistics.
+        struct Statistics {
+
+            /// Number of registered threads per role.
+            int threads[THREAD_ROLE_COUNT] { };
+
+            /// Number of threads running with SCHED_FIFO scheduling.
+            int realtimeThreads = 0;
+
+            /// Number of successful placements.
+            quint64 placements = 0;
+
+            /// Number of placements the system refused.
+            quint64 failures = 0;
+
+            /// Number of SCHED_FIFO requests the system refused.
+            quint64 realtimeDenials = 0;
+        };
+
+    public:
+
+        /// Returns the registry of the process.
+        /// \return Thread affinity registry.
+        static ThreadAffinity& instance();
+
+        /// Builds a policy from the processor topology.
+        /// \return Enabled policy.
+        static AffinityPolicy detectPolicy();
+
+        /// Returns the processor the calling thread runs on.
+        /// \return Processor index, or -1 if unknown.
+        static int currentProcessor() noexcept;
+
+    public:
+
+        ThreadAffinity(const ThreadAffinity&) = delete;
+        ThreadAffinity& operator=(const ThreadAffinity&) = delete;
+
+        /// Returns the policy.
+        /// \return Affinity policy.
+        AffinityPolicy policy() const;
+
+        /// Sets the policy and places registered threads again.
+        /// \param[in]  policy  Affinity policy.
+        void setPolicy(const AffinityPolicy& policy);
+
+        /// Makes the calling thread enter a role.
+        /// \param[in]  role    Thread role.
+        /// \retval true if the thread is placed as the policy asks.
+        /// \retval false if the policy is disabled or placement failed.
+        bool enter(ThreadRole role);
+
+        /// Makes the calling thread leave its last entered role.
+        void leave();
+
+        /// Returns placement statistics.
+        /// \return Statistics.
+        Statistics statistics() const;
+
+    private:
+
+        /// A structure that contains the state of a registered thread.
+        struct Thread;
+
+        /// Constructs the registry.
+        ThreadAffinity();
+
+        /// Destroys the registry.
+        ~ThreadAffinity();
+
+        /// Places a thread for its current role.
+        /// \details Expects the mutex to be held.
+        /// \param[in,out]  thread  Registered thread.
+        /// \retval true if the thread is placed as the policy asks.
+        /// \retval false if the policy is disabled or placement failed.
+        bool place(Thread& thread) noexcept;
+
+        /// Gives a thread its original affinity and scheduling back.
+        /// \details Expects the mutex to be held.
+        /// \param[in,out]  thread  Registered thread.
+        void restore(Thread& thread) noexcept;
+
+    private:
+
+        /// Guards the policy, the threads and the statistics.
+        mutable std::mutex mutex_;
+
+        /// Affinity policy.
+        AffinityPolicy policy_;
+
+        /// Registered threads.
+        std::vector<Thread> threads_;
+
+        /// Placement statistics.
+        Statistics statistics_;
+    };
+
+    /// A class that keeps the calling thread in a role for its lifetime.
+    class ScopedThreadRole {
+    public:
+
+        /// Makes the calling thread enter a role.
+        /// \param[in]  role    Thread role.
+        explicit ScopedThreadRole(ThreadRole role);
+
+        /// Makes the calling thread leave the role.
+        ~ScopedThreadRole();
+
+        ScopedThreadRole(const ScopedThreadRole&) = delete;
+        ScopedThreadRole& operator=(const ScopedThreadRole&) = delete;
+    };
+}
+
+#endif
@@ -5,7 +5,13 @@
 HEADERS             +=                                                      \
                         $$PWD/ChecksumUtilities.hpp                         \
                         $$PWD/ChronoUtilities.hpp                           \
+                        $$PWD/HugePageArena.hpp                             \
+                        $$PWD/MemoryBudget.hpp                              \
+                        $$PWD/ThreadAffinity.hpp                            \
 
 SOURCES             +=                                                      \
                         $$PWD/ChecksumUtilities.cpp                         \
                         $$PWD/ChronoUtilities.cpp                           \
+                        $$PWD/HugePageArena.cpp                             \
+                        $$PWD/MemoryBudget.cpp                              \
+                        $$PWD/ThreadAffinity.cpp                            \
@@ -0,0 +1,479 @@
+/// \file main.cpp
+/// \brief Contains entry point to the thread affinity benchmark.
+/// \bug No known bugs.
+
+#include "Base/Utility/ThreadAffinity.hpp"
+#include "Playback/Decoding/VideoDecoder.hpp"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QThread>
+
+extern "C" {
+    #include <libavcodec/avcodec.h>
+}
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    /// A structure that defines benchmark case results.
+    struct Result {
+
+        /// Number of decoded frames.
+        quint64 frames = 0;
+
+        /// 99th percentile of IO thread wakeup lateness in microseconds.
+        double wakeupP99 = 0.0;
+
+        /// Median arrival to decoded time in microseconds.
+        double latencyP50 = 0.0;
+
+        /// 99th percentile of arrival to decoded time in microseconds.
+        double latencyP99 = 0.0;
+
+        /// Maximum arrival to decoded time in microseconds.
+        double latencyMax = 0.0;
+
+        /// Number of times a decoding thread ran on another processor than
+        /// for its previous frame.
+        quint64 migrations = 0;
+
+        /// Number of placements the system refused.
+        quint64 placementFailures = 0;
+
+        /// Number of SCHED_FIFO requests the system refused.
+        quint64 realtimeDenials = 0;
+
+        /// Indicates whether a decoder reported errors.
+        bool failed = false;
+    };
+
+    /// A structure that defines benchmark settings.
+    struct Settings {
+
+        /// Number of streams.
+        int streams = 4;
+
+        /// Frames per second of each stream.
+        double fps = 30.0;
+
+        /// Number of frames per stream.
+        int frames = 600;
+
+        /// Number of threads loading the processors.
+        int load = 0;
+    };
+
+    /// Size of the buffer each load thread streams through in bytes.
+    /// \details Larger than the last level cache share of a core, so load
+    /// threads together evict what decoding threads cache.
+    constexpr std::size_t LOAD_BUFFER_SIZE { 16 * 1024 * 1024 };
+
+    /// Stride of load thread accesses in bytes.
+    constexpr std::size_t LOAD_STRIDE { 64 };
+
+    /// Benchmarked resolution.
+    constexpr int RESOLUTION[2] { 1280, 720 };
+
+    /// Number of distinct frames in the clip.
+    constexpr int CLIP_FRAMES { 30 };
+
+    /// A structure that contains frames waiting for a decoding thread.
+    struct Channel {
+
+        /// Guards the queue and the stop request.
+        std::mutex mutex;
+
+        /// Signals that a frame was queued or the thread should stop.
+        std::condition_variable available;
+
+        /// Clip indices and arrival times of queued frames.
+        std::deque<std::pair<int, Clock::time_point>> frames;
+
+        /// Indicates whether the thread should stop once the queue is empty.
+        bool stopping = false;
+
+        /// Arrival to decoded times in microseconds.
+        std::vector<double> latencies;
+
+        /// Number of processor changes between frames.
+        quint64 migrations = 0;
+
+        /// Indicates whether the decoder reported errors.
+        bool failed = false;
+    };
+
+    /// Fills a frame with a moving test pattern.
+    /// \param[in,out]  frame   YUV 4:2:0 frame.
+    /// \param[in]      index   Frame index.
+    void fillFrame(AVFrame* frame, int index) {
+        for (auto y = 0; y < frame->height; ++y) {
+            auto row = frame->data[0] + y * frame->linesize[0];
+            for (auto x = 0; x < frame->width; ++x)
+                row[x] = static_cast<uint8_t>(x + y + index * 4);
+        }
+
+        for (auto plane = 1; plane < 3; ++plane) {
+            for (auto y = 0; y < frame->height / 2; ++y) {
+                auto row = frame->data[plane] + y * frame->linesize[plane];
+                for (auto x = 0; x < frame->width / 2; ++x)
+                    row[x] = static_cast<uint8_t>(64 * plane + x - y + index);
+            }
+        }
+    }
+
+    /// Encodes an MJPEG test clip.
+    /// \param[in]  width   Frame width.
+    /// \param[in]  height  Frame height.
+    /// \param[in]  frames  Number of frames.
+    /// \return Encoded frames, empty if the encoder is unavailable.
+    std::vector<QByteArray> encodeClip(int width, int height, int frames) {
+        std::vector<QByteArray> packets;
+
+        auto codec = avcodec_find_encoder(AV_CODEC_ID_MJPEG);
+        if (!codec) return packets;
+
+        auto context = avcodec_alloc_context3(codec);
+        auto frame = av_frame_alloc();
+        auto packet = av_packet_alloc();
+        auto result = context && frame && packet;
+
+        if (result) {
+            context->width = width;
+            context->height = height;
+            context->time_base = { 1, 25 };
+            context->pix_fmt = AV_PIX_FMT_YUVJ420P;
+            context->flags |= AV_CODEC_FLAG_QSCALE;
+            context->global_quality = FF_QP2LAMBDA * 4;
+
+            frame->format = context->pix_fmt;
+            frame->width = width;
+            frame->height = height;
+
+            result = avcodec_open2(context, codec, nullptr) >= 0 &&
+                     av_frame_get_buffer(frame, 0) >= 0;
+        }
+
+        for (auto i = 0; result && i < frames; ++i) {
+            result = av_frame_make_writable(frame) >= 0;
+            if (!result) break;
+
+            fillFrame(frame, i);
+            frame->pts = i;
+
+            result = avcodec_send_frame(context, frame) >= 0;
+
+            while (result && avcodec_receive_packet(context, packet) == 0) {
+                packets.emplace_back(reinterpret_cast<const char*>(packet->data),
+                                     packet->size);
+                av_packet_unref(packet);
+            }
+        }
+
+        if (!result) packets.clear();
+
+        av_packet_free(&packet);
+        av_frame_free(&frame);
+        avcodec_free_context(&context);
+
+        return packets;
+    }
+
+    /// Returns a percentile of samples.
+    /// \param[in,out]  samples     Samples, sorted in place.
+    /// \param[in]      share       Percentile between 0 and 100.
+    /// \return Percentile, or zero without samples.
+    double percentile(std::vector<double>& samples, double share) {
+        if (samples.empty()) return 0.0;
+
+        std::sort(samples.begin(), samples.end());
+
+        auto rank = static_cast<std::size_t>(share / 100.0 * samples.size());
+        return samples[std::min(rank, samples.size() - 1)];
+    }
+
+    /// Returns the microseconds between two time points.
+    /// \param[in]  from    Earlier time point.
+    /// \param[in]  to      Later time point.
+    /// \return Elapsed time in microseconds.
+    double microseconds(Clock::time_point from, Clock::time_point to) {
+        return std::chrono::duration<double, std::micro>(to - from).count();
+    }
+
+    /// Streams through memory until stopped.
+    /// \details Load threads enter no role, so they float across every
+    /// processor like unrelated work on a busy machine.
+    /// \param[in]  stopping    Stop request.
+    void loadProcessor(const std::atomic<bool>& stopping) {
+        std::vector<uint8_t> buffer(LOAD_BUFFER_SIZE, 1);
+        volatile uint8_t sink = 0;
+
+        while (!stopping.load(std::memory_order_relaxed)) {
+            uint8_t sum = 0;
+
+            for (std::size_t offset = 0; offset < buffer.size(); offset += LOAD_STRIDE) {
+                buffer[offset] = static_cast<uint8_t>(buffer[offset] + 1);
+                sum = static_cast<uint8_t>(sum + buffer[offset]);
+            }
+
+            sink = sum;
+        }
+
+        Q_UNUSED(sink)
+    }
+
+    /// Decodes and converts queued frames until stopped.
+    /// \details Each decoder uses one thread, so the measured thread does all
+    /// of its work.
+    /// \param[in]      packets Encoded clip.
+    /// \param[in,out]  channel Queue of the stream.
+    void decodeStream(const std::vector<QByteArray>& packets, Channel& channel) {
+        Common::Utility::ScopedThreadRole role(Common::Utility::ThreadRole::Decoding);
+
+        Decoders::VideoDecoder decoder;
+        decoder.setThreadCount(1);
+
+        QObject::connect(&decoder, &Decoders::VideoDecoder::onError,
+                         [&channel](Decoders::VideoDecoder::Error) {
+                             channel.failed = true;
+                         });
+
+        if (!decoder.initialize(Decoders::VideoDecoder::Codec::MJPEG,
+                                Decoders::VideoDecoder::Format::RGBX8888))
+            channel.failed = true;
+
+        auto processor = Common::Utility::ThreadAffinity::currentProcessor();
+        quint16 number = 0;
+
+        for (;;) {
+            std::pair<int, Clock::time_point> frame;
+
+            {
+                std::unique_lock<std::mutex> lock(channel.mutex);
+                channel.available.wait(lock, [&channel] {
+                    return channel.stopping || !channel.frames.empty();
+                });
+
+                if (channel.frames.empty()) return;
+
+                frame = channel.frames.front();
+                channel.frames.pop_front();
+            }
+
+            Decoders::VideoDecoder::FrameInfo info;
+            info.id = number;
+            info.number = number++;
+
+            decoder.decode(packets[static_cast<std::size_t>(frame.first)], info);
+            channel.latencies.push_back(microseconds(frame.second, Clock::now()));
+
+            auto current = Common::Utility::ThreadAffinity::currentProcessor();
+            if (current != processor) ++channel.migrations;
+            processor = current;
+        }
+    }
+
+    /// Runs a benchmark case.
+    /// \details An IO thread wakes at the frame rate and hands a frame to
+    /// the decoding thread of every stream, while load threads stream
+    /// through memory on every processor. Latency runs from the planned
+    /// arrival, so late IO wakeups count too.
+    /// \param[in]  packets     Encoded clip.
+    /// \param[in]  settings    Benchmark settings.
+    /// \param[in]  policy      Affinity policy of the case.
+    /// \return Benchmark results.
+    Result runCase(const std::vector<QByteArray>& packets,
+                   const Settings& settings,
+                   const Common::Utility::AffinityPolicy& policy) {
+
+        auto& affinity = Common::Utility::ThreadAffinity::instance();
+        auto statistics = affinity.statistics();
+        affinity.setPolicy(policy);
+
+        std::atomic<bool> stopping { false };
+        std::vector<std::thread> loaders;
+
+        for (auto i = 0; i < settings.load; ++i)
+            loaders.emplace_back(loadProcessor, std::cref(stopping));
+
+        std::vector<std::unique_ptr<Channel>> channels;
+        std::vector<std::thread> decoders;
+
+        for (auto i = 0; i < settings.streams; ++i) {
+            channels.push_back(std::make_unique<Channel>());
+            decoders.emplace_back(decodeStream, std::cref(packets), std::ref(*channels.back()));
+        }
+
+        std::vector<double> wakeups;
+
+        std::thread io([&] {
+            Common::Utility::ScopedThreadRole role(Common::Utility::ThreadRole::Io);
+
+            auto period = std::chrono::duration_cast<Clock::duration>(
+                std::chrono::duration<double>(1.0 / settings.fps));
+            auto arrival = Clock::now();
+
+            for (auto frame = 0; frame < settings.frames; ++frame) {
+                arrival += period;
+                std::this_thread::sleep_until(arrival);
+                wakeups.push_back(microseconds(arrival, Clock::now()));
+
+                auto index = frame % static_cast<int>(packets.size());
+
+                for (auto& channel : channels) {
+                    {
+                        std::lock_guard<std::mutex> lock(channel->mutex);
+                        channel->frames.emplace_back(index, arrival);
+                    }
+
+                    channel->available.notify_one();
+                }
+            }
+        });
+
+        io.join();
+
+        for (auto& channel : channels) {
+            {
+                std::lock_guard<std::mutex> lock(channel->mutex);
+                channel->stopping = true;
+            }
+
+            channel->available.notify_one();
+        }
+
+        for (auto& decoder : decoders)
+            decoder.join();
+
+        Result result;
+        result.placementFailures = affinity.statistics().failures - statistics.failures;
+        result.realtimeDenials =
+            affinity.statistics().realtimeDenials - statistics.realtimeDenials;
+
+        stopping = true;
+        for (auto& loader : loaders)
+            loader.join();
+
+        std::vector<double> latencies;
+
+        for (const auto& channel : channels) {
+            latencies.insert(latencies.end(),
+                             channel->latencies.begin(),
+                             channel->latencies.end());
+
+            result.migrations += channel->migrations;
+            result.failed = result.failed || channel->failed;
+        }
+
+        result.frames = latencies.size();
+        result.wakeupP99 = percentile(wakeups, 99.0);
+        result.latencyP50 = percentile(latencies, 50.0);
+        result.latencyP99 = percentile(latencies, 99.0);
+        result.latencyMax = latencies.empty() ? 0.0 : latencies.back();
+
+        return result;
+    }
+}
+
+/// Runs the thread affinity benchmark.
+/// \details Decodes and converts 720p MJPEG streams paced by an IO thread
+/// on a machine loaded by memory streaming threads, with floating threads,
+/// with threads pinned by the detected policy, and pinned with SCHED_FIFO
+/// for the IO thread. Reports IO wakeup lateness, median, 99th percentile
+/// and maximum arrival to decoded latency and migrations of decoding
+/// threads. Prints one JSON object per line.
+/// \param[in]  argc    Number of arguments passed to the program.
+/// \param[in]  argv    An array of pointers to the arguments passed to the
+///                     program.
+/// \return Exit status.
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    parser.addOption(QCommandLineOption("streams",
+                                        "Number of streams.",
+                                        "count",
+                                        "4"));
+    parser.addOption(QCommandLineOption("fps",
+                                        "Frames per second of each stream.",
+                                        "rate",
+                                        "30"));
+    parser.addOption(QCommandLineOption("frames",
+                                        "Number of frames per stream.",
+                                        "count",
+                                        "600"));
+    parser.addOption(QCommandLineOption("load",
+                                        "Number of threads loading the "
+                                        "processors.",
+                                        "count",
+                                        QString::number(QThread::idealThreadCount())));
+    parser.process(app);
+
+    Settings settings;
+    settings.streams = qBound(1, parser.value("streams").toInt(), 64);
+    settings.fps = qBound(1.0, parser.value("fps").toDouble(), 1000.0);
+    settings.frames = qMax(1, parser.value("frames").toInt());
+    settings.load = qBound(0, parser.value("load").toInt(), 256);
+
+    auto packets = encodeClip(RESOLUTION[0], RESOLUTION[1], CLIP_FRAMES);
+
+    if (packets.empty()) {
+        std::fprintf(stderr, "No usable MJPEG encoder\n");
+        return EXIT_FAILURE;
+    }
+
+    auto pinned = Common::Utility::ThreadAffinity::detectPolicy();
+    auto realtime = pinned;
+    realtime.realtimeIo = true;
+
+    const struct {
+        const char* name;
+        Common::Utility::AffinityPolicy policy;
+    } cases[] {
+        { "floating", Common::Utility::AffinityPolicy() },
+        { "pinned", pinned },
+        { "pinned_realtime", realtime },
+    };
+
+    for (const auto& benchmarkCase : cases) {
+        auto result = runCase(packets, settings, benchmarkCase.policy);
+
+        std::printf("{\"case\":\"%s\",\"streams\":%d,\"fps\":%.1f,\"load\":%d,"
+                    "\"frames\":%llu,\"wakeup_p99_us\":%.1f,"
+                    "\"latency_p50_us\":%.1f,\"latency_p99_us\":%.1f,"
+                    "\"latency_max_us\":%.1f,\"migrations\":%llu,"
+                    "\"placement_failures\":%llu,\"realtime_denials\":%llu,"
+                    "\"failed\":%s}\n",
+                    benchmarkCase.name,
+                    settings.streams,
+                    settings.fps,
+                    settings.load,
+                    static_cast<unsigned long long>(result.frames),
+                    result.wakeupP99,
+                    result.latencyP50,
+                    result.latencyP99,
+                    result.latencyMax,
+                    static_cast<unsigned long long>(result.migrations),
+                    static_cast<unsigned long long>(result.placementFailures),
+                    static_cast<unsigned long long>(result.realtimeDenials),
+                    result.failed ? "true" : "false");
+
+        std::fflush(stdout);
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,255 @@
+/// \file main.cpp
+/// \brief Contains entry point to the band conversion benchmark.
+/// \bug No known bugs.
+
+#include "Playback/Decoding/VideoDecoder.hpp"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QThread>
+
+extern "C" {
+    #include <libavcodec/avcodec.h>
+}
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace {
+
+    /// A structure that defines a benchmark output format.
+    struct OutputFormat {
+
+        /// Format name.
+        const char* name;
+
+        /// Decoder output format.
+        Decoders::VideoDecoder::Format format;
+    };
+
+    /// A structure that defines benchmark case results.
+    struct Result {
+
+        /// Number of converted frames, without the first one.
+        quint64 frames = 0;
+
+        /// Mean conversion time per frame in microseconds.
+        double convertTime = 0.0;
+
+        /// Number of frames converted in bands.
+        quint64 splitFrames = 0;
+
+        /// Indicates whether the decoder reported errors.
+        bool failed = false;
+    };
+
+    /// Benchmarked resolutions.
+    constexpr int RESOLUTIONS[][2] {
+        { 1920, 1080 },
+        { 3840, 2160 },
+        { 7680, 4320 },
+    };
+
+    /// Benchmarked output formats.
+    const OutputFormat OUTPUT_FORMATS[] {
+        { "rgb888", Decoders::VideoDecoder::Format::RGB888 },
+        { "rgbx8888", Decoders::VideoDecoder::Format::RGBX8888 },
+    };
+
+    /// Fills a frame with a moving test pattern.
+    /// \param[in,out]  frame   YUV 4:2:0 frame.
+    /// \param[in]      index   Frame index.
+    void fillFrame(AVFrame* frame, int index) {
+        for (auto y = 0; y < frame->height; ++y) {
+            auto row = frame->data[0] + y * frame->linesize[0];
+            for (auto x = 0; x < frame->width; ++x)
+                row[x] = static_cast<uint8_t>(x + y + index * 4);
+        }
+
+        for (auto plane = 1; plane < 3; ++plane) {
+            for (auto y = 0; y < frame->height / 2; ++y) {
+                auto row = frame->data[plane] + y * frame->linesize[plane];
+                for (auto x = 0; x < frame->width / 2; ++x)
+                    row[x] = static_cast<uint8_t>(64 * plane + x - y + index);
+            }
+        }
+    }
+
+    /// Encodes an MJPEG test clip.
+    /// \param[in]  width   Frame width.
+    /// \param[in]  height  Frame height.
+    /// \param[in]  frames  Number of frames.
+    /// \return Encoded frames, empty if the encoder is unavailable.
+    std::vector<QByteArray> encodeClip(int width, int height, int frames) {
+        std::vector<QByteArray> packets;
+
+        auto codec = avcodec_find_encoder(AV_CODEC_ID_MJPEG);
+        if (!codec) return packets;
+
+        auto context = avcodec_alloc_context3(codec);
+        auto frame = av_frame_alloc();
+        auto packet = av_packet_alloc();
+        auto result = context && frame && packet;
+
+        if (result) {
+            context->width = width;
+            context->height = height;
+            context->time_base = { 1, 25 };
+            context->pix_fmt = AV_PIX_FMT_YUVJ420P;
+            context->flags |= AV_CODEC_FLAG_QSCALE;
+            context->global_quality = FF_QP2LAMBDA * 4;
+
+            frame->format = context->pix_fmt;
+            frame->width = width;
+            frame->height = height;
+
+            result = avcodec_open2(context, codec, nullptr) >= 0 &&
+                     av_frame_get_buffer(frame, 0) >= 0;
+        }
+
+        for (auto i = 0; result && i < frames; ++i) {
+            result = av_frame_make_writable(frame) >= 0;
+            if (!result) break;
+
+            fillFrame(frame, i);
+            frame->pts = i;
+
+            result = avcodec_send_frame(context, frame) >= 0;
+
+            while (result && avcodec_receive_packet(context, packet) == 0) {
+                packets.emplace_back(reinterpret_cast<const char*>(packet->data),
+                                     packet->size);
+                av_packet_unref(packet);
+            }
+        }
+
+        if (!result) packets.clear();
+
+        av_packet_free(&packet);
+        av_frame_free(&frame);
+        avcodec_free_context(&context);
+
+        return packets;
+    }
+
+    /// Decodes a clip converting with a number of threads.
+    /// \details The first frame allocates the scalers and is left out of
+    /// the per frame time.
+    /// \param[in]  packets     Encoded frames.
+    /// \param[in]  format      Output format.
+    /// \param[in]  threadCount Number of conversion threads.
+    /// \return Benchmark results.
+    Result runCase(const std::vector<QByteArray>& packets,
+                   Decoders::VideoDecoder::Format format,
+                   int threadCount) {
+
+        Result result;
+        Decoders::VideoDecoder decoder;
+        Decoders::VideoDecoder::Statistics warmup;
+        auto frames = 0;
+
+        QObject::connect(&decoder, &Decoders::VideoDecoder::onFrame,
+                         [&](const QImage&) {
+                             if (frames++ == 0) warmup = decoder.statistics();
+                         });
+
+        QObject::connect(&decoder, &Decoders::VideoDecoder::onError,
+                         [&result](Decoders::VideoDecoder::Error) {
+                             result.failed = true;
+                         });
+
+        decoder.setConversionThreadCount(threadCount);
+
+        if (!decoder.initialize(Decoders::VideoDecoder::Codec::MJPEG, format)) {
+            result.failed = true;
+            return result;
+        }
+
+        for (const auto& packet : packets)
+            decoder.decode(packet);
+
+        decoder.decode(QByteArray());
+
+        auto statistics = decoder.statistics();
+        result.frames = statistics.convertedFrames - warmup.convertedFrames;
+        result.splitFrames = statistics.splitFrames;
+
+        if (result.frames > 0)
+            result.convertTime =
+                static_cast<double>(statistics.convertTime - warmup.convertTime) /
+                result.frames;
+
+        return result;
+    }
+}
+
+/// Runs the band conversion benchmark.
+/// \details Decodes MJPEG clips at 1080p, 4K and 8K and converts every frame
+/// split into bands over one to as many threads as processors, plus the
+/// automatic policy. Reports the conversion latency per frame and how many
+/// frames were split. Prints one JSON object per line.
+/// \param[in]  argc    Number of arguments passed to the program.
+/// \param[in]  argv    An array of pointers to the arguments passed to the
+///                     program.
+/// \return Exit status.
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    parser.addOption(QCommandLineOption("frames",
+                                        "Number of frames per clip.",
+                                        "count",
+                                        "20"));
+    parser.addOption(QCommandLineOption("threads",
+                                        "Maximum number of conversion threads.",
+                                        "count",
+                                        QString::number(QThread::idealThreadCount())));
+    parser.process(app);
+
+    auto frames = qMax(2, parser.value("frames").toInt());
+    auto maximumThreads = qBound(1, parser.value("threads").toInt(), 16);
+
+    std::vector<int> threadCounts;
+    for (auto count = 1; count < maximumThreads; count *= 2)
+        threadCounts.push_back(count);
+
+    threadCounts.push_back(maximumThreads);
+    threadCounts.push_back(0);
+
+    for (const auto& resolution : RESOLUTIONS) {
+        auto packets = encodeClip(resolution[0], resolution[1], frames);
+
+        if (packets.empty()) {
+            std::fprintf(stderr, "Skipping %dx%d: no usable encoder\n",
+                         resolution[0], resolution[1]);
+            continue;
+        }
+
+        for (const auto& format : OUTPUT_FORMATS) {
+            for (auto threadCount : threadCounts) {
+                auto result = runCase(packets, format.format, threadCount);
+
+                std::printf("{\"width\":%d,\"height\":%d,\"format\":\"%s\","
+                            "\"threads\":\"%s\",\"frames\":%llu,"
+                            "\"convert_us_per_frame\":%.1f,"
+                            "\"split_frames\":%llu,\"failed\":%s}\n",
+                            resolution[0],
+                            resolution[1],
+                            format.name,
+                            threadCount > 0
+                                ? qPrintable(QString::number(threadCount))
+                                : "auto",
+                            static_cast<unsigned long long>(result.frames),
+                            result.convertTime,
+                            static_cast<unsigned long long>(result.splitFrames),
+                            result.failed ? "true" : "false");
+
+                std::fflush(stdout);
+            }
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,26 @@
+#------------------------------------------------------------------------------#
+#                                Base settings                                 #
+#------------------------------------------------------------------------------#
+
+TEMPLATE            =   subdirs
+
+
+#------------------------------------------------------------------------------#
+#                            Project subdirectories                            #
+#------------------------------------------------------------------------------#
+
+SUBDIRS             +=                                                      \
+                        AffinityBenchmark                                   \
+                        BandConversionBenchmark                             \
+                        ConversionBenchmark                                 \
+                        DecoderBenchmark                                    \
+                        HugePageBenchmark                                   \
+                        LayoutBenchmark                                     \
+                        MjpegBenchmark                                      \
+                        MosaicBenchmark                                     \
+                        PixelFormatBenchmark                                \
+                        SoftwareRenderBenchmark                             \
+                        StreamBenchmark                                     \
+                        StreamBrowserBenchmark                              \
+                        SyncBenchmark                                       \
+                        UploadBenchmark                                     \
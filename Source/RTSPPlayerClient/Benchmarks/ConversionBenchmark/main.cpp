@@ -0,0 +1,361 @@
+/// \file main.cpp
+/// \brief Contains entry point to the conversion benchmark.
+/// \bug No known bugs.
+
+#include "Playback/Conversion/ConversionKernels.hpp"
+
+extern "C" {
+    #include <libavutil/frame.h>
+    #include <libswscale/swscale.h>
+}
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+
+namespace {
+
+    /// A structure that defines a benchmark resolution.
+    struct Resolution {
+
+        /// Resolution name.
+        const char* name;
+
+        /// Frame width.
+        int width;
+
+        /// Frame height.
+        int height;
+    };
+
+    /// A structure that defines a YUV 4:2:0 source format.
+    struct SourceFormat {
+
+        /// Format name.
+        const char* name;
+
+        /// Pixel format.
+        AVPixelFormat format;
+
+        /// Chroma layout.
+        Conversion::ChromaLayout chroma;
+    };
+
+    /// A structure that defines an RGB target format.
+    struct TargetFormat {
+
+        /// Format name.
+        const char* name;
+
+        /// Pixel format.
+        AVPixelFormat format;
+
+        /// Byte order.
+        Conversion::RgbLayout layout;
+
+        /// Pixel size in bytes.
+        int pixelSize;
+    };
+
+    /// A structure that contains the difference between two images.
+    struct Accuracy {
+
+        /// Largest absolute difference of a channel.
+        int maximum = 0;
+
+        /// Mean absolute difference of a channel.
+        double mean = 0.0;
+    };
+
+    /// Benchmarked resolutions.
+    constexpr Resolution RESOLUTIONS[] {
+        { "1080p", 1920, 1080 },
+        { "4k", 3840, 2160 },
+    };
+
+    /// Benchmarked YUV 4:2:0 source formats.
+    constexpr SourceFormat SOURCE_FORMATS[] {
+        { "yuv420p", AV_PIX_FMT_YUV420P, Conversion::ChromaLayout::Planar },
+        { "nv12", AV_PIX_FMT_NV12, Conversion::ChromaLayout::Interleaved },
+    };
+
+    /// Benchmarked RGB target formats.
+    constexpr TargetFormat TARGET_FORMATS[] {
+        { "rgb24", AV_PIX_FMT_RGB24, Conversion::RgbLayout::RGB24, 3 },
+        { "rgbx", AV_PIX_FMT_RGBA, Conversion::RgbLayout::RGBX, 4 },
+        { "bgra", AV_PIX_FMT_BGRA, Conversion::RgbLayout::BGRA, 4 },
+    };
+
+    /// Number of measured iterations per case.
+    constexpr int ITERATIONS { 200 };
+
+    /// Allocates a frame with random contents.
+    /// \param[in]  format  Pixel format.
+    /// \param[in]  width   Frame width.
+    /// \param[in]  height  Frame height.
+    /// \return Allocated frame or \c nullptr on error.
+    AVFrame* allocateFrame(AVPixelFormat format, int width, int height) {
+        auto frame = av_frame_alloc();
+        if (!frame) return nullptr;
+
+        frame->format = format;
+        frame->width = width;
+        frame->height = height;
+
+        if (av_frame_get_buffer(frame, 64) < 0) {
+            av_frame_free(&frame);
+            return nullptr;
+        }
+
+        for (auto plane = 0; plane < AV_NUM_DATA_POINTERS; ++plane) {
+            if (!frame->buf[plane]) continue;
+            for (auto i = 0; i < frame->buf[plane]->size; ++i)
+                frame->buf[plane]->data[i] = static_cast<uint8_t>(rand());
+        }
+
+        return frame;
+    }
+
+    /// Measures a conversion and prints a result line.
+    /// \param[in]  format      Output format name.
+    /// \param[in]  resolution  Frame resolution.
+    /// \param[in]  path        Conversion path name.
+    /// \param[in]  function    Conversion function.
+    /// \param[in]  accuracy    Difference from swscale, or null if not
+    ///                         compared.
+    void measure(const char* format,
+                 const Resolution& resolution,
+                 const char* path,
+                 const std::function<void()>& function,
+                 const Accuracy* accuracy = nullptr) {
+
+        function();
+
+        auto start = std::chrono::steady_clock::now();
+        for (auto i = 0; i < ITERATIONS; ++i) function();
+        auto elapsed = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start).count();
+
+        auto frameTime = elapsed / ITERATIONS;
+        auto pixels = static_cast<double>(resolution.width) * resolution.height;
+
+        std::printf("%s,%s,%s,%d,%.4f,%.1f,",
+                    format,
+                    resolution.name,
+                    path,
+                    ITERATIONS,
+                    frameTime,
+                    pixels / frameTime / 1000.0);
+
+        if (accuracy)
+            std::printf("%d,%.4f\n", accuracy->maximum, accuracy->mean);
+        else
+            std::printf(",\n");
+    }
+
+    /// Compares the pixels of two frames of the same size and format.
+    /// \param[in]  first   First frame.
+    /// \param[in]  second  Second frame.
+    /// \param[in]  rowSize Row size in bytes.
+    /// \return Difference between the frames.
+    Accuracy compare(const AVFrame* first, const AVFrame* second, int rowSize) {
+        Accuracy accuracy;
+        std::uint64_t total = 0;
+
+        for (auto y = 0; y < first->height; ++y) {
+            auto firstRow = first->data[0] + y * first->linesize[0];
+            auto secondRow = second->data[0] + y * second->linesize[0];
+
+            for (auto x = 0; x < rowSize; ++x) {
+                auto difference = std::abs(firstRow[x] - secondRow[x]);
+                accuracy.maximum = std::max(accuracy.maximum, difference);
+                total += static_cast<std::uint64_t>(difference);
+            }
+        }
+
+        accuracy.mean = static_cast<double>(total) /
+                        (static_cast<double>(rowSize) * first->height);
+        return accuracy;
+    }
+
+    /// Measures a swscale conversion.
+    /// \param[in]  format      Output format name.
+    /// \param[in]  resolution  Frame resolution.
+    /// \param[in]  source      Source frame.
+    /// \param[in]  target      Target frame.
+    void measureScaler(const char* format,
+                       const Resolution& resolution,
+                       const AVFrame* source,
+                       AVFrame* target) {
+
+        auto context = sws_getContext(source->width,
+                                      source->height,
+                                      static_cast<AVPixelFormat>(source->format),
+                                      target->width,
+                                      target->height,
+                                      static_cast<AVPixelFormat>(target->format),
+                                      SWS_BICUBIC,
+                                      nullptr,
+                                      nullptr,
+                                      nullptr);
+        if (!context) return;
+
+        measure(format, resolution, "swscale", [&] {
+            sws_scale(context,
+                      source->data,
+                      source->linesize,
+                      0,
+                      source->height,
+                      target->data,
+                      target->linesize);
+        });
+
+        sws_freeContext(context);
+    }
+
+    /// Measures the YUV to RGB kernels and swscale for a pair of formats.
+    /// \details The swscale result is the accuracy reference of both
+    /// kernel paths. Halved targets are compared against a bicubic
+    /// downscale, so their difference includes the filter.
+    /// \param[in]  resolution      Frame resolution.
+    /// \param[in]  sourceFormat    Source format.
+    /// \param[in]  targetFormat    Target format.
+    /// \param[in]  halve           Indicates whether the target is half
+    ///                             size.
+    /// \retval true on success.
+    /// \retval false if frames cannot be allocated.
+    bool measureYuvToRgb(const Resolution& resolution,
+                         const SourceFormat& sourceFormat,
+                         const TargetFormat& targetFormat,
+                         bool halve) {
+
+        auto width = resolution.width, height = resolution.height;
+        auto targetWidth = halve ? width / 2 : width;
+        auto targetHeight = halve ? height / 2 : height;
+
+        auto source = allocateFrame(sourceFormat.format, width, height);
+        auto reference = allocateFrame(targetFormat.format, targetWidth, targetHeight);
+        auto target = allocateFrame(targetFormat.format, targetWidth, targetHeight);
+        auto result = source && reference && target;
+
+        if (result) {
+            char format[64];
+            std::snprintf(format, sizeof(format), "%s-%s%s",
+                          sourceFormat.name,
+                          targetFormat.name,
+                          halve ? "-half" : "");
+
+            auto convert = [&](bool avx2) {
+                Conversion::convertYuv420ToRgb(source->data,
+                                               source->linesize,
+                                               sourceFormat.chroma,
+                                               width,
+                                               height,
+                                               target->data[0],
+                                               target->linesize[0],
+                                               targetFormat.layout,
+                                               halve,
+                                               avx2);
+            };
+
+            measureScaler(format, resolution, source, reference);
+
+            auto rowSize = targetWidth * targetFormat.pixelSize;
+
+            if (Conversion::hasAvx2()) {
+                convert(true);
+                auto accuracy = compare(target, reference, rowSize);
+                measure(format, resolution, "kernel-avx2",
+                        [&] { convert(true); }, &accuracy);
+            }
+
+            convert(false);
+            auto accuracy = compare(target, reference, rowSize);
+            measure(format, resolution, "kernel-scalar",
+                    [&] { convert(false); }, &accuracy);
+        }
+
+        av_frame_free(&target);
+        av_frame_free(&reference);
+        av_frame_free(&source);
+
+        return result;
+    }
+}
+
+/// Runs the conversion benchmark.
+/// \details Compares luma plane fast paths against swscale for every
+/// grayscale and monochrome output format, and the YUV to RGB kernels with
+/// and without AVX2 against swscale for YUV420P and NV12 to RGB24, RGBX and
+/// BGRA at full and half size. Prints CSV lines with format, resolution,
+/// path, iterations, milliseconds per frame and megapixels per second; kernel
+/// lines add the largest and mean channel difference from swscale.
+/// \return Exit status.
+int main() {
+    std::printf("format,resolution,path,iterations,ms_per_frame,mpix_per_s,"
+                "max_diff,mean_diff\n");
+    std::printf("# avx2=%d\n", Conversion::hasAvx2() ? 1 : 0);
+
+    for (const auto& resolution : RESOLUTIONS) {
+        auto width = resolution.width, height = resolution.height;
+        auto source = allocateFrame(AV_PIX_FMT_YUV420P, width, height);
+        auto gray8 = allocateFrame(AV_PIX_FMT_GRAY8, width, height);
+        auto gray16 = allocateFrame(AV_PIX_FMT_GRAY16, width, height);
+        auto mono = allocateFrame(AV_PIX_FMT_MONOBLACK, width, height);
+
+        if (!source || !gray8 || !gray16 || !mono) {
+            std::fprintf(stderr, "Failed to allocate frames\n");
+            return EXIT_FAILURE;
+        }
+
+        measure("grayscale8", resolution, "luma", [&] {
+            auto reference = av_frame_clone(source);
+            av_frame_free(&reference);
+        });
+
+        measureScaler("grayscale8", resolution, source, gray8);
+
+        measure("grayscale16", resolution, "luma", [&] {
+            Conversion::widenGray8ToGray16(source->data[0],
+                                           source->linesize[0],
+                                           gray16->data[0],
+                                           gray16->linesize[0],
+                                           width,
+                                           height);
+        });
+
+        measureScaler("grayscale16", resolution, source, gray16);
+
+        measure("mono", resolution, "luma", [&] {
+            Conversion::thresholdGray8ToMono(source->data[0],
+                                             source->linesize[0],
+                                             mono->data[0],
+                                             mono->linesize[0],
+                                             width,
+                                             height);
+        });
+
+        measureScaler("mono", resolution, source, mono);
+
+        av_frame_free(&mono);
+        av_frame_free(&gray16);
+        av_frame_free(&gray8);
+        av_frame_free(&source);
+
+        for (const auto& sourceFormat : SOURCE_FORMATS) {
+            for (const auto& targetFormat : TARGET_FORMATS) {
+                for (auto halve : { false, true }) {
+                    if (!measureYuvToRgb(resolution, sourceFormat, targetFormat, halve)) {
+                        std::fprintf(stderr, "Failed to allocate frames\n");
+                        return EXIT_FAILURE;
+                    }
+                }
+            }
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
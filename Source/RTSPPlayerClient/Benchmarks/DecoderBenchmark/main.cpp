@@ -0,0 +1,540 @@
+/// \file main.cpp
+/// \brief Contains entry point to the decoder benchmark.
+/// \bug No known bugs.
+
+#include "Playback/Decoding/VideoDecoder.hpp"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+
+extern "C" {
+    #include <libavcodec/avcodec.h>
+    #include <libavutil/opt.h>
+}
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <vector>
+
+#if defined (Q_OS_UNIX)
+    #include <sys/resource.h>
+#endif
+
+namespace {
+
+    /// Number of heap allocations made by the process.
+    std::atomic<quint64> allocationCount { 0 };
+
+    /// A structure that defines an encoded test clip.
+    struct Clip {
+
+        /// Codec name.
+        const char* codecName;
+
+        /// Decoder codec.
+        Decoders::VideoDecoder::Codec codec;
+
+        /// Frame width.
+        int width;
+
+        /// Frame height.
+        int height;
+
+        /// Distance between intra frames.
+        int gop;
+
+        /// Encoded frames.
+        std::vector<QByteArray> packets;
+    };
+
+    /// A structure that defines a benchmark output format.
+    struct OutputFormat {
+
+        /// Format name.
+        const char* name;
+
+        /// Decoder output format.
+        Decoders::VideoDecoder::Format format;
+    };
+
+    /// A structure that defines benchmark case results.
+    struct Result {
+
+        /// Number of decoded frames.
+        int frames = 0;
+
+        /// Frames per second.
+        double fps = 0.0;
+
+        /// Process CPU time per frame in milliseconds.
+        double cpuTime = 0.0;
+
+        /// Heap allocations per frame, negative if not counted.
+        double allocations = -1.0;
+
+        /// Peak resident set size in kilobytes, negative if unknown.
+        long peakMemory = -1;
+
+        /// Number of frames converted to output images.
+        quint64 convertedFrames = 0;
+
+        /// Indicates whether the decoder reported errors.
+        bool failed = false;
+    };
+
+    /// Benchmarked resolutions.
+    constexpr int RESOLUTIONS[][2] {
+        { 1280, 720 },
+        { 1920, 1080 },
+        { 3840, 2160 },
+    };
+
+    /// Benchmarked H.264 intra frame distances.
+    constexpr int H264_GOPS[] { 25, 250 };
+
+    /// Benchmarked decoding thread counts, zero for automatic selection.
+    constexpr int THREAD_COUNTS[] { 1, 2, 4, 0 };
+
+    /// Number of decoded frames per presented frame in presentation cases,
+    /// as for a 60 fps stream shown on a tile refreshed at 15 Hz.
+    constexpr int PRESENTATION_INTERVAL { 4 };
+
+    /// Benchmarked output formats.
+    const OutputFormat OUTPUT_FORMATS[] {
+        { "rgb888", Decoders::VideoDecoder::Format::RGB888 },
+        { "rgbx8888", Decoders::VideoDecoder::Format::RGBX8888 },
+        { "bgra8888", Decoders::VideoDecoder::Format::BGRA8888 },
+        { "grayscale8", Decoders::VideoDecoder::Format::Grayscale8 },
+        { "grayscale16", Decoders::VideoDecoder::Format::Grayscale16 },
+        { "mono", Decoders::VideoDecoder::Format::Mono },
+    };
+
+    /// Returns the peak resident set size.
+    /// \return Peak resident set size in kilobytes, negative if unknown.
+    long peakMemory() {
+#if defined (Q_OS_LINUX)
+        rusage usage { };
+        if (getrusage(RUSAGE_SELF, &usage) == 0) return usage.ru_maxrss;
+#endif
+        return -1;
+    }
+
+    /// Fills a frame with a moving test pattern.
+    /// \param[in,out]  frame   YUV 4:2:0 frame.
+    /// \param[in]      index   Frame index.
+    void fillFrame(AVFrame* frame, int index) {
+        for (auto y = 0; y < frame->height; ++y) {
+            auto row = frame->data[0] + y * frame->linesize[0];
+            for (auto x = 0; x < frame->width; ++x)
+                row[x] = static_cast<uint8_t>(x + y + index * 4 +
+                                              ((x * y) >> 7));
+        }
+
+        for (auto y = 0; y < frame->height / 2; ++y) {
+            auto u = frame->data[1] + y * frame->linesize[1];
+            auto v = frame->data[2] + y * frame->linesize[2];
+            for (auto x = 0; x < frame->width / 2; ++x) {
+                u[x] = static_cast<uint8_t>(128 + y + index * 2);
+                v[x] = static_cast<uint8_t>(64 + x + index * 5);
+            }
+        }
+    }
+
+    /// Drains encoded packets from the encoder.
+    /// \param[in]      context Encoder context.
+    /// \param[in]      packet  Packet buffer.
+    /// \param[in,out]  packets Encoded frames.
+    void receivePackets(AVCodecContext* context,
+                        AVPacket* packet,
+                        std::vector<QByteArray>& packets) {
+
+        while (avcodec_receive_packet(context, packet) == 0) {
+            packets.emplace_back(reinterpret_cast<const char*>(packet->data),
+                                 packet->size);
+            av_packet_unref(packet);
+        }
+    }
+
+    /// Encodes a test clip with a libavcodec encoder.
+    /// \param[in]      codecID Encoder codec identifier.
+    /// \param[in]      frames  Number of frames to encode.
+    /// \param[in,out]  clip    Clip with geometry set, receives packets.
+    /// \retval true on success.
+    /// \retval false if the encoder is unavailable or fails.
+    bool encodeClip(AVCodecID codecID, int frames, Clip& clip) {
+        auto codec = avcodec_find_encoder(codecID);
+        if (!codec) return false;
+
+        auto context = avcodec_alloc_context3(codec);
+        auto frame = av_frame_alloc();
+        auto packet = av_packet_alloc();
+        auto result = context && frame && packet;
+
+        if (result) {
+            context->width = clip.width;
+            context->height = clip.height;
+            context->time_base = { 1, 25 };
+            context->framerate = { 25, 1 };
+            context->gop_size = clip.gop;
+            context->max_b_frames = 0;
+            context->bit_rate = static_cast<int64_t>(clip.width) * clip.height * 2;
+            context->pix_fmt = codecID == AV_CODEC_ID_MJPEG ? AV_PIX_FMT_YUVJ420P
+                                                            : AV_PIX_FMT_YUV420P;
+
+            if (codecID == AV_CODEC_ID_MJPEG) {
+                context->flags |= AV_CODEC_FLAG_QSCALE;
+                context->global_quality = FF_QP2LAMBDA * 4;
+            }
+
+            av_opt_set(context->priv_data, "preset", "veryfast", 0);
+
+            frame->format = context->pix_fmt;
+            frame->width = clip.width;
+            frame->height = clip.height;
+
+            result = avcodec_open2(context, codec, nullptr) >= 0 &&
+                     av_frame_get_buffer(frame, 0) >= 0;
+        }
+
+        for (auto i = 0; result && i < frames; ++i) {
+            result = av_frame_make_writable(frame) >= 0;
+            if (!result) break;
+
+            fillFrame(frame, i);
+            frame->pts = i;
+
+            result = avcodec_send_frame(context, frame) >= 0;
+            receivePackets(context, packet, clip.packets);
+        }
+
+        if (result) {
+            avcodec_send_frame(context, nullptr);
+            receivePackets(context, packet, clip.packets);
+        }
+
+        av_packet_free(&packet);
+        av_frame_free(&frame);
+        avcodec_free_context(&context);
+
+        return result && !clip.packets.empty();
+    }
+
+    /// Decodes and converts a clip.
+    /// \param[in]  clip        Encoded clip.
+    /// \param[in]  format      Output format.
+    /// \param[in]  threadCount Number of decoding threads.
+    /// \return Benchmark results.
+    Result runCase(const Clip& clip,
+                   Decoders::VideoDecoder::Format format,
+                   int threadCount) {
+
+        Result result;
+        Decoders::VideoDecoder decoder;
+
+        QObject::connect(&decoder, &Decoders::VideoDecoder::onFrame,
+                         [&result](const QImage&) { ++result.frames; });
+
+        QObject::connect(&decoder, &Decoders::VideoDecoder::onError,
+                         [&result](Decoders::VideoDecoder::Error) {
+                             result.failed = true;
+                         });
+
+        decoder.setThreadCount(threadCount);
+
+        if (!decoder.initialize(clip.codec, format)) {
+            result.failed = true;
+            return result;
+        }
+
+        auto allocations = allocationCount.load();
+        auto cpuStart = std::clock();
+        auto wallStart = std::chrono::steady_clock::now();
+
+        Decoders::VideoDecoder::FrameInfo info;
+
+        for (const auto& packet : clip.packets) {
+            decoder.decode(packet, info);
+            ++info.id, ++info.number;
+        }
+
+        decoder.decode(QByteArray(), info);
+
+        auto wallTime = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - wallStart).count();
+        auto cpuTime = static_cast<double>(std::clock() - cpuStart) /
+                       CLOCKS_PER_SEC;
+
+        if (result.frames > 0) {
+            result.fps = result.frames / wallTime;
+            result.cpuTime = cpuTime * 1000.0 / result.frames;
+#if defined (__GLIBC__)
+            result.allocations =
+                static_cast<double>(allocationCount.load() - allocations) /
+                result.frames;
+#else
+            Q_UNUSED(allocations)
+#endif
+        }
+
+        result.peakMemory = peakMemory();
+        result.convertedFrames = decoder.statistics().convertedFrames;
+        return result;
+    }
+
+    /// Decodes a clip and presents every PRESENTATION_INTERVAL-th frame.
+    /// \details Eager conversion converts every decoded frame; deferred
+    /// conversion converts only the presented ones when they are shown.
+    /// \param[in]  clip        Encoded clip.
+    /// \param[in]  format      Output format.
+    /// \param[in]  deferred    Indicates whether conversion is deferred.
+    /// \return Benchmark results, with frames counting decoded frames.
+    Result runPresentationCase(const Clip& clip,
+                               Decoders::VideoDecoder::Format format,
+                               bool deferred) {
+
+        Result result;
+        Decoders::VideoDecoder decoder;
+        quint64 checksum = 0;
+
+        QObject::connect(&decoder, &Decoders::VideoDecoder::onFrame,
+                         [&](const QImage& frame) {
+                             if (result.frames++ % PRESENTATION_INTERVAL == 0)
+                                 checksum += frame.constBits()[0];
+                         });
+
+        QObject::connect(&decoder, &Decoders::VideoDecoder::onDecodedFrame,
+                         [&](const Decoders::VideoDecoder::DecodedFrame& frame) {
+                             if (result.frames++ % PRESENTATION_INTERVAL == 0) {
+                                 auto image = frame.image();
+                                 if (!image.isNull()) checksum += image.constBits()[0];
+                             }
+                         });
+
+        QObject::connect(&decoder, &Decoders::VideoDecoder::onError,
+                         [&result](Decoders::VideoDecoder::Error) {
+                             result.failed = true;
+                         });
+
+        decoder.setDeferredConversion(deferred);
+
+        if (!decoder.initialize(clip.codec, format)) {
+            result.failed = true;
+            return result;
+        }
+
+        auto cpuStart = std::clock();
+
+        Decoders::VideoDecoder::FrameInfo info;
+
+        for (const auto& packet : clip.packets) {
+            decoder.decode(packet, info);
+            ++info.id, ++info.number;
+        }
+
+        decoder.decode(QByteArray(), info);
+
+        auto cpuTime = static_cast<double>(std::clock() - cpuStart) /
+                       CLOCKS_PER_SEC;
+
+        if (result.frames > 0)
+            result.cpuTime = cpuTime * 1000.0 / result.frames;
+
+        result.peakMemory = peakMemory();
+        result.convertedFrames = decoder.statistics().convertedFrames;
+        return result;
+    }
+
+    /// Prints benchmark case results as a JSON line.
+    /// \param[in]  clip        Encoded clip.
+    /// \param[in]  format      Output format.
+    /// \param[in]  threadCount Number of decoding threads.
+    /// \param[in]  result      Benchmark results.
+    void printResult(const Clip& clip,
+                     const OutputFormat& format,
+                     int threadCount,
+                     const Result& result) {
+
+        std::printf("{\"codec\":\"%s\",\"width\":%d,\"height\":%d,\"gop\":%d,"
+                    "\"threads\":%d,\"format\":\"%s\",\"frames\":%d,"
+                    "\"fps\":%.2f,\"cpu_ms_per_frame\":%.3f,"
+                    "\"allocations_per_frame\":%.1f,\"peak_rss_kb\":%ld,"
+                    "\"converted_frames\":%llu,\"failed\":%s}\n",
+                    clip.codecName,
+                    clip.width,
+                    clip.height,
+                    clip.gop,
+                    threadCount,
+                    format.name,
+                    result.frames,
+                    result.fps,
+                    result.cpuTime,
+                    result.allocations,
+                    result.peakMemory,
+                    static_cast<unsigned long long>(result.convertedFrames),
+                    result.failed ? "true" : "false");
+
+        std::fflush(stdout);
+    }
+
+    /// Prints presentation case results as a JSON line.
+    /// \param[in]  clip        Encoded clip.
+    /// \param[in]  format      Output format.
+    /// \param[in]  deferred    Indicates whether conversion was deferred.
+    /// \param[in]  result      Benchmark results.
+    void printPresentationResult(const Clip& clip,
+                                 const OutputFormat& format,
+                                 bool deferred,
+                                 const Result& result) {
+
+        std::printf("{\"codec\":\"%s\",\"width\":%d,\"height\":%d,\"gop\":%d,"
+                    "\"format\":\"%s\",\"conversion\":\"%s\","
+                    "\"presented_every\":%d,\"frames\":%d,"
+                    "\"converted_frames\":%llu,\"cpu_ms_per_frame\":%.3f,"
+                    "\"failed\":%s}\n",
+                    clip.codecName,
+                    clip.width,
+                    clip.height,
+                    clip.gop,
+                    format.name,
+                    deferred ? "deferred" : "eager",
+                    PRESENTATION_INTERVAL,
+                    result.frames,
+                    static_cast<unsigned long long>(result.convertedFrames),
+                    result.cpuTime,
+                    result.failed ? "true" : "false");
+
+        std::fflush(stdout);
+    }
+}
+
+#if defined (__GLIBC__)
+extern "C" {
+
+    void* __libc_malloc(size_t size);
+    void* __libc_calloc(size_t count, size_t size);
+    void* __libc_realloc(void* pointer, size_t size);
+    void* __libc_memalign(size_t alignment, size_t size);
+
+    /// Allocates memory, counting the allocation.
+    void* malloc(size_t size) noexcept {
+        allocationCount.fetch_add(1, std::memory_order_relaxed);
+        return __libc_malloc(size);
+    }
+
+    /// Allocates zeroed memory, counting the allocation.
+    void* calloc(size_t count, size_t size) noexcept {
+        allocationCount.fetch_add(1, std::memory_order_relaxed);
+        return __libc_calloc(count, size);
+    }
+
+    /// Reallocates memory, counting the allocation.
+    void* realloc(void* pointer, size_t size) noexcept {
+        allocationCount.fetch_add(1, std::memory_order_relaxed);
+        return __libc_realloc(pointer, size);
+    }
+
+    /// Allocates aligned memory, counting the allocation.
+    int posix_memalign(void** pointer, size_t alignment, size_t size) noexcept {
+        allocationCount.fetch_add(1, std::memory_order_relaxed);
+        *pointer = __libc_memalign(alignment, size);
+        return *pointer ? 0 : ENOMEM;
+    }
+
+    /// Allocates aligned memory, counting the allocation.
+    void* aligned_alloc(size_t alignment, size_t size) noexcept {
+        allocationCount.fetch_add(1, std::memory_order_relaxed);
+        return __libc_memalign(alignment, size);
+    }
+}
+#endif
+
+/// Runs the decoder benchmark.
+/// \details Encodes H.264 and MJPEG clips with libavcodec encoders and runs
+/// them through the decode and convert path for every thread count and
+/// output format. Then presents only every PRESENTATION_INTERVAL-th frame
+/// with eager and deferred conversion in 32-bit formats, showing the
+/// conversion work saved on frames that are never shown. Prints one JSON
+/// object per line.
+/// \param[in]  argc    Number of arguments passed to the program.
+/// \param[in]  argv    An array of pointers to the arguments passed to the
+///                     program.
+/// \return Exit status.
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    parser.addOption(QCommandLineOption("frames",
+                                        "Number of frames per clip.",
+                                        "count",
+                                        "250"));
+    parser.addOption(QCommandLineOption("codec",
+                                        "Only run the codec (h264, mjpeg).",
+                                        "name"));
+    parser.process(app);
+
+    auto frames = qMax(1, parser.value("frames").toInt());
+    auto codecFilter = parser.value("codec");
+
+    std::vector<Clip> clips;
+
+    for (const auto& resolution : RESOLUTIONS) {
+        if (codecFilter.isEmpty() || codecFilter == "h264") {
+            for (auto gop : H264_GOPS) {
+                clips.push_back({ "h264",
+                                  Decoders::VideoDecoder::Codec::H264,
+                                  resolution[0], resolution[1], gop, { } });
+            }
+        }
+
+        if (codecFilter.isEmpty() || codecFilter == "mjpeg") {
+            clips.push_back({ "mjpeg",
+                              Decoders::VideoDecoder::Codec::MJPEG,
+                              resolution[0], resolution[1], 1, { } });
+        }
+    }
+
+    for (auto& clip : clips) {
+        auto codecID = clip.codec == Decoders::VideoDecoder::Codec::H264
+                           ? AV_CODEC_ID_H264
+                           : AV_CODEC_ID_MJPEG;
+
+        if (!encodeClip(codecID, frames, clip)) {
+            std::fprintf(stderr, "Skipping %s %dx%d: no usable encoder\n",
+                         clip.codecName, clip.width, clip.height);
+            continue;
+        }
+
+        for (auto threadCount : THREAD_COUNTS) {
+            for (const auto& format : OUTPUT_FORMATS) {
+                printResult(clip,
+                            format,
+                            threadCount,
+                            runCase(clip, format.format, threadCount));
+            }
+        }
+
+        for (const auto& format : OUTPUT_FORMATS) {
+            if (format.format != Decoders::VideoDecoder::Format::RGBX8888 &&
+                format.format != Decoders::VideoDecoder::Format::BGRA8888)
+                continue;
+
+            for (auto deferred : { false, true }) {
+                printPresentationResult(clip,
+                                        format,
+                                        deferred,
+                                        runPresentationCase(clip,
+                                                            format.format,
+                                                            deferred));
+            }
+        }
+
+        clip.packets.clear();
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,56 @@
+#------------------------------------------------------------------------------#
+#                                Base settings                                 #
+#------------------------------------------------------------------------------#
+
+TEMPLATE            =   app
+TARGET              =   hugepagebenchmark
+QT                  =   core
+CONFIG              +=	c++17 strict_c++ console
+CONFIG              -=  app_bundle
+
+
+#------------------------------------------------------------------------------#
+#                             Project files settings                           #
+#------------------------------------------------------------------------------#
+
+CLIENT_PATH         =   $$absolute_path(RTSPPlayerClient, $$SOURCE_PATH)
+
+include($$absolute_path(Base/Utility/Utility.pri, $$CLIENT_PATH))
+include($$absolute_path(Playback/Conversion/Conversion.pri, $$CLIENT_PATH))
+
+SOURCES             +=                                                      \
+                        $$PWD/main.cpp                                      \
+
+
+#------------------------------------------------------------------------------#
+#                            External dependencies                             #
+#------------------------------------------------------------------------------#
+
+FFMPEG_DIRECTORY    =   $$find_directory($$EXTERNAL_PATH, "ffmpeg-*")
+FFMPEG_INCLUDE_PATH =   $$find_include_path($$EXTERNAL_PATH, $$FFMPEG_DIRECTORY)
+FFMPEG_LIBRARY_PATH =   $$find_library_path($$EXTERNAL_PATH, $$FFMPEG_DIRECTORY)
+
+
+#------------------------------------------------------------------------------#
+#                          Include directories settings                        #
+#------------------------------------------------------------------------------#
+
+INCLUDEPATH         +=                                                      \
+                        $$CLIENT_PATH                                       \
+                        $$FFMPEG_INCLUDE_PATH                               \
+
+DEPENDPATH          +=                                                      \
+                        $$CLIENT_PATH                                       \
+                        $$FFMPEG_INCLUDE_PATH                               \
+
+
+#------------------------------------------------------------------------------#
+#                           External libraries settings                        #
+#------------------------------------------------------------------------------#
+
+LIBS                +=                                                      \
+                        -L$$FFMPEG_LIBRARY_PATH                             \
+
+LIBS                +=                                                      \
+                        -lswscale                                           \
+                        -lavutil                                            \
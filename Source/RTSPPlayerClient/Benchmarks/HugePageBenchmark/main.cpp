@@ -0,0 +1,277 @@
+/// \file main.cpp
+/// \brief Contains entry point to the huge page benchmark.
+/// \bug No known bugs.
+
+#include "Base/Utility/HugePageArena.hpp"
+#include "Playback/Conversion/ConversionKernels.hpp"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+
+extern "C" {
+    #include <libavutil/mem.h>
+}
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+    /// A structure that defines a benchmark resolution.
+    struct Resolution {
+
+        /// Resolution name.
+        const char* name;
+
+        /// Frame width.
+        int width;
+
+        /// Frame height.
+        int height;
+    };
+
+    /// Ways of allocating the target of every frame.
+    enum class Allocation {
+        Heap        ,   ///< av_malloc() and av_free(), as before the arena.
+        SmallPages  ,   ///< Arena with huge pages disabled.
+        HugePages   ,   ///< Arena with huge pages enabled.
+    };
+
+    /// A structure that contains benchmark case results.
+    struct Result {
+
+        /// Milliseconds per frame.
+        double frameTime = 0.0;
+
+        /// Gigabytes read and written per second.
+        double throughput = 0.0;
+
+        /// Arena statistics after the case.
+        Common::Utility::HugePageArena::Statistics statistics;
+
+        /// Indicates whether a target could not be allocated.
+        bool failed = false;
+    };
+
+    /// Benchmarked resolutions.
+    constexpr Resolution RESOLUTIONS[] {
+        { "1080p", 1920, 1080 },
+        { "4k", 3840, 2160 },
+    };
+
+    /// Size of an RGBX pixel in bytes.
+    constexpr int PIXEL_SIZE { 4 };
+
+    /// Returns the name of an allocation.
+    /// \param[in]  allocation  Allocation.
+    /// \return Allocation name.
+    const char* allocationName(Allocation allocation) {
+        switch (allocation) {
+            case Allocation::Heap:
+                return "heap";
+            case Allocation::SmallPages:
+                return "arena_small_pages";
+            case Allocation::HugePages:
+                return "arena_huge_pages";
+        }
+
+        return "";
+    }
+
+    /// Fills a buffer with random bytes.
+    /// \param[out] data    Buffer.
+    void randomize(std::vector<std::uint8_t>& data) {
+        for (auto& value : data)
+            value = static_cast<std::uint8_t>(std::rand());
+    }
+
+    /// Measures a workload writing into a freshly allocated target per frame.
+    /// \details Every frame allocates its target, writes it with the
+    /// workload, reads it back once as an upload would and releases it, so
+    /// the result includes page faults of fresh mappings as well as TLB
+    /// misses of the passes.
+    /// \param[in]  allocation  Way of allocating targets.
+    /// \param[in]  size        Target size in bytes.
+    /// \param[in]  traffic     Bytes read and written per frame.
+    /// \param[in]  frames      Number of measured frames.
+    /// \param[in]  workload    Function writing a target.
+    /// \return Case results.
+    template<typename Workload>
+    Result measure(Allocation allocation,
+                   std::size_t size,
+                   double traffic,
+                   int frames,
+                   Workload workload) {
+
+        auto& arena = Common::Utility::HugePageArena::instance();
+        arena.trim();
+        arena.setHugePagesEnabled(allocation == Allocation::HugePages);
+
+        auto before = arena.statistics();
+        Result result;
+        volatile std::uint64_t checksum = 0;
+
+        auto run = [&] {
+            auto target = allocation == Allocation::Heap ?
+                static_cast<std::uint8_t*>(av_malloc(size)) :
+                static_cast<std::uint8_t*>(arena.allocate(size));
+
+            if (!target) {
+                result.failed = true;
+                return;
+            }
+
+            workload(target);
+
+            for (std::size_t offset = 0; offset < size; offset += 64)
+                checksum = checksum + target[offset];
+
+            if (allocation == Allocation::Heap)
+                av_free(target);
+            else
+                arena.release(target);
+        };
+
+        run();
+
+        auto start = std::chrono::steady_clock::now();
+        for (auto i = 0; i < frames && !result.failed; ++i) run();
+        auto elapsed = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start).count();
+
+        result.frameTime = elapsed / frames;
+        result.throughput = traffic / result.frameTime / 1e6;
+
+        result.statistics = arena.statistics();
+        result.statistics.allocations -= before.allocations;
+        result.statistics.reuses -= before.reuses;
+        result.statistics.hugePageMappings -= before.hugePageMappings;
+        result.statistics.smallPageMappings -= before.smallPageMappings;
+
+        return result;
+    }
+
+    /// Prints a result line.
+    /// \param[in]  workload    Workload name.
+    /// \param[in]  resolution  Frame resolution.
+    /// \param[in]  allocation  Way of allocating targets.
+    /// \param[in]  frames      Number of measured frames.
+    /// \param[in]  result      Case results.
+    void print(const char* workload,
+               const Resolution& resolution,
+               Allocation allocation,
+               int frames,
+               const Result& result) {
+
+        std::printf("{\"workload\":\"%s\",\"resolution\":\"%s\",\"case\":\"%s\","
+                    "\"frames\":%d,\"ms_per_frame\":%.4f,\"gb_per_s\":%.2f,"
+                    "\"allocations\":%llu,\"reuses\":%llu,"
+                    "\"huge_page_mappings\":%llu,\"small_page_mappings\":%llu,"
+                    "\"failed\":%s}\n",
+                    workload,
+                    resolution.name,
+                    allocationName(allocation),
+                    frames,
+                    result.frameTime,
+                    result.throughput,
+                    static_cast<unsigned long long>(result.statistics.allocations),
+                    static_cast<unsigned long long>(result.statistics.reuses),
+                    static_cast<unsigned long long>(result.statistics.hugePageMappings),
+                    static_cast<unsigned long long>(result.statistics.smallPageMappings),
+                    result.failed ? "true" : "false");
+
+        std::fflush(stdout);
+    }
+}
+
+/// Runs the huge page benchmark.
+/// \details Converts YUV420P frames to RGBX and copies RGBX frames at 1080p
+/// and 4K into a target allocated per frame from the heap, from the huge
+/// page arena on small pages and from the arena on huge pages. Reports
+/// milliseconds per frame, bytes read and written per second and arena
+/// statistics of each case. Prints one JSON object per line.
+/// \param[in]  argc    Number of arguments passed to the program.
+/// \param[in]  argv    An array of pointers to the arguments passed to the
+///                     program.
+/// \return Exit status.
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    parser.addOption(QCommandLineOption("frames",
+                                        "Number of measured frames per case.",
+                                        "count",
+                                        "200"));
+    parser.process(app);
+
+    auto frames = qMax(1, parser.value("frames").toInt());
+
+    std::printf("{\"thp\":%s,\"avx2\":%s}\n",
+                Common::Utility::HugePageArena::isSupported() ? "true" : "false",
+                Conversion::hasAvx2() ? "true" : "false");
+
+    const Allocation allocations[] {
+        Allocation::Heap,
+        Allocation::SmallPages,
+        Allocation::HugePages,
+    };
+
+    for (const auto& resolution : RESOLUTIONS) {
+        auto width = resolution.width, height = resolution.height;
+        auto stride = width * PIXEL_SIZE;
+        auto size = static_cast<std::size_t>(stride) * height;
+
+        std::vector<std::uint8_t> luma(static_cast<std::size_t>(width) * height);
+        std::vector<std::uint8_t> chroma[2];
+        std::vector<std::uint8_t> frame(size);
+
+        for (auto& plane : chroma)
+            plane.resize(static_cast<std::size_t>(width / 2) * (height / 2));
+
+        randomize(luma);
+        randomize(chroma[0]);
+        randomize(chroma[1]);
+        randomize(frame);
+
+        const std::uint8_t* const planes[] {
+            luma.data(), chroma[0].data(), chroma[1].data()
+        };
+        const int strides[] { width, width / 2, width / 2 };
+
+        auto yuvSize = static_cast<double>(luma.size() + 2 * chroma[0].size());
+
+        for (auto allocation : allocations) {
+            auto result = measure(allocation, size, yuvSize + 2.0 * size, frames,
+                                  [&](std::uint8_t* target) {
+                Conversion::convertYuv420ToRgb(planes,
+                                               strides,
+                                               Conversion::ChromaLayout::Planar,
+                                               width,
+                                               height,
+                                               target,
+                                               stride,
+                                               Conversion::RgbLayout::RGBX);
+            });
+
+            print("convert", resolution, allocation, frames, result);
+        }
+
+        for (auto allocation : allocations) {
+            auto result = measure(allocation, size, 3.0 * size, frames,
+                                  [&](std::uint8_t* target) {
+                std::memcpy(target, frame.data(), size);
+            });
+
+            print("copy", resolution, allocation, frames, result);
+        }
+    }
+
+    Common::Utility::HugePageArena::instance().trim();
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,89 @@
+#------------------------------------------------------------------------------#
+#                                Base settings                                 #
+#------------------------------------------------------------------------------#
+
+TEMPLATE            =   app
+TARGET              =   layoutbenchmark
+QT                  =   core gui widgets
+CONFIG              +=	c++17 strict_c++ console
+CONFIG              -=  app_bundle
+
+
+#------------------------------------------------------------------------------#
+#                             Project files settings                           #
+#------------------------------------------------------------------------------#
+
+CLIENT_PATH         =   $$absolute_path(RTSPPlayerClient, $$SOURCE_PATH)
+GUI_PATH            =   $$absolute_path(GUI, $$CLIENT_PATH)
+OUTPUT_PATH         =   $$absolute_path(Playback/Output, $$CLIENT_PATH)
+
+include($$absolute_path(Base/Utility/Utility.pri, $$CLIENT_PATH))
+include($$absolute_path(Playback/Conversion/Conversion.pri, $$CLIENT_PATH))
+include($$absolute_path(Playback/Decoding/Decoding.pri, $$CLIENT_PATH))
+
+HEADERS             +=                                                      \
+                        $$GUI_PATH/MediaSubWindow.hpp                       \
+                        $$GUI_PATH/MediaSubWindowStyle.hpp                  \
+                        $$GUI_PATH/PerformanceHud.hpp                       \
+                        $$GUI_PATH/SubWindowPool.hpp                        \
+                        $$OUTPUT_PATH/PlaybackWidget.hpp                    \
+                        $$OUTPUT_PATH/RenderThread.hpp                      \
+                        $$OUTPUT_PATH/ResourceCache.hpp                     \
+                        $$OUTPUT_PATH/StreamCounters.hpp                    \
+                        $$OUTPUT_PATH/TextureStream.hpp                     \
+
+SOURCES             +=                                                      \
+                        $$GUI_PATH/MediaSubWindow.cpp                       \
+                        $$GUI_PATH/MediaSubWindowStyle.cpp                  \
+                        $$GUI_PATH/PerformanceHud.cpp                       \
+                        $$GUI_PATH/SubWindowPool.cpp                        \
+                        $$OUTPUT_PATH/PlaybackWidget.cpp                    \
+                        $$OUTPUT_PATH/RenderThread.cpp                      \
+                        $$OUTPUT_PATH/ResourceCache.cpp                     \
+                        $$OUTPUT_PATH/StreamCounters.cpp                    \
+                        $$OUTPUT_PATH/TextureStream.cpp                     \
+                        $$PWD/main.cpp                                      \
+
+FORMS               +=                                                      \
+                        $$GUI_PATH/MediaSubWindow.ui                        \
+
+RESOURCES           +=                                                      \
+                        $$GUI_PATH/resources.qrc                            \
+
+
+#------------------------------------------------------------------------------#
+#                            External dependencies                             #
+#------------------------------------------------------------------------------#
+
+FFMPEG_DIRECTORY    =   $$find_directory($$EXTERNAL_PATH, "ffmpeg-*")
+FFMPEG_INCLUDE_PATH =   $$find_include_path($$EXTERNAL_PATH, $$FFMPEG_DIRECTORY)
+FFMPEG_LIBRARY_PATH =   $$find_library_path($$EXTERNAL_PATH, $$FFMPEG_DIRECTORY)
+
+
+#------------------------------------------------------------------------------#
+#                          Include directories settings                        #
+#------------------------------------------------------------------------------#
+
+INCLUDEPATH         +=                                                      \
+                        $$CLIENT_PATH                                       \
+                        $$GUI_PATH                                          \
+                        $$FFMPEG_INCLUDE_PATH                               \
+
+DEPENDPATH          +=                                                      \
+                        $$CLIENT_PATH                                       \
+                        $$GUI_PATH                                          \
+                        $$FFMPEG_INCLUDE_PATH                               \
+
+
+#------------------------------------------------------------------------------#
+#                           External libraries settings                        #
+#------------------------------------------------------------------------------#
+
+LIBS                +=                                                      \
+                        -L$$FFMPEG_LIBRARY_PATH                             \
+
+LIBS                +=                                                      \
+                        -lavcodec                                           \
+                        -lswresample                                        \
+                        -lswscale                                           \
+                        -lavutil                                            \
@@ -0,0 +1,313 @@
+/// \file main.cpp
+/// \brief Contains entry point to the layout switching benchmark.
+/// \bug No known bugs.
+
+#include "GUI/MediaSubWindow.hpp"
+#include "GUI/SubWindowPool.hpp"
+#include "Playback/Output/PlaybackWidget.hpp"
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMdiArea>
+#include <QStringList>
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace {
+
+    /// Benchmarked grid columns, switched between in turn.
+    constexpr int GRID_COLUMNS[] {
+        2, 4
+    };
+
+    /// Number of streams, enough for the largest grid.
+    constexpr int STREAM_COUNT {
+        16
+    };
+
+    /// Window width.
+    constexpr int WINDOW_WIDTH {
+        1920
+    };
+
+    /// Window height.
+    constexpr int WINDOW_HEIGHT {
+        1080
+    };
+
+    /// Frame period at 60 Hz in milliseconds.
+    constexpr double FRAME_PERIOD {
+        1000.0 / 60.0
+    };
+
+    /// A structure that contains the result of a benchmark case.
+    struct Result {
+
+        /// Mean switch time in milliseconds.
+        double meanTime = 0.0;
+
+        /// Longest switch time in milliseconds.
+        double maximumTime = 0.0;
+
+        /// Number of switches longer than a frame period.
+        int slowSwitches = 0;
+    };
+
+    /// Creates a test image.
+    /// \param[in]  width   Image width.
+    /// \param[in]  height  Image height.
+    /// \param[in]  seed    Pattern seed.
+    /// \return Test image.
+    QImage createImage(int width, int height, int seed) {
+        QImage image(width, height, QImage::Format_RGBX8888);
+
+        for (auto y = 0; y < height; ++y) {
+            auto row = image.scanLine(y);
+            for (auto x = 0; x < image.bytesPerLine(); ++x)
+                row[x] = static_cast<uchar>(x + y + seed);
+        }
+
+        return image;
+    }
+
+    /// A class that lays streams out in a grid of subwindows.
+    /// \details Borrows subwindows from a pool, or creates and deletes
+    /// them like the client did before pooling.
+    class Layout {
+    public:
+
+        /// Constructs a layout.
+        /// \param[in]  area    Area that holds the subwindows.
+        /// \param[in]  pool    Subwindow pool, or null to create subwindows.
+        /// \param[in]  image   Image shown by new tiles in place of a
+        ///                     decoded frame.
+        Layout(QMdiArea& area, GUI::SubWindowPool* pool, const QImage& image) :
+            area_(area),
+            pool_(pool),
+            image_(image)
+        {
+        }
+
+        /// Shows the first streams in a grid.
+        /// \details Tiles that keep their stream are only moved.
+        /// \param[in]  columns Number of grid columns and rows.
+        void show(int columns) {
+            QStringList streams;
+            for (auto stream = 0; stream < columns * columns; ++stream)
+                streams << QString("stream-%1").arg(stream);
+
+            for (auto tile = tiles_.begin(); tile != tiles_.end(); ) {
+                if (streams.contains(tile.key())) {
+                    ++tile;
+                    continue;
+                }
+
+                if (pool_) {
+                    pool_->release(tile.value());
+                }
+                else {
+                    fed_.remove(static_cast<Player::Playback::PlaybackWidget*>(
+                        tile.value()->widget()));
+                    area_.removeSubWindow(tile.value());
+                    delete tile.value();
+                }
+
+                tile = tiles_.erase(tile);
+            }
+
+            auto width = area_.viewport()->width() / columns;
+            auto height = area_.viewport()->height() / columns;
+
+            for (auto cell = 0; cell < streams.size(); ++cell) {
+                auto& subWindow = tiles_[streams[cell]];
+                if (!subWindow) subWindow = open(streams[cell]);
+
+                subWindow->setGeometry(cell % columns * width,
+                                       cell / columns * height,
+                                       width,
+                                       height);
+            }
+        }
+
+        /// Returns the number of created subwindows.
+        /// \return Number of created subwindows.
+        quint64 createdSubWindows() const {
+            return pool_ ? pool_->statistics().createdSubWindows : created_;
+        }
+
+    private:
+
+        /// Opens a subwindow for a stream.
+        /// \details Only tiles without a frame of the stream are fed, as a
+        /// parked pipeline keeps showing its last frame.
+        /// \param[in]  address Stream address.
+        /// \return Shown subwindow.
+        QMdiSubWindow* open(const QString& address) {
+            QMdiSubWindow* subWindow = nullptr;
+            Player::Playback::PlaybackWidget* widget = nullptr;
+
+            if (pool_) {
+                subWindow = pool_->acquire(address);
+                widget = pool_->playbackWidget(subWindow);
+            }
+            else {
+                auto mediaSubWindow = new MediaSubWindow;
+                mediaSubWindow->setTitleBarColor(QColor("lightgray"));
+                widget = new Player::Playback::PlaybackWidget;
+                mediaSubWindow->setWidget(widget);
+                area_.addSubWindow(mediaSubWindow);
+                mediaSubWindow->show();
+                subWindow = mediaSubWindow;
+                ++created_;
+            }
+
+            if (fed_.value(widget) != address) {
+                widget->setImage(image_);
+                fed_[widget] = address;
+            }
+
+            return subWindow;
+        }
+
+    private:
+
+        /// Area that holds the subwindows.
+        QMdiArea& area_;
+
+        /// Subwindow pool, or null.
+        GUI::SubWindowPool* pool_;
+
+        /// Image shown by new tiles.
+        QImage image_;
+
+        /// Shown subwindows by stream address.
+        QHash<QString, QMdiSubWindow*> tiles_;
+
+        /// Stream last shown by each playback widget.
+        QHash<Player::Playback::PlaybackWidget*, QString> fed_;
+
+        /// Number of subwindows created without a pool.
+        quint64 created_ = 0;
+    };
+
+    /// Switches layouts and measures the time until they are painted.
+    /// \param[in]  app         Application.
+    /// \param[in]  area        Area that holds the subwindows.
+    /// \param[in]  layout      Layout to switch.
+    /// \param[in]  switches    Number of switches.
+    /// \return Benchmark result.
+    Result run(QApplication& app, QMdiArea& area, Layout& layout, int switches) {
+        Result result;
+        std::vector<double> times;
+
+        layout.show(GRID_COLUMNS[0]);
+        app.processEvents();
+        area.repaint();
+
+        for (auto i = 1; i <= switches; ++i) {
+            QElapsedTimer timer;
+            timer.start();
+
+            layout.show(GRID_COLUMNS[i % 2]);
+            app.processEvents();
+            area.repaint();
+
+            times.push_back(timer.nsecsElapsed() / 1000000.0);
+        }
+
+        for (auto time : times) {
+            result.meanTime += time / times.size();
+            result.maximumTime = qMax(result.maximumTime, time);
+
+            if (time > FRAME_PERIOD)
+                ++result.slowSwitches;
+        }
+
+        return result;
+    }
+
+    /// Prints a benchmark result.
+    /// \param[in]  mode        Subwindow handling name.
+    /// \param[in]  switches    Number of switches.
+    /// \param[in]  result      Benchmark result.
+    /// \param[in]  created     Number of created subwindows.
+    void print(const char* mode, int switches, const Result& result, quint64 created) {
+        std::printf("{\"mode\":\"%s\",\"switches\":%d,\"switch_ms\":%.2f,"
+                    "\"max_switch_ms\":%.2f,\"over_frame\":%d,"
+                    "\"created_subwindows\":%llu}\n",
+                    mode,
+                    switches,
+                    result.meanTime,
+                    result.maximumTime,
+                    result.slowSwitches,
+                    static_cast<unsigned long long>(created));
+
+        std::fflush(stdout);
+    }
+}
+
+/// Runs the layout switching benchmark.
+/// \details Switches a multiple document interface area between a 2x2 and
+/// a 4x4 grid of streams, once borrowing prewarmed subwindows from a pool
+/// and once creating and deleting subwindows, and measures each switch up
+/// to the synchronous repaint of the area. Tiles that get a new stream are
+/// fed a test image in place of a decoded frame. Defaults to the offscreen
+/// platform and Mesa software rendering, so it runs without a GPU. Prints
+/// one JSON object per line.
+/// \param[in]  argc    Number of arguments passed to the program.
+/// \param[in]  argv    An array of pointers to the arguments passed to the
+///                     program.
+/// \return Exit status.
+int main(int argc, char* argv[]) {
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    if (qEnvironmentVariableIsEmpty("LIBGL_ALWAYS_SOFTWARE"))
+        qputenv("LIBGL_ALWAYS_SOFTWARE", "1");
+
+    QApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    parser.addOption(QCommandLineOption("switches",
+                                        "Number of layout switches per case.",
+                                        "count",
+                                        "20"));
+    parser.addOption(QCommandLineOption("no-pool",
+                                        "Only run the case without a pool."));
+    parser.process(app);
+
+    auto switches = qMax(1, parser.value("switches").toInt());
+    auto image = createImage(WINDOW_WIDTH / 4, WINDOW_HEIGHT / 4, 0);
+
+    if (!parser.isSet("no-pool")) {
+        QMdiArea area;
+        area.resize(WINDOW_WIDTH, WINDOW_HEIGHT);
+        area.show();
+
+        GUI::SubWindowPool pool(&area);
+        pool.prewarm(STREAM_COUNT);
+        app.processEvents();
+
+        Layout layout(area, &pool, image);
+        auto result = run(app, area, layout, switches);
+        print("pool", switches, result, layout.createdSubWindows());
+    }
+
+    {
+        QMdiArea area;
+        area.resize(WINDOW_WIDTH, WINDOW_HEIGHT);
+        area.show();
+        app.processEvents();
+
+        Layout layout(area, nullptr, image);
+        auto result = run(app, area, layout, switches);
+        print("create", switches, result, layout.createdSubWindows());
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,251 @@
+/// \file main.cpp
+/// \brief Contains entry point to the concurrent MJPEG decoding benchmark.
+/// \bug No known bugs.
+
+#include "Playback/Decoding/VideoDecoder.hpp"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QThread>
+
+extern "C" {
+    #include <libavcodec/avcodec.h>
+}
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace {
+
+    /// A structure that defines benchmark case results.
+    struct Result {
+
+        /// Number of decoded frames.
+        quint64 frames = 0;
+
+        /// Decoded frames per second.
+        double framesPerSecond = 0.0;
+
+        /// Number of frames emitted in network order.
+        quint64 orderedFrames = 0;
+
+        /// Number of frames decoded concurrently.
+        quint64 concurrentFrames = 0;
+
+        /// Indicates whether the decoder reported errors.
+        bool failed = false;
+    };
+
+    /// Benchmarked resolutions.
+    constexpr int RESOLUTIONS[][2] {
+        { 1920, 1080 },
+        { 3840, 2160 },
+    };
+
+    /// Fills a frame with a moving test pattern.
+    /// \param[in,out]  frame   YUV 4:2:0 frame.
+    /// \param[in]      index   Frame index.
+    void fillFrame(AVFrame* frame, int index) {
+        for (auto y = 0; y < frame->height; ++y) {
+            auto row = frame->data[0] + y * frame->linesize[0];
+            for (auto x = 0; x < frame->width; ++x)
+                row[x] = static_cast<uint8_t>(x + y + index * 4);
+        }
+
+        for (auto plane = 1; plane < 3; ++plane) {
+            for (auto y = 0; y < frame->height / 2; ++y) {
+                auto row = frame->data[plane] + y * frame->linesize[plane];
+                for (auto x = 0; x < frame->width / 2; ++x)
+                    row[x] = static_cast<uint8_t>(64 * plane + x - y + index);
+            }
+        }
+    }
+
+    /// Encodes an MJPEG test clip.
+    /// \param[in]  width   Frame width.
+    /// \param[in]  height  Frame height.
+    /// \param[in]  frames  Number of frames.
+    /// \return Encoded frames, empty if the encoder is unavailable.
+    std::vector<QByteArray> encodeClip(int width, int height, int frames) {
+        std::vector<QByteArray> packets;
+
+        auto codec = avcodec_find_encoder(AV_CODEC_ID_MJPEG);
+        if (!codec) return packets;
+
+        auto context = avcodec_alloc_context3(codec);
+        auto frame = av_frame_alloc();
+        auto packet = av_packet_alloc();
+        auto result = context && frame && packet;
+
+        if (result) {
+            context->width = width;
+            context->height = height;
+            context->time_base = { 1, 25 };
+            context->pix_fmt = AV_PIX_FMT_YUVJ420P;
+            context->flags |= AV_CODEC_FLAG_QSCALE;
+            context->global_quality = FF_QP2LAMBDA * 4;
+
+            frame->format = context->pix_fmt;
+            frame->width = width;
+            frame->height = height;
+
+            result = avcodec_open2(context, codec, nullptr) >= 0 &&
+                     av_frame_get_buffer(frame, 0) >= 0;
+        }
+
+        for (auto i = 0; result && i < frames; ++i) {
+            result = av_frame_make_writable(frame) >= 0;
+            if (!result) break;
+
+            fillFrame(frame, i);
+            frame->pts = i;
+
+            result = avcodec_send_frame(context, frame) >= 0;
+
+            while (result && avcodec_receive_packet(context, packet) == 0) {
+                packets.emplace_back(reinterpret_cast<const char*>(packet->data),
+                                     packet->size);
+                av_packet_unref(packet);
+            }
+        }
+
+        if (!result) packets.clear();
+
+        av_packet_free(&packet);
+        av_frame_free(&frame);
+        avcodec_free_context(&context);
+
+        return packets;
+    }
+
+    /// Decodes a clip with a number of decoding threads.
+    /// \details Conversion is deferred and never requested, so only
+    /// decoding is measured. Frames are numbered like network frames and
+    /// every emitted frame is checked to come after the previous one.
+    /// \param[in]  packets     Encoded frames.
+    /// \param[in]  threadCount Number of decoding threads.
+    /// \return Benchmark results.
+    Result runCase(const std::vector<QByteArray>& packets, int threadCount) {
+        Result result;
+        Decoders::VideoDecoder decoder;
+        auto lastNumber = -1;
+
+        QObject::connect(&decoder, &Decoders::VideoDecoder::onDecodedFrame,
+                         [&](const Decoders::VideoDecoder::DecodedFrame&,
+                             const Decoders::VideoDecoder::FrameInfo& info) {
+                             if (static_cast<int>(info.number) > lastNumber)
+                                 ++result.orderedFrames;
+
+                             lastNumber = info.number;
+                         });
+
+        QObject::connect(&decoder, &Decoders::VideoDecoder::onError,
+                         [&result](Decoders::VideoDecoder::Error) {
+                             result.failed = true;
+                         });
+
+        decoder.setDeferredConversion(true);
+        decoder.setThreadCount(threadCount);
+
+        if (!decoder.initialize(Decoders::VideoDecoder::Codec::MJPEG,
+                                Decoders::VideoDecoder::Format::RGBX8888)) {
+            result.failed = true;
+            return result;
+        }
+
+        QElapsedTimer timer;
+        timer.start();
+
+        for (std::size_t i = 0; i < packets.size(); ++i) {
+            Decoders::VideoDecoder::FrameInfo info;
+            info.id = static_cast<quint32>(i);
+            info.number = static_cast<quint16>(i);
+
+            decoder.decode(packets[i], info);
+        }
+
+        decoder.decode(QByteArray());
+
+        auto elapsed = timer.nsecsElapsed() / 1e9;
+        auto statistics = decoder.statistics();
+
+        result.frames = statistics.decodedFrames;
+        result.concurrentFrames = statistics.concurrentFrames;
+
+        if (elapsed > 0.0)
+            result.framesPerSecond = result.frames / elapsed;
+
+        return result;
+    }
+}
+
+/// Runs the concurrent MJPEG decoding benchmark.
+/// \details Decodes MJPEG clips at 1080p and 4K with one to as many decoding
+/// threads as processors. Reports decoded frames per second, the speedup
+/// over one thread, how many emitted frames kept network order and how many
+/// frames were decoded concurrently. Prints one JSON object per line.
+/// \param[in]  argc    Number of arguments passed to the program.
+/// \param[in]  argv    An array of pointers to the arguments passed to the
+///                     program.
+/// \return Exit status.
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    parser.addOption(QCommandLineOption("frames",
+                                        "Number of frames per clip.",
+                                        "count",
+                                        "120"));
+    parser.addOption(QCommandLineOption("threads",
+                                        "Maximum number of decoding threads.",
+                                        "count",
+                                        QString::number(QThread::idealThreadCount())));
+    parser.process(app);
+
+    auto frames = qMax(2, parser.value("frames").toInt());
+    auto maximumThreads = qBound(1, parser.value("threads").toInt(), 16);
+
+    std::vector<int> threadCounts;
+    for (auto count = 1; count < maximumThreads; count *= 2)
+        threadCounts.push_back(count);
+
+    threadCounts.push_back(maximumThreads);
+
+    for (const auto& resolution : RESOLUTIONS) {
+        auto packets = encodeClip(resolution[0], resolution[1], frames);
+
+        if (packets.empty()) {
+            std::fprintf(stderr, "Skipping %dx%d: no usable encoder\n",
+                         resolution[0], resolution[1]);
+            continue;
+        }
+
+        auto baseline = 0.0;
+
+        for (auto threadCount : threadCounts) {
+            auto result = runCase(packets, threadCount);
+            if (threadCount == 1) baseline = result.framesPerSecond;
+
+            std::printf("{\"width\":%d,\"height\":%d,\"threads\":%d,"
+                        "\"frames\":%llu,\"fps\":%.1f,\"speedup\":%.2f,"
+                        "\"ordered_frames\":%llu,\"concurrent_frames\":%llu,"
+                        "\"failed\":%s}\n",
+                        resolution[0],
+                        resolution[1],
+                        threadCount,
+                        static_cast<unsigned long long>(result.frames),
+                        result.framesPerSecond,
+                        baseline > 0.0 ? result.framesPerSecond / baseline : 0.0,
+                        static_cast<unsigned long long>(result.orderedFrames),
+                        static_cast<unsigned long long>(result.concurrentFrames),
+                        result.failed ? "true" : "false");
+
+            std::fflush(stdout);
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,50 @@
+#------------------------------------------------------------------------------#
+#                                Base settings                                 #
+#------------------------------------------------------------------------------#
+
+TEMPLATE            =   app
+TARGET              =   mosaicbenchmark
+QT                  =   core gui widgets
+CONFIG              +=	c++17 strict_c++ console
+CONFIG              -=  app_bundle
+
+
+#------------------------------------------------------------------------------#
+#                             Project files settings                           #
+#------------------------------------------------------------------------------#
+
+CLIENT_PATH         =   $$absolute_path(RTSPPlayerClient, $$SOURCE_PATH)
+OUTPUT_PATH         =   $$absolute_path(Playback/Output, $$CLIENT_PATH)
+
+include($$absolute_path(Base/Utility/Utility.pri, $$CLIENT_PATH))
+
+HEADERS             +=                                                      \
+                        $$OUTPUT_PATH/MosaicWidget.hpp                      \
+                        $$OUTPUT_PATH/PlaybackWidget.hpp                    \
+                        $$OUTPUT_PATH/RenderThread.hpp                      \
+                        $$OUTPUT_PATH/ResourceCache.hpp                     \
+                        $$OUTPUT_PATH/StreamCounters.hpp                    \
+                        $$OUTPUT_PATH/TextureStream.hpp                     \
+
+SOURCES             +=                                                      \
+                        $$OUTPUT_PATH/MosaicWidget.cpp                      \
+                        $$OUTPUT_PATH/PlaybackWidget.cpp                    \
+                        $$OUTPUT_PATH/RenderThread.cpp                      \
+                        $$OUTPUT_PATH/ResourceCache.cpp                     \
+                        $$OUTPUT_PATH/StreamCounters.cpp                    \
+                        $$OUTPUT_PATH/TextureStream.cpp                     \
+                        $$PWD/main.cpp                                      \
+
+RESOURCES           +=                                                      \
+                        $$CLIENT_PATH/GUI/resources.qrc                     \
+
+
+#------------------------------------------------------------------------------#
+#                          Include directories settings                        #
+#------------------------------------------------------------------------------#
+
+INCLUDEPATH         +=                                                      \
+                        $$CLIENT_PATH                                       \
+
+DEPENDPATH          +=                                                      \
+                        $$CLIENT_PATH                                       \
@@ -0,0 +1,189 @@
+/// \file main.cpp
+/// \brief Contains entry point to the mosaic rendering benchmark.
+/// \bug No known bugs.
+
+#include "Playback/Output/MosaicWidget.hpp"
+#include "Playback/Output/PlaybackWidget.hpp"
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QGridLayout>
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <vector>
+
+namespace {
+
+    /// Benchmarked tile counts.
+    constexpr int TILE_COUNTS[] {
+        4, 16, 36, 64
+    };
+
+    /// Window width.
+    constexpr int WINDOW_WIDTH {
+        1920
+    };
+
+    /// Window height.
+    constexpr int WINDOW_HEIGHT {
+        1080
+    };
+
+    /// A structure that contains the result of a benchmark case.
+    struct Result {
+
+        /// Wall time per presented frame in microseconds.
+        double frameTime;
+
+        /// CPU time per presented frame in microseconds.
+        double cpuTime;
+    };
+
+    /// Creates a test image.
+    /// \param[in]  width   Image width.
+    /// \param[in]  height  Image height.
+    /// \param[in]  seed    Pattern seed.
+    /// \return Test image.
+    QImage createImage(int width, int height, int seed) {
+        QImage image(width, height, QImage::Format_RGBX8888);
+
+        for (auto y = 0; y < height; ++y) {
+            auto row = image.scanLine(y);
+            for (auto x = 0; x < image.bytesPerLine(); ++x)
+                row[x] = static_cast<uchar>(x + y + seed);
+        }
+
+        return image;
+    }
+
+    /// Presents frames and measures the time per frame.
+    /// \param[in]  window  Window to repaint.
+    /// \param[in]  frames  Number of frames.
+    /// \param[in]  feed    Function that sets the images of a frame.
+    /// \return Benchmark result.
+    template <typename Feed>
+    Result present(QWidget& window, int frames, Feed feed) {
+        feed(0);
+        window.repaint();
+
+        QElapsedTimer timer;
+        timer.start();
+        auto clock = std::clock();
+
+        for (auto i = 0; i < frames; ++i) {
+            feed(i);
+            window.repaint();
+        }
+
+        auto cpu = static_cast<double>(std::clock() - clock) / CLOCKS_PER_SEC;
+
+        return {
+            timer.nsecsElapsed() / 1000.0 / frames,
+            cpu * 1000000.0 / frames
+        };
+    }
+
+    /// Prints a benchmark result.
+    /// \param[in]  mode    Rendering mode name.
+    /// \param[in]  tiles   Number of tiles.
+    /// \param[in]  frames  Number of frames.
+    /// \param[in]  result  Benchmark result.
+    void print(const char* mode, int tiles, int frames, const Result& result) {
+        std::printf("{\"mode\":\"%s\",\"tiles\":%d,\"frames\":%d,"
+                    "\"frame_us\":%.1f,\"cpu_us_per_frame\":%.1f,"
+                    "\"cpu_us_per_tile\":%.1f}\n",
+                    mode,
+                    tiles,
+                    frames,
+                    result.frameTime,
+                    result.cpuTime,
+                    result.cpuTime / tiles);
+
+        std::fflush(stdout);
+    }
+}
+
+/// Runs the mosaic rendering benchmark.
+/// \details Renders a grid of streams once with one playback widget per
+/// stream and once with a single mosaic widget, repainting synchronously
+/// after every set of tile images. Defaults to the offscreen platform and
+/// Mesa software rendering, so it runs without a GPU. Prints one JSON object
+/// per line.
+/// \param[in]  argc    Number of arguments passed to the program.
+/// \param[in]  argv    An array of pointers to the arguments passed to the
+///                     program.
+/// \return Exit status.
+int main(int argc, char* argv[]) {
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    if (qEnvironmentVariableIsEmpty("LIBGL_ALWAYS_SOFTWARE"))
+        qputenv("LIBGL_ALWAYS_SOFTWARE", "1");
+
+    QApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    parser.addOption(QCommandLineOption("frames",
+                                        "Number of presented frames per case.",
+                                        "count",
+                                        "60"));
+    parser.process(app);
+
+    auto frames = qMax(1, parser.value("frames").toInt());
+
+    for (auto tiles : TILE_COUNTS) {
+        auto columns = static_cast<int>(std::ceil(std::sqrt(tiles)));
+        auto rows = (tiles + columns - 1) / columns;
+
+        QImage images[] {
+            createImage(WINDOW_WIDTH / columns, WINDOW_HEIGHT / rows, 0),
+            createImage(WINDOW_WIDTH / columns, WINDOW_HEIGHT / rows, 1),
+        };
+
+        {
+            QWidget window;
+            auto layout = new QGridLayout(&window);
+            layout->setSpacing(0);
+            layout->setContentsMargins(0, 0, 0, 0);
+
+            std::vector<Player::Playback::PlaybackWidget*> widgets;
+
+            for (auto tile = 0; tile < tiles; ++tile) {
+                auto widget = new Player::Playback::PlaybackWidget;
+                layout->addWidget(widget, tile / columns, tile % columns);
+                widgets.push_back(widget);
+            }
+
+            window.resize(WINDOW_WIDTH, WINDOW_HEIGHT);
+            window.show();
+            app.processEvents();
+
+            print("widgets", tiles, frames,
+                  present(window, frames, [&](int frame) {
+                      for (auto widget : widgets)
+                          widget->setImage(images[frame % 2]);
+                  }));
+        }
+
+        {
+            Player::Playback::MosaicWidget window;
+            window.setTileCount(tiles);
+            window.resize(WINDOW_WIDTH, WINDOW_HEIGHT);
+            window.show();
+            app.processEvents();
+
+            print("mosaic", tiles, frames,
+                  present(window, frames, [&](int frame) {
+                      for (auto tile = 0; tile < tiles; ++tile)
+                          window.setImage(tile, images[frame % 2]);
+                  }));
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,586 @@
+/// \file main.cpp
+/// \brief Contains entry point to the pixel format benchmark.
+/// \bug No known bugs.
+
+#include "Playback/Decoding/VideoDecoder.hpp"
+#include "Playback/Output/TextureStream.hpp"
+
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QGuiApplication>
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+
+extern "C" {
+    #include <libavcodec/avcodec.h>
+    #include <libswscale/swscale.h>
+}
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace {
+
+    /// A structure that defines a benchmark output format.
+    struct OutputFormat {
+
+        /// Format name.
+        const char* name;
+
+        /// Decoder output format.
+        Decoders::VideoDecoder::Format format;
+    };
+
+    /// A structure that defines benchmark case results.
+    struct Result {
+
+        /// Number of presented frames.
+        int frames = 0;
+
+        /// Conversion time per frame in microseconds.
+        double convertTime = 0.0;
+
+        /// Upload time per frame in microseconds.
+        double uploadTime = 0.0;
+
+        /// Wall time per frame until uploads finished in microseconds.
+        double finishedTime = 0.0;
+
+        /// Number of frames whose rows were packed before the upload.
+        quint64 packedFrames = 0;
+
+        /// Number of frames converted before the upload.
+        quint64 convertedFrames = 0;
+
+        /// Row stride of the converted images in bytes.
+        int stride = 0;
+
+        /// Indicates whether pixel unpack buffers were used.
+        bool streaming = false;
+    };
+
+    /// A structure that defines a luma range compared against swscale.
+    struct LumaRange {
+
+        /// Range name.
+        const char* name;
+
+        /// Pixel format the clip is encoded in.
+        AVPixelFormat format;
+    };
+
+    /// A structure that defines a grayscale output format compared against
+    /// swscale.
+    struct GrayFormat {
+
+        /// Format name.
+        const char* name;
+
+        /// Decoder output format.
+        Decoders::VideoDecoder::Format format;
+    };
+
+    /// A structure that contains the comparison of fast path output with
+    /// swscale output.
+    struct Comparison {
+
+        /// Number of compared frames.
+        int frames = 0;
+
+        /// Number of compared pixels.
+        quint64 pixels = 0;
+
+        /// Number of pixels that differ.
+        quint64 differentPixels = 0;
+
+        /// Largest difference in 8-bit steps. For monochrome output, the
+        /// distance of the swscale luma from the threshold.
+        int maximumDifference = 0;
+    };
+
+    /// Largest difference from swscale the fast paths may show, in 8-bit
+    /// steps, which allows for rounding.
+    constexpr int FAST_PATH_TOLERANCE {
+        1
+    };
+
+    /// Luma ranges compared against swscale. MJPEG marks pictures encoded
+    /// in a non JPEG format as limited range.
+    const LumaRange LUMA_RANGES[] {
+        { "full", AV_PIX_FMT_YUVJ420P },
+        { "limited", AV_PIX_FMT_YUV420P },
+    };
+
+    /// Grayscale output formats compared against swscale.
+    const GrayFormat GRAY_FORMATS[] {
+        { "gray8", Decoders::VideoDecoder::Format::Grayscale8 },
+        { "gray16", Decoders::VideoDecoder::Format::Grayscale16 },
+        { "mono", Decoders::VideoDecoder::Format::Mono },
+    };
+
+    /// Benchmarked resolutions. Rows 1366 pixels wide are padded to 64
+    /// bytes, so they show the cost of padded rows in each format.
+    constexpr int RESOLUTIONS[][2] {
+        { 1366, 768 },
+        { 1920, 1080 },
+        { 3840, 2160 },
+    };
+
+    /// Benchmarked output formats.
+    const OutputFormat OUTPUT_FORMATS[] {
+        { "rgb888", Decoders::VideoDecoder::Format::RGB888 },
+        { "rgbx8888", Decoders::VideoDecoder::Format::RGBX8888 },
+        { "bgra8888", Decoders::VideoDecoder::Format::BGRA8888 },
+    };
+
+    /// Fills a frame with a moving test pattern.
+    /// \param[in,out]  frame   YUV 4:2:0 frame.
+    /// \param[in]      index   Frame index.
+    void fillFrame(AVFrame* frame, int index) {
+        for (auto y = 0; y < frame->height; ++y) {
+            auto row = frame->data[0] + y * frame->linesize[0];
+            for (auto x = 0; x < frame->width; ++x)
+                row[x] = static_cast<uint8_t>(x + y + index * 4);
+        }
+
+        for (auto plane = 1; plane < 3; ++plane) {
+            for (auto y = 0; y < frame->height / 2; ++y) {
+                auto row = frame->data[plane] + y * frame->linesize[plane];
+                for (auto x = 0; x < frame->width / 2; ++x)
+                    row[x] = static_cast<uint8_t>(64 * plane + x - y + index);
+            }
+        }
+    }
+
+    /// Encodes an MJPEG test clip.
+    /// \details Formats other than the YUVJ ones are limited range, which
+    /// MJPEG only allows as an unofficial extension.
+    /// \param[in]  width   Frame width.
+    /// \param[in]  height  Frame height.
+    /// \param[in]  frames  Number of frames.
+    /// \param[in]  format  Encoded pixel format.
+    /// \return Encoded frames, empty if the encoder is unavailable.
+    std::vector<QByteArray> encodeClip(
+        int width,
+        int height,
+        int frames,
+        AVPixelFormat format = AV_PIX_FMT_YUVJ420P) {
+
+        std::vector<QByteArray> packets;
+
+        auto codec = avcodec_find_encoder(AV_CODEC_ID_MJPEG);
+        if (!codec) return packets;
+
+        auto context = avcodec_alloc_context3(codec);
+        auto frame = av_frame_alloc();
+        auto packet = av_packet_alloc();
+        auto result = context && frame && packet;
+
+        if (result) {
+            context->width = width;
+            context->height = height;
+            context->time_base = { 1, 25 };
+            context->pix_fmt = format;
+            context->flags |= AV_CODEC_FLAG_QSCALE;
+
+            if (format != AV_PIX_FMT_YUVJ420P)
+                context->strict_std_compliance = FF_COMPLIANCE_UNOFFICIAL;
+            context->global_quality = FF_QP2LAMBDA * 4;
+
+            frame->format = context->pix_fmt;
+            frame->width = width;
+            frame->height = height;
+
+            result = avcodec_open2(context, codec, nullptr) >= 0 &&
+                     av_frame_get_buffer(frame, 0) >= 0;
+        }
+
+        for (auto i = 0; result && i < frames; ++i) {
+            result = av_frame_make_writable(frame) >= 0;
+            if (!result) break;
+
+            fillFrame(frame, i);
+            frame->pts = i;
+
+            result = avcodec_send_frame(context, frame) >= 0;
+
+            while (result && avcodec_receive_packet(context, packet) == 0) {
+                packets.emplace_back(reinterpret_cast<const char*>(packet->data),
+                                     packet->size);
+                av_packet_unref(packet);
+            }
+        }
+
+        if (!result) packets.clear();
+
+        av_packet_free(&packet);
+        av_frame_free(&frame);
+        avcodec_free_context(&context);
+
+        return packets;
+    }
+
+    /// Decodes a clip and uploads every frame.
+    /// \details The first frame allocates the scaler and the texture and is
+    /// left out of the per frame times.
+    /// \param[in]  packets     Encoded frames.
+    /// \param[in]  format      Output format.
+    /// \param[in]  streaming   Indicates whether pixel unpack buffers are
+    ///                         used.
+    /// \param[in]  functions   Functions of the current context.
+    /// \return Benchmark results.
+    Result runCase(const std::vector<QByteArray>& packets,
+                   Decoders::VideoDecoder::Format format,
+                   bool streaming,
+                   QOpenGLFunctions* functions) {
+
+        Result result;
+        Decoders::VideoDecoder decoder;
+        Player::Playback::TextureStream stream;
+
+        if (!stream.initialize() ||
+            !decoder.initialize(Decoders::VideoDecoder::Codec::MJPEG, format))
+            return result;
+
+        stream.setStreamingEnabled(streaming);
+        result.streaming = stream.isStreaming();
+
+        Decoders::VideoDecoder::Statistics warmup;
+        quint64 warmupUpload = 0;
+        QElapsedTimer timer;
+
+        QObject::connect(&decoder, &Decoders::VideoDecoder::onFrame,
+                         [&](const QImage& frame) {
+                             stream.upload(frame);
+
+                             if (result.frames++ == 0) {
+                                 functions->glFinish();
+                                 warmup = decoder.statistics();
+                                 warmupUpload = stream.statistics().totalUploadTime;
+                                 result.stride = frame.bytesPerLine();
+                                 timer.start();
+                             }
+                         });
+
+        for (const auto& packet : packets)
+            decoder.decode(packet);
+
+        decoder.decode(QByteArray());
+        functions->glFinish();
+
+        auto frames = result.frames - 1;
+
+        if (frames > 0) {
+            auto statistics = decoder.statistics();
+            const auto& upload = stream.statistics();
+
+            result.convertTime =
+                static_cast<double>(statistics.convertTime - warmup.convertTime) /
+                (statistics.convertedFrames - warmup.convertedFrames);
+            result.uploadTime =
+                static_cast<double>(upload.totalUploadTime - warmupUpload) / frames;
+            result.finishedTime = timer.nsecsElapsed() / 1000.0 / frames;
+            result.packedFrames = upload.packedFrames;
+            result.convertedFrames = upload.convertedFrames;
+        }
+
+        stream.destroy();
+        return result;
+    }
+
+    /// Decodes a clip with swscale converting the luma to grayscale.
+    /// \details swscale takes the range from the decoded pixel format and
+    /// expands limited range luma itself.
+    /// \param[in]  packets Encoded frames.
+    /// \param[in]  format  Grayscale output format.
+    /// \return Converted frames, empty on error.
+    std::vector<QImage> scaleClip(const std::vector<QByteArray>& packets,
+                                  AVPixelFormat format) {
+        std::vector<QImage> images;
+
+        auto codec = avcodec_find_decoder(AV_CODEC_ID_MJPEG);
+        if (!codec) return images;
+
+        auto context = avcodec_alloc_context3(codec);
+        auto frame = av_frame_alloc();
+        auto packet = av_packet_alloc();
+        SwsContext* scaler = nullptr;
+        auto result = context && frame && packet &&
+                      avcodec_open2(context, codec, nullptr) >= 0;
+
+        for (const auto& data : packets) {
+            if (!result) break;
+
+            packet->data = reinterpret_cast<uint8_t*>(
+                const_cast<char*>(data.constData()));
+            packet->size = data.size();
+
+            result = avcodec_send_packet(context, packet) >= 0;
+
+            while (result && avcodec_receive_frame(context, frame) == 0) {
+                QImage image(frame->width,
+                             frame->height,
+                             format == AV_PIX_FMT_GRAY16
+                                 ? QImage::Format_Grayscale16
+                                 : QImage::Format_Grayscale8);
+
+                scaler = sws_getCachedContext(
+                    scaler,
+                    frame->width,
+                    frame->height,
+                    static_cast<AVPixelFormat>(frame->format),
+                    frame->width,
+                    frame->height,
+                    format,
+                    SWS_POINT | SWS_ACCURATE_RND | SWS_BITEXACT,
+                    nullptr,
+                    nullptr,
+                    nullptr);
+
+                result = scaler && !image.isNull();
+                if (!result) break;
+
+                uint8_t* data[4] { image.bits() };
+                int linesize[4] { image.bytesPerLine() };
+
+                sws_scale(scaler,
+                          frame->data,
+                          frame->linesize,
+                          0,
+                          frame->height,
+                          data,
+                          linesize);
+
+                images.push_back(image);
+                av_frame_unref(frame);
+            }
+        }
+
+        if (!result) images.clear();
+
+        sws_freeContext(scaler);
+        av_packet_free(&packet);
+        av_frame_free(&frame);
+        avcodec_free_context(&context);
+
+        return images;
+    }
+
+    /// Compares the grayscale fast paths of the decoder with swscale.
+    /// \details Grayscale output is compared value by value. Monochrome
+    /// output is compared with swscale grayscale output thresholded at
+    /// 128, since swscale dithers monochrome output.
+    /// \param[in]  packets Encoded frames.
+    /// \param[in]  format  Decoder output format.
+    /// \return Comparison results.
+    Comparison compareCase(const std::vector<QByteArray>& packets,
+                           Decoders::VideoDecoder::Format format) {
+        Comparison comparison;
+        Decoders::VideoDecoder decoder;
+        std::vector<QImage> images;
+
+        if (!decoder.initialize(Decoders::VideoDecoder::Codec::MJPEG, format))
+            return comparison;
+
+        QObject::connect(&decoder, &Decoders::VideoDecoder::onFrame,
+                         [&](const QImage& frame) {
+                             images.push_back(frame.copy());
+                         });
+
+        for (const auto& packet : packets)
+            decoder.decode(packet);
+
+        decoder.decode(QByteArray());
+
+        auto wide = format == Decoders::VideoDecoder::Format::Grayscale16;
+        auto mono = format == Decoders::VideoDecoder::Format::Mono;
+        auto references = scaleClip(packets,
+                                    wide ? AV_PIX_FMT_GRAY16
+                                         : AV_PIX_FMT_GRAY8);
+
+        auto frames = qMin(images.size(), references.size());
+
+        for (size_t index = 0; index < frames; ++index) {
+            const auto& image = images[index];
+            const auto& reference = references[index];
+
+            if (image.size() != reference.size()) continue;
+
+            for (auto y = 0; y < image.height(); ++y) {
+                auto row = image.constScanLine(y);
+                auto referenceRow = reference.constScanLine(y);
+
+                for (auto x = 0; x < image.width(); ++x) {
+                    auto difference = 0;
+
+                    if (wide) {
+                        auto value = reinterpret_cast<const quint16*>(row)[x];
+                        auto expected =
+                            reinterpret_cast<const quint16*>(referenceRow)[x];
+                        difference = (qAbs(value - expected) + 128) / 257;
+                    }
+                    else if (mono) {
+                        auto bit = (row[x / 8] >> (7 - x % 8)) & 1;
+                        auto expected = static_cast<int>(referenceRow[x]);
+
+                        if (bit != (expected >= 128 ? 1 : 0))
+                            difference = expected >= 128 ? expected - 127
+                                                         : 128 - expected;
+                    }
+                    else {
+                        difference = qAbs(row[x] - referenceRow[x]);
+                    }
+
+                    if (difference > 0) ++comparison.differentPixels;
+
+                    comparison.maximumDifference =
+                        qMax(comparison.maximumDifference, difference);
+                }
+            }
+
+            comparison.pixels +=
+                static_cast<quint64>(image.width()) * image.height();
+            ++comparison.frames;
+        }
+
+        return comparison;
+    }
+}
+
+/// Runs the pixel format benchmark.
+/// \details Decodes MJPEG clips with the decoder converting to each output
+/// format and uploads every frame through a texture stream on an offscreen
+/// surface, with and without pixel unpack buffers. Reports conversion and
+/// upload time per frame, and how many frames needed packing or another
+/// conversion before the upload. Then checks the grayscale fast paths
+/// against swscale on full and limited range clips, and fails if they
+/// differ by more than rounding. Defaults to the offscreen platform and
+/// Mesa software rendering, so it runs without a GPU. Prints one JSON
+/// object per line.
+/// \param[in]  argc    Number of arguments passed to the program.
+/// \param[in]  argv    An array of pointers to the arguments passed to the
+///                     program.
+/// \return Exit status.
+int main(int argc, char* argv[]) {
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    if (qEnvironmentVariableIsEmpty("LIBGL_ALWAYS_SOFTWARE"))
+        qputenv("LIBGL_ALWAYS_SOFTWARE", "1");
+
+    QGuiApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    parser.addOption(QCommandLineOption("frames",
+                                        "Number of frames per clip.",
+                                        "count",
+                                        "60"));
+    parser.process(app);
+
+    auto frames = qMax(2, parser.value("frames").toInt());
+
+    QOpenGLContext context;
+    if (!context.create()) {
+        std::fprintf(stderr, "Failed to create an OpenGL context\n");
+        return EXIT_FAILURE;
+    }
+
+    QOffscreenSurface surface;
+    surface.setFormat(context.format());
+    surface.create();
+
+    if (!context.makeCurrent(&surface)) {
+        std::fprintf(stderr, "Failed to make the OpenGL context current\n");
+        return EXIT_FAILURE;
+    }
+
+    auto functions = context.functions();
+    auto renderer = reinterpret_cast<const char*>(
+        functions->glGetString(GL_RENDERER));
+
+    for (const auto& resolution : RESOLUTIONS) {
+        auto packets = encodeClip(resolution[0], resolution[1], frames);
+
+        if (packets.empty()) {
+            std::fprintf(stderr, "Skipping %dx%d: no usable encoder\n",
+                         resolution[0], resolution[1]);
+            continue;
+        }
+
+        for (const auto& format : OUTPUT_FORMATS) {
+            for (auto streaming : { false, true }) {
+                auto result = runCase(packets, format.format, streaming, functions);
+
+                std::printf("{\"renderer\":\"%s\",\"width\":%d,\"height\":%d,"
+                            "\"format\":\"%s\",\"stride\":%d,\"pbo\":%s,"
+                            "\"frames\":%d,\"convert_us_per_frame\":%.1f,"
+                            "\"upload_us_per_frame\":%.1f,"
+                            "\"convert_upload_us_per_frame\":%.1f,"
+                            "\"finished_us_per_frame\":%.1f,"
+                            "\"packed_frames\":%llu,"
+                            "\"converted_frames\":%llu}\n",
+                            renderer ? renderer : "unknown",
+                            resolution[0],
+                            resolution[1],
+                            format.name,
+                            result.stride,
+                            result.streaming ? "true" : "false",
+                            result.frames,
+                            result.convertTime,
+                            result.uploadTime,
+                            result.convertTime + result.uploadTime,
+                            result.finishedTime,
+                            static_cast<unsigned long long>(result.packedFrames),
+                            static_cast<unsigned long long>(result.convertedFrames));
+
+                std::fflush(stdout);
+            }
+        }
+    }
+
+    context.doneCurrent();
+
+    auto matched = true;
+    const auto& resolution = RESOLUTIONS[0];
+
+    for (const auto& range : LUMA_RANGES) {
+        auto packets = encodeClip(resolution[0],
+                                  resolution[1],
+                                  frames,
+                                  range.format);
+
+        if (packets.empty()) {
+            std::fprintf(stderr, "Skipping the %s range comparison: "
+                                 "no usable encoder\n", range.name);
+            continue;
+        }
+
+        for (const auto& format : GRAY_FORMATS) {
+            auto comparison = compareCase(packets, format.format);
+
+            matched = matched && comparison.frames > 0 &&
+                      comparison.maximumDifference <= FAST_PATH_TOLERANCE;
+
+            std::printf("{\"comparison\":\"swscale\",\"range\":\"%s\","
+                        "\"width\":%d,\"height\":%d,\"format\":\"%s\","
+                        "\"frames\":%d,\"pixels\":%llu,"
+                        "\"different_pixels\":%llu,"
+                        "\"max_difference\":%d}\n",
+                        range.name,
+                        resolution[0],
+                        resolution[1],
+                        format.name,
+                        comparison.frames,
+                        static_cast<unsigned long long>(comparison.pixels),
+                        static_cast<unsigned long long>(
+                            comparison.differentPixels),
+                        comparison.maximumDifference);
+
+            std::fflush(stdout);
+        }
+    }
+
+    return matched ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,37 @@
+#------------------------------------------------------------------------------#
+#                                Base settings                                 #
+#------------------------------------------------------------------------------#
+
+TEMPLATE            =   app
+TARGET              =   softwarerenderbenchmark
+QT                  =   core gui widgets
+CONFIG              +=	c++17 strict_c++ console
+CONFIG              -=  app_bundle
+
+
+#------------------------------------------------------------------------------#
+#                             Project files settings                           #
+#------------------------------------------------------------------------------#
+
+CLIENT_PATH         =   $$absolute_path(RTSPPlayerClient, $$SOURCE_PATH)
+OUTPUT_PATH         =   $$absolute_path(Playback/Output, $$CLIENT_PATH)
+
+include($$absolute_path(Playback/Conversion/Conversion.pri, $$CLIENT_PATH))
+
+HEADERS             +=                                                      \
+                        $$OUTPUT_PATH/PlaybackVideo.hpp                     \
+
+SOURCES             +=                                                      \
+                        $$OUTPUT_PATH/PlaybackVideo.cpp                     \
+                        $$PWD/main.cpp                                      \
+
+
+#------------------------------------------------------------------------------#
+#                          Include directories settings                        #
+#------------------------------------------------------------------------------#
+
+INCLUDEPATH         +=                                                      \
+                        $$CLIENT_PATH                                       \
+
+DEPENDPATH          +=                                                      \
+                        $$CLIENT_PATH                                       \
@@ -0,0 +1,183 @@
+/// \file main.cpp
+/// \brief Contains entry point to the software rendering benchmark.
+/// \bug No known bugs.
+
+#include "Playback/Output/PlaybackVideo.hpp"
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QGridLayout>
+#include <QPainter>
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <vector>
+
+namespace {
+
+    /// Benchmarked tile counts.
+    constexpr int TILE_COUNTS[] {
+        4, 16, 36, 64
+    };
+
+    /// Window width.
+    constexpr int WINDOW_WIDTH {
+        1920
+    };
+
+    /// Window height.
+    constexpr int WINDOW_HEIGHT {
+        1080
+    };
+
+    /// A widget that scales its image on every paint.
+    /// \details Reproduces the former PlaybackVideo behavior as a baseline.
+    class PainterVideo : public QWidget {
+    public:
+
+        /// Sets the frame to show and schedules a repaint.
+        /// \param[in]  image   Frame image.
+        void setImage(const QImage& image) {
+            image_ = image;
+            update();
+        }
+
+    protected:
+
+        /// Paints the image scaled to the widget.
+        void paintEvent(QPaintEvent*) override {
+            QPainter painter(this);
+            painter.drawImage(rect(), image_);
+        }
+
+    private:
+
+        /// Frame image.
+        QImage image_;
+    };
+
+    /// Creates a test image.
+    /// \param[in]  width   Image width.
+    /// \param[in]  height  Image height.
+    /// \param[in]  seed    Pattern seed.
+    /// \return Test image.
+    QImage createImage(int width, int height, int seed) {
+        QImage image(width, height, QImage::Format_RGB32);
+
+        for (auto y = 0; y < height; ++y) {
+            auto row = image.scanLine(y);
+            for (auto x = 0; x < image.bytesPerLine(); ++x)
+                row[x] = static_cast<uchar>(x + y + seed);
+        }
+
+        return image;
+    }
+
+    /// Repaints a grid of tiles and prints the time per frame.
+    /// \param[in]  mode        Rendering mode name.
+    /// \param[in]  tiles       Number of tiles.
+    /// \param[in]  frames      Number of frames.
+    /// \param[in]  images      Frame images used in turn.
+    /// \param[in]  newFrames   Indicates whether every repaint has new frames.
+    template <typename Video>
+    void measure(const char* mode,
+                 int tiles,
+                 int frames,
+                 const QImage (&images)[2],
+                 bool newFrames) {
+
+        auto columns = static_cast<int>(std::ceil(std::sqrt(tiles)));
+
+        QWidget window;
+        auto layout = new QGridLayout(&window);
+        layout->setSpacing(0);
+        layout->setContentsMargins(0, 0, 0, 0);
+
+        std::vector<Video*> videos;
+
+        for (auto tile = 0; tile < tiles; ++tile) {
+            auto video = new Video;
+            layout->addWidget(video, tile / columns, tile % columns);
+            videos.push_back(video);
+        }
+
+        window.resize(WINDOW_WIDTH, WINDOW_HEIGHT);
+        window.show();
+        QApplication::processEvents();
+
+        for (auto video : videos)
+            video->setImage(images[0]);
+        window.repaint();
+
+        QElapsedTimer timer;
+        timer.start();
+        auto clock = std::clock();
+
+        for (auto i = 0; i < frames; ++i) {
+            if (newFrames) {
+                for (auto video : videos)
+                    video->setImage(images[i % 2]);
+            }
+            window.repaint();
+        }
+
+        auto cpu = static_cast<double>(std::clock() - clock) / CLOCKS_PER_SEC;
+        auto wall = timer.nsecsElapsed() / 1000.0;
+
+        std::printf("{\"mode\":\"%s\",\"tiles\":%d,\"frames\":%d,"
+                    "\"new_frames\":%s,\"frame_us\":%.1f,"
+                    "\"cpu_us_per_tile\":%.1f}\n",
+                    mode,
+                    tiles,
+                    frames,
+                    newFrames ? "true" : "false",
+                    wall / frames,
+                    cpu * 1000000.0 / frames / tiles);
+
+        std::fflush(stdout);
+    }
+}
+
+/// Runs the software rendering benchmark.
+/// \details Repaints grids of 1080p streams with the former per-paint
+/// QPainter scaling and with the cached PlaybackVideo path, with a new frame
+/// on every repaint and with repaints only. Defaults to the offscreen
+/// platform. Prints one JSON object per line.
+/// \param[in]  argc    Number of arguments passed to the program.
+/// \param[in]  argv    An array of pointers to the arguments passed to the
+///                     program.
+/// \return Exit status.
+int main(int argc, char* argv[]) {
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    QApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    parser.addOption(QCommandLineOption("frames",
+                                        "Number of repaints per case.",
+                                        "count",
+                                        "30"));
+    parser.process(app);
+
+    auto frames = qMax(1, parser.value("frames").toInt());
+
+    const QImage images[2] {
+        createImage(1920, 1080, 0),
+        createImage(1920, 1080, 1),
+    };
+
+    for (auto tiles : TILE_COUNTS) {
+        for (auto newFrames : { true, false }) {
+            measure<PainterVideo>("painter", tiles, frames, images, newFrames);
+            measure<PlaybackVideo>("playback_video", tiles, frames, images,
+                                   newFrames);
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,104 @@
+#------------------------------------------------------------------------------#
+#                                Base settings                                 #
+#------------------------------------------------------------------------------#
+
+TEMPLATE            =   app
+TARGET              =   streambenchmark
+QT                  =   core gui widgets
+CONFIG              +=	c++17 strict_c++ console
+CONFIG              -=  app_bundle
+
+
+#------------------------------------------------------------------------------#
+#                                Project macros                                #
+#------------------------------------------------------------------------------#
+
+DEFINES             +=                                                      \
+                        ASIO_STANDALONE                                     \
+                        NETWORK_PROTOCOL_EXTENDED=0                         \
+
+
+#------------------------------------------------------------------------------#
+#                             Project files settings                           #
+#------------------------------------------------------------------------------#
+
+CLIENT_PATH         =   $$absolute_path(RTSPPlayerClient, $$SOURCE_PATH)
+GUI_PATH            =   $$absolute_path(GUI, $$CLIENT_PATH)
+
+include($$absolute_path(Base/Base.pri, $$CLIENT_PATH))
+include($$absolute_path(Playback/Playback.pri, $$CLIENT_PATH))
+
+HEADERS             +=                                                      \
+                        $$GUI_PATH/MainWindow.hpp                           \
+                        $$GUI_PATH/MediaSubWindow.hpp                       \
+                        $$GUI_PATH/MediaSubWindowStyle.hpp                  \
+                        $$GUI_PATH/PerformanceHud.hpp                       \
+                        $$GUI_PATH/StreamBrowser.hpp                        \
+                        $$GUI_PATH/StreamBrowserModel.hpp                   \
+                        $$GUI_PATH/StreamIndex.hpp                          \
+                        $$GUI_PATH/StreamReceiver.hpp                       \
+                        $$GUI_PATH/SubWindowPool.hpp                        \
+                        $$GUI_PATH/VisibilityTracker.hpp                    \
+
+SOURCES             +=                                                      \
+                        $$GUI_PATH/MainWindow.cpp                           \
+                        $$GUI_PATH/MediaSubWindow.cpp                       \
+                        $$GUI_PATH/MediaSubWindowStyle.cpp                  \
+                        $$GUI_PATH/PerformanceHud.cpp                       \
+                        $$GUI_PATH/StreamBrowser.cpp                        \
+                        $$GUI_PATH/StreamBrowserModel.cpp                   \
+                        $$GUI_PATH/StreamIndex.cpp                          \
+                        $$GUI_PATH/StreamReceiver.cpp                       \
+                        $$GUI_PATH/SubWindowPool.cpp                        \
+                        $$GUI_PATH/VisibilityTracker.cpp                    \
+                        $$PWD/main.cpp                                      \
+
+FORMS               +=                                                      \
+                        $$GUI_PATH/MainWindow.ui                            \
+                        $$GUI_PATH/MediaSubWindow.ui                        \
+
+RESOURCES           +=                                                      \
+                        $$GUI_PATH/resources.qrc                            \
+
+
+#------------------------------------------------------------------------------#
+#                            External dependencies                             #
+#------------------------------------------------------------------------------#
+
+ASIO_DIRECTORY      =   $$find_directory($$EXTERNAL_PATH, "asio-*")
+ASIO_INCLUDE_PATH   =   $$find_include_path($$EXTERNAL_PATH, $$ASIO_DIRECTORY)
+
+FFMPEG_DIRECTORY    =   $$find_directory($$EXTERNAL_PATH, "ffmpeg-*")
+FFMPEG_INCLUDE_PATH =   $$find_include_path($$EXTERNAL_PATH, $$FFMPEG_DIRECTORY)
+FFMPEG_LIBRARY_PATH =   $$find_library_path($$EXTERNAL_PATH, $$FFMPEG_DIRECTORY)
+
+
+#------------------------------------------------------------------------------#
+#                          Include directories settings                        #
+#------------------------------------------------------------------------------#
+
+INCLUDEPATH         +=                                                      \
+                        $$CLIENT_PATH                                       \
+                        $$GUI_PATH                                          \
+                        $$ASIO_INCLUDE_PATH                                 \
+                        $$FFMPEG_INCLUDE_PATH                               \
+
+DEPENDPATH          +=                                                      \
+                        $$CLIENT_PATH                                       \
+                        $$GUI_PATH                                          \
+                        $$ASIO_INCLUDE_PATH                                 \
+                        $$FFMPEG_INCLUDE_PATH                               \
+
+
+#------------------------------------------------------------------------------#
+#                           External libraries settings                        #
+#------------------------------------------------------------------------------#
+
+LIBS                +=                                                      \
+                        -L$$FFMPEG_LIBRARY_PATH                             \
+
+LIBS                +=                                                      \
+                        -lavcodec                                           \
+                        -lswresample                                        \
+                        -lswscale                                           \
+                        -lavutil                                            \
@@ -0,0 +1,399 @@
+/// \file main.cpp
+/// \brief Contains entry point to the received stream benchmark.
+/// \bug No known bugs.
+
+#include "GUI/MainWindow.hpp"
+#include "GUI/StreamBrowser.hpp"
+#include "GUI/StreamReceiver.hpp"
+#include "GUI/SubWindowPool.hpp"
+
+#include "Base/Serialization/NetworkSerializer.hpp"
+#include "Playback/Output/PlaybackWidget.hpp"
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QMdiArea>
+#include <QMdiSubWindow>
+#include <QTimer>
+
+#include <asio.hpp>
+
+extern "C" {
+    #include <libavcodec/avcodec.h>
+}
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace {
+
+    /// Number of distinct frames sent in a loop.
+    constexpr int CLIP_FRAMES {
+        8
+    };
+
+    /// Interval at which a stream resends its metadata, in frames.
+    constexpr int METADATA_INTERVAL {
+        25
+    };
+
+    /// Time to wait for the streams to be discovered in milliseconds.
+    constexpr int DISCOVERY_TIMEOUT {
+        5000
+    };
+
+    /// Sender task identifier of the benchmark streams.
+    constexpr char TASK[] {
+        "bench"
+    };
+
+    /// A structure that contains benchmark results.
+    struct Result {
+
+        /// Number of sent frames.
+        quint64 sentFrames = 0;
+
+        /// Receiver statistics.
+        GUI::StreamReceiver::Statistics receiver;
+
+        /// Number of pictures the decoders produced.
+        quint64 decodedFrames = 0;
+
+        /// Number of frames converted to output images.
+        quint64 convertedFrames = 0;
+
+        /// Number of buffer swaps of the stream widgets.
+        quint64 presentedFrames = 0;
+    };
+
+    /// Fills a frame with a moving test pattern.
+    /// \param[in,out]  frame   YUV 4:2:0 frame.
+    /// \param[in]      index   Frame index.
+    void fillFrame(AVFrame* frame, int index) {
+        for (auto y = 0; y < frame->height; ++y) {
+            auto row = frame->data[0] + y * frame->linesize[0];
+            for (auto x = 0; x < frame->width; ++x)
+                row[x] = static_cast<uint8_t>(x + y + index * 16);
+        }
+
+        for (auto plane = 1; plane < 3; ++plane) {
+            for (auto y = 0; y < frame->height / 2; ++y) {
+                auto row = frame->data[plane] + y * frame->linesize[plane];
+                for (auto x = 0; x < frame->width / 2; ++x)
+                    row[x] = static_cast<uint8_t>(64 * plane + x - y + index);
+            }
+        }
+    }
+
+    /// Encodes an MJPEG test clip.
+    /// \param[in]  width   Frame width.
+    /// \param[in]  height  Frame height.
+    /// \return Encoded frames, empty if the encoder is unavailable.
+    std::vector<QByteArray> encodeClip(int width, int height) {
+        std::vector<QByteArray> packets;
+
+        auto codec = avcodec_find_encoder(AV_CODEC_ID_MJPEG);
+        if (!codec) return packets;
+
+        auto context = avcodec_alloc_context3(codec);
+        auto frame = av_frame_alloc();
+        auto packet = av_packet_alloc();
+        auto result = context && frame && packet;
+
+        if (result) {
+            context->width = width;
+            context->height = height;
+            context->time_base = { 1, 25 };
+            context->pix_fmt = AV_PIX_FMT_YUVJ420P;
+
+            frame->format = context->pix_fmt;
+            frame->width = width;
+            frame->height = height;
+
+            result = avcodec_open2(context, codec, nullptr) >= 0 &&
+                     av_frame_get_buffer(frame, 0) >= 0;
+        }
+
+        for (auto i = 0; result && i < CLIP_FRAMES; ++i) {
+            result = av_frame_make_writable(frame) >= 0;
+            if (!result) break;
+
+            fillFrame(frame, i);
+            frame->pts = i;
+
+            result = avcodec_send_frame(context, frame) >= 0;
+
+            while (result && avcodec_receive_packet(context, packet) == 0) {
+                packets.emplace_back(
+                    reinterpret_cast<const char*>(packet->data),
+                    packet->size);
+                av_packet_unref(packet);
+            }
+        }
+
+        if (!result) packets.clear();
+
+        av_packet_free(&packet);
+        av_frame_free(&frame);
+        avcodec_free_context(&context);
+
+        return packets;
+    }
+
+    /// A class that sends MJPEG streams like the server does.
+    class Sender {
+    public:
+
+        /// Constructs a sender.
+        /// \param[in]  port    Local UDP port the client receives on.
+        explicit Sender(quint16 port) :
+            socket_(context_),
+            endpoint_(asio::ip::address_v4::loopback(), port)
+        {
+            asio::error_code error;
+            socket_.open(asio::ip::udp::v4(), error);
+        }
+
+    public:
+
+        /// Sends a frame of a stream.
+        /// \details Frame identifiers are unique microsecond timestamps,
+        /// truncated like those of the server.
+        /// \param[in]  flow        Information flow identifier.
+        /// \param[in]  number      Frame number.
+        /// \param[in]  packet      MJPEG frame.
+        /// \param[in]  metadata    Indicates whether the codec metadata is
+        ///                         sent in front of the frame.
+        void send(const QString& flow,
+                  int number,
+                  const QByteArray& packet,
+                  bool metadata) {
+            Common::Serialization::NetworkFrame frame;
+            frame.id = nextId();
+            frame.number = static_cast<quint16>(number);
+            frame.interpretation = 2;
+            frame.task = TASK;
+            frame.flow = flow;
+
+            if (metadata) {
+                QByteArray header(19, '\0');
+                header[0] = 1;
+                header.replace(1, 5, "MJPEG");
+                frame.data = header + packet;
+            }
+            else {
+                frame.data = QByteArray(1, '\0') + packet;
+            }
+
+            for (const auto& datagram : serializer_.serialize(frame)) {
+                asio::error_code error;
+                socket_.send_to(asio::buffer(datagram.constData(),
+                                             datagram.size()),
+                                endpoint_,
+                                0,
+                                error);
+            }
+        }
+
+    private:
+
+        /// Returns the next frame identifier.
+        /// \return Frame identifier.
+        quint32 nextId() {
+            lastId_ = qMax(lastId_ + 1, static_cast<quint64>(
+                QDateTime::currentMSecsSinceEpoch()) * 1000);
+            return static_cast<quint32>(lastId_);
+        }
+
+    private:
+
+        /// I/O context of the socket.
+        asio::io_context context_;
+
+        /// Sending socket.
+        asio::ip::udp::socket socket_;
+
+        /// Client endpoint.
+        asio::ip::udp::endpoint endpoint_;
+
+        /// Splits frames into datagrams.
+        Common::Serialization::NetworkSerializer serializer_;
+
+        /// Last frame identifier before truncation.
+        quint64 lastId_ = 0;
+    };
+
+    /// Runs the event loop for a while, or until a condition holds.
+    /// \param[in]  app             Application.
+    /// \param[in]  milliseconds    Maximum time in milliseconds.
+    /// \param[in]  done            Condition.
+    template <typename Condition>
+    void runFor(QApplication& app, int milliseconds, Condition done) {
+        QElapsedTimer timer;
+        timer.start();
+
+        while (timer.elapsed() < milliseconds && !done())
+            app.processEvents(QEventLoop::AllEvents, 10);
+    }
+}
+
+/// Runs the received stream benchmark.
+/// \details Opens the main window of the client on a local port and sends
+/// it MJPEG streams over UDP the way the server does, with codec metadata
+/// in front of every few frames. Once the window has discovered the
+/// streams they are activated in its stream browser, so each is shown in a
+/// pooled subwindow fed by a decoder from the pipeline factory of the
+/// window. Reports frames sent, received, decoded, converted and presented
+/// over the run. Fails if no stream reaches the screen. Defaults to the
+/// offscreen platform and Mesa software rendering, so it runs without a
+/// GPU. Prints one JSON object.
+/// \param[in]  argc    Number of arguments passed to the program.
+/// \param[in]  argv    An array of pointers to the arguments passed to the
+///                     program.
+/// \return Exit status.
+int main(int argc, char* argv[]) {
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    if (qEnvironmentVariableIsEmpty("LIBGL_ALWAYS_SOFTWARE"))
+        qputenv("LIBGL_ALWAYS_SOFTWARE", "1");
+
+    QApplication::setAttribute(Qt::AA_ShareOpenGLContexts);
+    QApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    parser.addOption(QCommandLineOption("streams",
+                                        "Number of sent streams.",
+                                        "count",
+                                        "4"));
+    parser.addOption(QCommandLineOption("fps",
+                                        "Frames per second of each stream.",
+                                        "rate",
+                                        "25"));
+    parser.addOption(QCommandLineOption("resolution",
+                                        "Frame size.",
+                                        "WxH",
+                                        "640x360"));
+    parser.addOption(QCommandLineOption("duration",
+                                        "Measured time in seconds.",
+                                        "seconds",
+                                        "5"));
+    parser.process(app);
+
+    auto streams = qBound(1, parser.value("streams").toInt(), 16);
+    auto fps = qMax(1.0, parser.value("fps").toDouble());
+    auto duration = qMax(1.0, parser.value("duration").toDouble());
+
+    QSize size(640, 360);
+    auto resolution = parser.value("resolution").split('x');
+    if (resolution.size() == 2)
+        size = QSize(resolution[0].toInt(), resolution[1].toInt());
+
+    auto clip = encodeClip(size.width(), size.height());
+    if (clip.empty()) {
+        std::fprintf(stderr, "No usable MJPEG encoder\n");
+        return EXIT_FAILURE;
+    }
+
+    MainWindow window;
+    window.resize(1280, 720);
+    window.show();
+
+    if (!window.listen(0)) {
+        std::fprintf(stderr, "Failed to receive streams\n");
+        return EXIT_FAILURE;
+    }
+
+    auto receiver = window.findChild<GUI::StreamReceiver*>();
+    auto browser = window.findChild<GUI::StreamBrowser*>();
+    auto pool = window.findChild<GUI::SubWindowPool*>();
+    auto area = window.findChild<QMdiArea*>();
+
+    Result result;
+    Sender sender(receiver->port());
+    auto number = 0;
+
+    QTimer feedTimer;
+    feedTimer.setTimerType(Qt::PreciseTimer);
+    feedTimer.setInterval(qRound(1000.0 / fps));
+    QObject::connect(&feedTimer, &QTimer::timeout, [&] {
+        const auto& packet = clip[static_cast<std::size_t>(number) %
+                                  clip.size()];
+
+        for (auto stream = 0; stream < streams; ++stream) {
+            sender.send(QString("cam%1").arg(stream, 2, 10, QChar('0')),
+                        number,
+                        packet,
+                        number % METADATA_INTERVAL == 0);
+            ++result.sentFrames;
+        }
+
+        ++number;
+    });
+    feedTimer.start();
+
+    runFor(app, DISCOVERY_TIMEOUT, [&] {
+        return browser->model()->streams().size() >= streams;
+    });
+
+    if (browser->model()->streams().size() < streams) {
+        std::fprintf(stderr, "Discovered %d of %d streams\n",
+                     browser->model()->streams().size(),
+                     streams);
+        return EXIT_FAILURE;
+    }
+
+    for (const auto& stream : browser->model()->streams())
+        emit browser->streamActivated(stream);
+
+    area->tileSubWindows();
+
+    for (auto subWindow : area->subWindowList()) {
+        if (pool->address(subWindow).isEmpty()) continue;
+
+        QObject::connect(pool->playbackWidget(subWindow),
+                         &QOpenGLWidget::frameSwapped,
+                         [&result] { ++result.presentedFrames; });
+    }
+
+    runFor(app, qRound(duration * 1000.0), [] { return false; });
+    feedTimer.stop();
+
+    result.receiver = receiver->statistics();
+
+    for (auto subWindow : area->subWindowList()) {
+        if (auto decoder = pool->decoder(subWindow)) {
+            auto statistics = decoder->statistics();
+            result.decodedFrames += statistics.decodedFrames;
+            result.convertedFrames += statistics.convertedFrames;
+        }
+    }
+
+    std::printf("{\"streams\":%d,\"fps\":%.1f,\"width\":%d,\"height\":%d,"
+                "\"sent_frames\":%llu,\"received_frames\":%llu,"
+                "\"queued_frames\":%llu,\"dropped_frames\":%llu,"
+                "\"decoded_frames\":%llu,\"converted_frames\":%llu,"
+                "\"presented_frames\":%llu,\"presented_fps\":%.1f}\n",
+                streams,
+                fps,
+                size.width(),
+                size.height(),
+                static_cast<unsigned long long>(result.sentFrames),
+                static_cast<unsigned long long>(
+                    result.receiver.receivedFrames),
+                static_cast<unsigned long long>(result.receiver.queuedFrames),
+                static_cast<unsigned long long>(
+                    result.receiver.droppedFrames),
+                static_cast<unsigned long long>(result.decodedFrames),
+                static_cast<unsigned long long>(result.convertedFrames),
+                static_cast<unsigned long long>(result.presentedFrames),
+                result.presentedFrames / duration / streams);
+
+    std::fflush(stdout);
+
+    return result.presentedFrames > 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,39 @@
+#------------------------------------------------------------------------------#
+#                                Base settings                                 #
+#------------------------------------------------------------------------------#
+
+TEMPLATE            =   app
+TARGET              =   streambrowserbenchmark
+QT                  =   core gui widgets
+CONFIG              +=	c++17 strict_c++ console
+CONFIG              -=  app_bundle
+
+
+#------------------------------------------------------------------------------#
+#                             Project files settings                           #
+#------------------------------------------------------------------------------#
+
+CLIENT_PATH         =   $$absolute_path(RTSPPlayerClient, $$SOURCE_PATH)
+GUI_PATH            =   $$absolute_path(GUI, $$CLIENT_PATH)
+
+HEADERS             +=                                                      \
+                        $$GUI_PATH/StreamBrowser.hpp                        \
+                        $$GUI_PATH/StreamBrowserModel.hpp                   \
+                        $$GUI_PATH/StreamIndex.hpp                          \
+
+SOURCES             +=                                                      \
+                        $$GUI_PATH/StreamBrowser.cpp                        \
+                        $$GUI_PATH/StreamBrowserModel.cpp                   \
+                        $$GUI_PATH/StreamIndex.cpp                          \
+                        $$PWD/main.cpp                                      \
+
+
+#------------------------------------------------------------------------------#
+#                          Include directories settings                        #
+#------------------------------------------------------------------------------#
+
+INCLUDEPATH         +=                                                      \
+                        $$CLIENT_PATH                                       \
+
+DEPENDPATH          +=                                                      \
+                        $$CLIENT_PATH                                       \
@@ -0,0 +1,199 @@
+/// \file main.cpp
+/// \brief Contains entry point to the stream browser benchmark.
+/// \bug No known bugs.
+
+#include "GUI/StreamBrowser.hpp"
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QLineEdit>
+#include <QThread>
+#include <QTreeView>
+#include <QTreeWidget>
+
+#include <cstdio>
+#include <cstdlib>
+
+namespace {
+
+    /// Words stream names are made of.
+    const char* const NAME_WORDS[] {
+        "North", "South", "East", "West", "Gate", "Lobby", "Parking",
+        "Entrance", "Corridor", "Dock", "Roof", "Yard", "Stairs", "Hall"
+    };
+
+    /// Number of stream groups.
+    constexpr int GROUPS {
+        64
+    };
+
+    /// Typed queries.
+    const char* const QUERIES[] {
+        "north gate 12",
+        "site 07 lobby",
+        "10.3.1",
+        "cam 004",
+    };
+
+    /// Creates synthetic stream definitions.
+    /// \param[in]  count   Number of streams.
+    /// \return Stream definitions.
+    QVector<GUI::StreamBrowserModel::Stream> createStreams(int count) {
+        QVector<GUI::StreamBrowserModel::Stream> streams;
+        streams.reserve(count);
+
+        constexpr auto words = static_cast<int>(sizeof(NAME_WORDS) /
+                                                sizeof(NAME_WORDS[0]));
+
+        for (auto index = 0; index < count; ++index) {
+            GUI::StreamBrowserModel::Stream stream;
+            stream.name = QString("%1 %2 Cam %3")
+                .arg(NAME_WORDS[index % words])
+                .arg(NAME_WORDS[index / words % words])
+                .arg(index, 4, 10, QLatin1Char('0'));
+            stream.group = QString("Site %1").arg(index % GROUPS, 2, 10,
+                                                  QLatin1Char('0'));
+            stream.address = QString("rtsp://10.%1.%2.%3:554/stream1")
+                .arg(index / 65536 % 256)
+                .arg(index / 256 % 256)
+                .arg(index % 256);
+            streams.append(stream);
+        }
+
+        return streams;
+    }
+
+    /// Builds the former tree widget with one item per stream.
+    /// \param[in]  streams Stream definitions.
+    /// \return Time until the first paint in milliseconds.
+    double measureTreeWidget(
+        const QVector<GUI::StreamBrowserModel::Stream>& streams) {
+
+        QElapsedTimer timer;
+        timer.start();
+
+        QTreeWidget tree;
+        tree.setColumnCount(3);
+
+        for (const auto& stream : streams) {
+            new QTreeWidgetItem(&tree,
+                                { stream.name, stream.group, stream.address });
+        }
+
+        tree.resize(400, 800);
+        tree.show();
+        tree.repaint();
+
+        return timer.nsecsElapsed() / 1000000.0;
+    }
+
+    /// Types a query one character at a time and deletes it again.
+    /// \details Every keystroke includes filtering and repainting the view.
+    /// \param[in]  browser Stream browser.
+    /// \param[in]  query   Query.
+    void typeQuery(GUI::StreamBrowser& browser, const QString& query) {
+        browser.searchField()->clear();
+        browser.repaint();
+
+        auto type = [&](const char* direction, int first, int last, int step) {
+            auto total = 0.0, longest = 0.0;
+            auto keystrokes = 0;
+
+            for (auto length = first; length != last; length += step) {
+                QElapsedTimer timer;
+                timer.start();
+
+                browser.searchField()->setText(query.left(length));
+                browser.view()->viewport()->repaint();
+
+                auto elapsed = timer.nsecsElapsed() / 1000000.0;
+                total += elapsed;
+                longest = qMax(longest, elapsed);
+                ++keystrokes;
+            }
+
+            std::printf("{\"query\":\"%s\",\"direction\":\"%s\","
+                        "\"keystrokes\":%d,\"mean_ms\":%.3f,\"max_ms\":%.3f,"
+                        "\"matches\":%d}\n",
+                        qPrintable(query),
+                        direction,
+                        keystrokes,
+                        total / keystrokes,
+                        longest,
+                        browser.model()->matchCount());
+        };
+
+        type("typing", 1, query.size() + 1, 1);
+        type("deleting", query.size() - 1, -1, -1);
+    }
+}
+
+/// Runs the stream browser benchmark.
+/// \details Measures the time until the browser first paints a synthetic
+/// stream list, the time until the search index is ready and the time per
+/// keystroke of typed queries, against a tree widget baseline. Defaults to
+/// the offscreen platform. Prints one JSON object per line.
+/// \param[in]  argc    Number of arguments passed to the program.
+/// \param[in]  argv    An array of pointers to the arguments passed to the
+///                     program.
+/// \return Exit status.
+int main(int argc, char* argv[]) {
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    QApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    parser.addOption(QCommandLineOption("entries",
+                                        "Number of stream definitions.",
+                                        "count",
+                                        "10000"));
+    parser.addOption(QCommandLineOption("baseline",
+                                        "Also measure a tree widget."));
+    parser.process(app);
+
+    auto entries = qMax(1, parser.value("entries").toInt());
+    auto streams = createStreams(entries);
+
+    if (parser.isSet("baseline"))
+        std::printf("{\"mode\":\"tree_widget\",\"entries\":%d,"
+                    "\"startup_ms\":%.3f}\n",
+                    entries,
+                    measureTreeWidget(streams));
+
+    QElapsedTimer timer;
+    timer.start();
+
+    GUI::StreamBrowser browser;
+    browser.model()->setStatusProvider(
+        [](const GUI::StreamBrowserModel::Stream& stream) {
+            return stream.name.endsWith(QLatin1Char('7'))
+                ? GUI::StreamBrowserModel::Status::Offline
+                : GUI::StreamBrowserModel::Status::Online;
+        });
+    browser.model()->setStreams(streams);
+    browser.resize(400, 800);
+    browser.show();
+    browser.repaint();
+
+    auto startup = timer.nsecsElapsed() / 1000000.0;
+
+    while (!browser.model()->isIndexed())
+        QThread::usleep(100);
+
+    auto indexed = timer.nsecsElapsed() / 1000000.0;
+
+    std::printf("{\"mode\":\"stream_browser\",\"entries\":%d,"
+                "\"startup_ms\":%.3f,\"index_ready_ms\":%.3f}\n",
+                entries,
+                startup,
+                indexed);
+
+    for (auto query : QUERIES)
+        typeQuery(browser, query);
+
+    std::fflush(stdout);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,39 @@
+#------------------------------------------------------------------------------#
+#                                Base settings                                 #
+#------------------------------------------------------------------------------#
+
+TEMPLATE            =   app
+TARGET              =   syncbenchmark
+QT                  =   core gui
+CONFIG              +=	c++17 strict_c++ console
+CONFIG              -=  app_bundle
+
+
+#------------------------------------------------------------------------------#
+#                             Project files settings                           #
+#------------------------------------------------------------------------------#
+
+CLIENT_PATH         =   $$absolute_path(RTSPPlayerClient, $$SOURCE_PATH)
+OUTPUT_PATH         =   $$absolute_path(Playback/Output, $$CLIENT_PATH)
+
+include($$absolute_path(Base/Utility/Utility.pri, $$CLIENT_PATH))
+
+HEADERS             +=                                                      \
+                        $$OUTPUT_PATH/PresentationScheduler.hpp             \
+                        $$OUTPUT_PATH/StreamCounters.hpp                    \
+
+SOURCES             +=                                                      \
+                        $$OUTPUT_PATH/PresentationScheduler.cpp             \
+                        $$OUTPUT_PATH/StreamCounters.cpp                    \
+                        $$PWD/main.cpp                                      \
+
+
+#------------------------------------------------------------------------------#
+#                          Include directories settings                        #
+#------------------------------------------------------------------------------#
+
+INCLUDEPATH         +=                                                      \
+                        $$CLIENT_PATH                                       \
+
+DEPENDPATH          +=                                                      \
+                        $$CLIENT_PATH                                       \
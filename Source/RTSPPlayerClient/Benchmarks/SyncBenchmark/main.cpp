@@ -0,0 +1,433 @@
+/// \file main.cpp
+/// \brief Contains entry point to the synchronized presentation benchmark.
+/// \bug No known bugs.
+
+#include "Playback/Output/PresentationScheduler.hpp"
+
+#include <QCommandLineParser>
+#include <QEventLoop>
+#include <QGuiApplication>
+#include <QImage>
+#include <QTimer>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace {
+
+    /// A structure that contains benchmark settings.
+    struct Settings {
+
+        /// Number of streams.
+        int streams = 4;
+
+        /// Frames per second of each stream.
+        qreal fps = 30.0;
+
+        /// Measured run time per case in seconds.
+        qreal duration = 10.0;
+
+        /// Rate error of sender clocks in parts per million.
+        qreal drift = 100.0;
+
+        /// Difference between the lowest and highest stream transit in
+        /// microseconds.
+        qint64 transitSpread = 60000;
+
+        /// Largest random transit delay in microseconds.
+        qint64 jitter = 15000;
+    };
+
+    /// Simulated camera setups.
+    enum class Scenario {
+        OneServer       ,   ///< One sender clock, transit differs per stream.
+        SeparateSenders ,   ///< A clock per stream, transit is the same.
+    };
+
+    /// Presentation modes.
+    enum class Mode {
+        Independent     ,   ///< Every stream on its own playout clock.
+        SyncGroup       ,   ///< Sync group with a clock per stream.
+        SharedClock     ,   ///< Sync group with a shared sender clock.
+    };
+
+    /// A structure that contains benchmark case results.
+    struct Result {
+
+        /// Number of presented frames.
+        quint64 presented = 0;
+
+        /// Median capture time spread of shown frames in microseconds.
+        double skewP50 = 0.0;
+
+        /// 99th percentile of the capture time spread in microseconds.
+        double skewP99 = 0.0;
+
+        /// Largest capture time spread in microseconds.
+        double skewMax = 0.0;
+
+        /// Mean spread reported by the scheduler in microseconds.
+        double reportedSkew = 0.0;
+
+        /// Common playout delay at the end in microseconds.
+        qint64 playoutDelay = 0;
+
+        /// Mean error of the estimated stream drifts in parts per million.
+        double driftError = 0.0;
+
+        /// Number of playout clock resynchronizations.
+        quint64 resynchronizations = 0;
+    };
+
+    /// A structure that describes a frame on its way to the client.
+    struct Packet {
+
+        /// Local capture time in microseconds.
+        qint64 captureTime;
+
+        /// Local arrival time in microseconds.
+        qint64 arrivalTime;
+    };
+
+    /// A structure that describes a simulated camera.
+    struct Camera {
+
+        /// Scheduler stream identifier.
+        int stream = -1;
+
+        /// Local capture time of the next frame in microseconds.
+        qint64 nextCapture = 0;
+
+        /// Lowest transit in microseconds.
+        qint64 transit = 0;
+
+        /// Sender clock reading at the start of a case in microseconds.
+        qint64 senderEpoch = 0;
+
+        /// Rate error of the sender clock in parts per million.
+        qreal senderDrift = 0.0;
+
+        /// Arrival time of the last frame in microseconds.
+        qint64 lastArrival = 0;
+
+        /// Frames on their way.
+        std::deque<Packet> packets;
+
+        /// Capture time of the shown frame, or a negative value if none.
+        qint64 shownCapture = -1;
+    };
+
+    /// Sender clock reading at the start of a case in microseconds.
+    constexpr qint64 SENDER_EPOCH { 3600000000 };
+
+    /// Largest difference between sender clock readings in microseconds.
+    constexpr int SENDER_EPOCH_SPREAD { 900000000 };
+
+    /// Time after the start of a case that is not measured in microseconds.
+    /// \details Covers the first clock estimation window.
+    constexpr qint64 WARMUP { 3000000 };
+
+    /// Period of the simulated network in milliseconds.
+    constexpr int NETWORK_PERIOD { 1 };
+
+    /// Returns the current time.
+    /// \return Steady clock time in microseconds.
+    qint64 currentTime() {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    /// Returns a percentile of sorted values.
+    /// \param[in]  values  Sorted values.
+    /// \param[in]  share   Percentile in percent.
+    /// \return Percentile, or zero if there are no values.
+    double percentile(const std::vector<qint64>& values, double share) {
+        if (values.empty()) return 0.0;
+
+        auto index = static_cast<std::size_t>(share / 100.0 * (values.size() - 1));
+        return static_cast<double>(values[index]);
+    }
+
+    /// Returns the name of a simulated camera setup.
+    /// \param[in]  scenario    Camera setup.
+    /// \return Scenario name.
+    const char* scenarioName(Scenario scenario) {
+        switch (scenario) {
+            case Scenario::OneServer:
+                return "one_server";
+            case Scenario::SeparateSenders:
+                return "separate_senders";
+        }
+
+        return "";
+    }
+
+    /// Returns the name of a presentation mode.
+    /// \param[in]  mode    Presentation mode.
+    /// \return Mode name.
+    const char* modeName(Mode mode) {
+        switch (mode) {
+            case Mode::Independent:
+                return "independent";
+            case Mode::SyncGroup:
+                return "sync_group";
+            case Mode::SharedClock:
+                return "sync_group_shared_clock";
+        }
+
+        return "";
+    }
+
+    /// Runs a benchmark case.
+    /// \details Cameras capture at the same rate and at the same instants,
+    /// so shown frames of streams in sync have equal capture times. On one
+    /// server they stamp frames with one drifting clock and each has its own
+    /// lowest transit, spread evenly over the transit spread. As separate
+    /// senders each stamps frames with its own clock, with drifts spread
+    /// evenly between plus and minus the drift, over the same transit. All
+    /// frames get random jitter that never reorders them. After every
+    /// refresh that showed a frame the spread of the true capture times of
+    /// the shown frames is sampled.
+    /// \param[in]  settings    Benchmark settings.
+    /// \param[in]  scenario    Camera setup.
+    /// \param[in]  mode        Presentation mode.
+    /// \return Case results.
+    Result runCase(const Settings& settings, Scenario scenario, Mode mode) {
+        Player::Playback::PresentationScheduler scheduler;
+        std::vector<Camera> cameras(static_cast<std::size_t>(settings.streams));
+        std::vector<qint64> skews;
+        std::mt19937 random(7);
+
+        auto period = static_cast<qint64>(1000000 / settings.fps);
+        auto start = currentTime();
+        std::uniform_int_distribution<qint64> jitter(0, settings.jitter);
+        std::uniform_int_distribution<int> epoch(0, SENDER_EPOCH_SPREAD);
+        auto separate = scenario == Scenario::SeparateSenders;
+        auto shown = false;
+        Result result;
+
+        for (auto index = 0; index < settings.streams; ++index) {
+            auto& camera = cameras[static_cast<std::size_t>(index)];
+            auto position = static_cast<qreal>(index) / (settings.streams - 1);
+
+            camera.nextCapture = start;
+            camera.transit = separate
+                ? 0
+                : qRound64(settings.transitSpread * position);
+            camera.senderEpoch = separate
+                ? SENDER_EPOCH + epoch(random)
+                : SENDER_EPOCH;
+            camera.senderDrift = separate
+                ? settings.drift * (2.0 * position - 1.0)
+                : settings.drift;
+
+            camera.stream = scheduler.addStream([&, index](const QImage& frame) {
+                cameras[static_cast<std::size_t>(index)].shownCapture =
+                    frame.text("capture").toLongLong();
+
+                ++result.presented;
+                shown = true;
+            });
+
+            if (mode != Mode::Independent)
+                scheduler.setSyncGroup(camera.stream, 0, mode == Mode::SharedClock);
+        }
+
+        QTimer network;
+        network.setTimerType(Qt::PreciseTimer);
+        network.setInterval(NETWORK_PERIOD);
+
+        QObject::connect(&network, &QTimer::timeout, [&] {
+            auto now = currentTime();
+
+            if (shown && now - start >= WARMUP) {
+                auto earliest = std::numeric_limits<qint64>::max();
+                auto latest = std::numeric_limits<qint64>::min();
+
+                for (const auto& camera : cameras) {
+                    earliest = qMin(earliest, camera.shownCapture);
+                    latest = qMax(latest, camera.shownCapture);
+                }
+
+                if (earliest >= 0) skews.push_back(latest - earliest);
+            }
+
+            shown = false;
+
+            for (auto& camera : cameras) {
+                while (camera.nextCapture <= now) {
+                    auto arrival = qMax(camera.lastArrival,
+                                        camera.nextCapture + camera.transit +
+                                            jitter(random));
+
+                    camera.packets.push_back({ camera.nextCapture, arrival });
+                    camera.lastArrival = arrival;
+                    camera.nextCapture += period;
+                }
+
+                while (!camera.packets.empty() &&
+                       camera.packets.front().arrivalTime <= now) {
+                    auto packet = camera.packets.front();
+                    camera.packets.pop_front();
+
+                    auto elapsed = static_cast<double>(packet.captureTime - start);
+                    auto timestamp = camera.senderEpoch + static_cast<qint64>(
+                        elapsed * (1.0 + camera.senderDrift / 1000000.0));
+
+                    QImage frame(8, 8, QImage::Format_RGB32);
+                    frame.setText("capture", QString::number(packet.captureTime));
+
+                    scheduler.submit(camera.stream,
+                                     frame,
+                                     static_cast<quint64>(timestamp),
+                                     static_cast<quint64>(packet.arrivalTime));
+                }
+            }
+        });
+
+        QEventLoop loop;
+        QTimer::singleShot(qRound(settings.duration * 1000.0) + WARMUP / 1000,
+                           &loop,
+                           &QEventLoop::quit);
+
+        network.start();
+        loop.exec();
+        network.stop();
+
+        std::sort(skews.begin(), skews.end());
+
+        result.skewP50 = percentile(skews, 50.0);
+        result.skewP99 = percentile(skews, 99.0);
+        result.skewMax = skews.empty() ? 0.0 : static_cast<double>(skews.back());
+
+        if (mode != Mode::Independent) {
+            auto statistics = scheduler.syncStatistics(0);
+
+            result.playoutDelay = statistics.playoutDelay;
+            if (statistics.skewSamples > 0)
+                result.reportedSkew = static_cast<double>(statistics.skewTime) /
+                                      statistics.skewSamples;
+        }
+        else {
+            result.playoutDelay = scheduler.playoutDelay();
+        }
+
+        for (const auto& camera : cameras) {
+            auto statistics = scheduler.statistics(camera.stream);
+            result.resynchronizations += statistics.resynchronizations;
+
+            // A fast sender clock makes the offset to local time shrink.
+            if (mode != Mode::Independent)
+                result.driftError +=
+                    std::abs(statistics.clockDrift + camera.senderDrift) /
+                    settings.streams;
+        }
+
+        return result;
+    }
+}
+
+/// Runs the synchronized presentation benchmark.
+/// \details Presents simulated cameras of one server, whose frames reach the
+/// client over paths of different transit, and cameras with clocks of their
+/// own, with every stream on its own playout clock, in a sync group with a
+/// clock estimated per stream and, for the server, in a sync group sharing
+/// its clock. Cameras capture together, so the capture time spread of the
+/// shown frames is the synchronization error. Reports percentiles of that
+/// spread, the spread the scheduler reports, the common playout delay and
+/// the error of the estimated drifts. Defaults to the offscreen platform.
+/// Prints one JSON object per line.
+/// \param[in]  argc    Number of arguments passed to the program.
+/// \param[in]  argv    An array of pointers to the arguments passed to the
+///                     program.
+/// \return Exit status.
+int main(int argc, char* argv[]) {
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    QGuiApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    parser.addOption(QCommandLineOption("streams",
+                                        "Number of streams.",
+                                        "count",
+                                        "4"));
+    parser.addOption(QCommandLineOption("fps",
+                                        "Frames per second of each stream.",
+                                        "rate",
+                                        "30"));
+    parser.addOption(QCommandLineOption("duration",
+                                        "Measured run time per case in "
+                                        "seconds.",
+                                        "seconds",
+                                        "10"));
+    parser.addOption(QCommandLineOption("drift",
+                                        "Sender clock drift in parts per "
+                                        "million.",
+                                        "ppm",
+                                        "100"));
+    parser.addOption(QCommandLineOption("transit-spread",
+                                        "Transit difference between streams "
+                                        "in milliseconds.",
+                                        "ms",
+                                        "60"));
+    parser.addOption(QCommandLineOption("jitter",
+                                        "Largest random transit delay in "
+                                        "milliseconds.",
+                                        "ms",
+                                        "15"));
+    parser.process(app);
+
+    Settings settings;
+    settings.streams = qBound(2, parser.value("streams").toInt(), 64);
+    settings.fps = qBound(1.0, parser.value("fps").toDouble(), 240.0);
+    settings.duration = qMax(1.0, parser.value("duration").toDouble());
+    settings.drift = qBound(-1000.0, parser.value("drift").toDouble(), 1000.0);
+    settings.transitSpread =
+        qMax<qint64>(0, parser.value("transit-spread").toLongLong() * 1000);
+    settings.jitter = qMax<qint64>(0, parser.value("jitter").toLongLong() * 1000);
+
+    for (auto scenario : { Scenario::OneServer, Scenario::SeparateSenders }) {
+        for (auto mode : { Mode::Independent, Mode::SyncGroup, Mode::SharedClock }) {
+            if (scenario == Scenario::SeparateSenders && mode == Mode::SharedClock)
+                continue;
+
+            auto result = runCase(settings, scenario, mode);
+
+            std::printf("{\"scenario\":\"%s\",\"case\":\"%s\",\"streams\":%d,"
+                        "\"fps\":%.1f,\"drift_ppm\":%.1f,\"transit_spread_ms\":%.1f,"
+                        "\"jitter_ms\":%.1f,\"presented\":%llu,"
+                        "\"skew_p50_ms\":%.2f,\"skew_p99_ms\":%.2f,"
+                        "\"skew_max_ms\":%.2f,\"reported_skew_ms\":%.2f,"
+                        "\"playout_delay_ms\":%.2f,\"drift_error_ppm\":%.1f,"
+                        "\"resynchronizations\":%llu}\n",
+                        scenarioName(scenario),
+                        modeName(mode),
+                        settings.streams,
+                        settings.fps,
+                        settings.drift,
+                        settings.transitSpread / 1000.0,
+                        settings.jitter / 1000.0,
+                        static_cast<unsigned long long>(result.presented),
+                        result.skewP50 / 1000.0,
+                        result.skewP99 / 1000.0,
+                        result.skewMax / 1000.0,
+                        result.reportedSkew / 1000.0,
+                        result.playoutDelay / 1000.0,
+                        result.driftError,
+                        static_cast<unsigned long long>(result.resynchronizations));
+
+            std::fflush(stdout);
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,165 @@
+/// \file main.cpp
+/// \brief Contains entry point to the texture upload benchmark.
+/// \bug No known bugs.
+
+#include "Playback/Output/TextureStream.hpp"
+
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QGuiApplication>
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+
+#include <cstdio>
+#include <cstdlib>
+
+namespace {
+
+    /// A structure that defines a benchmark image format.
+    struct ImageFormat {
+
+        /// Format name.
+        const char* name;
+
+        /// Image format.
+        QImage::Format format;
+    };
+
+    /// Benchmarked resolutions.
+    constexpr int RESOLUTIONS[][2] {
+        { 1920, 1080 },
+        { 3840, 2160 },
+    };
+
+    /// Benchmarked image formats.
+    const ImageFormat IMAGE_FORMATS[] {
+        { "rgb888", QImage::Format_RGB888 },
+        { "grayscale8", QImage::Format_Grayscale8 },
+        { "rgbx8888", QImage::Format_RGBX8888 },
+        { "bgra8888", QImage::Format_RGB32 },
+    };
+
+    /// Creates a test image.
+    /// \param[in]  width   Image width.
+    /// \param[in]  height  Image height.
+    /// \param[in]  format  Image format.
+    /// \param[in]  seed    Pattern seed.
+    /// \return Test image.
+    QImage createImage(int width, int height, QImage::Format format, int seed) {
+        QImage image(width, height, format);
+
+        for (auto y = 0; y < height; ++y) {
+            auto row = image.scanLine(y);
+            for (auto x = 0; x < image.bytesPerLine(); ++x)
+                row[x] = static_cast<uchar>(x + y + seed);
+        }
+
+        return image;
+    }
+}
+
+/// Runs the texture upload benchmark.
+/// \details Streams images into a texture through a context on an offscreen
+/// surface, with and without pixel unpack buffers. Defaults to the offscreen
+/// platform and Mesa software rendering, so it runs without a GPU. Prints
+/// one JSON object per line.
+/// \param[in]  argc    Number of arguments passed to the program.
+/// \param[in]  argv    An array of pointers to the arguments passed to the
+///                     program.
+/// \return Exit status.
+int main(int argc, char* argv[]) {
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    if (qEnvironmentVariableIsEmpty("LIBGL_ALWAYS_SOFTWARE"))
+        qputenv("LIBGL_ALWAYS_SOFTWARE", "1");
+
+    QGuiApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    parser.addOption(QCommandLineOption("frames",
+                                        "Number of uploaded frames per case.",
+                                        "count",
+                                        "120"));
+    parser.process(app);
+
+    auto frames = qMax(1, parser.value("frames").toInt());
+
+    QOpenGLContext context;
+    if (!context.create()) {
+        std::fprintf(stderr, "Failed to create an OpenGL context\n");
+        return EXIT_FAILURE;
+    }
+
+    QOffscreenSurface surface;
+    surface.setFormat(context.format());
+    surface.create();
+
+    if (!context.makeCurrent(&surface)) {
+        std::fprintf(stderr, "Failed to make the OpenGL context current\n");
+        return EXIT_FAILURE;
+    }
+
+    auto functions = context.functions();
+    auto renderer = reinterpret_cast<const char*>(
+        functions->glGetString(GL_RENDERER));
+
+    for (const auto& resolution : RESOLUTIONS) {
+        for (const auto& format : IMAGE_FORMATS) {
+            QImage images[] {
+                createImage(resolution[0], resolution[1], format.format, 0),
+                createImage(resolution[0], resolution[1], format.format, 1),
+            };
+
+            for (auto streaming : { false, true }) {
+                Player::Playback::TextureStream stream;
+
+                if (!stream.initialize()) {
+                    std::fprintf(stderr, "Failed to initialize a texture\n");
+                    return EXIT_FAILURE;
+                }
+
+                stream.setStreamingEnabled(streaming);
+                stream.upload(images[1]);
+                functions->glFinish();
+
+                auto warmup = stream.statistics().totalUploadTime;
+
+                QElapsedTimer timer;
+                timer.start();
+
+                for (auto i = 0; i < frames; ++i)
+                    stream.upload(images[i % 2]);
+
+                functions->glFinish();
+
+                auto elapsed = timer.nsecsElapsed() / 1000.0;
+                const auto& statistics = stream.statistics();
+
+                std::printf("{\"renderer\":\"%s\",\"width\":%d,\"height\":%d,"
+                            "\"format\":\"%s\",\"pbo\":%s,\"frames\":%d,"
+                            "\"reallocations\":%llu,"
+                            "\"upload_us_per_frame\":%.1f,"
+                            "\"finished_us_per_frame\":%.1f}\n",
+                            renderer ? renderer : "unknown",
+                            resolution[0],
+                            resolution[1],
+                            format.name,
+                            stream.isStreaming() ? "true" : "false",
+                            frames,
+                            static_cast<unsigned long long>(
+                                statistics.reallocations),
+                            static_cast<double>(
+                                statistics.totalUploadTime - warmup) / frames,
+                            elapsed / frames);
+
+                std::fflush(stdout);
+                stream.destroy();
+            }
+        }
+    }
+
+    context.doneCurrent();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,305 @@
+/// \file ClientBenchmark.cpp
+/// \brief Contains definitions of classes and functions for benchmarking
+/// the client rendering path.
+/// \bug No known bugs.
+
+#include "ClientBenchmark.hpp"
+#include "MediaSubWindow.hpp"
+#include "PerformanceHud.hpp"
+
+#include "Base/Utility/MemoryBudget.hpp"
+#include "Playback/Output/PlaybackWidget.hpp"
+#include "Playback/Output/PresentationScheduler.hpp"
+#include "Playback/Output/RenderThread.hpp"
+#include "Playback/Output/ResourceCache.hpp"
+
+#include <QOpenGLContext>
+#include <QOpenGLFunctions>
+#include <QPainter>
+
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+
+namespace {
+
+    /// Number of distinct synthetic frames.
+    constexpr int SYNTHETIC_FRAMES {
+        8
+    };
+
+    /// Returns process CPU time.
+    /// \return Process CPU time in microseconds.
+    qint64 cpuTime() {
+        return static_cast<qint64>(std::clock()) * 1000000 / CLOCKS_PER_SEC;
+    }
+
+    /// Creates a synthetic frame.
+    /// \details Draws a gradient with a bar that moves from frame to frame,
+    /// so consecutive frames differ everywhere the bar passes.
+    /// \param[in]  size    Frame size.
+    /// \param[in]  index   Frame index.
+    /// \return Synthetic frame.
+    QImage createFrame(const QSize& size, int index) {
+        QImage frame(size, QImage::Format_RGBX8888);
+
+        for (auto y = 0; y < size.height(); ++y) {
+            auto row = frame.scanLine(y);
+            for (auto x = 0; x < size.width(); ++x) {
+                row[4 * x + 0] = static_cast<uchar>(x * 255 / size.width());
+                row[4 * x + 1] = static_cast<uchar>(y * 255 / size.height());
+                row[4 * x + 2] = static_cast<uchar>(index * 255 / SYNTHETIC_FRAMES);
+                row[4 * x + 3] = 255;
+            }
+        }
+
+        QPainter painter(&frame);
+        auto barWidth = size.width() / SYNTHETIC_FRAMES;
+        painter.fillRect(index * barWidth, 0, barWidth, size.height(), Qt::white);
+
+        return frame;
+    }
+}
+
+/// A namespace that contains GUI classes and functions.
+namespace GUI {
+
+    /// Constructs a client benchmark.
+    /// \details Creates the subwindows and synthetic frames.
+    /// \param[in]  options Benchmark options.
+    /// \param[in]  parent  Parent object.
+    ClientBenchmark::ClientBenchmark(const Options& options, QObject* parent) :
+        QObject(parent),
+        options_(options)
+    {
+        options_.tiles = qMax(1, options_.tiles);
+        options_.fps = qMax<qreal>(1.0, options_.fps);
+
+        if (!options_.programBinaries)
+            Player::Playback::ResourceCache::setBinaryDirectory(QString());
+
+        for (auto index = 0; index < SYNTHETIC_FRAMES; ++index)
+            frames_.append(createFrame(options_.frameSize, index));
+
+        if (options_.renderThread) {
+            renderThread_.reset(new Player::Playback::RenderThread);
+            if (!renderThread_->start()) {
+                std::fprintf(stderr, "Failed to start the render thread, "
+                                     "drawing on the GUI thread\n");
+                renderThread_.reset();
+            }
+        }
+
+        if (options_.scheduler)
+            scheduler_.reset(new Player::Playback::PresentationScheduler);
+
+        if (options_.hud) {
+            hud_.reset(new PerformanceHud);
+            connect(hud_.get(), &PerformanceHud::sampled, this, [this] {
+                hudLoad_ += hud_->load();
+                ++hudSamples_;
+            });
+        }
+
+        tiles_.resize(options_.tiles);
+
+        for (auto index = 0; index < tiles_.size(); ++index) {
+            auto& tile = tiles_[index];
+            auto subWindow = new MediaSubWindow;
+            tile.widget = new Player::Playback::PlaybackWidget;
+            subWindow->setWidget(tile.widget);
+            area_.addSubWindow(subWindow);
+
+            if (renderThread_)
+                tile.widget->setRenderThread(renderThread_.get());
+
+            auto counter = &tile.presentedFrames;
+            connect(tile.widget, &QOpenGLWidget::frameSwapped, this, [this, counter] {
+                if (++*counter == 1 && ++openedTiles_ == tiles_.size())
+                    layoutOpenTime_ = layoutTimer_.nsecsElapsed() / 1000000.0;
+            });
+
+            if (scheduler_) {
+                auto widget = tile.widget;
+                tile.stream = scheduler_->addStream([widget](const QImage& frame) {
+                    widget->setImage(frame);
+                });
+            }
+
+            if (hud_) {
+                auto name = QString("Tile %1").arg(index);
+                auto counters =
+                    std::make_shared<Player::Playback::StreamCounters>(
+                        Common::Utility::MemoryBudget::instance()
+                            .createAccount(name));
+
+                tile.widget->setCounters(counters);
+                if (scheduler_)
+                    scheduler_->setCounters(tile.stream, counters);
+
+                hud_->addTile(name,
+                              tile.widget,
+                              nullptr,
+                              counters);
+            }
+        }
+
+        feedTimer_.setTimerType(Qt::PreciseTimer);
+        feedTimer_.setInterval(qRound(1000.0 / options_.fps));
+        connect(&feedTimer_, &QTimer::timeout, this, &ClientBenchmark::feed);
+    }
+
+    /// Destroys the client benchmark.
+    /// \details Widgets leave the render thread before it stops.
+    ClientBenchmark::~ClientBenchmark()
+    {
+        for (auto& tile : tiles_)
+            tile.widget->setRenderThread(nullptr);
+    }
+
+    /// Starts the benchmark.
+    /// \details Shows the tiled subwindows and starts feeding frames. The
+    /// run ends after the configured duration. The layout is open when every
+    /// tile has initialized its GL resources and presented once.
+    void ClientBenchmark::start()
+    {
+        layoutTimer_.start();
+
+        area_.resize(1920, 1080);
+        area_.show();
+        area_.tileSubWindows();
+
+        for (auto& tile : tiles_)
+            tile.presentedFrames = 0;
+
+        runTimer_.start();
+        startCpuTime_ = cpuTime();
+        feedTimer_.start();
+
+        QTimer::singleShot(qRound(options_.duration * 1000.0),
+                           this,
+                           &ClientBenchmark::finish);
+    }
+
+    /// Feeds the next frame to every tile.
+    /// \details Tiles are offset in the frame sequence, so neighbours show
+    /// different frames.
+    void ClientBenchmark::feed()
+    {
+        auto timestamp = static_cast<quint64>(
+            runTimer_.nsecsElapsed() / 1000);
+        auto receiveTime = static_cast<quint64>(
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+
+        for (auto index = 0; index < tiles_.size(); ++index) {
+            auto& tile = tiles_[index];
+            const auto& frame = frames_[(nextFrame_ + index) % frames_.size()];
+
+            ++tile.fedFrames;
+
+            if (scheduler_)
+                scheduler_->submit(tile.stream, frame, timestamp, receiveTime);
+            else
+                tile.widget->setImage(frame);
+        }
+
+        ++nextFrame_;
+    }
+
+    /// Prints results and finishes.
+    /// \details Upload times come from the render thread when it is used.
+    /// Dropped presents are fed frames that never reached a buffer swap.
+    void ClientBenchmark::finish()
+    {
+        feedTimer_.stop();
+
+        auto elapsed = runTimer_.nsecsElapsed() / 1000000000.0;
+        auto cpu = static_cast<double>(cpuTime() - startCpuTime_);
+
+        quint64 fedFrames = 0;
+        quint64 presentedFrames = 0;
+        quint64 droppedPresents = 0;
+        quint64 uploadedFrames = 0;
+        quint64 uploadTime = 0;
+        quint64 schedulerDropped = 0;
+        quint64 schedulerMissed = 0;
+
+        for (const auto& tile : tiles_) {
+            fedFrames += tile.fedFrames;
+            presentedFrames += tile.presentedFrames;
+
+            if (tile.fedFrames > tile.presentedFrames)
+                droppedPresents += tile.fedFrames - tile.presentedFrames;
+
+            if (renderThread_) {
+                auto statistics = tile.widget->renderStatistics();
+                uploadedFrames += statistics.renderedFrames;
+                uploadTime += statistics.totalRenderTime;
+            }
+            else {
+                const auto& statistics = tile.widget->uploadStatistics();
+                uploadedFrames += statistics.uploadedFrames;
+                uploadTime += statistics.totalUploadTime;
+            }
+
+            if (scheduler_) {
+                auto statistics = scheduler_->statistics(tile.stream);
+                schedulerDropped += statistics.droppedFrames;
+                schedulerMissed += statistics.missedDeadlines;
+            }
+        }
+
+        QString renderer = "unknown";
+        auto widget = tiles_.first().widget;
+
+        if (widget->context()) {
+            widget->makeCurrent();
+            auto name = widget->context()->functions()->glGetString(GL_RENDERER);
+            if (name) renderer = reinterpret_cast<const char*>(name);
+            widget->doneCurrent();
+        }
+
+        auto tiles = static_cast<double>(tiles_.size());
+        auto cache = Player::Playback::ResourceCache::statistics();
+
+        std::printf("{\"renderer\":\"%s\",\"tiles\":%d,\"fps\":%.1f,"
+                    "\"width\":%d,\"height\":%d,\"render_thread\":%s,"
+                    "\"scheduler\":%s,\"duration_s\":%.2f,"
+                    "\"fed_fps_per_tile\":%.2f,\"present_fps_per_tile\":%.2f,"
+                    "\"dropped_presents\":%llu,\"upload_us_per_frame\":%.1f,"
+                    "\"cpu_percent_per_tile\":%.2f,"
+                    "\"scheduler_dropped\":%llu,\"scheduler_missed\":%llu,"
+                    "\"hud\":%s,\"hud_cpu_percent\":%.3f,"
+                    "\"layout_open_ms\":%.1f,\"programs_compiled\":%llu,"
+                    "\"programs_loaded\":%llu,\"programs_shared\":%llu,"
+                    "\"program_setup_ms\":%.2f}\n",
+                    qPrintable(renderer),
+                    tiles_.size(),
+                    options_.fps,
+                    options_.frameSize.width(),
+                    options_.frameSize.height(),
+                    renderThread_ ? "true" : "false",
+                    scheduler_ ? "true" : "false",
+                    elapsed,
+                    fedFrames / tiles / elapsed,
+                    presentedFrames / tiles / elapsed,
+                    static_cast<unsigned long long>(droppedPresents),
+                    uploadedFrames > 0
+                        ? static_cast<double>(uploadTime) / uploadedFrames
+                        : 0.0,
+                    cpu / 10000.0 / elapsed / tiles,
+                    static_cast<unsigned long long>(schedulerDropped),
+                    static_cast<unsigned long long>(schedulerMissed),
+                    hud_ ? "true" : "false",
+                    hudSamples_ > 0 ? hudLoad_ / hudSamples_ : 0.0,
+                    layoutOpenTime_,
+                    static_cast<unsigned long long>(cache.compiledPrograms),
+                    static_cast<unsigned long long>(cache.loadedPrograms),
+                    static_cast<unsigned long long>(cache.sharedPrograms),
+                    cache.programTime / 1000.0);
+
+        std::fflush(stdout);
+        emit finished();
+    }
+}
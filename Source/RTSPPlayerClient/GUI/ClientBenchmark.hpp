@@ -0,0 +1,169 @@
+/// \file ClientBenchmark.hpp
+/// \brief Contains declarations of classes and functions for benchmarking
+/// the client rendering path.
+/// \bug No known bugs.
+
+#ifndef CLIENTBENCHMARK_HPP
+#define CLIENTBENCHMARK_HPP
+
+#include <QElapsedTimer>
+#include <QImage>
+#include <QMdiArea>
+#include <QObject>
+#include <QTimer>
+#include <QVector>
+
+#include <memory>
+
+namespace Player {
+    namespace Playback {
+        class PlaybackWidget;
+        class PresentationScheduler;
+        class RenderThread;
+    }
+}
+
+/// A namespace that contains GUI classes and functions.
+namespace GUI {
+
+    class PerformanceHud;
+
+    /// A class that benchmarks rendering of many media subwindows.
+    /// \details Creates media subwindows with playback widgets, feeds them
+    /// synthetic frames at a fixed rate and prints one JSON object with the
+    /// results when the run ends.
+    class ClientBenchmark : public QObject {
+
+        Q_OBJECT
+
+    public:
+
+        /// A structure that contains benchmark options.
+        struct Options {
+
+            /// Number of tiles.
+            int tiles = 16;
+
+            /// Frames per second fed to every tile.
+            qreal fps = 25.0;
+
+            /// Frame size.
+            QSize frameSize { 1280, 720 };
+
+            /// Run duration in seconds.
+            qreal duration = 10.0;
+
+            /// Indicates whether frames are rendered on a render thread.
+            bool renderThread = false;
+
+            /// Indicates whether frames are paced by a presentation scheduler.
+            bool scheduler = false;
+
+            /// Indicates whether the performance HUD is shown.
+            bool hud = false;
+
+            /// Indicates whether program binaries are stored and loaded.
+            bool programBinaries = true;
+        };
+
+    public:
+
+        /// Constructs a client benchmark.
+        /// \param[in]  options Benchmark options.
+        /// \param[in]  parent  Parent object.
+        explicit ClientBenchmark(const Options& options,
+                                 QObject* parent = nullptr);
+
+        /// Destroys the client benchmark.
+        virtual ~ClientBenchmark();
+
+    public:
+
+        /// Starts the benchmark.
+        void start();
+
+    signals:
+
+        /// Signals that the benchmark has finished.
+        void finished();
+
+    private:
+
+        /// A structure that contains counters of a tile.
+        struct Tile {
+
+            /// Playback widget.
+            Player::Playback::PlaybackWidget* widget = nullptr;
+
+            /// Presentation scheduler stream identifier.
+            int stream = -1;
+
+            /// Number of fed frames.
+            quint64 fedFrames = 0;
+
+            /// Number of presented frames.
+            quint64 presentedFrames = 0;
+        };
+
+    private:
+
+        /// Feeds the next frame to every tile.
+        void feed();
+
+        /// Prints results and finishes.
+        void finish();
+
+    private:
+
+        /// Benchmark options.
+        Options options_;
+
+        /// Window that holds the subwindows.
+        QMdiArea area_;
+
+        /// Tiles.
+        QVector<Tile> tiles_;
+
+        /// Synthetic frames used in turn.
+        QVector<QImage> frames_;
+
+        /// Index of the next synthetic frame.
+        int nextFrame_ = 0;
+
+        /// Feed timer.
+        QTimer feedTimer_;
+
+        /// Measures the run time.
+        QElapsedTimer runTimer_;
+
+        /// Measures the time until every tile presented once.
+        QElapsedTimer layoutTimer_;
+
+        /// Time until every tile presented once in milliseconds, or a
+        /// negative value if some tile never did.
+        double layoutOpenTime_ = -1.0;
+
+        /// Number of tiles that presented at least once.
+        int openedTiles_ = 0;
+
+        /// Process CPU time at the start in microseconds.
+        qint64 startCpuTime_ = 0;
+
+        /// Render thread, if enabled.
+        std::unique_ptr<Player::Playback::RenderThread> renderThread_;
+
+        /// Presentation scheduler, if enabled.
+        std::unique_ptr<Player::Playback::PresentationScheduler> scheduler_;
+
+        /// Performance HUD, if enabled.
+        std::unique_ptr<PerformanceHud> hud_;
+
+        /// Sum of HUD load samples in percent.
+        double hudLoad_ = 0.0;
+
+        /// Number of HUD load samples.
+        int hudSamples_ = 0;
+    };
+}
+
+#endif
@@ -3,14 +3,30 @@
 #------------------------------------------------------------------------------#
 
 HEADERS             +=                                                      \
+                        $$PWD/ClientBenchmark.hpp                           \
                         $$PWD/MainWindow.hpp                                \
                         $$PWD/MediaSubWindow.hpp                            \
-    $$PWD/MediaSubWindowStyle.hpp
+    $$PWD/MediaSubWindowStyle.hpp \
+                        $$PWD/PerformanceHud.hpp                            \
+                        $$PWD/StreamBrowser.hpp                             \
+                        $$PWD/StreamBrowserModel.hpp                        \
+                        $$PWD/StreamIndex.hpp                               \
+                        $$PWD/StreamReceiver.hpp                            \
+                        $$PWD/SubWindowPool.hpp                             \
+                        $$PWD/VisibilityTracker.hpp                         \
 
 SOURCES             +=                                                      \
+                        $$PWD/ClientBenchmark.cpp                           \
                         $$PWD/MainWindow.cpp                                \
                         $$PWD/MediaSubWindow.cpp                            \
     $$PWD/MediaSubWindowStyle.cpp \
+                        $$PWD/PerformanceHud.cpp                            \
+                        $$PWD/StreamBrowser.cpp                             \
+                        $$PWD/StreamBrowserModel.cpp                        \
+                        $$PWD/StreamIndex.cpp                               \
+                        $$PWD/StreamReceiver.cpp                            \
+                        $$PWD/SubWindowPool.cpp                             \
+                        $$PWD/VisibilityTracker.cpp                         \
                         $$PWD/main.cpp                                      \
 
 FORMS               +=                                                      \
@@ -1,20 +1,277 @@
 #include "MainWindow.hpp"
 #include "MediaSubWindow.hpp"
+#include "PerformanceHud.hpp"
+#include "StreamBrowser.hpp"
+#include "StreamReceiver.hpp"
+#include "SubWindowPool.hpp"
+#include "VisibilityTracker.hpp"
+
+#include "Playback/Decoding/VideoDecoder.hpp"
+#include "Playback/Output/MosaicWidget.hpp"
+#include "Playback/Output/PresentationScheduler.hpp"
+#include "Playback/Output/RenderThread.hpp"
 
 #include "ui_MainWindow.h"
 
+#include <QElapsedTimer>
+#include <QMdiSubWindow>
+#include <QTimer>
+
 MainWindow::MainWindow(QWidget *parent) :
     QMainWindow(parent),
-    ui(new Ui::MainWindow)
+    ui(new Ui::MainWindow),
+    mosaicWidget(new Player::Playback::MosaicWidget),
+    visibilityTracker(nullptr),
+    streamBrowser(new GUI::StreamBrowser),
+    performanceHud(nullptr),
+    subWindowPool(nullptr),
+    streamReceiver(nullptr),
+    presentationScheduler(nullptr),
+    renderThread(nullptr),
+    switchingLayout(false)
 {
     ui->setupUi(this);
 
-    auto mediaSubWindow = new MediaSubWindow;
-    mediaSubWindow->setTitleBarColor(QColor("lightgray"));
-    ui->mdiArea->addSubWindow(mediaSubWindow);
+    // Streams of subwindows that are minimized, covered or scrolled out of
+    // the viewport stop converting and uploading frames.
+    visibilityTracker = new GUI::VisibilityTracker(ui->mdiArea, this);
+
+    // Layouts borrow subwindows from the pool and return them, so switching
+    // layouts neither builds subwindows nor restarts decoders. Returned
+    // subwindows are hidden, so the tracker throttles their streams.
+    subWindowPool = new GUI::SubWindowPool(ui->mdiArea, this);
+    connect(subWindowPool, &GUI::SubWindowPool::acquired,
+            visibilityTracker, &GUI::VisibilityTracker::track);
+    connect(subWindowPool, &GUI::SubWindowPool::released,
+            this, [this](QMdiSubWindow *subWindow) {
+        if (!switchingLayout) {
+            layoutStreams.removeOne(subWindowPool->address(subWindow));
+            streamBrowser->model()->invalidateStatus();
+        }
+    });
+
+    // Decoded frames wait in the scheduler for the display refresh, so each
+    // widget repaints at most once per refresh, whatever the stream rate.
+    presentationScheduler = new Player::Playback::PresentationScheduler(this);
+    subWindowPool->setPresentationScheduler(presentationScheduler);
+
+    // Frames are uploaded and drawn on a render thread, so the GUI thread
+    // only composites them. Without one, widgets draw on the GUI thread.
+    renderThread = new Player::Playback::RenderThread(this);
+    if (renderThread->start()) {
+        subWindowPool->setRenderThread(renderThread);
+    }
+    else {
+        delete renderThread;
+        renderThread = nullptr;
+    }
+
+    // Streams are received on an I/O thread and decoded on decoding threads,
+    // so a pipeline is a decoder fed by the receiver for the stream address.
+    streamReceiver = new GUI::StreamReceiver(this);
+    subWindowPool->setPipelineFactory([this](const QString &address) {
+        return streamReceiver->createDecoder(address);
+    });
+    connect(subWindowPool, &GUI::SubWindowPool::pipelineDestroying,
+            streamReceiver, &GUI::StreamReceiver::releaseDecoder);
+    connect(streamReceiver, &GUI::StreamReceiver::streamDiscovered,
+            this, &MainWindow::addStream);
+    connect(streamReceiver, &GUI::StreamReceiver::onError,
+            this, [this](const QString &message) {
+        ui->statusBar->showMessage(tr("Receive error: %1").arg(message));
+    });
+
+    subWindowPool->acquire(QString());
+
+    // The mosaic draws every stream on one GL surface, instead of one
+    // context and one swap per subwindow.
+    mosaicWidget->setTileCount(ui->mdiArea->subWindowList().size());
+    mosaicWidget->hide();
+    ui->centralWidgetLayout->addWidget(mosaicWidget, 0, 0);
+    connect(mosaicWidget, &Player::Playback::MosaicWidget::frameSwapped,
+            presentationScheduler,
+            &Player::Playback::PresentationScheduler::synchronize);
+
+    auto mosaicAction = ui->toolBar->addAction(tr("Mosaic"));
+    mosaicAction->setCheckable(true);
+    connect(mosaicAction, &QAction::toggled, this, &MainWindow::setMosaicMode);
+
+    // Stream totals stay in the status bar, per tile overlays can be hidden.
+    performanceHud = new GUI::PerformanceHud(ui->statusBar, this);
+    subWindowPool->setPerformanceHud(performanceHud);
+
+    for (auto columns : { 2, 3, 4 }) {
+        auto layoutAction = ui->toolBar->addAction(tr("%1x%1").arg(columns));
+        connect(layoutAction, &QAction::triggered,
+                this, [this, columns] { setGridLayout(columns); });
+    }
+
+    // Enough subwindows for the largest layout are created once the window
+    // is shown, so the first switch does not create them.
+    QTimer::singleShot(0, subWindowPool, [this] { subWindowPool->prewarm(16); });
+
+    auto hudAction = ui->toolBar->addAction(tr("HUD"));
+    hudAction->setCheckable(true);
+    hudAction->setChecked(performanceHud->overlaysVisible());
+    connect(hudAction, &QAction::toggled,
+            performanceHud, &GUI::PerformanceHud::setOverlaysVisible);
+
+    // All flows of one server are stamped by its clock, so its streams can
+    // be shown by capture time instead of as soon as they arrive.
+    auto syncAction = ui->toolBar->addAction(tr("Sync"));
+    syncAction->setCheckable(true);
+    syncAction->setChecked(subWindowPool->taskSync());
+    connect(syncAction, &QAction::toggled,
+            subWindowPool, &GUI::SubWindowPool::setTaskSync);
+
+    ui->dockWidget->setWindowTitle(tr("Streams"));
+    ui->gridLayout_2->setContentsMargins(0, 0, 0, 0);
+    ui->gridLayout_2->addWidget(streamBrowser, 0, 0);
+    connect(streamBrowser, &GUI::StreamBrowser::streamActivated,
+            this, &MainWindow::openStream);
+    streamBrowser->model()->setStatusProvider(
+        [this](const GUI::StreamBrowserModel::Stream &stream) {
+            return layoutStreams.contains(stream.address)
+                ? GUI::StreamBrowserModel::Status::Playing
+                : GUI::StreamBrowserModel::Status::Online;
+        });
 }
 
 MainWindow::~MainWindow()
 {
+    // Decoding threads stop before the pool deletes the decoders, and the
+    // widgets leave the render thread before it stops.
+    streamReceiver->stop();
+    subWindowPool->setRenderThread(nullptr);
+    delete renderThread;
     delete ui;
 }
+
+bool MainWindow::listen(quint16 port)
+{
+    if (!streamReceiver->start(port))
+        return false;
+
+    ui->statusBar->showMessage(tr("Receiving streams on port %1")
+                                   .arg(streamReceiver->port()),
+                               2000);
+    return true;
+}
+
+void MainWindow::setMosaicMode(bool enabled)
+{
+    for (const auto &connection : mosaicConnections)
+        disconnect(connection);
+    mosaicConnections.clear();
+
+    QList<QMdiSubWindow *> streams;
+    for (auto subWindow : ui->mdiArea->subWindowList()) {
+        subWindowPool->setPresenter(subWindow, nullptr);
+
+        if (enabled && subWindow->isVisibleTo(ui->mdiArea) &&
+            !subWindowPool->address(subWindow).isEmpty())
+            streams.append(subWindow);
+    }
+
+    // Every shown stream gets a tile. The scheduler presents its frames on
+    // the tile, and its decoder scales them to the tile size, so the mosaic
+    // neither scales frames on the GUI thread nor keeps full size layers.
+    mosaicWidget->setTileCount(streams.size());
+
+    for (auto tile = 0; tile < streams.size(); ++tile) {
+        mosaicWidget->setOverlay(tile, { streams[tile]->windowTitle(),
+                                         QColor() });
+
+        auto decoder = subWindowPool->decoder(streams[tile]);
+        if (!decoder) continue;
+
+        auto mosaic = mosaicWidget;
+        subWindowPool->setPresenter(streams[tile],
+                                    [mosaic, tile](const QImage &frame) {
+            mosaic->setImage(tile, frame);
+        });
+
+        auto setOutputSize = [decoder](const QSize &size) {
+            decoder->setOutputSize(size);
+        };
+
+        mosaicConnections
+            << connect(mosaicWidget,
+                       &Player::Playback::MosaicWidget::tileSizeChanged,
+                       decoder, setOutputSize);
+
+        auto size = mosaicWidget->tileSize();
+        QMetaObject::invokeMethod(decoder, [decoder, size] {
+            decoder->setOutputSize(size);
+        });
+    }
+
+    mosaicWidget->setVisible(enabled);
+    ui->mdiArea->setVisible(!enabled);
+    visibilityTracker->setEnabled(!enabled);
+}
+
+void MainWindow::openStream(const GUI::StreamBrowserModel::Stream& stream)
+{
+    auto mediaSubWindow = subWindowPool->acquire(stream.address);
+    mediaSubWindow->setWindowTitle(stream.name);
+    layoutStreams.removeOne(stream.address);
+    layoutStreams.append(stream.address);
+    streamBrowser->model()->invalidateStatus();
+
+    if (mosaicWidget->isVisible())
+        setMosaicMode(true);
+}
+
+void MainWindow::setGridLayout(int columns)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    // Streams beyond the grid are returned to the pool but stay in the
+    // layout list, so switching back to a larger grid borrows them warm.
+    auto cells = columns * columns;
+    auto streams = layoutStreams.mid(0, cells);
+
+    switchingLayout = true;
+
+    for (auto subWindow : ui->mdiArea->subWindowList()) {
+        if (!subWindow->isVisibleTo(ui->mdiArea)) continue;
+
+        auto address = subWindowPool->address(subWindow);
+        if (address.isEmpty() || !streams.contains(address))
+            subWindowPool->release(subWindow);
+    }
+
+    switchingLayout = false;
+
+    auto area = ui->mdiArea->viewport()->rect();
+    auto width = area.width() / columns;
+    auto height = area.height() / columns;
+
+    for (auto cell = 0; cell < streams.size(); ++cell) {
+        auto subWindow = subWindowPool->acquire(streams[cell]);
+        subWindow->setGeometry(cell % columns * width,
+                               cell / columns * height,
+                               width,
+                               height);
+    }
+
+    if (mosaicWidget->isVisible())
+        setMosaicMode(true);
+
+    ui->statusBar->showMessage(tr("%1x%1 layout in %2 ms")
+                                   .arg(columns)
+                                   .arg(timer.nsecsElapsed() / 1000000.0,
+                                        0, 'f', 2),
+                               2000);
+}
+
+void MainWindow::addStream(const QString &task, const QString &flow)
+{
+    auto streams = streamBrowser->model()->streams();
+    streams.append({ flow,
+                     task,
+                     GUI::StreamReceiver::streamAddress(task, flow) });
+    streamBrowser->model()->setStreams(streams);
+}
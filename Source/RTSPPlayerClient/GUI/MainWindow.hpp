@@ -1,12 +1,33 @@
 #ifndef MAINWINDOW_HPP
 #define MAINWINDOW_HPP
 
+#include "StreamBrowserModel.hpp"
+
+#include <QList>
 #include <QMainWindow>
+#include <QMetaObject>
+#include <QStringList>
 
 namespace Ui {
     class MainWindow;
 }
 
+namespace GUI {
+    class PerformanceHud;
+    class StreamBrowser;
+    class StreamReceiver;
+    class SubWindowPool;
+    class VisibilityTracker;
+}
+
+namespace Player {
+    namespace Playback {
+        class MosaicWidget;
+        class PresentationScheduler;
+        class RenderThread;
+    }
+}
+
 class MainWindow : public QMainWindow
 {
     Q_OBJECT
@@ -15,8 +36,27 @@ public:
     explicit MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
 
+    bool listen(quint16 port);
+
+private slots:
+    void setMosaicMode(bool enabled);
+    void openStream(const GUI::StreamBrowserModel::Stream& stream);
+    void setGridLayout(int columns);
+    void addStream(const QString &task, const QString &flow);
+
 private:
     Ui::MainWindow *ui;
+    Player::Playback::MosaicWidget *mosaicWidget;
+    GUI::VisibilityTracker *visibilityTracker;
+    GUI::StreamBrowser *streamBrowser;
+    GUI::PerformanceHud *performanceHud;
+    GUI::SubWindowPool *subWindowPool;
+    GUI::StreamReceiver *streamReceiver;
+    Player::Playback::PresentationScheduler *presentationScheduler;
+    Player::Playback::RenderThread *renderThread;
+    QStringList layoutStreams;
+    QList<QMetaObject::Connection> mosaicConnections;
+    bool switchingLayout;
 };
 
 #endif // MAINWINDOW_HPP
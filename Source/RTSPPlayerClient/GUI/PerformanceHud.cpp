@@ -0,0 +1,361 @@
+/// \file PerformanceHud.cpp
+/// \brief Contains definitions of classes and functions for showing live
+/// stream performance.
+/// \bug No known bugs.
+
+#include "PerformanceHud.hpp"
+
+#include "Base/Utility/MemoryBudget.hpp"
+#include "Playback/Output/PlaybackWidget.hpp"
+
+#include <QFontDatabase>
+#include <QFontMetrics>
+#include <QImage>
+#include <QLabel>
+#include <QPainter>
+#include <QStatusBar>
+#include <QStringList>
+
+namespace {
+
+    /// Default sampling interval in milliseconds.
+    constexpr int DEFAULT_INTERVAL {
+        500
+    };
+
+    /// Overlay text padding in pixels.
+    constexpr int OVERLAY_PADDING {
+        4
+    };
+
+    /// Bytes per mebibyte.
+    constexpr double MEBIBYTE {
+        1024.0 * 1024.0
+    };
+
+    /// Returns the mean of a counter delta per event in milliseconds.
+    /// \param[in]  time    Time delta in microseconds.
+    /// \param[in]  count   Event count delta.
+    /// \return Mean time in milliseconds, or zero without events.
+    double meanTime(quint64 time, quint64 count) {
+        return count > 0 ? time / 1000.0 / count : 0.0;
+    }
+}
+
+/// A namespace that contains GUI classes and functions.
+namespace GUI {
+
+    /// Constructs a performance HUD.
+    /// \details Adds a permanent label to the status bar if one is given.
+    /// \param[in]  statusBar   Status bar that shows totals, or null.
+    /// \param[in]  parent      Parent object.
+    PerformanceHud::PerformanceHud(QStatusBar* statusBar, QObject* parent) :
+        QObject(parent)
+    {
+        if (statusBar) {
+            statusLabel_ = new QLabel(statusBar);
+            statusBar->addPermanentWidget(statusLabel_);
+        }
+
+        timer_.setInterval(DEFAULT_INTERVAL);
+        connect(&timer_, &QTimer::timeout, this, &PerformanceHud::update);
+
+        intervalTimer_.start();
+        timer_.start();
+    }
+
+    /// Destroys the performance HUD.
+    /// \details Removes the overlays of remaining tiles.
+    PerformanceHud::~PerformanceHud()
+    {
+        for (const auto& tile : qAsConst(tiles_)) {
+            if (tile.widget)
+                tile.widget->setOverlay(QImage());
+        }
+    }
+
+    /// Adds a tile.
+    /// \details The first sample of the tile covers the time from now to
+    /// the next interval.
+    /// \param[in]  name        Tile name shown in its overlay.
+    /// \param[in]  widget      Widget that shows the stream, or null.
+    /// \param[in]  decoder     Decoder of the stream, or null.
+    /// \param[in]  counters    Output counters of the stream, or null.
+    /// \return Tile identifier.
+    int PerformanceHud::addTile(
+        const QString& name,
+        Player::Playback::PlaybackWidget* widget,
+        Decoders::VideoDecoder* decoder,
+        std::shared_ptr<Player::Playback::StreamCounters> counters)
+    {
+        Tile tile;
+        tile.name = name;
+        tile.widget = widget;
+        tile.decoder = decoder;
+        tile.counters = std::move(counters);
+
+        if (tile.decoder)
+            tile.decoderStatistics = tile.decoder->statistics();
+
+        if (tile.counters)
+            tile.snapshot = tile.counters->snapshot();
+
+        auto identifier = nextTile_++;
+        tiles_.insert(identifier, tile);
+        return identifier;
+    }
+
+    /// Removes a tile and its overlay.
+    /// \param[in]  tile    Tile identifier.
+    void PerformanceHud::removeTile(int tile)
+    {
+        auto widget = tiles_.take(tile).widget;
+        if (widget)
+            widget->setOverlay(QImage());
+    }
+
+    /// Returns the last sample of a tile.
+    /// \param[in]  tile    Tile identifier.
+    /// \return Tile performance.
+    PerformanceHud::Sample PerformanceHud::sample(int tile) const
+    {
+        return tiles_.value(tile).sample;
+    }
+
+    /// Returns the sampling interval.
+    /// \return Interval in milliseconds.
+    int PerformanceHud::interval() const
+    {
+        return timer_.interval();
+    }
+
+    /// Sets the sampling interval.
+    /// \param[in]  milliseconds    Interval in milliseconds.
+    void PerformanceHud::setInterval(int milliseconds)
+    {
+        timer_.setInterval(qMax(1, milliseconds));
+    }
+
+    /// Indicates whether tile overlays are shown.
+    /// \retval true if overlays are shown.
+    /// \retval false if only the status bar is updated.
+    bool PerformanceHud::overlaysVisible() const
+    {
+        return overlaysVisible_;
+    }
+
+    /// Shows or hides tile overlays.
+    /// \details Hidden overlays are removed at once and shown overlays
+    /// appear with the next sample.
+    /// \param[in]  visible Indicates whether overlays are shown.
+    void PerformanceHud::setOverlaysVisible(bool visible)
+    {
+        if (visible == overlaysVisible_) return;
+        overlaysVisible_ = visible;
+
+        for (const auto& tile : qAsConst(tiles_)) {
+            if (!tile.widget) continue;
+
+            if (visible)
+                drawOverlay(tile);
+            else
+                tile.widget->setOverlay(QImage());
+        }
+    }
+
+    /// Returns the processor time the HUD itself takes.
+    /// \details Measured as the time spent sampling and drawing on the GUI
+    /// thread. Overlay uploads happen when the widgets paint and are not
+    /// included.
+    /// \return Share of one core over the last interval in percent.
+    double PerformanceHud::load() const
+    {
+        return load_;
+    }
+
+    /// Samples every tile and updates overlays and the status bar.
+    void PerformanceHud::update()
+    {
+        QElapsedTimer workTimer;
+        workTimer.start();
+
+        auto elapsed = intervalTimer_.nsecsElapsed();
+        intervalTimer_.restart();
+
+        auto seconds = elapsed / 1e9;
+        if (seconds <= 0.0) return;
+
+        Sample total;
+        total.latency = 0.0;
+        auto latencyTiles = 0;
+
+        for (auto& tile : tiles_) {
+            sampleTile(tile, seconds);
+
+            total.receivedRate += tile.sample.receivedRate;
+            total.bitrate += tile.sample.bitrate;
+            total.queuedFrames += tile.sample.queuedFrames;
+            total.droppedFrames += tile.sample.droppedFrames;
+
+            if (tile.sample.latency >= 0.0) {
+                total.latency += tile.sample.latency;
+                ++latencyTiles;
+            }
+
+            if (overlaysVisible_ && tile.widget)
+                drawOverlay(tile);
+        }
+
+        if (statusLabel_) {
+            auto text = tr("%1 streams  %2 fps  %3 Mbit/s  %4 dropped")
+                .arg(tiles_.size())
+                .arg(total.receivedRate, 0, 'f', 1)
+                .arg(total.bitrate / 1e6, 0, 'f', 2)
+                .arg(total.droppedFrames);
+
+            if (latencyTiles > 0)
+                text += tr("  latency %1 ms")
+                    .arg(total.latency / latencyTiles, 0, 'f', 1);
+
+            auto budget = Common::Utility::MemoryBudget::instance().snapshot();
+            text += tr("  memory %1 MiB").arg(budget.totalBytes / MEBIBYTE, 0, 'f', 0);
+
+            if (budget.globalLimit > 0)
+                text += tr(" of %1").arg(budget.globalLimit / MEBIBYTE, 0, 'f', 0);
+
+            if (budget.evictions > 0 || budget.degradations > 0)
+                text += tr(" (%1 evicted, %2 degraded)")
+                    .arg(budget.evictions)
+                    .arg(budget.degradations);
+
+            text += tr("  HUD %1%").arg(load_, 0, 'f', 2);
+            statusLabel_->setText(text);
+        }
+
+        load_ = workTimer.nsecsElapsed() / (elapsed / 100.0);
+
+        emit sampled();
+    }
+
+    /// Samples a tile.
+    /// \details Rates and means cover the time since the previous sample.
+    /// Decoding time excludes conversion, which the decoder accounts to
+    /// both.
+    /// \param[in]  tile    Tile state.
+    /// \param[in]  seconds Time since the previous sample in seconds.
+    void PerformanceHud::sampleTile(Tile& tile, double seconds)
+    {
+        Sample sample;
+
+        if (tile.decoder) {
+            auto current = tile.decoder->statistics();
+            const auto& previous = tile.decoderStatistics;
+
+            sample.receivedRate =
+                (current.receivedFrames - previous.receivedFrames) / seconds;
+            sample.bitrate =
+                (current.receivedBytes - previous.receivedBytes) * 8.0 / seconds;
+            sample.decodeTime = meanTime(
+                (current.decodeTime - current.convertTime) -
+                (previous.decodeTime - previous.convertTime),
+                current.decodedFrames - previous.decodedFrames);
+            sample.convertTime = meanTime(
+                current.convertTime - previous.convertTime,
+                current.convertedFrames - previous.convertedFrames);
+
+            sample.droppedFrames =
+                current.skippedFrames - previous.skippedFrames;
+            tile.decoderStatistics = current;
+        }
+
+        if (tile.counters) {
+            auto current = tile.counters->snapshot();
+            const auto& previous = tile.snapshot;
+
+            sample.uploadTime = meanTime(
+                current.uploadTime - previous.uploadTime,
+                current.uploadedFrames - previous.uploadedFrames);
+            sample.queuedFrames = current.queuedFrames;
+            sample.droppedFrames +=
+                current.droppedFrames - previous.droppedFrames;
+
+            if (current.latencyFrames > previous.latencyFrames)
+                sample.latency = meanTime(
+                    current.latencyTime - previous.latencyTime,
+                    current.latencyFrames - previous.latencyFrames);
+
+            tile.snapshot = current;
+
+            if (const auto& account = tile.counters->memoryAccount()) {
+                sample.memoryBytes = account->totalUsage();
+                sample.degradation = account->degradation();
+            }
+        }
+
+        tile.sample = sample;
+    }
+
+    /// Draws the overlay of a tile.
+    /// \details Draws translucent text at the device pixel ratio of the
+    /// widget, so the widget can draw it without scaling.
+    /// \param[in]  tile    Tile state.
+    void PerformanceHud::drawOverlay(const Tile& tile) const
+    {
+        const auto& sample = tile.sample;
+
+        QStringList lines;
+        lines << tile.name
+              << tr("%1 fps  %2 Mbit/s")
+                     .arg(sample.receivedRate, 0, 'f', 1)
+                     .arg(sample.bitrate / 1e6, 0, 'f', 2)
+              << tr("dec %1  cvt %2  up %3 ms")
+                     .arg(sample.decodeTime, 0, 'f', 1)
+                     .arg(sample.convertTime, 0, 'f', 1)
+                     .arg(sample.uploadTime, 0, 'f', 1)
+              << tr("queue %1  drop %2  lat %3")
+                     .arg(sample.queuedFrames)
+                     .arg(sample.droppedFrames)
+                     .arg(sample.latency >= 0.0
+                              ? tr("%1 ms").arg(sample.latency, 0, 'f', 1)
+                              : tr("n/a"));
+
+        if (tile.counters && tile.counters->memoryAccount()) {
+            auto memory = tr("mem %1 MiB")
+                .arg(sample.memoryBytes / MEBIBYTE, 0, 'f', 1);
+
+            if (sample.degradation > 0)
+                memory += tr("  scale 1/%1").arg(1 << sample.degradation);
+
+            lines << memory;
+        }
+
+        auto font = QFontDatabase::systemFont(QFontDatabase::FixedFont);
+        QFontMetrics metrics(font);
+
+        auto width = 0;
+        for (const auto& line : qAsConst(lines))
+            width = qMax(width, metrics.boundingRect(line).width());
+
+        auto ratio = tile.widget->devicePixelRatioF();
+        QSize size(width + 2 * OVERLAY_PADDING,
+                   metrics.height() * lines.size() + 2 * OVERLAY_PADDING);
+
+        QImage overlay(size * ratio, QImage::Format_ARGB32_Premultiplied);
+        overlay.setDevicePixelRatio(ratio);
+        overlay.fill(QColor(0, 0, 0, 160));
+
+        QPainter painter(&overlay);
+        painter.setFont(font);
+        painter.setPen(Qt::white);
+
+        auto y = OVERLAY_PADDING + metrics.ascent();
+        for (const auto& line : qAsConst(lines)) {
+            painter.drawText(OVERLAY_PADDING, y, line);
+            y += metrics.height();
+        }
+
+        painter.end();
+
+        tile.widget->setOverlay(overlay);
+    }
+}
@@ -0,0 +1,208 @@
+/// \file PerformanceHud.hpp
+/// \brief Contains declarations of classes and functions for showing live
+/// stream performance.
+/// \bug No known bugs.
+
+#ifndef PERFORMANCEHUD_HPP
+#define PERFORMANCEHUD_HPP
+
+#include "Playback/Decoding/VideoDecoder.hpp"
+#include "Playback/Output/StreamCounters.hpp"
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QObject>
+#include <QPointer>
+#include <QTimer>
+
+#include <memory>
+
+class QLabel;
+class QStatusBar;
+
+namespace Player {
+    namespace Playback {
+        class PlaybackWidget;
+    }
+}
+
+/// A namespace that contains GUI classes and functions.
+namespace GUI {
+
+    /// A class that shows live stream performance.
+    /// \details Samples decoder statistics and stream counters of every tile
+    /// at a fixed interval and shows the rates over the last interval in a
+    /// small overlay per tile and as totals in the status bar. Sampling only
+    /// reads relaxed atomic counters, so it never waits for decoding,
+    /// conversion, upload or presentation. Overlays are redrawn once per
+    /// interval and are drawn by the playback widget in the same pass as
+    /// the frame.
+    class PerformanceHud : public QObject {
+
+        Q_OBJECT
+
+    public:
+
+        /// A structure that contains the performance of a tile over the last
+        /// interval.
+        struct Sample {
+
+            /// Received frames per second.
+            double receivedRate = 0.0;
+
+            /// Received bits per second.
+            double bitrate = 0.0;
+
+            /// Mean decoding time per frame in milliseconds, without
+            /// conversion.
+            double decodeTime = 0.0;
+
+            /// Mean conversion time per frame in milliseconds.
+            double convertTime = 0.0;
+
+            /// Mean upload time per frame in milliseconds.
+            double uploadTime = 0.0;
+
+            /// Number of frames waiting for presentation.
+            quint64 queuedFrames = 0;
+
+            /// Number of frames skipped or dropped over the interval.
+            quint64 droppedFrames = 0;
+
+            /// Mean receive to presentation time in milliseconds, or a
+            /// negative value if unknown.
+            double latency = -1.0;
+
+            /// Bytes held by the stream across all stages.
+            quint64 memoryBytes = 0;
+
+            /// Number of times output images are halved to save memory.
+            int degradation = 0;
+        };
+
+    public:
+
+        /// Constructs a performance HUD.
+        /// \param[in]  statusBar   Status bar that shows totals, or null.
+        /// \param[in]  parent      Parent object.
+        explicit PerformanceHud(QStatusBar* statusBar = nullptr,
+                                QObject* parent = nullptr);
+
+        /// Destroys the performance HUD.
+        virtual ~PerformanceHud();
+
+    public:
+
+        /// Adds a tile.
+        /// \param[in]  name        Tile name shown in its overlay.
+        /// \param[in]  widget      Widget that shows the stream, or null.
+        /// \param[in]  decoder     Decoder of the stream, or null.
+        /// \param[in]  counters    Output counters of the stream, or null.
+        /// \return Tile identifier.
+        int addTile(const QString& name,
+                    Player::Playback::PlaybackWidget* widget,
+                    Decoders::VideoDecoder* decoder,
+                    std::shared_ptr<Player::Playback::StreamCounters> counters);
+
+        /// Removes a tile and its overlay.
+        /// \param[in]  tile    Tile identifier.
+        void removeTile(int tile);
+
+        /// Returns the last sample of a tile.
+        /// \param[in]  tile    Tile identifier.
+        /// \return Tile performance.
+        Sample sample(int tile) const;
+
+        /// Returns the sampling interval.
+        /// \return Interval in milliseconds.
+        int interval() const;
+
+        /// Sets the sampling interval.
+        /// \param[in]  milliseconds    Interval in milliseconds.
+        void setInterval(int milliseconds);
+
+        /// Indicates whether tile overlays are shown.
+        /// \retval true if overlays are shown.
+        /// \retval false if only the status bar is updated.
+        bool overlaysVisible() const;
+
+        /// Shows or hides tile overlays.
+        /// \param[in]  visible Indicates whether overlays are shown.
+        void setOverlaysVisible(bool visible);
+
+        /// Returns the processor time the HUD itself takes.
+        /// \return Share of one core over the last interval in percent.
+        double load() const;
+
+    signals:
+
+        /// Signals that every tile was sampled.
+        void sampled();
+
+    private:
+
+        /// A structure that contains the state of a tile.
+        struct Tile {
+
+            /// Tile name.
+            QString name;
+
+            /// Widget that shows the stream.
+            QPointer<Player::Playback::PlaybackWidget> widget;
+
+            /// Decoder of the stream.
+            QPointer<Decoders::VideoDecoder> decoder;
+
+            /// Output counters of the stream.
+            std::shared_ptr<Player::Playback::StreamCounters> counters;
+
+            /// Decoder statistics at the previous sample.
+            Decoders::VideoDecoder::Statistics decoderStatistics;
+
+            /// Output counters at the previous sample.
+            Player::Playback::StreamCounters::Snapshot snapshot;
+
+            /// Last sample.
+            Sample sample;
+        };
+
+    private:
+
+        /// Samples every tile and updates overlays and the status bar.
+        void update();
+
+        /// Samples a tile.
+        /// \param[in]  tile    Tile state.
+        /// \param[in]  seconds Time since the previous sample in seconds.
+        void sampleTile(Tile& tile, double seconds);
+
+        /// Draws the overlay of a tile.
+        /// \param[in]  tile    Tile state.
+        void drawOverlay(const Tile& tile) const;
+
+    private:
+
+        /// Status bar label that shows totals, or null.
+        QLabel* statusLabel_ = nullptr;
+
+        /// Fires once per sampling interval.
+        QTimer timer_;
+
+        /// Measures the time between samples.
+        QElapsedTimer intervalTimer_;
+
+        /// Tiles by identifier.
+        QHash<int, Tile> tiles_;
+
+        /// Next tile identifier.
+        int nextTile_ = 0;
+
+        /// Indicates whether tile overlays are shown.
+        bool overlaysVisible_ = true;
+
+        /// Processor time the HUD took over the last interval in percent.
+        double load_ = 0.0;
+    };
+}
+
+#endif
@@ -0,0 +1,79 @@
+/// \file StreamBrowser.cpp
+/// \brief Contains definitions of classes and functions for browsing
+/// stream definitions.
+/// \bug No known bugs.
+
+#include "StreamBrowser.hpp"
+
+#include <QHeaderView>
+#include <QLineEdit>
+#include <QTreeView>
+#include <QVBoxLayout>
+
+/// A namespace that contains GUI classes and functions.
+namespace GUI {
+
+    /// Constructs a stream browser.
+    /// \details Filters on every keystroke and emits the activated stream.
+    /// \param[in]  parent  Parent widget.
+    StreamBrowser::StreamBrowser(QWidget* parent) :
+        QWidget(parent),
+        model_(new StreamBrowserModel(this)),
+        searchField_(new QLineEdit),
+        view_(new QTreeView)
+    {
+        searchField_->setPlaceholderText(tr("Search streams"));
+        searchField_->setClearButtonEnabled(true);
+
+        view_->setModel(model_);
+        view_->setUniformRowHeights(true);
+        view_->setRootIsDecorated(false);
+        view_->setAllColumnsShowFocus(true);
+        view_->setSelectionMode(QAbstractItemView::SingleSelection);
+        view_->setEditTriggers(QAbstractItemView::NoEditTriggers);
+        view_->header()->setSectionResizeMode(QHeaderView::Interactive);
+        view_->header()->setStretchLastSection(true);
+
+        auto layout = new QVBoxLayout(this);
+        layout->setContentsMargins(0, 0, 0, 0);
+        layout->addWidget(searchField_);
+        layout->addWidget(view_);
+
+        connect(searchField_, &QLineEdit::textChanged,
+                model_, &StreamBrowserModel::setFilter);
+
+        connect(view_, &QTreeView::activated,
+                this, [this](const QModelIndex& index) {
+            auto stream = model_->streamAt(index);
+            if (stream >= 0)
+                emit streamActivated(model_->streams()[stream]);
+        });
+    }
+
+    /// Destroys the stream browser.
+    StreamBrowser::~StreamBrowser()
+    {
+
+    }
+
+    /// Returns the model.
+    /// \return Stream browser model.
+    StreamBrowserModel* StreamBrowser::model() const
+    {
+        return model_;
+    }
+
+    /// Returns the search field.
+    /// \return Search field.
+    QLineEdit* StreamBrowser::searchField() const
+    {
+        return searchField_;
+    }
+
+    /// Returns the view.
+    /// \return View.
+    QTreeView* StreamBrowser::view() const
+    {
+        return view_;
+    }
+}
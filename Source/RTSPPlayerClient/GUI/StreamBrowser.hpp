@@ -0,0 +1,68 @@
+/// \file StreamBrowser.hpp
+/// \brief Contains declarations of classes and functions for browsing
+/// stream definitions.
+/// \bug No known bugs.
+
+#ifndef STREAMBROWSER_HPP
+#define STREAMBROWSER_HPP
+
+#include "StreamBrowserModel.hpp"
+
+#include <QWidget>
+
+class QLineEdit;
+class QTreeView;
+
+/// A namespace that contains GUI classes and functions.
+namespace GUI {
+
+    /// A widget that lists stream definitions with a search field.
+    /// \details Shows the stream browser model in a view with uniform row
+    /// heights, so the view never measures rows it does not paint.
+    class StreamBrowser : public QWidget {
+
+        Q_OBJECT
+
+    public:
+
+        /// Constructs a stream browser.
+        /// \param[in]  parent  Parent widget.
+        explicit StreamBrowser(QWidget* parent = nullptr);
+
+        /// Destroys the stream browser.
+        virtual ~StreamBrowser();
+
+    public:
+
+        /// Returns the model.
+        /// \return Stream browser model.
+        StreamBrowserModel* model() const;
+
+        /// Returns the search field.
+        /// \return Search field.
+        QLineEdit* searchField() const;
+
+        /// Returns the view.
+        /// \return View.
+        QTreeView* view() const;
+
+    signals:
+
+        /// Signals that a stream was activated.
+        /// \param[in]  stream  Stream definition.
+        void streamActivated(const GUI::StreamBrowserModel::Stream& stream);
+
+    private:
+
+        /// Stream browser model.
+        StreamBrowserModel* model_;
+
+        /// Search field.
+        QLineEdit* searchField_;
+
+        /// View.
+        QTreeView* view_;
+    };
+}
+
+#endif
@@ -0,0 +1,376 @@
+/// \file StreamBrowserModel.cpp
+/// \brief Contains definitions of classes and functions for listing stream
+/// definitions.
+/// \bug No known bugs.
+
+#include "StreamBrowserModel.hpp"
+#include "StreamIndex.hpp"
+
+#include <QPainter>
+#include <QPixmap>
+
+#include <chrono>
+
+namespace {
+
+    /// Number of rows handed to views at once.
+    constexpr int FETCH_BATCH {
+        256
+    };
+
+    /// Size of status icons in pixels.
+    constexpr int STATUS_ICON_SIZE {
+        12
+    };
+
+    /// Creates a status icon.
+    /// \param[in]  color   Icon color.
+    /// \return Status icon.
+    QIcon createStatusIcon(const QColor& color) {
+        QPixmap pixmap(STATUS_ICON_SIZE, STATUS_ICON_SIZE);
+        pixmap.fill(Qt::transparent);
+
+        QPainter painter(&pixmap);
+        painter.setRenderHint(QPainter::Antialiasing);
+        painter.setPen(color.darker());
+        painter.setBrush(color);
+        painter.drawEllipse(QRectF(1.5, 1.5,
+                                   STATUS_ICON_SIZE - 3,
+                                   STATUS_ICON_SIZE - 3));
+
+        return QIcon(pixmap);
+    }
+}
+
+/// A namespace that contains GUI classes and functions.
+namespace GUI {
+
+    /// Constructs a stream browser model.
+    /// \param[in]  parent  Parent object.
+    StreamBrowserModel::StreamBrowserModel(QObject* parent) :
+        QAbstractItemModel(parent)
+    {
+
+    }
+
+    /// Destroys the stream browser model.
+    /// \details Waits for the search index build to finish.
+    StreamBrowserModel::~StreamBrowserModel()
+    {
+        if (indexBuild_.valid())
+            indexBuild_.wait();
+    }
+
+    /// Replaces the stream definitions.
+    /// \details Prepares the search texts and starts building the search
+    /// index on a worker thread. The current filter is applied to the new
+    /// definitions.
+    /// \param[in]  streams Stream definitions.
+    void StreamBrowserModel::setStreams(const QVector<Stream>& streams)
+    {
+        if (indexBuild_.valid())
+            indexBuild_.wait();
+
+        beginResetModel();
+
+        streams_ = streams;
+        texts_.resize(streams.size());
+
+        for (auto stream = 0; stream < streams.size(); ++stream) {
+            const auto& definition = streams[stream];
+            texts_[stream] = StreamIndex::normalize(definition.name +
+                                                    QLatin1Char(' ') +
+                                                    definition.group +
+                                                    QLatin1Char(' ') +
+                                                    definition.address);
+        }
+
+        index_.reset();
+
+        auto texts = texts_;
+        indexBuild_ = std::async(std::launch::async, [texts] {
+            return std::shared_ptr<const StreamIndex>(new StreamIndex(texts));
+        });
+
+        statuses_.fill(-1, streams.size());
+
+        rows_ = search(terms_);
+        fetchedRows_ = qMin(FETCH_BATCH, rows_.size());
+
+        endResetModel();
+    }
+
+    /// Returns the stream definitions.
+    /// \return Stream definitions.
+    const QVector<StreamBrowserModel::Stream>&
+    StreamBrowserModel::streams() const
+    {
+        return streams_;
+    }
+
+    /// Returns the stream of a model index.
+    /// \param[in]  index   Model index.
+    /// \return Stream definition index, or -1 if the index is invalid.
+    int StreamBrowserModel::streamAt(const QModelIndex& index) const
+    {
+        if (!index.isValid() || index.row() >= fetchedRows_) return -1;
+        return rows_[index.row()];
+    }
+
+    /// Returns the filter.
+    /// \return Filter.
+    QString StreamBrowserModel::filter() const
+    {
+        return filter_;
+    }
+
+    /// Shows only streams matching a filter.
+    /// \details A filter that extends the previous one is checked against
+    /// the current rows only; any other filter goes through the index.
+    /// Views get the first batch of matches.
+    /// \param[in]  filter  Filter, empty to show every stream.
+    void StreamBrowserModel::setFilter(const QString& filter)
+    {
+        filter_ = filter;
+
+        auto terms = StreamIndex::terms(filter);
+        if (terms == terms_) return;
+
+        QVector<int> rows;
+
+        if (StreamIndex::narrows(terms, terms_)) {
+            rows.reserve(rows_.size());
+            for (auto stream : qAsConst(rows_)) {
+                if (StreamIndex::matches(texts_[stream], terms))
+                    rows.append(stream);
+            }
+        }
+        else {
+            rows = search(terms);
+        }
+
+        beginResetModel();
+
+        terms_ = terms;
+        rows_.swap(rows);
+        fetchedRows_ = qMin(FETCH_BATCH, rows_.size());
+
+        endResetModel();
+    }
+
+    /// Returns the number of streams matching the filter.
+    /// \return Number of matching streams.
+    int StreamBrowserModel::matchCount() const
+    {
+        return rows_.size();
+    }
+
+    /// Indicates whether the search index is ready.
+    /// \retval true if the index is ready.
+    /// \retval false if filters are scanned linearly.
+    bool StreamBrowserModel::isIndexed() const
+    {
+        takeIndex();
+        return index_ != nullptr;
+    }
+
+    /// Sets the function that returns the status of a stream.
+    /// \param[in]  provider    Status provider.
+    void StreamBrowserModel::setStatusProvider(StatusProvider provider)
+    {
+        statusProvider_ = std::move(provider);
+        invalidateStatus();
+    }
+
+    /// Discards cached statuses, so they are requested again.
+    /// \details Only rows handed to views are announced as changed, and
+    /// views request statuses for the rows they paint only.
+    void StreamBrowserModel::invalidateStatus()
+    {
+        statuses_.fill(-1);
+
+        if (fetchedRows_ > 0)
+            emit dataChanged(index(0, NameColumn),
+                             index(fetchedRows_ - 1, NameColumn),
+                             { Qt::DecorationRole });
+    }
+
+    /// Returns the index of an item.
+    /// \param[in]  row     Row.
+    /// \param[in]  column  Column.
+    /// \param[in]  parent  Parent index.
+    /// \return Model index.
+    QModelIndex StreamBrowserModel::index(int row,
+                                          int column,
+                                          const QModelIndex& parent) const
+    {
+        if (parent.isValid() ||
+            row < 0 || row >= fetchedRows_ ||
+            column < 0 || column >= ColumnCount)
+            return QModelIndex();
+
+        return createIndex(row, column);
+    }
+
+    /// Returns the parent of an item.
+    /// \param[in]  child   Model index.
+    /// \return Invalid index, as the model is flat.
+    QModelIndex StreamBrowserModel::parent(const QModelIndex&) const
+    {
+        return QModelIndex();
+    }
+
+    /// Returns the number of fetched rows.
+    /// \param[in]  parent  Parent index.
+    /// \return Number of rows.
+    int StreamBrowserModel::rowCount(const QModelIndex& parent) const
+    {
+        return parent.isValid() ? 0 : fetchedRows_;
+    }
+
+    /// Returns the number of columns.
+    /// \param[in]  parent  Parent index.
+    /// \return Number of columns.
+    int StreamBrowserModel::columnCount(const QModelIndex& parent) const
+    {
+        return parent.isValid() ? 0 : ColumnCount;
+    }
+
+    /// Returns item data.
+    /// \param[in]  index   Model index.
+    /// \param[in]  role    Data role.
+    /// \return Item data.
+    QVariant StreamBrowserModel::data(const QModelIndex& index, int role) const
+    {
+        auto stream = streamAt(index);
+        if (stream < 0) return QVariant();
+
+        const auto& definition = streams_[stream];
+
+        switch (role) {
+        case Qt::DisplayRole:
+            switch (index.column()) {
+            case NameColumn:
+                return definition.name;
+            case GroupColumn:
+                return definition.group;
+            case AddressColumn:
+                return definition.address;
+            default:
+                break;
+            }
+            break;
+        case Qt::ToolTipRole:
+            return definition.address;
+        case Qt::DecorationRole:
+            if (index.column() == NameColumn)
+                return statusIcon(stream);
+            break;
+        default:
+            break;
+        }
+
+        return QVariant();
+    }
+
+    /// Returns header data.
+    /// \param[in]  section     Section.
+    /// \param[in]  orientation Header orientation.
+    /// \param[in]  role        Data role.
+    /// \return Header data.
+    QVariant StreamBrowserModel::headerData(int section,
+                                            Qt::Orientation orientation,
+                                            int role) const
+    {
+        if (orientation != Qt::Horizontal || role != Qt::DisplayRole)
+            return QVariant();
+
+        switch (section) {
+        case NameColumn:
+            return tr("Name");
+        case GroupColumn:
+            return tr("Group");
+        case AddressColumn:
+            return tr("Address");
+        default:
+            return QVariant();
+        }
+    }
+
+    /// Indicates whether more rows can be fetched.
+    /// \param[in]  parent  Parent index.
+    /// \retval true if more rows match the filter.
+    /// \retval false otherwise.
+    bool StreamBrowserModel::canFetchMore(const QModelIndex& parent) const
+    {
+        return !parent.isValid() && fetchedRows_ < rows_.size();
+    }
+
+    /// Fetches the next batch of rows.
+    /// \param[in]  parent  Parent index.
+    void StreamBrowserModel::fetchMore(const QModelIndex& parent)
+    {
+        if (!canFetchMore(parent)) return;
+
+        auto count = qMin(FETCH_BATCH, rows_.size() - fetchedRows_);
+
+        beginInsertRows(QModelIndex(), fetchedRows_, fetchedRows_ + count - 1);
+        fetchedRows_ += count;
+        endInsertRows();
+    }
+
+    /// Takes the search index from the worker thread if it is ready.
+    void StreamBrowserModel::takeIndex() const
+    {
+        if (index_ || !indexBuild_.valid()) return;
+
+        if (indexBuild_.wait_for(std::chrono::seconds(0)) ==
+            std::future_status::ready)
+            index_ = indexBuild_.get();
+    }
+
+    /// Finds streams matching filter terms.
+    /// \details Scans every text linearly while the index is being built.
+    /// \param[in]  terms   Normalized terms.
+    /// \return Matching streams in ascending order.
+    QVector<int> StreamBrowserModel::search(const QStringList& terms) const
+    {
+        takeIndex();
+        if (index_) return index_->search(terms);
+
+        QVector<int> rows;
+        rows.reserve(texts_.size());
+
+        for (auto stream = 0; stream < texts_.size(); ++stream) {
+            if (StreamIndex::matches(texts_[stream], terms))
+                rows.append(stream);
+        }
+
+        return rows;
+    }
+
+    /// Returns the status decoration of a stream.
+    /// \details Requests the status on first use and caches it until it is
+    /// invalidated.
+    /// \param[in]  stream  Stream definition index.
+    /// \return Status icon.
+    QIcon StreamBrowserModel::statusIcon(int stream) const
+    {
+        if (!statusProvider_) return QIcon();
+
+        auto& status = statuses_[stream];
+        if (status < 0)
+            status = static_cast<qint8>(statusProvider_(streams_[stream]));
+
+        if (statusIcons_.isEmpty()) {
+            statusIcons_ = {
+                createStatusIcon(Qt::lightGray),
+                createStatusIcon(QColor(204, 51, 51)),
+                createStatusIcon(QColor(51, 170, 85)),
+                createStatusIcon(QColor(51, 119, 221)),
+            };
+        }
+
+        return statusIcons_.value(status);
+    }
+}
@@ -0,0 +1,224 @@
+/// \file StreamBrowserModel.hpp
+/// \brief Contains declarations of classes and functions for listing stream
+/// definitions.
+/// \bug No known bugs.
+
+#ifndef STREAMBROWSERMODEL_HPP
+#define STREAMBROWSERMODEL_HPP
+
+#include <QAbstractItemModel>
+#include <QIcon>
+#include <QStringList>
+#include <QVector>
+
+#include <functional>
+#include <future>
+#include <memory>
+
+/// A namespace that contains GUI classes and functions.
+namespace GUI {
+
+    class StreamIndex;
+
+    /// A class that lists stream definitions for item views.
+    /// \details Keeps the definitions in one flat table and exposes the rows
+    /// matching the current filter. Rows are handed to the view in batches
+    /// as it scrolls, so the cost of showing the list does not grow with the
+    /// number of definitions. The search index is built on a worker thread;
+    /// filters are scanned linearly until it is ready. Typing that extends
+    /// the filter only narrows the current rows. Status decorations are
+    /// requested from the status provider when a row is first painted.
+    class StreamBrowserModel : public QAbstractItemModel {
+
+        Q_OBJECT
+
+    public:
+
+        /// Model columns.
+        enum Column {
+            NameColumn      ,   ///< Stream name.
+            GroupColumn     ,   ///< Group the stream belongs to.
+            AddressColumn   ,   ///< Stream address.
+            ColumnCount     ,   ///< Number of columns.
+        };
+
+        /// Stream status.
+        enum class Status {
+            Unknown     ,   ///< Status is not known.
+            Offline     ,   ///< Stream is not reachable.
+            Online      ,   ///< Stream is reachable.
+            Playing     ,   ///< Stream is shown in a subwindow.
+        };
+
+        /// A structure that describes a stream.
+        struct Stream {
+
+            /// Stream name.
+            QString name;
+
+            /// Group the stream belongs to, such as a site.
+            QString group;
+
+            /// Stream address.
+            QString address;
+        };
+
+        /// A function that returns the status of a stream.
+        /// \details Called on the GUI thread for rows being painted.
+        using StatusProvider = std::function<Status(const Stream&)>;
+
+    public:
+
+        /// Constructs a stream browser model.
+        /// \param[in]  parent  Parent object.
+        explicit StreamBrowserModel(QObject* parent = nullptr);
+
+        /// Destroys the stream browser model.
+        virtual ~StreamBrowserModel();
+
+    public:
+
+        /// Replaces the stream definitions.
+        /// \param[in]  streams Stream definitions.
+        void setStreams(const QVector<Stream>& streams);
+
+        /// Returns the stream definitions.
+        /// \return Stream definitions.
+        const QVector<Stream>& streams() const;
+
+        /// Returns the stream of a model index.
+        /// \param[in]  index   Model index.
+        /// \return Stream definition index, or -1 if the index is invalid.
+        int streamAt(const QModelIndex& index) const;
+
+        /// Returns the filter.
+        /// \return Filter.
+        QString filter() const;
+
+        /// Shows only streams matching a filter.
+        /// \param[in]  filter  Filter, empty to show every stream.
+        void setFilter(const QString& filter);
+
+        /// Returns the number of streams matching the filter.
+        /// \return Number of matching streams.
+        int matchCount() const;
+
+        /// Indicates whether the search index is ready.
+        /// \retval true if the index is ready.
+        /// \retval false if filters are scanned linearly.
+        bool isIndexed() const;
+
+        /// Sets the function that returns the status of a stream.
+        /// \param[in]  provider    Status provider.
+        void setStatusProvider(StatusProvider provider);
+
+        /// Discards cached statuses, so they are requested again.
+        void invalidateStatus();
+
+    public:
+
+        /// Returns the index of an item.
+        /// \param[in]  row     Row.
+        /// \param[in]  column  Column.
+        /// \param[in]  parent  Parent index.
+        /// \return Model index.
+        QModelIndex index(int row,
+                          int column,
+                          const QModelIndex& parent = QModelIndex())
+                          const override;
+
+        /// Returns the parent of an item.
+        /// \param[in]  child   Model index.
+        /// \return Invalid index, as the model is flat.
+        QModelIndex parent(const QModelIndex& child) const override;
+
+        /// Returns the number of fetched rows.
+        /// \param[in]  parent  Parent index.
+        /// \return Number of rows.
+        int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+
+        /// Returns the number of columns.
+        /// \param[in]  parent  Parent index.
+        /// \return Number of columns.
+        int columnCount(const QModelIndex& parent = QModelIndex())
+                        const override;
+
+        /// Returns item data.
+        /// \param[in]  index   Model index.
+        /// \param[in]  role    Data role.
+        /// \return Item data.
+        QVariant data(const QModelIndex& index,
+                      int role = Qt::DisplayRole) const override;
+
+        /// Returns header data.
+        /// \param[in]  section     Section.
+        /// \param[in]  orientation Header orientation.
+        /// \param[in]  role        Data role.
+        /// \return Header data.
+        QVariant headerData(int section,
+                            Qt::Orientation orientation,
+                            int role = Qt::DisplayRole) const override;
+
+        /// Indicates whether more rows can be fetched.
+        /// \param[in]  parent  Parent index.
+        /// \retval true if more rows match the filter.
+        /// \retval false otherwise.
+        bool canFetchMore(const QModelIndex& parent) const override;
+
+        /// Fetches the next batch of rows.
+        /// \param[in]  parent  Parent index.
+        void fetchMore(const QModelIndex& parent) override;
+
+    private:
+
+        /// Takes the search index from the worker thread if it is ready.
+        void takeIndex() const;
+
+        /// Finds streams matching filter terms.
+        /// \param[in]  terms   Normalized terms.
+        /// \return Matching streams in ascending order.
+        QVector<int> search(const QStringList& terms) const;
+
+        /// Returns the status decoration of a stream.
+        /// \param[in]  stream  Stream definition index.
+        /// \return Status icon.
+        QIcon statusIcon(int stream) const;
+
+    private:
+
+        /// Stream definitions.
+        QVector<Stream> streams_;
+
+        /// Normalized texts searched by filters.
+        QVector<QString> texts_;
+
+        /// Filter.
+        QString filter_;
+
+        /// Filter terms.
+        QStringList terms_;
+
+        /// Streams matching the filter.
+        QVector<int> rows_;
+
+        /// Number of rows handed to views.
+        int fetchedRows_ = 0;
+
+        /// Search index, once built.
+        mutable std::shared_ptr<const StreamIndex> index_;
+
+        /// Search index being built.
+        mutable std::future<std::shared_ptr<const StreamIndex>> indexBuild_;
+
+        /// Status provider.
+        StatusProvider statusProvider_;
+
+        /// Cached statuses, or -1 where not requested yet.
+        mutable QVector<qint8> statuses_;
+
+        /// Status icons, created on first use.
+        mutable QVector<QIcon> statusIcons_;
+    };
+}
+
+#endif
@@ -0,0 +1,246 @@
+/// \file StreamIndex.cpp
+/// \brief Contains definitions of classes and functions for searching
+/// stream definitions.
+/// \bug No known bugs.
+
+#include "StreamIndex.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+namespace {
+
+    /// Minimum length of a term looked up in the trigram index.
+    constexpr int TRIGRAM_LENGTH {
+        3
+    };
+
+    /// Returns the trigram key at a position.
+    /// \param[in]  text        Text.
+    /// \param[in]  position    Position of the first character.
+    /// \return Trigram key.
+    quint64 trigramAt(const QString& text, int position) {
+        return static_cast<quint64>(text[position].unicode()) << 32 |
+               static_cast<quint64>(text[position + 1].unicode()) << 16 |
+               static_cast<quint64>(text[position + 2].unicode());
+    }
+
+    /// Indicates whether a character separates words.
+    /// \param[in]  character   Character.
+    /// \retval true if the character is a separator.
+    /// \retval false otherwise.
+    bool isSeparator(QChar character) {
+        return !character.isLetterOrNumber();
+    }
+
+    /// Indicates whether a word of a text starts with a term.
+    /// \param[in]  text    Normalized text.
+    /// \param[in]  term    Normalized term.
+    /// \retval true if a word starts with the term.
+    /// \retval false otherwise.
+    bool hasWordPrefix(const QString& text, const QString& term) {
+        for (auto position = text.indexOf(term);
+             position >= 0;
+             position = text.indexOf(term, position + 1)) {
+
+            if (position == 0 || isSeparator(text[position - 1]))
+                return true;
+        }
+
+        return false;
+    }
+}
+
+/// A namespace that contains GUI classes and functions.
+namespace GUI {
+
+    /// Constructs an index.
+    /// \details Entries are visited in ascending order, so every trigram
+    /// posting list comes out sorted and needs only a check against its
+    /// last element to stay free of duplicates.
+    /// \param[in]  texts   Normalized entry texts.
+    StreamIndex::StreamIndex(const QVector<QString>& texts) :
+        texts_(texts)
+    {
+        trigrams_.reserve(texts.size() * 4);
+
+        for (auto entry = 0; entry < texts.size(); ++entry) {
+            const auto& text = texts[entry];
+
+            for (auto position = 0;
+                 position + TRIGRAM_LENGTH <= text.size();
+                 ++position) {
+
+                auto& postings = trigrams_[trigramAt(text, position)];
+                if (postings.isEmpty() || postings.last() != entry)
+                    postings.append(entry);
+            }
+
+            auto start = -1;
+
+            for (auto position = 0; position <= text.size(); ++position) {
+                auto separator = position == text.size() ||
+                                 isSeparator(text[position]);
+
+                if (separator && start >= 0) {
+                    words_.append({ text.mid(start, position - start), entry });
+                    start = -1;
+                }
+                else if (!separator && start < 0) {
+                    start = position;
+                }
+            }
+        }
+
+        std::sort(words_.begin(), words_.end());
+    }
+
+    /// Normalizes an entry text or a filter.
+    /// \details Folds case and collapses whitespace.
+    /// \param[in]  text    Text.
+    /// \return Normalized text.
+    QString StreamIndex::normalize(const QString& text)
+    {
+        return text.toCaseFolded().simplified();
+    }
+
+    /// Splits a filter into terms.
+    /// \param[in]  filter  Filter.
+    /// \return Normalized terms.
+    QStringList StreamIndex::terms(const QString& filter)
+    {
+        auto normalized = normalize(filter);
+        if (normalized.isEmpty()) return { };
+
+        return normalized.split(QLatin1Char(' '));
+    }
+
+    /// Indicates whether an entry text matches all terms.
+    /// \param[in]  text    Normalized entry text.
+    /// \param[in]  terms   Normalized terms.
+    /// \retval true if the text matches.
+    /// \retval false otherwise.
+    bool StreamIndex::matches(const QString& text, const QStringList& terms)
+    {
+        for (const auto& term : terms) {
+            auto match = term.size() >= TRIGRAM_LENGTH
+                ? text.contains(term)
+                : hasWordPrefix(text, term);
+
+            if (!match) return false;
+        }
+
+        return true;
+    }
+
+    /// Indicates whether every entry matching one set of terms also
+    /// matches another.
+    /// \details Holds when each wider term is extended by the term at the
+    /// same position without crossing from word prefix to substring
+    /// matching, which is the common case of typing one more character.
+    /// \param[in]  narrower    Normalized terms.
+    /// \param[in]  wider       Normalized terms.
+    /// \retval true if matches of \a narrower are a subset.
+    /// \retval false if the subset relation is not known.
+    bool StreamIndex::narrows(const QStringList& narrower,
+                              const QStringList& wider)
+    {
+        if (wider.isEmpty() || narrower.size() < wider.size()) return false;
+
+        for (auto index = 0; index < wider.size(); ++index) {
+            const auto& term = narrower[index];
+            const auto& widerTerm = wider[index];
+
+            if (!term.startsWith(widerTerm)) return false;
+
+            if (widerTerm.size() < TRIGRAM_LENGTH &&
+                term.size() >= TRIGRAM_LENGTH)
+                return false;
+        }
+
+        return true;
+    }
+
+    /// Finds entries matching all terms.
+    /// \details Verifies the shortest candidate list only.
+    /// \param[in]  terms   Normalized terms.
+    /// \return Matching entries in ascending order.
+    QVector<int> StreamIndex::search(const QStringList& terms) const
+    {
+        QVector<int> result;
+        if (terms.isEmpty()) {
+            result.resize(texts_.size());
+            std::iota(result.begin(), result.end(), 0);
+            return result;
+        }
+
+        auto best = candidates(terms.first());
+
+        for (auto index = 1; index < terms.size() && !best.isEmpty(); ++index) {
+            auto other = candidates(terms[index]);
+            if (other.size() < best.size()) best.swap(other);
+        }
+
+        result.reserve(best.size());
+
+        for (auto entry : best) {
+            if (matches(texts_[entry], terms))
+                result.append(entry);
+        }
+
+        return result;
+    }
+
+    /// Returns candidate entries of a term.
+    /// \details Long terms take the shortest posting list among their
+    /// trigrams; short terms take the entries of the words they prefix.
+    /// Words hold no separators, so a short term containing one is looked
+    /// up by its part before the separator, which a matching word must
+    /// start with, and a short term starting with one takes all entries.
+    /// \param[in]  term    Normalized term.
+    /// \return Candidates in ascending order, a superset of matches.
+    QVector<int> StreamIndex::candidates(const QString& term) const
+    {
+        if (term.size() >= TRIGRAM_LENGTH) {
+            const QVector<int>* best = nullptr;
+
+            for (auto position = 0;
+                 position + TRIGRAM_LENGTH <= term.size();
+                 ++position) {
+
+                auto postings = trigrams_.constFind(trigramAt(term, position));
+                if (postings == trigrams_.constEnd()) return { };
+
+                if (!best || postings->size() < best->size())
+                    best = &*postings;
+            }
+
+            return *best;
+        }
+
+        QVector<int> result;
+
+        auto prefix = term;
+        auto separator = std::find_if(term.cbegin(), term.cend(), isSeparator);
+        if (separator != term.cend())
+            prefix.truncate(static_cast<int>(separator - term.cbegin()));
+
+        if (prefix.isEmpty()) {
+            result.resize(texts_.size());
+            std::iota(result.begin(), result.end(), 0);
+            return result;
+        }
+
+        auto word = std::lower_bound(words_.cbegin(),
+                                     words_.cend(),
+                                     qMakePair(prefix, -1));
+
+        for (; word != words_.cend() && word->first.startsWith(prefix); ++word)
+            result.append(word->second);
+
+        std::sort(result.begin(), result.end());
+        result.erase(std::unique(result.begin(), result.end()), result.end());
+
+        return result;
+    }
+}
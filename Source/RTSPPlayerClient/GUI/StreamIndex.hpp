@@ -0,0 +1,86 @@
+/// \file StreamIndex.hpp
+/// \brief Contains declarations of classes and functions for searching
+/// stream definitions.
+/// \bug No known bugs.
+
+#ifndef STREAMINDEX_HPP
+#define STREAMINDEX_HPP
+
+#include <QHash>
+#include <QPair>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+/// A namespace that contains GUI classes and functions.
+namespace GUI {
+
+    /// A class that finds stream definitions matching a filter.
+    /// \details A filter is split into terms and an entry matches when it
+    /// matches every term. Terms of three or more characters match anywhere
+    /// in the entry text and are looked up in a trigram index. Shorter terms
+    /// match the start of a word and are looked up in a sorted word index.
+    /// The smallest candidate list is verified against all terms. Entry
+    /// texts must be normalized. The index is immutable after construction,
+    /// so it can be built on one thread and used on another.
+    class StreamIndex {
+    public:
+
+        /// Constructs an index.
+        /// \param[in]  texts   Normalized entry texts.
+        explicit StreamIndex(const QVector<QString>& texts);
+
+    public:
+
+        /// Normalizes an entry text or a filter.
+        /// \param[in]  text    Text.
+        /// \return Normalized text.
+        static QString normalize(const QString& text);
+
+        /// Splits a filter into terms.
+        /// \param[in]  filter  Filter.
+        /// \return Normalized terms.
+        static QStringList terms(const QString& filter);
+
+        /// Indicates whether an entry text matches all terms.
+        /// \param[in]  text    Normalized entry text.
+        /// \param[in]  terms   Normalized terms.
+        /// \retval true if the text matches.
+        /// \retval false otherwise.
+        static bool matches(const QString& text, const QStringList& terms);
+
+        /// Indicates whether every entry matching one set of terms also
+        /// matches another.
+        /// \param[in]  narrower    Normalized terms.
+        /// \param[in]  wider       Normalized terms.
+        /// \retval true if matches of \a narrower are a subset.
+        /// \retval false if the subset relation is not known.
+        static bool narrows(const QStringList& narrower,
+                            const QStringList& wider);
+
+        /// Finds entries matching all terms.
+        /// \param[in]  terms   Normalized terms.
+        /// \return Matching entries in ascending order.
+        QVector<int> search(const QStringList& terms) const;
+
+    private:
+
+        /// Returns candidate entries of a term.
+        /// \param[in]  term    Normalized term.
+        /// \return Candidates in ascending order, a superset of matches.
+        QVector<int> candidates(const QString& term) const;
+
+    private:
+
+        /// Normalized entry texts.
+        QVector<QString> texts_;
+
+        /// Entries containing each trigram.
+        QHash<quint64, QVector<int>> trigrams_;
+
+        /// Words and the entries they start, sorted by word.
+        QVector<QPair<QString, int>> words_;
+    };
+}
+
+#endif
@@ -0,0 +1,351 @@
+/// \file StreamReceiver.cpp
+/// \brief Contains definitions of classes and functions for receiving
+/// network streams and feeding their decoders.
+/// \bug No known bugs.
+
+#include "StreamReceiver.hpp"
+
+#include "Base/System/IOService.hpp"
+#include "Base/System/UdpSocket.hpp"
+
+#include <QThread>
+#include <QtEndian>
+
+#include <chrono>
+
+namespace {
+
+    /// Frame interpretation of video frames.
+    constexpr quint8 VIDEO_INTERPRETATION {
+        2
+    };
+
+    /// Marker of frame data that starts with metadata.
+    constexpr char METADATA_MARKER {
+        1
+    };
+
+    /// Size of the codec name in the metadata in bytes.
+    constexpr int CODEC_NAME_SIZE {
+        10
+    };
+
+    /// Size of the metadata without the codec configuration in bytes.
+    /// \details Marker, codec name, bits per coded unit and configuration
+    /// size.
+    constexpr int METADATA_SIZE {
+        1 + CODEC_NAME_SIZE + 4 + 4
+    };
+
+    /// Number of frames queued to a decoder beyond which frames are
+    /// dropped.
+    /// \details A decoder that falls this far behind resumes at the next
+    /// key frame instead of adding latency.
+    constexpr int MAXIMUM_PENDING_FRAMES {
+        32
+    };
+
+    /// Decoder output format, uploaded without conversion.
+    constexpr auto OUTPUT_FORMAT {
+        Decoders::VideoDecoder::Format::RGBX8888
+    };
+
+    /// Returns a string up to its first null character.
+    /// \param[in]  string  Null padded string.
+    /// \return Unpadded string.
+    QString unpadded(const QString& string) {
+        auto end = string.indexOf(QChar('\0'));
+        return end < 0 ? string : string.left(end);
+    }
+
+    /// Returns the steady clock time.
+    /// \return Time in microseconds.
+    quint64 steadyTime() {
+        return static_cast<quint64>(
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+}
+
+/// A namespace that contains GUI classes and functions.
+namespace GUI {
+
+    /// Constructs a stream receiver.
+    /// \param[in]  parent  Parent object.
+    StreamReceiver::StreamReceiver(QObject* parent) :
+        QObject(parent),
+        ioService_(new Common::System::IOService(this)),
+        socket_(new Common::System::UdpSocket(*ioService_, this))
+    {
+        socket_->setDatagramHandler([this](const char* data, int size) {
+            receive(data, size);
+        });
+
+        connect(socket_, &Common::System::UdpSocket::onError,
+                this, &StreamReceiver::onError);
+    }
+
+    /// Destroys the stream receiver.
+    /// \details Stops receiving and decoding.
+    StreamReceiver::~StreamReceiver()
+    {
+        stop();
+    }
+
+    /// Returns the address of a flow.
+    /// \param[in]  task    Sender task identifier.
+    /// \param[in]  flow    Information flow identifier.
+    /// \return Stream address.
+    QString StreamReceiver::streamAddress(const QString& task,
+                                          const QString& flow)
+    {
+        return unpadded(task) + '/' + unpadded(flow);
+    }
+
+    /// Returns the sender task of a stream.
+    /// \param[in]  address Stream address.
+    /// \return Sender task identifier.
+    QString StreamReceiver::streamTask(const QString& address)
+    {
+        return address.section('/', 0, 0);
+    }
+
+    /// Starts receiving and decoding.
+    /// \details Decoding threads are started before the socket is bound,
+    /// so decoders created from now on never land on the GUI thread.
+    /// \param[in]  port            Local UDP port, zero for any free port.
+    /// \param[in]  decodingThreads Number of decoding threads, zero for
+    ///                             automatic selection.
+    /// \retval true on success.
+    /// \retval false if the port could not be bound.
+    bool StreamReceiver::start(quint16 port, int decodingThreads)
+    {
+        stop();
+
+        if (decodingThreads <= 0)
+            decodingThreads = qMax(1, QThread::idealThreadCount());
+
+        for (auto index = 0; index < decodingThreads; ++index) {
+            auto thread = new QThread(this);
+            thread->setObjectName(QString("Decoding %1").arg(index));
+            thread->start();
+            decodingThreads_.append(thread);
+        }
+
+        ioService_->start();
+
+        if (!socket_->open(port)) {
+            stop();
+            return false;
+        }
+
+        return true;
+    }
+
+    /// Stops receiving and decoding.
+    /// \details Decoders stay registered, but get no more frames, and those
+    /// released with a pending deletion are deleted. Decoders left on the
+    /// stopped threads no longer handle events, so the receiver is only
+    /// stopped on shutdown.
+    void StreamReceiver::stop()
+    {
+        socket_->close();
+        ioService_->stop();
+
+        for (auto thread : decodingThreads_) {
+            thread->quit();
+            thread->wait();
+            delete thread;
+        }
+
+        decodingThreads_.clear();
+        serializer_.clear();
+        flows_.clear();
+    }
+
+    /// Returns the local port.
+    /// \return Local UDP port, zero if stopped.
+    quint16 StreamReceiver::port() const
+    {
+        return socket_->port();
+    }
+
+    /// Creates the decoder of a stream.
+    /// \details Decoders are moved to the decoding threads in turn. A
+    /// decoder is initialized once its flow sends metadata.
+    /// The caller takes ownership of the decoder, and must release it
+    /// before deleting it.
+    /// \param[in]  address Stream address.
+    /// \return Decoder.
+    Decoders::VideoDecoder* StreamReceiver::createDecoder(
+        const QString& address)
+    {
+        auto decoder = new Decoders::VideoDecoder;
+
+        if (!decodingThreads_.isEmpty()) {
+            nextThread_ %= decodingThreads_.size();
+            decoder->moveToThread(decodingThreads_[nextThread_++]);
+        }
+
+        Sink sink;
+        sink.decoder = decoder;
+        sink.pendingFrames = std::make_shared<std::atomic<int>>(0);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        sinks_.insert(address, sink);
+
+        return decoder;
+    }
+
+    /// Stops feeding a decoder.
+    /// \details Frames already queued to the decoder are still delivered
+    /// unless it is deleted.
+    /// \param[in]  decoder Decoder created by the receiver.
+    void StreamReceiver::releaseDecoder(Decoders::VideoDecoder* decoder)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        for (auto sink = sinks_.begin(); sink != sinks_.end(); ) {
+            if (sink.value().decoder == decoder)
+                sink = sinks_.erase(sink);
+            else
+                ++sink;
+        }
+    }
+
+    /// Returns receiver statistics.
+    /// \details Can be called from any thread.
+    /// \return Receiver statistics.
+    StreamReceiver::Statistics StreamReceiver::statistics() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        auto statistics = statistics_;
+        statistics.receivedDatagrams = socket_->receivedDatagrams();
+        return statistics;
+    }
+
+    /// Handles a received datagram.
+    /// \details Called on the I/O thread.
+    /// \param[in]  data    Datagram data.
+    /// \param[in]  size    Datagram size.
+    void StreamReceiver::receive(const char* data, int size)
+    {
+        serializer_.deserialize(data, size);
+        serializer_.completedFrames(frames_);
+
+        for (const auto& frame : frames_) {
+            if (frame.interpretation == VIDEO_INTERPRETATION)
+                dispatch(frame);
+        }
+
+        frames_.clear();
+    }
+
+    /// Queues a reassembled frame to the decoder of its flow.
+    /// \details Frame data starts with a marker. Key frames carry the codec
+    /// name and configuration after it, which initialize the decoders of
+    /// the flow; decoders created later are initialized from the last
+    /// metadata of the flow. Frames of a flow whose codec is not known yet,
+    /// or not a video codec, are dropped. Called on the I/O thread.
+    /// \param[in]  frame   Network frame.
+    void StreamReceiver::dispatch(
+        const Common::Serialization::NetworkFrame& frame)
+    {
+        if (frame.data.isEmpty()) return;
+
+        auto address = streamAddress(frame.task, frame.flow);
+
+        if (!flows_.contains(address))
+            emit streamDiscovered(unpadded(frame.task), unpadded(frame.flow));
+
+        auto& flow = flows_[address];
+        auto offset = 1;
+
+        if (frame.data[0] == METADATA_MARKER) {
+            if (frame.data.size() < METADATA_SIZE) return;
+
+            auto metadata = frame.data.constData();
+            auto name = QByteArray(metadata + 1, CODEC_NAME_SIZE);
+            name.truncate(qstrnlen(name.constData(), CODEC_NAME_SIZE));
+
+            auto configurationSize = qFromBigEndian<qint32>(
+                metadata + 1 + CODEC_NAME_SIZE + 4);
+
+            if (configurationSize < 0 ||
+                configurationSize > frame.data.size() - METADATA_SIZE)
+                return;
+
+            if (name == "H264")
+                flow.codec = Decoders::VideoDecoder::Codec::H264;
+            else if (name == "MJPEG")
+                flow.codec = Decoders::VideoDecoder::Codec::MJPEG;
+            else
+                return;
+
+            flow.configured = true;
+            flow.extradata = frame.data.mid(METADATA_SIZE, configurationSize);
+            offset = METADATA_SIZE + configurationSize;
+        }
+
+        if (!flow.configured) return;
+
+        Decoders::VideoDecoder::FrameInfo info;
+        info.id = frame.id;
+        info.number = frame.number;
+        info.time = frame.time;
+        info.task = frame.task;
+        info.flow = frame.flow;
+        info.receiveTime = steadyTime();
+
+        auto data = frame.data.mid(offset);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++statistics_.receivedFrames;
+
+        for (auto sink = sinks_.find(address);
+             sink != sinks_.end() && sink.key() == address;
+             ++sink) {
+
+            auto decoder = sink.value().decoder;
+            auto pendingFrames = sink.value().pendingFrames;
+
+            if (!sink.value().initialized ||
+                sink.value().codec != flow.codec) {
+                QMetaObject::invokeMethod(decoder, [decoder, flow] {
+                    if (decoder->initialize(flow.codec, OUTPUT_FORMAT) &&
+                        !flow.extradata.isEmpty())
+                        decoder->setExtradata(flow.extradata);
+                }, Qt::QueuedConnection);
+
+                sink.value().initialized = true;
+                sink.value().codec = flow.codec;
+                sink.value().extradata = flow.extradata;
+            }
+            else if (sink.value().extradata != flow.extradata &&
+                     !flow.extradata.isEmpty()) {
+                auto extradata = flow.extradata;
+                QMetaObject::invokeMethod(decoder, [decoder, extradata] {
+                    decoder->setExtradata(extradata);
+                }, Qt::QueuedConnection);
+
+                sink.value().extradata = extradata;
+            }
+
+            if (pendingFrames->load(std::memory_order_relaxed) >=
+                MAXIMUM_PENDING_FRAMES) {
+                ++statistics_.droppedFrames;
+                continue;
+            }
+
+            pendingFrames->fetch_add(1, std::memory_order_relaxed);
+            ++statistics_.queuedFrames;
+
+            QMetaObject::invokeMethod(decoder,
+                                      [decoder, data, info, pendingFrames] {
+                pendingFrames->fetch_sub(1, std::memory_order_relaxed);
+                decoder->decode(data, info);
+            }, Qt::QueuedConnection);
+        }
+    }
+}
@@ -0,0 +1,217 @@
+/// \file StreamReceiver.hpp
+/// \brief Contains declarations of classes and functions for receiving
+/// network streams and feeding their decoders.
+/// \bug No known bugs.
+
+#ifndef STREAMRECEIVER_HPP
+#define STREAMRECEIVER_HPP
+
+#include "Base/Serialization/NetworkSerializer.hpp"
+#include "Playback/Decoding/VideoDecoder.hpp"
+
+#include <QHash>
+#include <QObject>
+#include <QString>
+#include <QVector>
+
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+
+class QThread;
+
+namespace Common::System {
+    class IOService;
+    class UdpSocket;
+}
+
+/// A namespace that contains GUI classes and functions.
+namespace GUI {
+
+    /// A class that receives network streams and feeds their decoders.
+    /// \details Reassembles network frames from datagrams on an I/O thread
+    /// and queues the frames of each video flow to the decoder created for
+    /// its address. Decoders run on a few decoding threads owned by the
+    /// receiver, never on the GUI thread, and are initialized from the
+    /// metadata the sender puts in front of key frames. Flows are announced
+    /// once, when their first video frame arrives, whether or not a decoder
+    /// was created for them.
+    class StreamReceiver : public QObject {
+
+        Q_OBJECT
+
+    public:
+
+        /// A structure that contains receiver statistics.
+        struct Statistics {
+
+            /// Number of received datagrams.
+            quint64 receivedDatagrams = 0;
+
+            /// Number of reassembled video frames.
+            quint64 receivedFrames = 0;
+
+            /// Number of video frames queued to a decoder.
+            quint64 queuedFrames = 0;
+
+            /// Number of video frames dropped because their decoder had too
+            /// many frames queued.
+            quint64 droppedFrames = 0;
+        };
+
+    public:
+
+        /// Constructs a stream receiver.
+        /// \param[in]  parent  Parent object.
+        explicit StreamReceiver(QObject* parent = nullptr);
+
+        /// Destroys the stream receiver.
+        /// \details Stops receiving and decoding.
+        virtual ~StreamReceiver();
+
+    public:
+
+        /// Returns the address of a flow.
+        /// \param[in]  task    Sender task identifier.
+        /// \param[in]  flow    Information flow identifier.
+        /// \return Stream address.
+        static QString streamAddress(const QString& task, const QString& flow);
+
+        /// Returns the sender task of a stream.
+        /// \param[in]  address Stream address.
+        /// \return Sender task identifier.
+        static QString streamTask(const QString& address);
+
+        /// Starts receiving and decoding.
+        /// \param[in]  port            Local UDP port, zero for any free port.
+        /// \param[in]  decodingThreads Number of decoding threads, zero for
+        ///                             automatic selection.
+        /// \retval true on success.
+        /// \retval false if the port could not be bound.
+        bool start(quint16 port, int decodingThreads = 0);
+
+        /// Stops receiving and decoding.
+        /// \details Decoders stay registered, but get no more frames.
+        void stop();
+
+        /// Returns the local port.
+        /// \return Local UDP port, zero if stopped.
+        quint16 port() const;
+
+        /// Creates the decoder of a stream.
+        /// \details The caller takes ownership of the decoder, and must
+        /// release it before deleting it.
+        /// \param[in]  address Stream address.
+        /// \return Decoder.
+        Decoders::VideoDecoder* createDecoder(const QString& address);
+
+        /// Stops feeding a decoder.
+        /// \details Frames already queued to the decoder are still delivered
+        /// unless it is deleted.
+        /// \param[in]  decoder Decoder created by the receiver.
+        void releaseDecoder(Decoders::VideoDecoder* decoder);
+
+        /// Returns receiver statistics.
+        /// \details Can be called from any thread.
+        /// \return Receiver statistics.
+        Statistics statistics() const;
+
+    signals:
+
+        /// Signals the first video frame of a flow.
+        /// \details Emitted on the I/O thread.
+        /// \param[in]  task    Sender task identifier.
+        /// \param[in]  flow    Information flow identifier.
+        void streamDiscovered(const QString& task, const QString& flow);
+
+        /// Signals a receive error.
+        /// \param[in]  message Error message.
+        void onError(const QString& message);
+
+    private:
+
+        /// A structure that contains the state of a received flow.
+        /// \details Only used on the I/O thread.
+        struct Flow {
+
+            /// Indicates whether the codec is known from metadata.
+            bool configured = false;
+
+            /// Codec of the flow.
+            Decoders::VideoDecoder::Codec codec =
+                Decoders::VideoDecoder::Codec::H264;
+
+            /// Codec configuration of the flow.
+            QByteArray extradata;
+        };
+
+        /// A structure that describes a registered decoder.
+        struct Sink {
+
+            /// Decoder.
+            Decoders::VideoDecoder* decoder = nullptr;
+
+            /// Indicates whether the decoder was initialized.
+            bool initialized = false;
+
+            /// Codec the decoder was initialized with.
+            Decoders::VideoDecoder::Codec codec =
+                Decoders::VideoDecoder::Codec::H264;
+
+            /// Codec configuration the decoder was given.
+            QByteArray extradata;
+
+            /// Number of frames queued to the decoder and not yet decoded.
+            std::shared_ptr<std::atomic<int>> pendingFrames;
+        };
+
+    private:
+
+        /// Handles a received datagram.
+        /// \details Called on the I/O thread.
+        /// \param[in]  data    Datagram data.
+        /// \param[in]  size    Datagram size.
+        void receive(const char* data, int size);
+
+        /// Queues a reassembled frame to the decoder of its flow.
+        /// \details Called on the I/O thread.
+        /// \param[in]  frame   Network frame.
+        void dispatch(const Common::Serialization::NetworkFrame& frame);
+
+    private:
+
+        /// I/O service the socket runs on.
+        Common::System::IOService* ioService_;
+
+        /// Socket frames are received on.
+        Common::System::UdpSocket* socket_;
+
+        /// Reassembles frames, only used on the I/O thread.
+        Common::Serialization::NetworkSerializer serializer_;
+
+        /// Completed frames, only used on the I/O thread.
+        std::list<Common::Serialization::NetworkFrame> frames_;
+
+        /// Received flows by address, only used on the I/O thread.
+        QHash<QString, Flow> flows_;
+
+        /// Guards the sinks and the statistics.
+        mutable std::mutex mutex_;
+
+        /// Registered decoders by stream address, several when a stream is
+        /// shown more than once.
+        QMultiHash<QString, Sink> sinks_;
+
+        /// Receiver statistics.
+        Statistics statistics_;
+
+        /// Decoding threads.
+        QVector<QThread*> decodingThreads_;
+
+        /// Decoding thread the next decoder is moved to.
+        int nextThread_ = 0;
+    };
+}
+
+#endif
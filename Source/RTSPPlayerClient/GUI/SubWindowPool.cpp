@@ -0,0 +1,685 @@
+/// \file SubWindowPool.cpp
+/// \brief Contains definitions of classes and functions for pooling media
+/// subwindows and their stream pipelines.
+/// \bug No known bugs.
+
+#include "SubWindowPool.hpp"
+#include "MediaSubWindow.hpp"
+#include "PerformanceHud.hpp"
+#include "StreamReceiver.hpp"
+
+#include "Base/Utility/MemoryBudget.hpp"
+#include "Playback/Output/PlaybackWidget.hpp"
+#include "Playback/Output/PresentationScheduler.hpp"
+#include "Playback/Output/StreamCounters.hpp"
+
+#include <QDateTime>
+#include <QEvent>
+#include <QMdiArea>
+
+#include <algorithm>
+
+namespace {
+
+    /// Interval at which parked pipelines are checked in milliseconds.
+    constexpr int EXPIRY_INTERVAL {
+        500
+    };
+
+    /// Number of distinct frame identifiers.
+    constexpr quint64 IDENTIFIER_RANGE {
+        quint64(1) << 32
+    };
+
+    /// Extends a frame identifier to a stream timestamp.
+    /// \details Frame identifiers are sender capture times in microseconds
+    /// since the epoch cut to 32 bits, which wrap about every 71 minutes.
+    /// The identifier is placed in the wrap period closest to the local
+    /// time, so the streams of one sender get timestamps of one clock
+    /// whenever they started, as long as the sender clock is off by less
+    /// than half a wrap period.
+    /// \param[in]  id  Frame identifier.
+    /// \return Timestamp in microseconds.
+    quint64 unwrapTimestamp(quint32 id)
+    {
+        auto now = static_cast<quint64>(
+            QDateTime::currentMSecsSinceEpoch()) * 1000;
+        auto timestamp = (now & ~(IDENTIFIER_RANGE - 1)) | id;
+
+        if (timestamp + IDENTIFIER_RANGE / 2 < now)
+            timestamp += IDENTIFIER_RANGE;
+        else if (timestamp > now + IDENTIFIER_RANGE / 2)
+            timestamp -= IDENTIFIER_RANGE;
+
+        return timestamp;
+    }
+}
+
+/// A namespace that contains GUI classes and functions.
+namespace GUI {
+
+    /// Constructs a subwindow pool.
+    /// \param[in]  area    Area that holds the subwindows.
+    /// \param[in]  parent  Parent object.
+    SubWindowPool::SubWindowPool(QMdiArea* area, QObject* parent) :
+        QObject(parent),
+        area_(area)
+    {
+        expiryTimer_.setInterval(EXPIRY_INTERVAL);
+        connect(&expiryTimer_, &QTimer::timeout, this, &SubWindowPool::expire);
+    }
+
+    /// Destroys the subwindow pool.
+    /// \details Destroys the pipelines, whose decoding threads must have
+    /// stopped. Subwindows belong to the area.
+    SubWindowPool::~SubWindowPool()
+    {
+        for (auto& entry : entries_) {
+            if (scheduler_ && entry.stream >= 0)
+                scheduler_->removeStream(entry.stream);
+
+            if (entry.decoder)
+                emit pipelineDestroying(entry.decoder);
+
+            delete entry.decoder;
+
+            if (entry.subWindow)
+                entry.subWindow->removeEventFilter(this);
+        }
+    }
+
+    /// Sets the function that creates stream decoders.
+    /// \details Applies to streams lent from now on.
+    /// \param[in]  factory Pipeline factory, or null for no decoders.
+    void SubWindowPool::setPipelineFactory(PipelineFactory factory)
+    {
+        pipelineFactory_ = std::move(factory);
+    }
+
+    /// Sets the HUD lent subwindows are shown in.
+    /// \details Every lent subwindow showing a stream gets a HUD tile with
+    /// its widget, decoder and output counters, which is removed when the
+    /// subwindow is taken back. Applies to streams lent from now on.
+    /// \param[in]  hud Performance HUD, or null.
+    void SubWindowPool::setPerformanceHud(PerformanceHud* hud)
+    {
+        hud_ = hud;
+    }
+
+    /// Sets the scheduler decoded frames are presented through.
+    /// \details Every stream lent from now on is registered with the
+    /// scheduler, which shows its frames at the display refresh, and the
+    /// buffer swaps of the playback widgets align the refresh ticks.
+    /// \param[in]  scheduler   Presentation scheduler, or null to show
+    ///                         frames as soon as they are decoded.
+    void SubWindowPool::setPresentationScheduler(
+        Player::Playback::PresentationScheduler* scheduler)
+    {
+        scheduler_ = scheduler;
+    }
+
+    /// Sets the thread the playback widgets render on.
+    /// \details Applies to the pooled widgets at once and to those created
+    /// later. The widgets must leave the thread before it is deleted.
+    /// \param[in]  renderThread    Render thread, or null to render on
+    ///                             the GUI thread.
+    void SubWindowPool::setRenderThread(
+        Player::Playback::RenderThread* renderThread)
+    {
+        renderThread_ = renderThread;
+
+        for (auto& entry : entries_) {
+            if (entry.subWindow)
+                entry.widget->setRenderThread(renderThread);
+        }
+    }
+
+    /// Indicates whether streams of one sender task are synchronized.
+    /// \retval true if they share a sync group.
+    /// \retval false otherwise.
+    bool SubWindowPool::taskSync() const
+    {
+        return taskSync_;
+    }
+
+    /// Sets whether streams of one sender task are synchronized.
+    /// \details The flows of one task come from one server, which stamps
+    /// them with one clock, so they join one sync group sharing that clock
+    /// and are shown by capture time with a common playout delay. Applies
+    /// to the streams of the pool at once. Needs a presentation scheduler.
+    /// \param[in]  enabled Indicates whether streams of one task share a
+    ///                     sync group.
+    void SubWindowPool::setTaskSync(bool enabled)
+    {
+        taskSync_ = enabled;
+
+        for (auto& entry : entries_)
+            updateSyncGroup(entry);
+    }
+
+    /// Shows the frames of a pooled subwindow elsewhere.
+    /// \details The decoder keeps running; only where its frames go
+    /// changes. The presenter is dropped when the subwindow is taken back.
+    /// \param[in]  subWindow   Subwindow of the pool.
+    /// \param[in]  presenter   Function that shows the frames, or null to
+    ///                         show them in the playback widget.
+    void SubWindowPool::setPresenter(QMdiSubWindow* subWindow,
+                                     Presenter presenter)
+    {
+        auto index = find(subWindow);
+        if (index < 0) return;
+
+        auto& entry = entries_[index];
+
+        if (!presenter)
+            presenter = widgetPresenter(entry.widget);
+
+        if (scheduler_ && entry.stream >= 0) {
+            scheduler_->setPresenter(entry.stream, std::move(presenter));
+        }
+        else if (entry.decoder) {
+            disconnect(entry.frameConnection);
+            entry.frameConnection = connect(
+                entry.decoder, &Decoders::VideoDecoder::onFrame,
+                this, [presenter](const QImage& frame) {
+                    presenter(frame);
+                });
+        }
+    }
+
+    /// Returns the time returned pipelines are kept.
+    /// \return Grace period in milliseconds.
+    int SubWindowPool::gracePeriod() const
+    {
+        return gracePeriod_;
+    }
+
+    /// Sets the time returned pipelines are kept.
+    /// \details Applies to parked pipelines at the next check.
+    /// \param[in]  milliseconds    Grace period in milliseconds.
+    void SubWindowPool::setGracePeriod(int milliseconds)
+    {
+        gracePeriod_ = qMax(0, milliseconds);
+    }
+
+    /// Returns the maximum number of idle subwindows kept.
+    /// \return Maximum number of idle subwindows.
+    int SubWindowPool::maximumIdle() const
+    {
+        return maximumIdle_;
+    }
+
+    /// Sets the maximum number of idle subwindows kept.
+    /// \param[in]  count   Maximum number of idle subwindows.
+    void SubWindowPool::setMaximumIdle(int count)
+    {
+        maximumIdle_ = qMax(0, count);
+        trim();
+    }
+
+    /// Creates idle subwindows until a number of them is available.
+    /// \details Grabbing the framebuffer of a hidden playback widget
+    /// creates its context and GL resources, so the first loan does not
+    /// pay for them. Raises the idle maximum if needed.
+    /// \param[in]  count   Number of idle subwindows.
+    void SubWindowPool::prewarm(int count)
+    {
+        maximumIdle_ = qMax(maximumIdle_, count);
+
+        for (auto idle = idleCount(); idle < count; ++idle) {
+            auto index = create();
+            entries_[index].widget->grabFramebuffer();
+        }
+    }
+
+    /// Lends a subwindow showing a stream.
+    /// \details Prefers a subwindow parked with the same stream, then an
+    /// idle one, then the longest parked one of another stream, and creates
+    /// one only if none is left. A subwindow that changes streams is
+    /// cleared and gets a new pipeline from the factory.
+    /// \param[in]  address Stream address.
+    /// \return Subwindow, shown in the area.
+    MediaSubWindow* SubWindowPool::acquire(const QString& address)
+    {
+        auto index = findAvailable(address);
+
+        if (index < 0) {
+            index = create();
+            ++statistics_.coldLoans;
+        }
+        else if (entries_[index].state == State::Parked &&
+                 entries_[index].address == address) {
+            ++statistics_.warmLoans;
+        }
+        else {
+            ++statistics_.idleLoans;
+        }
+
+        auto& entry = entries_[index];
+
+        if (entry.state != State::Idle && entry.address != address)
+            destroyPipeline(entry);
+
+        if (entry.state == State::Idle) {
+            entry.address = address;
+
+            if (pipelineFactory_ && !address.isEmpty())
+                entry.decoder = pipelineFactory_(address);
+
+            if (!address.isEmpty()) {
+                attachMemoryAccount(entry);
+                connectPipeline(entry);
+            }
+        }
+
+        entry.state = State::Lent;
+        entry.subWindow->show();
+
+        if (hud_ && !address.isEmpty())
+            entry.hudTile = hud_->addTile(address,
+                                          entry.widget,
+                                          entry.decoder,
+                                          entry.counters);
+
+        emit acquired(entry.subWindow, entry.decoder);
+        return entry.subWindow;
+    }
+
+    /// Takes back a subwindow.
+    /// \details Hides the subwindow and parks it with its pipeline. With no
+    /// grace period the pipeline is destroyed at once.
+    /// \param[in]  subWindow   Subwindow lent by the pool.
+    void SubWindowPool::release(QMdiSubWindow* subWindow)
+    {
+        auto index = find(subWindow);
+        if (index < 0 || entries_[index].state != State::Lent) return;
+
+        auto& entry = entries_[index];
+        entry.subWindow->hide();
+        removeHudTile(entry);
+        setPresenter(entry.subWindow, nullptr);
+
+        if (gracePeriod_ > 0) {
+            entry.state = State::Parked;
+            entry.parkTimer.start();
+
+            if (!expiryTimer_.isActive())
+                expiryTimer_.start();
+        }
+        else {
+            destroyPipeline(entry);
+            trim();
+        }
+
+        emit released(subWindow);
+    }
+
+    /// Returns the playback widget of a pooled subwindow.
+    /// \param[in]  subWindow   Subwindow of the pool.
+    /// \return Playback widget, or null if the subwindow is not pooled.
+    Player::Playback::PlaybackWidget*
+    SubWindowPool::playbackWidget(QMdiSubWindow* subWindow) const
+    {
+        auto index = find(subWindow);
+        return index >= 0 ? entries_[index].widget : nullptr;
+    }
+
+    /// Returns the decoder of a pooled subwindow.
+    /// \param[in]  subWindow   Subwindow of the pool.
+    /// \return Decoder, or null if the subwindow has no pipeline.
+    Decoders::VideoDecoder* SubWindowPool::decoder(QMdiSubWindow* subWindow) const
+    {
+        auto index = find(subWindow);
+        return index >= 0 ? entries_[index].decoder.data() : nullptr;
+    }
+
+    /// Returns the stream address of a pooled subwindow.
+    /// \param[in]  subWindow   Subwindow of the pool.
+    /// \return Stream address, empty if idle.
+    QString SubWindowPool::address(QMdiSubWindow* subWindow) const
+    {
+        auto index = find(subWindow);
+        return index >= 0 ? entries_[index].address : QString();
+    }
+
+    /// Returns the number of lent subwindows.
+    /// \return Number of lent subwindows.
+    int SubWindowPool::lentCount() const
+    {
+        return static_cast<int>(std::count_if(
+            entries_.cbegin(), entries_.cend(), [](const Entry& entry) {
+                return entry.subWindow && entry.state == State::Lent;
+            }));
+    }
+
+    /// Returns the number of parked subwindows.
+    /// \return Number of returned subwindows that keep their pipeline.
+    int SubWindowPool::parkedCount() const
+    {
+        return static_cast<int>(std::count_if(
+            entries_.cbegin(), entries_.cend(), [](const Entry& entry) {
+                return entry.subWindow && entry.state == State::Parked;
+            }));
+    }
+
+    /// Returns the number of idle subwindows.
+    /// \return Number of subwindows without a pipeline.
+    int SubWindowPool::idleCount() const
+    {
+        return static_cast<int>(std::count_if(
+            entries_.cbegin(), entries_.cend(), [](const Entry& entry) {
+                return entry.subWindow && entry.state == State::Idle;
+            }));
+    }
+
+    /// Returns pool statistics.
+    /// \return Pool statistics.
+    const SubWindowPool::Statistics& SubWindowPool::statistics() const
+    {
+        return statistics_;
+    }
+
+    /// Returns closed subwindows to the pool.
+    /// \details The close is refused, so the subwindow is hidden by the
+    /// release instead of being deleted.
+    /// \param[in]  watched Watched object.
+    /// \param[in]  event   Event.
+    /// \retval true if a close was turned into a release.
+    /// \retval false to let the event through.
+    bool SubWindowPool::eventFilter(QObject* watched, QEvent* event)
+    {
+        if (event->type() == QEvent::Close) {
+            auto index = find(static_cast<QMdiSubWindow*>(watched));
+
+            if (index >= 0 && entries_[index].state == State::Lent) {
+                event->ignore();
+                release(entries_[index].subWindow);
+                return true;
+            }
+        }
+
+        return QObject::eventFilter(watched, event);
+    }
+
+    /// Creates an idle subwindow.
+    /// \details The subwindow is added to the area hidden and is never
+    /// deleted on close.
+    /// \return Index of the entry.
+    int SubWindowPool::create()
+    {
+        Entry entry;
+        entry.subWindow = new MediaSubWindow;
+        entry.widget = new Player::Playback::PlaybackWidget;
+
+        entry.subWindow->setAttribute(Qt::WA_DeleteOnClose, false);
+        entry.subWindow->setTitleBarColor(QColor("lightgray"));
+        entry.subWindow->setWidget(entry.widget);
+        entry.subWindow->installEventFilter(this);
+
+        if (renderThread_)
+            entry.widget->setRenderThread(renderThread_);
+
+        if (area_)
+            area_->addSubWindow(entry.subWindow);
+
+        entry.subWindow->hide();
+
+        ++statistics_.createdSubWindows;
+
+        entries_.append(entry);
+        return entries_.size() - 1;
+    }
+
+    /// Finds the entry of a subwindow.
+    /// \param[in]  subWindow   Subwindow.
+    /// \return Index of the entry, or -1 if not pooled.
+    int SubWindowPool::find(const QMdiSubWindow* subWindow) const
+    {
+        if (!subWindow) return -1;
+
+        for (auto index = 0; index < entries_.size(); ++index) {
+            if (entries_[index].subWindow == subWindow) return index;
+        }
+
+        return -1;
+    }
+
+    /// Finds a subwindow to lend for a stream.
+    /// \param[in]  address Stream address.
+    /// \return Index of the entry, or -1 if none is available.
+    int SubWindowPool::findAvailable(const QString& address) const
+    {
+        auto idle = -1, oldest = -1;
+
+        for (auto index = 0; index < entries_.size(); ++index) {
+            const auto& entry = entries_[index];
+            if (!entry.subWindow) continue;
+
+            switch (entry.state) {
+            case State::Parked:
+                if (entry.address == address) return index;
+
+                if (oldest < 0 ||
+                    entry.parkTimer.elapsed() >
+                        entries_[oldest].parkTimer.elapsed())
+                    oldest = index;
+                break;
+            case State::Idle:
+                if (idle < 0) idle = index;
+                break;
+            default:
+                break;
+            }
+        }
+
+        return idle >= 0 ? idle : oldest;
+    }
+
+    /// Destroys pipelines whose grace period has ended.
+    /// \details Stops checking once nothing is parked.
+    void SubWindowPool::expire()
+    {
+        auto parked = 0;
+
+        for (auto& entry : entries_) {
+            if (!entry.subWindow || entry.state != State::Parked) continue;
+
+            if (entry.parkTimer.elapsed() >= gracePeriod_) {
+                destroyPipeline(entry);
+                ++statistics_.expiredPipelines;
+            }
+            else {
+                ++parked;
+            }
+        }
+
+        if (parked == 0)
+            expiryTimer_.stop();
+
+        trim();
+    }
+
+    /// Destroys the pipeline of an entry, making it idle.
+    /// \details The decoder is deleted on its own thread. The playback
+    /// widget keeps its GL resources and is cleared.
+    /// \param[in]  entry   Pooled subwindow.
+    void SubWindowPool::destroyPipeline(Entry& entry)
+    {
+        if (entry.decoder) {
+            emit pipelineDestroying(entry.decoder);
+            entry.decoder->deleteLater();
+        }
+
+        if (scheduler_ && entry.stream >= 0)
+            scheduler_->removeStream(entry.stream);
+
+        removeHudTile(entry);
+
+        entry.stream = -1;
+        entry.decoder = nullptr;
+        entry.counters.reset();
+        entry.address.clear();
+        entry.state = State::Idle;
+        entry.widget->setCounters(nullptr);
+        entry.widget->clear();
+    }
+
+    /// Connects the decoder of an entry to its playback widget.
+    /// \details Frames are queued to the GUI thread. Without a scheduler
+    /// the widget shows them at once. Otherwise the stream is registered
+    /// with the scheduler, frames are submitted with their identifier as
+    /// timestamp, and the swaps of the widget align the refresh ticks. The
+    /// decoder then defers conversion, so frames the scheduler drops are
+    /// never converted; frames it emitted converted before the switch are
+    /// submitted as they are.
+    /// \param[in]  entry   Pooled subwindow showing a stream.
+    void SubWindowPool::connectPipeline(Entry& entry)
+    {
+        if (!entry.decoder) return;
+
+        if (!scheduler_) {
+            entry.frameConnection = connect(
+                entry.decoder, &Decoders::VideoDecoder::onFrame,
+                entry.widget, &Player::Playback::PlaybackWidget::setImage);
+            return;
+        }
+
+        auto scheduler = scheduler_.data();
+        auto stream = scheduler->addStream(widgetPresenter(entry.widget));
+
+        scheduler->setCounters(stream, entry.counters);
+        entry.stream = stream;
+        updateSyncGroup(entry);
+
+        auto decoder = entry.decoder.data();
+        QMetaObject::invokeMethod(decoder, [decoder] {
+            decoder->setDeferredConversion(true);
+        });
+
+        connect(decoder, &Decoders::VideoDecoder::onDecodedFrame,
+                scheduler, [scheduler, stream](
+                    const Decoders::VideoDecoder::DecodedFrame& frame,
+                    const Decoders::VideoDecoder::FrameInfo& info) {
+            scheduler->submitDeferred(stream,
+                                      [frame] { return frame.image(); },
+                                      unwrapTimestamp(info.id),
+                                      info.receiveTime);
+        });
+
+        connect(decoder, &Decoders::VideoDecoder::onFrame,
+                scheduler, [scheduler, stream](
+                    const QImage& frame,
+                    const Decoders::VideoDecoder::FrameInfo& info) {
+            scheduler->submit(stream,
+                              frame,
+                              unwrapTimestamp(info.id),
+                              info.receiveTime);
+        });
+
+        connect(entry.widget,
+                &Player::Playback::PlaybackWidget::frameSwapped,
+                scheduler,
+                &Player::Playback::PresentationScheduler::synchronize,
+                Qt::UniqueConnection);
+    }
+
+    /// Moves the scheduler stream of an entry to the sync group of its
+    /// task, or out of any group.
+    /// \details Groups are numbered by task in order of first use.
+    /// \param[in]  entry   Pooled subwindow.
+    void SubWindowPool::updateSyncGroup(Entry& entry)
+    {
+        if (!scheduler_ || entry.stream < 0) return;
+
+        auto group = -1;
+
+        if (taskSync_) {
+            auto task = StreamReceiver::streamTask(entry.address);
+            group = syncGroups_.value(task, syncGroups_.size());
+            syncGroups_.insert(task, group);
+        }
+
+        scheduler_->setSyncGroup(entry.stream, group, true);
+    }
+
+    /// Returns the function that shows frames in a playback widget.
+    /// \details Frames are dropped once the widget is deleted.
+    /// \param[in]  widget  Playback widget.
+    /// \return Presenter.
+    SubWindowPool::Presenter SubWindowPool::widgetPresenter(
+        Player::Playback::PlaybackWidget* widget)
+    {
+        QPointer<Player::Playback::PlaybackWidget> target(widget);
+
+        return [target](const QImage& frame) {
+            if (target) target->setImage(frame);
+        };
+    }
+
+    /// Gives the pipeline of an entry a memory account.
+    /// \details The decoder, if any, and the playback widget report to the
+    /// same account, which leaves the budget once both let go of it.
+    /// \param[in]  entry   Pooled subwindow showing a stream.
+    void SubWindowPool::attachMemoryAccount(Entry& entry)
+    {
+        auto account = Common::Utility::MemoryBudget::instance()
+            .createAccount(entry.address);
+
+        if (auto decoder = entry.decoder.data()) {
+            QMetaObject::invokeMethod(decoder, [decoder, account] {
+                decoder->setMemoryAccount(account);
+            });
+        }
+
+        entry.counters =
+            std::make_shared<Player::Playback::StreamCounters>(account);
+        entry.widget->setCounters(entry.counters);
+    }
+
+    /// Removes an entry from the HUD.
+    /// \param[in]  entry   Pooled subwindow.
+    void SubWindowPool::removeHudTile(Entry& entry)
+    {
+        if (hud_ && entry.hudTile >= 0)
+            hud_->removeTile(entry.hudTile);
+
+        entry.hudTile = -1;
+    }
+
+    /// Deletes idle subwindows beyond the maximum.
+    /// \details Also forgets subwindows deleted elsewhere.
+    void SubWindowPool::trim()
+    {
+        auto idle = 0;
+
+        for (auto index = 0; index < entries_.size(); ) {
+            auto& entry = entries_[index];
+
+            if (!entry.subWindow) {
+                removeHudTile(entry);
+
+                if (scheduler_ && entry.stream >= 0)
+                    scheduler_->removeStream(entry.stream);
+
+                if (entry.decoder) {
+                    emit pipelineDestroying(entry.decoder);
+                    entry.decoder->deleteLater();
+                }
+
+                entries_.remove(index);
+                continue;
+            }
+
+            if (entry.state == State::Idle && ++idle > maximumIdle_) {
+                if (area_)
+                    area_->removeSubWindow(entry.subWindow);
+
+                entry.subWindow->deleteLater();
+                entries_.remove(index);
+                continue;
+            }
+
+            ++index;
+        }
+    }
+}
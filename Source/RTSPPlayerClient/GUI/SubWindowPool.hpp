@@ -0,0 +1,352 @@
+/// \file SubWindowPool.hpp
+/// \brief Contains declarations of classes and functions for pooling media
+/// subwindows and their stream pipelines.
+/// \bug No known bugs.
+
+#ifndef SUBWINDOWPOOL_HPP
+#define SUBWINDOWPOOL_HPP
+
+#include "Playback/Decoding/VideoDecoder.hpp"
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QObject>
+#include <QPointer>
+#include <QTimer>
+#include <QVector>
+
+#include <functional>
+#include <memory>
+
+class MediaSubWindow;
+class QImage;
+class QMdiArea;
+class QMdiSubWindow;
+
+namespace Player {
+    namespace Playback {
+        class PlaybackWidget;
+        class PresentationScheduler;
+        class RenderThread;
+        class StreamCounters;
+    }
+}
+
+/// A namespace that contains GUI classes and functions.
+namespace GUI {
+
+    class PerformanceHud;
+
+    /// A class that lends prewarmed media subwindows to layouts.
+    /// \details Keeps media subwindows with their playback widgets in a
+    /// multiple document interface area, so layouts borrow and return them
+    /// instead of creating and destroying the subwindow, its style, the GL
+    /// widget and the decoder. A returned subwindow is hidden and parked
+    /// with its pipeline for the grace period: borrowing it again for the
+    /// same stream shows the last frame at once and decoding continues
+    /// without reconnecting or waiting for a keyframe. After the grace
+    /// period the decoder is destroyed and the subwindow becomes idle; an
+    /// idle subwindow is lent to any stream with its GL resources intact.
+    /// Closing a pooled subwindow returns it instead of deleting it. With a
+    /// presentation scheduler, decoded frames are paced to the display
+    /// refresh before the widget shows them.
+    class SubWindowPool : public QObject {
+
+        Q_OBJECT
+
+    public:
+
+        /// A function that creates the decoder of a stream.
+        /// \details The pool takes ownership of the decoder.
+        using PipelineFactory =
+            std::function<Decoders::VideoDecoder*(const QString& address)>;
+
+        /// A function that shows a frame of a stream.
+        using Presenter = std::function<void(const QImage& frame)>;
+
+        /// A structure that contains pool statistics.
+        struct Statistics {
+
+            /// Number of created subwindows.
+            quint64 createdSubWindows = 0;
+
+            /// Number of loans of a parked subwindow to the same stream.
+            quint64 warmLoans = 0;
+
+            /// Number of loans of an idle subwindow.
+            quint64 idleLoans = 0;
+
+            /// Number of loans that created a subwindow.
+            quint64 coldLoans = 0;
+
+            /// Number of pipelines destroyed after their grace period.
+            quint64 expiredPipelines = 0;
+        };
+
+    public:
+
+        /// Constructs a subwindow pool.
+        /// \param[in]  area    Area that holds the subwindows.
+        /// \param[in]  parent  Parent object.
+        explicit SubWindowPool(QMdiArea* area, QObject* parent = nullptr);
+
+        /// Destroys the subwindow pool.
+        virtual ~SubWindowPool();
+
+    public:
+
+        /// Sets the function that creates stream decoders.
+        /// \param[in]  factory Pipeline factory, or null for no decoders.
+        void setPipelineFactory(PipelineFactory factory);
+
+        /// Sets the HUD lent subwindows are shown in.
+        /// \param[in]  hud Performance HUD, or null.
+        void setPerformanceHud(PerformanceHud* hud);
+
+        /// Sets the scheduler decoded frames are presented through.
+        /// \param[in]  scheduler   Presentation scheduler, or null to show
+        ///                         frames as soon as they are decoded.
+        void setPresentationScheduler(
+            Player::Playback::PresentationScheduler* scheduler);
+
+        /// Sets the thread the playback widgets render on.
+        /// \param[in]  renderThread    Render thread, or null to render on
+        ///                             the GUI thread.
+        void setRenderThread(Player::Playback::RenderThread* renderThread);
+
+        /// Indicates whether streams of one sender task are synchronized.
+        /// \retval true if they share a sync group.
+        /// \retval false otherwise.
+        bool taskSync() const;
+
+        /// Sets whether streams of one sender task are synchronized.
+        /// \param[in]  enabled Indicates whether streams of one task share a
+        ///                     sync group.
+        void setTaskSync(bool enabled);
+
+        /// Shows the frames of a pooled subwindow elsewhere.
+        /// \param[in]  subWindow   Subwindow of the pool.
+        /// \param[in]  presenter   Function that shows the frames, or null to
+        ///                         show them in the playback widget.
+        void setPresenter(QMdiSubWindow* subWindow, Presenter presenter);
+
+        /// Returns the time returned pipelines are kept.
+        /// \return Grace period in milliseconds.
+        int gracePeriod() const;
+
+        /// Sets the time returned pipelines are kept.
+        /// \param[in]  milliseconds    Grace period in milliseconds.
+        void setGracePeriod(int milliseconds);
+
+        /// Returns the maximum number of idle subwindows kept.
+        /// \return Maximum number of idle subwindows.
+        int maximumIdle() const;
+
+        /// Sets the maximum number of idle subwindows kept.
+        /// \param[in]  count   Maximum number of idle subwindows.
+        void setMaximumIdle(int count);
+
+        /// Creates idle subwindows until a number of them is available.
+        /// \param[in]  count   Number of idle subwindows.
+        void prewarm(int count);
+
+        /// Lends a subwindow showing a stream.
+        /// \param[in]  address Stream address.
+        /// \return Subwindow, shown in the area.
+        MediaSubWindow* acquire(const QString& address);
+
+        /// Takes back a subwindow.
+        /// \param[in]  subWindow   Subwindow lent by the pool.
+        void release(QMdiSubWindow* subWindow);
+
+        /// Returns the playback widget of a pooled subwindow.
+        /// \param[in]  subWindow   Subwindow of the pool.
+        /// \return Playback widget, or null if the subwindow is not pooled.
+        Player::Playback::PlaybackWidget* playbackWidget(
+            QMdiSubWindow* subWindow) const;
+
+        /// Returns the decoder of a pooled subwindow.
+        /// \param[in]  subWindow   Subwindow of the pool.
+        /// \return Decoder, or null if the subwindow has no pipeline.
+        Decoders::VideoDecoder* decoder(QMdiSubWindow* subWindow) const;
+
+        /// Returns the stream address of a pooled subwindow.
+        /// \param[in]  subWindow   Subwindow of the pool.
+        /// \return Stream address, empty if idle.
+        QString address(QMdiSubWindow* subWindow) const;
+
+        /// Returns the number of lent subwindows.
+        /// \return Number of lent subwindows.
+        int lentCount() const;
+
+        /// Returns the number of parked subwindows.
+        /// \return Number of returned subwindows that keep their pipeline.
+        int parkedCount() const;
+
+        /// Returns the number of idle subwindows.
+        /// \return Number of subwindows without a pipeline.
+        int idleCount() const;
+
+        /// Returns pool statistics.
+        /// \return Pool statistics.
+        const Statistics& statistics() const;
+
+    signals:
+
+        /// Signals that a subwindow was lent.
+        /// \param[in]  subWindow   Subwindow.
+        /// \param[in]  decoder     Decoder of the stream, or null.
+        void acquired(QMdiSubWindow* subWindow,
+                      Decoders::VideoDecoder* decoder);
+
+        /// Signals that a subwindow was taken back.
+        /// \param[in]  subWindow   Subwindow.
+        void released(QMdiSubWindow* subWindow);
+
+        /// Signals that the decoder of a stream is about to be deleted.
+        /// \details Whoever feeds the decoder must stop before returning.
+        /// \param[in]  decoder     Decoder of the stream.
+        void pipelineDestroying(Decoders::VideoDecoder* decoder);
+
+    protected:
+
+        /// Returns closed subwindows to the pool.
+        /// \param[in]  watched Watched object.
+        /// \param[in]  event   Event.
+        /// \retval true if a close was turned into a release.
+        /// \retval false to let the event through.
+        bool eventFilter(QObject* watched, QEvent* event) override;
+
+    private:
+
+        /// Subwindow states.
+        enum class State {
+            Idle    ,   ///< Hidden without a pipeline.
+            Parked  ,   ///< Hidden with a pipeline kept for the grace period.
+            Lent    ,   ///< Shown in a layout.
+        };
+
+        /// A structure that contains a pooled subwindow.
+        struct Entry {
+
+            /// Subwindow.
+            QPointer<MediaSubWindow> subWindow;
+
+            /// Playback widget shown in the subwindow.
+            Player::Playback::PlaybackWidget* widget = nullptr;
+
+            /// Stream address, empty if idle.
+            QString address;
+
+            /// Decoder of the stream, or null.
+            QPointer<Decoders::VideoDecoder> decoder;
+
+            /// Output counters of the stream, or null.
+            std::shared_ptr<Player::Playback::StreamCounters> counters;
+
+            /// Scheduler stream identifier, or -1.
+            int stream = -1;
+
+            /// Connection of decoded frames to their presenter.
+            QMetaObject::Connection frameConnection;
+
+            /// HUD tile of the lent subwindow, or -1.
+            int hudTile = -1;
+
+            /// Subwindow state.
+            State state = State::Idle;
+
+            /// Measures the time since the subwindow was parked.
+            QElapsedTimer parkTimer;
+        };
+
+    private:
+
+        /// Creates an idle subwindow.
+        /// \return Index of the entry.
+        int create();
+
+        /// Finds the entry of a subwindow.
+        /// \param[in]  subWindow   Subwindow.
+        /// \return Index of the entry, or -1 if not pooled.
+        int find(const QMdiSubWindow* subWindow) const;
+
+        /// Finds a subwindow to lend for a stream.
+        /// \param[in]  address Stream address.
+        /// \return Index of the entry, or -1 if none is available.
+        int findAvailable(const QString& address) const;
+
+        /// Destroys pipelines whose grace period has ended.
+        void expire();
+
+        /// Destroys the pipeline of an entry, making it idle.
+        /// \param[in]  entry   Pooled subwindow.
+        void destroyPipeline(Entry& entry);
+
+        /// Connects the decoder of an entry to its playback widget.
+        /// \param[in]  entry   Pooled subwindow showing a stream.
+        void connectPipeline(Entry& entry);
+
+        /// Moves the scheduler stream of an entry to the sync group of its
+        /// task, or out of any group.
+        /// \param[in]  entry   Pooled subwindow.
+        void updateSyncGroup(Entry& entry);
+
+        /// Returns the function that shows frames in a playback widget.
+        /// \param[in]  widget  Playback widget.
+        /// \return Presenter.
+        static Presenter widgetPresenter(
+            Player::Playback::PlaybackWidget* widget);
+
+        /// Gives the pipeline of an entry a memory account.
+        /// \param[in]  entry   Pooled subwindow showing a stream.
+        void attachMemoryAccount(Entry& entry);
+
+        /// Removes an entry from the HUD.
+        /// \param[in]  entry   Pooled subwindow.
+        void removeHudTile(Entry& entry);
+
+        /// Deletes idle subwindows beyond the maximum.
+        void trim();
+
+    private:
+
+        /// Area that holds the subwindows.
+        QPointer<QMdiArea> area_;
+
+        /// Pooled subwindows.
+        QVector<Entry> entries_;
+
+        /// Pipeline factory.
+        PipelineFactory pipelineFactory_;
+
+        /// HUD lent subwindows are shown in, or null.
+        QPointer<PerformanceHud> hud_;
+
+        /// Scheduler decoded frames are presented through, or null.
+        QPointer<Player::Playback::PresentationScheduler> scheduler_;
+
+        /// Thread the playback widgets render on, or null.
+        QPointer<Player::Playback::RenderThread> renderThread_;
+
+        /// Indicates whether streams of one sender task are synchronized.
+        bool taskSync_ = false;
+
+        /// Sync group identifiers by sender task.
+        QHash<QString, int> syncGroups_;
+
+        /// Grace period in milliseconds.
+        int gracePeriod_ = 10000;
+
+        /// Maximum number of idle subwindows.
+        int maximumIdle_ = 16;
+
+        /// Checks parked pipelines for the end of their grace period.
+        QTimer expiryTimer_;
+
+        /// Pool statistics.
+        Statistics statistics_;
+    };
+}
+
+#endif
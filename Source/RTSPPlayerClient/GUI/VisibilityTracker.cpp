@@ -0,0 +1,368 @@
+/// \file VisibilityTracker.cpp
+/// \brief Contains definitions of classes and functions for tracking the
+/// visibility of media subwindows.
+/// \bug No known bugs.
+
+#include "VisibilityTracker.hpp"
+
+#include <QEvent>
+#include <QMdiArea>
+#include <QMdiSubWindow>
+#include <QRegion>
+
+namespace {
+
+    /// Returns the index of an activity.
+    /// \param[in]  activity    Decoding activity.
+    /// \return Activity index.
+    int indexOf(Decoders::VideoDecoder::Activity activity) {
+        return static_cast<int>(activity);
+    }
+
+    /// Returns the content rectangle of a subwindow.
+    /// \param[in]  subWindow   Subwindow.
+    /// \return Content rectangle in area viewport coordinates.
+    QRect contentRect(const QMdiSubWindow* subWindow) {
+        auto widget = subWindow->widget();
+        if (!widget) return subWindow->geometry();
+
+        return QRect(widget->mapTo(subWindow, QPoint()), widget->size())
+            .translated(subWindow->pos());
+    }
+}
+
+/// A namespace that contains GUI classes and functions.
+namespace GUI {
+
+    /// Constructs a visibility tracker.
+    /// \details Watches the area, its viewport and its window for changes.
+    /// \param[in]  area    Area that holds the subwindows.
+    /// \param[in]  parent  Parent object.
+    VisibilityTracker::VisibilityTracker(QMdiArea* area, QObject* parent) :
+        QObject(parent),
+        area_(area)
+    {
+        updateTimer_.setSingleShot(true);
+        updateTimer_.setInterval(0);
+        connect(&updateTimer_, &QTimer::timeout,
+                this, &VisibilityTracker::update);
+
+        area->installEventFilter(this);
+        area->viewport()->installEventFilter(this);
+        area->window()->installEventFilter(this);
+
+        connect(area, &QMdiArea::subWindowActivated,
+                this, &VisibilityTracker::scheduleUpdate);
+    }
+
+    /// Destroys the visibility tracker.
+    VisibilityTracker::~VisibilityTracker()
+    {
+
+    }
+
+    /// Starts tracking a subwindow.
+    /// \details The stream starts at full activity and follows the
+    /// visibility from the next update on.
+    /// \param[in]  subWindow   Subwindow of the area.
+    /// \param[in]  decoder     Decoder of the stream shown in the
+    ///                         subwindow, or null if it has none yet.
+    void VisibilityTracker::track(QMdiSubWindow* subWindow,
+                                  Decoders::VideoDecoder* decoder)
+    {
+        if (streams_.contains(subWindow)) {
+            auto& stream = streams_[subWindow];
+            stream.decoder = decoder;
+            if (enabled_) setOutputSize(stream);
+            setActivity(subWindow, stream, stream.activity);
+            return;
+        }
+
+        auto& stream = streams_[subWindow];
+        stream.decoder = decoder;
+        stream.activityTimer.start();
+
+        stream.graceTimer = new QTimer(this);
+        stream.graceTimer->setSingleShot(true);
+        connect(stream.graceTimer, &QTimer::timeout, this, [this, subWindow] {
+            auto stream = streams_.find(subWindow);
+            if (stream != streams_.end() && !stream->visible)
+                setActivity(subWindow, *stream, Activity::KeyframesOnly);
+        });
+
+        subWindow->installEventFilter(this);
+        connect(subWindow, &QObject::destroyed, this, [this, subWindow] {
+            untrack(subWindow);
+        });
+
+        scheduleUpdate();
+    }
+
+    /// Stops tracking a subwindow.
+    /// \details Leaves the stream at full activity and full size.
+    /// \param[in]  subWindow   Subwindow of the area.
+    void VisibilityTracker::untrack(QMdiSubWindow* subWindow)
+    {
+        auto stream = streams_.find(subWindow);
+        if (stream == streams_.end()) return;
+
+        stream->visibleSize = QSize();
+        setOutputSize(*stream);
+        setActivity(subWindow, *stream, Activity::Full);
+        delete stream->graceTimer;
+        streams_.erase(stream);
+
+        subWindow->removeEventFilter(this);
+        disconnect(subWindow, &QObject::destroyed, this, nullptr);
+    }
+
+    /// Returns the grace period before keyframes only activity.
+    /// \return Grace period in milliseconds.
+    int VisibilityTracker::gracePeriod() const
+    {
+        return gracePeriod_;
+    }
+
+    /// Sets the grace period before keyframes only activity.
+    /// \details Applies to streams hidden from now on.
+    /// \param[in]  milliseconds    Grace period in milliseconds.
+    void VisibilityTracker::setGracePeriod(int milliseconds)
+    {
+        gracePeriod_ = qMax(0, milliseconds);
+    }
+
+    /// Indicates whether streams are throttled.
+    /// \retval true if streams are throttled.
+    /// \retval false if every stream is treated as visible.
+    bool VisibilityTracker::isEnabled() const
+    {
+        return enabled_;
+    }
+
+    /// Enables or disables throttling.
+    /// \details Disabled while the streams are shown elsewhere, such as in
+    /// the mosaic view, where the subwindows are hidden but the streams are
+    /// not. The decoder output size is then left to the view showing them
+    /// and applied again once throttling is enabled.
+    /// \param[in]  enabled Indicates whether streams are throttled.
+    void VisibilityTracker::setEnabled(bool enabled)
+    {
+        if (enabled && !enabled_) {
+            for (auto& stream : streams_)
+                stream.visibleSize = QSize();
+        }
+
+        enabled_ = enabled;
+        scheduleUpdate();
+    }
+
+    /// Indicates whether any part of a subwindow content is on screen.
+    /// \param[in]  subWindow   Subwindow of the area.
+    /// \retval true if the content is visible.
+    /// \retval false otherwise.
+    bool VisibilityTracker::isVisible(QMdiSubWindow* subWindow) const
+    {
+        return streams_.value(subWindow).visible;
+    }
+
+    /// Returns the on screen size of a subwindow content.
+    /// \param[in]  subWindow   Subwindow of the area.
+    /// \return Size in device pixels, or an empty size if hidden.
+    QSize VisibilityTracker::visibleSize(QMdiSubWindow* subWindow) const
+    {
+        return streams_.value(subWindow).visibleSize;
+    }
+
+    /// Returns the decoding activity of a subwindow stream.
+    /// \param[in]  subWindow   Subwindow of the area.
+    /// \return Decoding activity.
+    VisibilityTracker::Activity
+    VisibilityTracker::activity(QMdiSubWindow* subWindow) const
+    {
+        return streams_.value(subWindow).activity;
+    }
+
+    /// Returns the usage of a subwindow stream per activity.
+    /// \details Decoding time comes from the decoder, which accounts it
+    /// to the activity it was decoding at.
+    /// \param[in]  subWindow   Subwindow of the area.
+    /// \return Usage per activity.
+    VisibilityTracker::Statistics
+    VisibilityTracker::statistics(QMdiSubWindow* subWindow) const
+    {
+        Statistics statistics;
+
+        auto stream = streams_.constFind(subWindow);
+        if (stream == streams_.constEnd()) return statistics;
+
+        quint64 wallTime[3] {
+            stream->activityTime[0],
+            stream->activityTime[1],
+            stream->activityTime[2]
+        };
+
+        wallTime[indexOf(stream->activity)] +=
+            static_cast<quint64>(stream->activityTimer.nsecsElapsed() / 1000);
+
+        statistics.full.wallTime = wallTime[indexOf(Activity::Full)];
+        statistics.decodeOnly.wallTime =
+            wallTime[indexOf(Activity::DecodeOnly)];
+        statistics.keyframesOnly.wallTime =
+            wallTime[indexOf(Activity::KeyframesOnly)];
+
+        if (stream->decoder) {
+            auto decoding = stream->decoder->statistics();
+            statistics.full.cpuTime = decoding.fullTime;
+            statistics.decodeOnly.cpuTime = decoding.decodeOnlyTime;
+            statistics.keyframesOnly.cpuTime = decoding.keyframesOnlyTime;
+        }
+
+        return statistics;
+    }
+
+    /// Schedules an update on events that move, resize, restack, show or
+    /// hide subwindows.
+    /// \param[in]  watched Watched object.
+    /// \param[in]  event   Event.
+    /// \retval false to let the event through.
+    bool VisibilityTracker::eventFilter(QObject* watched, QEvent* event)
+    {
+        switch (event->type()) {
+        case QEvent::Show:
+        case QEvent::Hide:
+        case QEvent::Move:
+        case QEvent::Resize:
+        case QEvent::WindowStateChange:
+        case QEvent::ZOrderChange:
+            scheduleUpdate();
+            break;
+        default:
+            break;
+        }
+
+        return QObject::eventFilter(watched, event);
+    }
+
+    /// Coalesces updates into one per event loop iteration.
+    void VisibilityTracker::scheduleUpdate()
+    {
+        if (!updateTimer_.isActive())
+            updateTimer_.start();
+    }
+
+    /// Recomputes the visibility of every tracked subwindow.
+    /// \details Walks the subwindows from top to bottom, subtracting the
+    /// area each one covers from the viewport. A subwindow whose content
+    /// has nothing left is hidden. Minimized subwindows are reduced to a
+    /// title bar, so they cover it but never count as visible.
+    void VisibilityTracker::update()
+    {
+        if (!area_) return;
+
+        auto areaVisible = area_->isVisible() &&
+                           !area_->window()->isMinimized();
+
+        QRegion uncovered(area_->viewport()->rect());
+        auto subWindows = area_->subWindowList(QMdiArea::StackingOrder);
+
+        for (auto index = subWindows.size() - 1; index >= 0; --index) {
+            auto subWindow = subWindows[index];
+
+            if (!subWindow->isVisibleTo(area_)) continue;
+
+            auto content = contentRect(subWindow);
+            auto visible = !enabled_ ||
+                           (areaVisible &&
+                            !subWindow->isMinimized() &&
+                            !subWindow->isShaded() &&
+                            uncovered.intersects(content));
+
+            uncovered -= subWindow->geometry();
+
+            auto stream = streams_.find(subWindow);
+            if (stream == streams_.end()) continue;
+
+            auto size = visible
+                ? content.size() * subWindow->devicePixelRatioF()
+                : QSize();
+
+            if (stream->visible == visible && stream->visibleSize == size)
+                continue;
+
+            auto shown = visible && !stream->visible;
+            auto hidden = !visible && stream->visible;
+
+            stream->visible = visible;
+            stream->visibleSize = size;
+
+            if (visible && enabled_) setOutputSize(*stream);
+
+            if (shown) {
+                stream->graceTimer->stop();
+                setActivity(subWindow, *stream, Activity::Full);
+            }
+            else if (hidden) {
+                setActivity(subWindow, *stream, Activity::DecodeOnly);
+                stream->graceTimer->start(gracePeriod_);
+            }
+
+            emit visibilityChanged(subWindow, visible, size);
+        }
+
+        for (auto stream = streams_.begin(); stream != streams_.end(); ++stream) {
+            if (!enabled_ || stream.key()->isVisibleTo(area_) ||
+                !stream->visible)
+                continue;
+
+            stream->visible = false;
+            stream->visibleSize = QSize();
+            setActivity(stream.key(), *stream, Activity::DecodeOnly);
+            stream->graceTimer->start(gracePeriod_);
+
+            emit visibilityChanged(stream.key(), false, QSize());
+        }
+    }
+
+    /// Applies a decoding activity to a stream.
+    /// \details The decoder may live on another thread, so the activity is
+    /// set through its event loop.
+    /// \param[in]  subWindow   Subwindow of the area.
+    /// \param[in]  stream      Stream state.
+    /// \param[in]  activity    Decoding activity.
+    void VisibilityTracker::setActivity(QMdiSubWindow* subWindow,
+                                        Stream& stream,
+                                        Activity activity)
+    {
+        if (stream.decoder) {
+            auto decoder = stream.decoder.data();
+            QMetaObject::invokeMethod(decoder, [decoder, activity] {
+                decoder->setActivity(activity);
+            });
+        }
+
+        if (stream.activity == activity) return;
+
+        stream.activityTime[indexOf(stream.activity)] +=
+            static_cast<quint64>(stream.activityTimer.nsecsElapsed() / 1000);
+        stream.activityTimer.restart();
+        stream.activity = activity;
+
+        emit activityChanged(subWindow, activity);
+    }
+
+    /// Applies the on screen size to a stream decoder.
+    /// \details Hidden streams keep their last size, which is only replaced
+    /// when they are shown again, before frames are converted at full
+    /// activity.
+    /// \param[in]  stream      Stream state.
+    void VisibilityTracker::setOutputSize(const Stream& stream)
+    {
+        if (!stream.decoder) return;
+
+        auto decoder = stream.decoder.data();
+        auto size = stream.visibleSize;
+        QMetaObject::invokeMethod(decoder, [decoder, size] {
+            decoder->setOutputSize(size);
+        });
+    }
+}
@@ -0,0 +1,220 @@
+/// \file VisibilityTracker.hpp
+/// \brief Contains declarations of classes and functions for tracking the
+/// visibility of media subwindows.
+/// \bug No known bugs.
+
+#ifndef VISIBILITYTRACKER_HPP
+#define VISIBILITYTRACKER_HPP
+
+#include "Playback/Decoding/VideoDecoder.hpp"
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QObject>
+#include <QPointer>
+#include <QSize>
+#include <QTimer>
+
+class QMdiArea;
+class QMdiSubWindow;
+
+/// A namespace that contains GUI classes and functions.
+namespace GUI {
+
+    /// A class that throttles stream pipelines by subwindow visibility.
+    /// \details Watches a multiple document interface area and decides for
+    /// every tracked subwindow whether any part of its content is on screen.
+    /// A subwindow is hidden when the area or its window is hidden or
+    /// minimized, when the subwindow is minimized or shaded, when it lies
+    /// outside the viewport, or when subwindows above it cover it entirely.
+    /// Hidden streams drop to decode only activity at once, which stops
+    /// conversion and upload, and to keyframes only activity after the grace
+    /// period. Visible streams return to full activity at once, and their
+    /// decoders scale output down to the on screen size.
+    class VisibilityTracker : public QObject {
+
+        Q_OBJECT
+
+    public:
+
+        /// Decoding activity.
+        using Activity = Decoders::VideoDecoder::Activity;
+
+        /// A structure that contains the usage of one activity.
+        struct Usage {
+
+            /// Time spent in the activity in microseconds.
+            quint64 wallTime = 0;
+
+            /// Decoding time spent in the activity in microseconds.
+            quint64 cpuTime = 0;
+        };
+
+        /// A structure that contains the usage of a stream per activity.
+        struct Statistics {
+
+            /// Usage at full activity.
+            Usage full;
+
+            /// Usage at decode only activity.
+            Usage decodeOnly;
+
+            /// Usage at keyframes only activity.
+            Usage keyframesOnly;
+        };
+
+    public:
+
+        /// Constructs a visibility tracker.
+        /// \param[in]  area    Area that holds the subwindows.
+        /// \param[in]  parent  Parent object.
+        explicit VisibilityTracker(QMdiArea* area, QObject* parent = nullptr);
+
+        /// Destroys the visibility tracker.
+        virtual ~VisibilityTracker();
+
+    public:
+
+        /// Starts tracking a subwindow.
+        /// \param[in]  subWindow   Subwindow of the area.
+        /// \param[in]  decoder     Decoder of the stream shown in the
+        ///                         subwindow, or null if it has none yet.
+        void track(QMdiSubWindow* subWindow,
+                   Decoders::VideoDecoder* decoder = nullptr);
+
+        /// Stops tracking a subwindow.
+        /// \param[in]  subWindow   Subwindow of the area.
+        void untrack(QMdiSubWindow* subWindow);
+
+        /// Returns the grace period before keyframes only activity.
+        /// \return Grace period in milliseconds.
+        int gracePeriod() const;
+
+        /// Sets the grace period before keyframes only activity.
+        /// \param[in]  milliseconds    Grace period in milliseconds.
+        void setGracePeriod(int milliseconds);
+
+        /// Indicates whether streams are throttled.
+        /// \retval true if streams are throttled.
+        /// \retval false if every stream is treated as visible.
+        bool isEnabled() const;
+
+        /// Enables or disables throttling.
+        /// \param[in]  enabled Indicates whether streams are throttled.
+        void setEnabled(bool enabled);
+
+        /// Indicates whether any part of a subwindow content is on screen.
+        /// \param[in]  subWindow   Subwindow of the area.
+        /// \retval true if the content is visible.
+        /// \retval false otherwise.
+        bool isVisible(QMdiSubWindow* subWindow) const;
+
+        /// Returns the on screen size of a subwindow content.
+        /// \param[in]  subWindow   Subwindow of the area.
+        /// \return Size in device pixels, or an empty size if hidden.
+        QSize visibleSize(QMdiSubWindow* subWindow) const;
+
+        /// Returns the decoding activity of a subwindow stream.
+        /// \param[in]  subWindow   Subwindow of the area.
+        /// \return Decoding activity.
+        Activity activity(QMdiSubWindow* subWindow) const;
+
+        /// Returns the usage of a subwindow stream per activity.
+        /// \details Decoding time comes from the decoder, which accounts it
+        /// to the activity it was decoding at.
+        /// \param[in]  subWindow   Subwindow of the area.
+        /// \return Usage per activity.
+        Statistics statistics(QMdiSubWindow* subWindow) const;
+
+    signals:
+
+        /// Signals that a subwindow was shown, hidden or resized on screen.
+        /// \param[in]  subWindow   Subwindow of the area.
+        /// \param[in]  visible     Indicates whether the content is visible.
+        /// \param[in]  size        On screen size in device pixels.
+        void visibilityChanged(QMdiSubWindow* subWindow,
+                               bool visible,
+                               const QSize& size);
+
+        /// Signals that a subwindow stream changed its decoding activity.
+        /// \param[in]  subWindow   Subwindow of the area.
+        /// \param[in]  activity    Decoding activity.
+        void activityChanged(QMdiSubWindow* subWindow,
+                             Decoders::VideoDecoder::Activity activity);
+
+    protected:
+
+        /// Schedules an update on events that move, resize, restack, show or
+        /// hide subwindows.
+        /// \param[in]  watched Watched object.
+        /// \param[in]  event   Event.
+        /// \retval false to let the event through.
+        bool eventFilter(QObject* watched, QEvent* event) override;
+
+    private:
+
+        /// A structure that contains the state of a tracked subwindow.
+        struct Stream {
+
+            /// Decoder of the stream.
+            QPointer<Decoders::VideoDecoder> decoder;
+
+            /// Indicates whether the content is visible.
+            bool visible = true;
+
+            /// On screen size in device pixels.
+            QSize visibleSize;
+
+            /// Decoding activity.
+            Activity activity = Activity::Full;
+
+            /// Measures the time spent in the current activity.
+            QElapsedTimer activityTimer;
+
+            /// Time spent in earlier periods per activity in microseconds.
+            quint64 activityTime[3] { };
+
+            /// Fires when the grace period of a hidden stream ends.
+            QTimer* graceTimer = nullptr;
+        };
+
+    private:
+
+        /// Coalesces updates into one per event loop iteration.
+        void scheduleUpdate();
+
+        /// Recomputes the visibility of every tracked subwindow.
+        void update();
+
+        /// Applies a decoding activity to a stream.
+        /// \param[in]  subWindow   Subwindow of the area.
+        /// \param[in]  stream      Stream state.
+        /// \param[in]  activity    Decoding activity.
+        void setActivity(QMdiSubWindow* subWindow,
+                         Stream& stream,
+                         Activity activity);
+
+        /// Applies the on screen size to a stream decoder.
+        /// \param[in]  stream      Stream state.
+        void setOutputSize(const Stream& stream);
+
+    private:
+
+        /// Area that holds the subwindows.
+        QPointer<QMdiArea> area_;
+
+        /// Tracked subwindows.
+        QHash<QMdiSubWindow*, Stream> streams_;
+
+        /// Grace period before keyframes only activity in milliseconds.
+        int gracePeriod_ = 3000;
+
+        /// Indicates whether streams are throttled.
+        bool enabled_ = true;
+
+        /// Coalesces updates.
+        QTimer updateTimer_;
+    };
+}
+
+#endif
@@ -2,21 +2,155 @@
 /// \brief Contains entry point to the application.
 /// \bug No known bugs.
 
+#include "ClientBenchmark.hpp"
 #include "MainWindow.hpp"
 
+#include "Base/Utility/ThreadAffinity.hpp"
+
 #include <QApplication>
+#include <QCommandLineParser>
+
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+    /// Indicates whether the benchmark mode is requested.
+    /// \details Scans arguments before the application object exists, so
+    /// that platform defaults can still be changed.
+    /// \param[in]  argc    Number of arguments passed to the program.
+    /// \param[in]  argv    An array of pointers to the arguments passed to the
+    ///                     program.
+    /// \retval true if the benchmark mode is requested.
+    /// \retval false otherwise.
+    bool isBenchmarkRequested(int argc, char *argv[]) {
+        for (auto i = 1; i < argc; ++i) {
+            if (std::strcmp(argv[i], "--benchmark") == 0) return true;
+        }
+        return false;
+    }
+
+    /// Applies the thread affinity options.
+    /// \details Threads float unless pinning is requested. SCHED_FIFO for
+    /// IO threads only applies with pinning and is skipped where the system
+    /// refuses it.
+    /// \param[in]  parser  Parsed command line.
+    void configureAffinity(const QCommandLineParser& parser) {
+        if (!parser.isSet("pin-threads")) return;
+
+        auto policy = Common::Utility::ThreadAffinity::detectPolicy();
+        policy.realtimeIo = parser.isSet("realtime-io");
+
+        Common::Utility::ThreadAffinity::instance().setPolicy(policy);
+    }
+
+    /// Runs the client rendering benchmark.
+    /// \details Defaults to the offscreen platform and Mesa software
+    /// rendering, so it runs without a display or GPU.
+    /// \param[in]  app     Application object.
+    /// \param[in]  parser  Parsed command line.
+    /// \return Exit status.
+    int runBenchmark(QApplication& app, const QCommandLineParser& parser) {
+        GUI::ClientBenchmark::Options options;
+        options.tiles = parser.value("tiles").toInt();
+        options.fps = parser.value("fps").toDouble();
+        options.duration = parser.value("duration").toDouble();
+        options.renderThread = parser.isSet("render-thread");
+        options.scheduler = parser.isSet("scheduler");
+        options.hud = parser.isSet("hud");
+        options.programBinaries = !parser.isSet("no-program-binaries");
+
+        auto size = parser.value("resolution").split('x');
+        if (size.size() == 2)
+            options.frameSize = QSize(size[0].toInt(), size[1].toInt());
+
+        GUI::ClientBenchmark benchmark(options);
+        QObject::connect(&benchmark, &GUI::ClientBenchmark::finished,
+                         &app, &QApplication::quit);
+
+        benchmark.start();
+        return app.exec();
+    }
+}
 
 /// Runs the main application thread.
-/// \details Starts the main application window.
+/// \details Starts the main application window, or the rendering benchmark
+/// if \c --benchmark is given. GL contexts share resources, so that frames
+/// rendered on the render thread can be composited by the playback widgets.
+/// The main thread runs in the GUI role.
 /// \param[in]  argc    Number of arguments passed to the program.
 /// \param[in]  argv    An array of pointers to the arguments passed to the
 ///                     program.
 /// \return Exit status.
 int main(int argc, char *argv[]) {
+    if (isBenchmarkRequested(argc, argv)) {
+        if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+            qputenv("QT_QPA_PLATFORM", "offscreen");
+
+        if (qEnvironmentVariableIsEmpty("LIBGL_ALWAYS_SOFTWARE"))
+            qputenv("LIBGL_ALWAYS_SOFTWARE", "1");
+    }
+
+    QApplication::setAttribute(Qt::AA_ShareOpenGLContexts);
     QApplication app(argc, argv);
 
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    parser.addOption(QCommandLineOption("benchmark",
+                                        "Runs the rendering benchmark."));
+    parser.addOption(QCommandLineOption("tiles",
+                                        "Number of benchmark tiles.",
+                                        "count",
+                                        "16"));
+    parser.addOption(QCommandLineOption("fps",
+                                        "Frames per second fed to each tile.",
+                                        "rate",
+                                        "25"));
+    parser.addOption(QCommandLineOption("resolution",
+                                        "Benchmark frame size.",
+                                        "WxH",
+                                        "1280x720"));
+    parser.addOption(QCommandLineOption("duration",
+                                        "Benchmark duration in seconds.",
+                                        "seconds",
+                                        "10"));
+    parser.addOption(QCommandLineOption("render-thread",
+                                        "Renders benchmark tiles on a render "
+                                        "thread."));
+    parser.addOption(QCommandLineOption("scheduler",
+                                        "Paces benchmark tiles with the "
+                                        "presentation scheduler."));
+    parser.addOption(QCommandLineOption("hud",
+                                        "Shows the performance HUD over "
+                                        "benchmark tiles."));
+    parser.addOption(QCommandLineOption("no-program-binaries",
+                                        "Neither stores nor loads GL program "
+                                        "binaries."));
+    parser.addOption(QCommandLineOption("port",
+                                        "UDP port streams are received on.",
+                                        "port",
+                                        "5000"));
+    parser.addOption(QCommandLineOption("pin-threads",
+                                        "Pins IO, decoding, render and GUI "
+                                        "threads to their processors."));
+    parser.addOption(QCommandLineOption("realtime-io",
+                                        "Runs pinned IO threads with "
+                                        "SCHED_FIFO where permitted."));
+    parser.process(app);
+
+    configureAffinity(parser);
+    Common::Utility::ScopedThreadRole guiRole(Common::Utility::ThreadRole::Gui);
+
+    if (parser.isSet("benchmark"))
+        return runBenchmark(app, parser);
+
     MainWindow mainWindow;
     mainWindow.show();
 
+    auto port = parser.value("port").toUShort();
+    if (!mainWindow.listen(port))
+        std::fprintf(stderr, "Failed to receive streams on port %u\n",
+                     static_cast<unsigned>(port));
+
     return app.exec();
 }
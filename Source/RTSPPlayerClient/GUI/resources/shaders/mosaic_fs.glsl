@@ -0,0 +1,12 @@
+in 			vec3 				texture_coord_out	;
+in 			vec2 				texture_limit_out	;
+out 		vec4 				color_out			;
+uniform 	sampler2DArray 		tiles				;
+
+void main(void) {
+	vec2 half_texel 	= 0.5 / vec2(textureSize(tiles, 0).xy)						;
+	vec2 coord 			= clamp(texture_coord_out.xy,
+								half_texel,
+								texture_limit_out - half_texel)					;
+	color_out 			= texture(tiles, vec3(coord, texture_coord_out.z))	;
+}
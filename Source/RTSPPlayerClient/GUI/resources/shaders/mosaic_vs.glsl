@@ -0,0 +1,13 @@
+in 			vec2 	vertex_coord_in		;
+in 			vec4 	tile_rect_in		;
+in 			vec3 	tile_texture_in		;
+out 		vec3 	texture_coord_out	;
+out 		vec2 	texture_limit_out	;
+
+void main(void) {
+	gl_Position 		= vec4(tile_rect_in.xy + vertex_coord_in * tile_rect_in.zw, 0.0, 1.0)	;
+	texture_coord_out 	= vec3(vertex_coord_in.x * tile_texture_in.x,
+							   (1.0 - vertex_coord_in.y) * tile_texture_in.y,
+							   tile_texture_in.z)											;
+	texture_limit_out 	= tile_texture_in.xy														;
+}
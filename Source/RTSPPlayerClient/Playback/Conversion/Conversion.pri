@@ -0,0 +1,11 @@
+#------------------------------------------------------------------------------#
+#                             Project files settings                           #
+#------------------------------------------------------------------------------#
+
+HEADERS			+=															\
+						$$PWD/ConversionKernels.hpp							\
+						$$PWD/ScalerCache.hpp								\
+
+SOURCES			+=															\
+						$$PWD/ConversionKernels.cpp							\
+						$$PWD/ScalerCache.cpp								\
@@ -0,0 +1,1138 @@
+/// \file ConversionKernels.cpp
+/// \brief Contains classes and functions definitions that provide pixel
+/// conversion kernels.
+/// \bug No known bugs.
+
+#include "ConversionKernels.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#if defined (__x86_64__) || defined (_M_X64) || \
+	defined (__i386__) || defined (_M_IX86)
+	#define CONVERSION_X86 1
+	#include <immintrin.h>
+	#if defined (_MSC_VER)
+		#include <intrin.h>
+	#endif
+#else
+	#define CONVERSION_X86 0
+#endif
+
+#if CONVERSION_X86 && (defined (__GNUC__) || defined (__clang__))
+	#define CONVERSION_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+	#define CONVERSION_TARGET_AVX2
+#endif
+
+namespace {
+
+	/// Luma scale of limited range BT.601 conversion, out of 16384.
+	constexpr int LUMA_SCALE = 19078;
+
+	/// Red weight of V, out of 16384.
+	constexpr int RED_V = 26149;
+
+	/// Green weight of U, out of 16384.
+	constexpr int GREEN_U = 6419;
+
+	/// Green weight of V, out of 16384.
+	constexpr int GREEN_V = 13320;
+
+	/// Blue weight of U minus one, out of 16384.
+	/// \details The full weight exceeds the 16-bit range, so one is added
+	/// separately.
+	constexpr int BLUE_U = 16666;
+
+	/// Multiplies 16-bit values with rounding, like \c pmulhrsw.
+	/// \param[in]	value	Value.
+	/// \param[in]	weight	Weight, out of 32768.
+	/// \return Product.
+	inline int multiplyRounded(int value, int weight) noexcept {
+		return (value * weight + 0x4000) >> 15;
+	}
+
+	/// Adds 16-bit values with saturation, like \c paddsw.
+	/// \param[in]	first	First value.
+	/// \param[in]	second	Second value.
+	/// \return Saturated sum.
+	inline int addSaturated(int first, int second) noexcept {
+		return std::min(std::max(first + second, -32768), 32767);
+	}
+
+	/// Converts a YUV pixel to RGB.
+	/// \details Uses limited range BT.601 coefficients in the same 16-bit
+	/// fixed point steps as the AVX2 code, so both give identical results.
+	/// \param[in]	y		Luma value.
+	/// \param[in]	u		U value.
+	/// \param[in]	v		V value.
+	/// \param[out]	pixel	Target pixel.
+	/// \param[in]	layout	Target byte order.
+	inline void convertPixelScalar(int y,
+								   int u,
+								   int v,
+								   std::uint8_t* pixel,
+								   Conversion::RgbLayout layout) noexcept {
+
+		auto luma = multiplyRounded((y - 16) * 128, LUMA_SCALE);
+		auto blue = (u - 128) * 128;
+		auto red = (v - 128) * 128;
+
+		int channels[3] {
+			addSaturated(luma, multiplyRounded(red, RED_V)),
+			addSaturated(addSaturated(luma, -multiplyRounded(blue, GREEN_U)),
+						 -multiplyRounded(red, GREEN_V)),
+			addSaturated(addSaturated(luma, multiplyRounded(blue, BLUE_U)),
+						 blue >> 1),
+		};
+
+		for (auto& channel : channels)
+			channel = std::min(
+				std::max(addSaturated(channel, 32) >> 6, 0), 255);
+
+		auto bgra = layout == Conversion::RgbLayout::BGRA;
+
+		pixel[0] = static_cast<std::uint8_t>(channels[bgra ? 2 : 0]);
+		pixel[1] = static_cast<std::uint8_t>(channels[1]);
+		pixel[2] = static_cast<std::uint8_t>(channels[bgra ? 0 : 2]);
+
+		if (layout != Conversion::RgbLayout::RGB24)
+			pixel[3] = 0xFF;
+	}
+
+	/// Converts a YUV 4:2:0 row to RGB.
+	/// \param[in]	luma	Luma row.
+	/// \param[in]	lower	Luma row below, when halving.
+	/// \param[in]	u		U row, or UV row if interleaved.
+	/// \param[in]	v		V row, ignored if interleaved.
+	/// \param[in]	chroma	Chroma layout.
+	/// \param[out]	target	Target row.
+	/// \param[in]	layout	Target byte order.
+	/// \param[in]	halve	Indicates whether the row is halved.
+	/// \param[in]	begin	First target pixel.
+	/// \param[in]	end		Target pixel after the last one.
+	inline void convertRowScalar(const std::uint8_t* luma,
+								 const std::uint8_t* lower,
+								 const std::uint8_t* u,
+								 const std::uint8_t* v,
+								 Conversion::ChromaLayout chroma,
+								 std::uint8_t* target,
+								 Conversion::RgbLayout layout,
+								 bool halve,
+								 int begin,
+								 int end) noexcept {
+
+		auto pixelSize = layout == Conversion::RgbLayout::RGB24 ? 3 : 4;
+		auto interleaved = chroma == Conversion::ChromaLayout::Interleaved;
+
+		for (auto x = begin; x < end; ++x) {
+			auto column = halve ? x : x >> 1;
+			auto y = static_cast<int>(luma[x]);
+
+			if (halve) {
+				y = ((luma[2 * x] + lower[2 * x] + 1) >> 1) +
+					((luma[2 * x + 1] + lower[2 * x + 1] + 1) >> 1);
+				y = (y + 1) >> 1;
+			}
+
+			convertPixelScalar(y,
+							   interleaved ? u[2 * column] : u[column],
+							   interleaved ? u[2 * column + 1] : v[column],
+							   target + x * pixelSize,
+							   layout);
+		}
+	}
+
+	/// Expands a limited range luma value to the full range.
+	/// \details Uses the fixed point steps of the luma in convertPixelScalar(),
+	/// which the AVX2 code repeats.
+	/// \param[in]	y	Luma value.
+	/// \return Expanded value.
+	inline int expandLuma(int y) noexcept {
+		auto luma = multiplyRounded((y - 16) * 128, LUMA_SCALE);
+		return std::min(std::max(addSaturated(luma, 32) >> 6, 0), 255);
+	}
+
+	/// Expands a limited range luma row to the full range.
+	/// \param[in]	source	Source row.
+	/// \param[out]	target	Target row.
+	/// \param[in]	begin	First pixel to convert.
+	/// \param[in]	end		Pixel after the last one to convert.
+	inline void expandRowScalar(const std::uint8_t* source,
+								std::uint8_t* target,
+								int begin,
+								int end) noexcept {
+
+		for (auto x = begin; x < end; ++x)
+			target[x] = static_cast<std::uint8_t>(expandLuma(source[x]));
+	}
+
+	/// Widens an 8-bit grayscale row to 16 bits.
+	/// \param[in]	source			Source row.
+	/// \param[out]	target			Target row.
+	/// \param[in]	begin			First pixel to convert.
+	/// \param[in]	end				Pixel after the last one to convert.
+	/// \param[in]	limitedRange	Indicates whether the row is limited
+	///								range luma.
+	inline void widenRowScalar(const std::uint8_t* source,
+							   std::uint16_t* target,
+							   int begin,
+							   int end,
+							   bool limitedRange) noexcept {
+
+		for (auto x = begin; x < end; ++x) {
+			auto value = limitedRange ? expandLuma(source[x]) : source[x];
+			target[x] = static_cast<std::uint16_t>(value * 257);
+		}
+	}
+
+	/// Finds the limited range luma threshold of a full range threshold.
+	/// \param[in]	threshold	Full range threshold.
+	/// \return Smallest luma value whose expansion reaches the threshold.
+	inline std::uint8_t limitedThreshold(std::uint8_t threshold) noexcept {
+		auto y = 0;
+		while (y < 255 && expandLuma(y) < threshold) ++y;
+
+		return static_cast<std::uint8_t>(y);
+	}
+
+	/// Thresholds an 8-bit grayscale row to a 1-bit row.
+	/// \details Starts at a byte boundary of the target row.
+	/// \param[in]	source		Source row.
+	/// \param[out]	target		Target row.
+	/// \param[in]	begin		First pixel to convert, a multiple of 8.
+	/// \param[in]	end			Pixel after the last one to convert.
+	/// \param[in]	threshold	Threshold value.
+	inline void thresholdRowScalar(const std::uint8_t* source,
+								   std::uint8_t* target,
+								   int begin,
+								   int end,
+								   std::uint8_t threshold) noexcept {
+
+		for (auto x = begin; x < end; x += 8) {
+			std::uint8_t bits = 0;
+
+			for (auto bit = 0; bit < 8 && x + bit < end; ++bit) {
+				if (source[x + bit] >= threshold)
+					bits |= static_cast<std::uint8_t>(0x80 >> bit);
+			}
+
+			target[x / 8] = bits;
+		}
+	}
+
+	/// Averages two values, rounding up.
+	/// \param[in]	first	First value.
+	/// \param[in]	second	Second value.
+	/// \return Average value.
+	inline std::uint8_t average(std::uint8_t first,
+								std::uint8_t second) noexcept {
+		return static_cast<std::uint8_t>((first + second + 1) >> 1);
+	}
+
+	/// Blends two values with an 8-bit weight.
+	/// \param[in]	first	First value.
+	/// \param[in]	second	Second value.
+	/// \param[in]	weight	Weight of the second value, out of 256.
+	/// \return Blended value.
+	inline std::uint8_t blend(std::uint8_t first,
+							  std::uint8_t second,
+							  int weight) noexcept {
+
+		return static_cast<std::uint8_t>(
+			(first * (256 - weight) + second * weight + 128) >> 8);
+	}
+
+	/// Halves a pair of 32-bit pixel rows by averaging 2x2 blocks.
+	/// \param[in]	top		Upper source row.
+	/// \param[in]	bottom	Lower source row.
+	/// \param[out]	target	Target row.
+	/// \param[in]	begin	First target pixel.
+	/// \param[in]	end		Target pixel after the last one.
+	inline void halveRowScalar(const std::uint8_t* top,
+							   const std::uint8_t* bottom,
+							   std::uint8_t* target,
+							   int begin,
+							   int end) noexcept {
+
+		for (auto x = begin; x < end; ++x) {
+			for (auto channel = 0; channel < 4; ++channel) {
+				auto left = average(top[8 * x + channel],
+									bottom[8 * x + channel]);
+				auto right = average(top[8 * x + 4 + channel],
+									 bottom[8 * x + 4 + channel]);
+				target[4 * x + channel] = average(left, right);
+			}
+		}
+	}
+
+	/// Blends two rows with an 8-bit weight.
+	/// \param[in]	top		Upper row.
+	/// \param[in]	bottom	Lower row.
+	/// \param[out]	target	Target row.
+	/// \param[in]	begin	First byte.
+	/// \param[in]	end		Byte after the last one.
+	/// \param[in]	weight	Weight of the lower row, out of 256.
+	inline void blendRowsScalar(const std::uint8_t* top,
+								const std::uint8_t* bottom,
+								std::uint8_t* target,
+								int begin,
+								int end,
+								int weight) noexcept {
+
+		for (auto i = begin; i < end; ++i)
+			target[i] = blend(top[i], bottom[i], weight);
+	}
+
+	/// Resamples a 32-bit pixel row horizontally.
+	/// \param[in]	source	Source row.
+	/// \param[in]	lefts	Left source pixel of each target pixel.
+	/// \param[in]	rights	Right source pixel of each target pixel.
+	/// \param[in]	weights	Weight of the right pixel, out of 256.
+	/// \param[out]	target	Target row.
+	/// \param[in]	begin	First target pixel.
+	/// \param[in]	end		Target pixel after the last one.
+	inline void blendColumnsScalar(const std::uint8_t* source,
+								   const std::int32_t* lefts,
+								   const std::int32_t* rights,
+								   const std::int32_t* weights,
+								   std::uint8_t* target,
+								   int begin,
+								   int end) noexcept {
+
+		for (auto x = begin; x < end; ++x) {
+			auto left = source + 4 * lefts[x];
+			auto right = source + 4 * rights[x];
+
+			for (auto channel = 0; channel < 4; ++channel)
+				target[4 * x + channel] =
+					blend(left[channel], right[channel], weights[x]);
+		}
+	}
+
+#if CONVERSION_X86
+	/// Expands limited range luma words to the full range with AVX2.
+	/// \details Repeats the steps of expandLuma() but the final clamp, so
+	/// results above 255 or below 0 are left to the caller.
+	/// \param[in]	words	Luma values.
+	/// \return Expanded values.
+	CONVERSION_TARGET_AVX2
+	inline __m256i expandWordsAvx2(__m256i words) noexcept {
+		auto luma = _mm256_mulhrs_epi16(
+			_mm256_slli_epi16(_mm256_sub_epi16(words, _mm256_set1_epi16(16)),
+							  7),
+			_mm256_set1_epi16(LUMA_SCALE));
+
+		return _mm256_srai_epi16(
+			_mm256_adds_epi16(luma, _mm256_set1_epi16(32)), 6);
+	}
+
+	/// Expands a limited range luma row to the full range with AVX2.
+	/// \param[in]	source	Source row.
+	/// \param[out]	target	Target row.
+	/// \param[in]	width	Row width in pixels.
+	CONVERSION_TARGET_AVX2
+	void expandRowAvx2(const std::uint8_t* source,
+					   std::uint8_t* target,
+					   int width) noexcept {
+
+		auto x = 0;
+
+		for (; x + 32 <= width; x += 32) {
+			auto pixels = _mm256_loadu_si256(
+				reinterpret_cast<const __m256i*>(source + x));
+			auto low = expandWordsAvx2(
+				_mm256_cvtepu8_epi16(_mm256_castsi256_si128(pixels)));
+			auto high = expandWordsAvx2(
+				_mm256_cvtepu8_epi16(_mm256_extracti128_si256(pixels, 1)));
+
+			// Packing works per lane, so the quarters are put back in order.
+			auto packed = _mm256_permute4x64_epi64(
+				_mm256_packus_epi16(low, high), 0xD8);
+
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(target + x),
+								packed);
+		}
+
+		expandRowScalar(source, target, x, width);
+	}
+
+	/// Widens an 8-bit grayscale row to 16 bits with AVX2.
+	/// \param[in]	source			Source row.
+	/// \param[out]	target			Target row.
+	/// \param[in]	width			Row width in pixels.
+	/// \param[in]	limitedRange	Indicates whether the row is limited
+	///								range luma.
+	CONVERSION_TARGET_AVX2
+	void widenRowAvx2(const std::uint8_t* source,
+					  std::uint16_t* target,
+					  int width,
+					  bool limitedRange) noexcept {
+
+		auto zero = _mm256_setzero_si256();
+		auto maximum = _mm256_set1_epi16(255);
+		auto x = 0;
+
+		for (; x + 16 <= width; x += 16) {
+			auto bytes = _mm_loadu_si128(
+				reinterpret_cast<const __m128i*>(source + x));
+			auto words = _mm256_cvtepu8_epi16(bytes);
+
+			if (limitedRange) {
+				words = _mm256_min_epi16(
+					_mm256_max_epi16(expandWordsAvx2(words), zero), maximum);
+			}
+
+			words = _mm256_or_si256(words, _mm256_slli_epi16(words, 8));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(target + x), words);
+		}
+
+		widenRowScalar(source, target, x, width, limitedRange);
+	}
+
+	/// Thresholds an 8-bit grayscale row to a 1-bit row with AVX2.
+	/// \details Reverses bytes inside each 8-byte group before extracting
+	/// the comparison mask, so that the first pixel of every group lands in
+	/// the most significant bit of its target byte.
+	/// \param[in]	source		Source row.
+	/// \param[out]	target		Target row.
+	/// \param[in]	width		Row width in pixels.
+	/// \param[in]	threshold	Threshold value.
+	CONVERSION_TARGET_AVX2
+	void thresholdRowAvx2(const std::uint8_t* source,
+						  std::uint8_t* target,
+						  int width,
+						  std::uint8_t threshold) noexcept {
+
+		auto limit = _mm256_set1_epi8(static_cast<char>(threshold));
+		auto reverse = _mm256_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0,
+										15, 14, 13, 12, 11, 10, 9, 8,
+										7, 6, 5, 4, 3, 2, 1, 0,
+										15, 14, 13, 12, 11, 10, 9, 8);
+		auto x = 0;
+
+		for (; x + 32 <= width; x += 32) {
+			auto pixels = _mm256_loadu_si256(
+				reinterpret_cast<const __m256i*>(source + x));
+			auto mask = _mm256_cmpeq_epi8(_mm256_max_epu8(pixels, limit),
+										  pixels);
+			mask = _mm256_shuffle_epi8(mask, reverse);
+
+			auto bits = static_cast<std::uint32_t>(_mm256_movemask_epi8(mask));
+
+			target[x / 8 + 0] = static_cast<std::uint8_t>(bits);
+			target[x / 8 + 1] = static_cast<std::uint8_t>(bits >> 8);
+			target[x / 8 + 2] = static_cast<std::uint8_t>(bits >> 16);
+			target[x / 8 + 3] = static_cast<std::uint8_t>(bits >> 24);
+		}
+
+		thresholdRowScalar(source, target, x, width, threshold);
+	}
+
+	/// Halves a pair of 32-bit pixel rows with AVX2.
+	/// \details Averages rows first and then pixel pairs, like the scalar
+	/// code, so both give identical results.
+	/// \param[in]	top		Upper source row.
+	/// \param[in]	bottom	Lower source row.
+	/// \param[out]	target	Target row.
+	/// \param[in]	width	Target row width in pixels.
+	CONVERSION_TARGET_AVX2
+	void halveRowAvx2(const std::uint8_t* top,
+					  const std::uint8_t* bottom,
+					  std::uint8_t* target,
+					  int width) noexcept {
+
+		auto x = 0;
+
+		for (; x + 8 <= width; x += 8) {
+			auto first = _mm256_avg_epu8(
+				_mm256_loadu_si256(
+					reinterpret_cast<const __m256i*>(top + 8 * x)),
+				_mm256_loadu_si256(
+					reinterpret_cast<const __m256i*>(bottom + 8 * x)));
+			auto second = _mm256_avg_epu8(
+				_mm256_loadu_si256(
+					reinterpret_cast<const __m256i*>(top + 8 * x + 32)),
+				_mm256_loadu_si256(
+					reinterpret_cast<const __m256i*>(bottom + 8 * x + 32)));
+
+			auto even = _mm256_castps_si256(_mm256_shuffle_ps(
+				_mm256_castsi256_ps(first), _mm256_castsi256_ps(second),
+				_MM_SHUFFLE(2, 0, 2, 0)));
+			auto odd = _mm256_castps_si256(_mm256_shuffle_ps(
+				_mm256_castsi256_ps(first), _mm256_castsi256_ps(second),
+				_MM_SHUFFLE(3, 1, 3, 1)));
+
+			even = _mm256_permute4x64_epi64(even, _MM_SHUFFLE(3, 1, 2, 0));
+			odd = _mm256_permute4x64_epi64(odd, _MM_SHUFFLE(3, 1, 2, 0));
+
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(target + 4 * x),
+								_mm256_avg_epu8(even, odd));
+		}
+
+		halveRowScalar(top, bottom, target, x, width);
+	}
+
+	/// Blends 16-bit widened values with 16-bit weights.
+	/// \param[in]	first			First values.
+	/// \param[in]	second			Second values.
+	/// \param[in]	weight			Weights of the second values.
+	/// \param[in]	inverseWeight	Weights of the first values.
+	/// \return Blended values, still widened.
+	CONVERSION_TARGET_AVX2
+	inline __m256i blendWords(__m256i first,
+							  __m256i second,
+							  __m256i weight,
+							  __m256i inverseWeight) noexcept {
+
+		auto sum = _mm256_add_epi16(_mm256_mullo_epi16(first, inverseWeight),
+									_mm256_mullo_epi16(second, weight));
+		sum = _mm256_add_epi16(sum, _mm256_set1_epi16(128));
+		return _mm256_srli_epi16(sum, 8);
+	}
+
+	/// Blends two rows with an 8-bit weight with AVX2.
+	/// \param[in]	top		Upper row.
+	/// \param[in]	bottom	Lower row.
+	/// \param[out]	target	Target row.
+	/// \param[in]	size	Row size in bytes.
+	/// \param[in]	weight	Weight of the lower row, out of 256.
+	CONVERSION_TARGET_AVX2
+	void blendRowsAvx2(const std::uint8_t* top,
+					   const std::uint8_t* bottom,
+					   std::uint8_t* target,
+					   int size,
+					   int weight) noexcept {
+
+		auto zero = _mm256_setzero_si256();
+		auto lowerWeight = _mm256_set1_epi16(static_cast<short>(weight));
+		auto upperWeight = _mm256_set1_epi16(static_cast<short>(256 - weight));
+		auto i = 0;
+
+		for (; i + 32 <= size; i += 32) {
+			auto upper = _mm256_loadu_si256(
+				reinterpret_cast<const __m256i*>(top + i));
+			auto lower = _mm256_loadu_si256(
+				reinterpret_cast<const __m256i*>(bottom + i));
+
+			auto low = blendWords(_mm256_unpacklo_epi8(upper, zero),
+								  _mm256_unpacklo_epi8(lower, zero),
+								  lowerWeight,
+								  upperWeight);
+			auto high = blendWords(_mm256_unpackhi_epi8(upper, zero),
+								   _mm256_unpackhi_epi8(lower, zero),
+								   lowerWeight,
+								   upperWeight);
+
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(target + i),
+								_mm256_packus_epi16(low, high));
+		}
+
+		blendRowsScalar(top, bottom, target, i, size, weight);
+	}
+
+	/// Resamples a 32-bit pixel row horizontally with AVX2.
+	/// \details Gathers the two source pixels of eight target pixels at a
+	/// time and spreads each weight over the four channels of its pixel.
+	/// \param[in]	source	Source row.
+	/// \param[in]	lefts	Left source pixel of each target pixel.
+	/// \param[in]	rights	Right source pixel of each target pixel.
+	/// \param[in]	weights	Weight of the right pixel, out of 256.
+	/// \param[out]	target	Target row.
+	/// \param[in]	width	Target row width in pixels.
+	CONVERSION_TARGET_AVX2
+	void blendColumnsAvx2(const std::uint8_t* source,
+						  const std::int32_t* lefts,
+						  const std::int32_t* rights,
+						  const std::int32_t* weights,
+						  std::uint8_t* target,
+						  int width) noexcept {
+
+		auto pixels = reinterpret_cast<const int*>(source);
+		auto zero = _mm256_setzero_si256();
+		auto full = _mm256_set1_epi16(256);
+		auto x = 0;
+
+		for (; x + 8 <= width; x += 8) {
+			auto left = _mm256_i32gather_epi32(
+				pixels,
+				_mm256_loadu_si256(reinterpret_cast<const __m256i*>(lefts + x)),
+				4);
+			auto right = _mm256_i32gather_epi32(
+				pixels,
+				_mm256_loadu_si256(
+					reinterpret_cast<const __m256i*>(rights + x)),
+				4);
+
+			auto weight = _mm256_loadu_si256(
+				reinterpret_cast<const __m256i*>(weights + x));
+			weight = _mm256_or_si256(weight, _mm256_slli_epi32(weight, 16));
+
+			auto lowWeight = _mm256_unpacklo_epi32(weight, weight);
+			auto highWeight = _mm256_unpackhi_epi32(weight, weight);
+
+			auto low = blendWords(_mm256_unpacklo_epi8(left, zero),
+								  _mm256_unpacklo_epi8(right, zero),
+								  lowWeight,
+								  _mm256_sub_epi16(full, lowWeight));
+			auto high = blendWords(_mm256_unpackhi_epi8(left, zero),
+								   _mm256_unpackhi_epi8(right, zero),
+								   highWeight,
+								   _mm256_sub_epi16(full, highWeight));
+
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(target + 4 * x),
+								_mm256_packus_epi16(low, high));
+		}
+
+		blendColumnsScalar(source, lefts, rights, weights, target, x, width);
+	}
+
+	/// Converts sixteen YUV pixels to RGB with AVX2.
+	/// \details Follows the fixed point steps of the scalar code.
+	/// \param[in]	y		Luma values as 16-bit lanes.
+	/// \param[in]	u		U values as 16-bit lanes.
+	/// \param[in]	v		V values as 16-bit lanes.
+	/// \param[out]	red		Red values.
+	/// \param[out]	green	Green values.
+	/// \param[out]	blue	Blue values.
+	CONVERSION_TARGET_AVX2
+	inline void convertPixelsAvx2(__m256i y,
+								  __m256i u,
+								  __m256i v,
+								  __m128i& red,
+								  __m128i& green,
+								  __m128i& blue) noexcept {
+
+		y = _mm256_slli_epi16(_mm256_sub_epi16(y, _mm256_set1_epi16(16)), 7);
+		u = _mm256_slli_epi16(_mm256_sub_epi16(u, _mm256_set1_epi16(128)), 7);
+		v = _mm256_slli_epi16(_mm256_sub_epi16(v, _mm256_set1_epi16(128)), 7);
+
+		auto luma = _mm256_mulhrs_epi16(y, _mm256_set1_epi16(LUMA_SCALE));
+
+		__m256i channels[3] {
+			_mm256_adds_epi16(
+				luma, _mm256_mulhrs_epi16(v, _mm256_set1_epi16(RED_V))),
+			_mm256_subs_epi16(
+				_mm256_subs_epi16(
+					luma,
+					_mm256_mulhrs_epi16(u, _mm256_set1_epi16(GREEN_U))),
+				_mm256_mulhrs_epi16(v, _mm256_set1_epi16(GREEN_V))),
+			_mm256_adds_epi16(
+				_mm256_adds_epi16(
+					luma,
+					_mm256_mulhrs_epi16(u, _mm256_set1_epi16(BLUE_U))),
+				_mm256_srai_epi16(u, 1)),
+		};
+
+		__m128i bytes[3];
+
+		for (auto i = 0; i < 3; ++i) {
+			auto channel = _mm256_srai_epi16(
+				_mm256_adds_epi16(channels[i], _mm256_set1_epi16(32)), 6);
+			auto packed = _mm256_packus_epi16(channel, channel);
+
+			bytes[i] = _mm256_castsi256_si128(
+				_mm256_permute4x64_epi64(packed, _MM_SHUFFLE(3, 1, 2, 0)));
+		}
+
+		red = bytes[0];
+		green = bytes[1];
+		blue = bytes[2];
+	}
+
+	/// Stores sixteen RGB pixels with AVX2.
+	/// \details RGB24 pixels are written with overlapping 16-byte stores,
+	/// so four bytes past the sixteenth pixel are overwritten.
+	/// \param[in]	red		Red values.
+	/// \param[in]	green	Green values.
+	/// \param[in]	blue	Blue values.
+	/// \param[out]	target	Target pixels.
+	/// \param[in]	layout	Target byte order.
+	CONVERSION_TARGET_AVX2
+	inline void storePixelsAvx2(__m128i red,
+								__m128i green,
+								__m128i blue,
+								std::uint8_t* target,
+								Conversion::RgbLayout layout) noexcept {
+
+		auto bgra = layout == Conversion::RgbLayout::BGRA;
+		auto first = bgra ? blue : red;
+		auto third = bgra ? red : blue;
+		auto opaque = _mm_set1_epi8(-1);
+
+		auto lowPairs = _mm_unpacklo_epi8(first, green);
+		auto highPairs = _mm_unpackhi_epi8(first, green);
+		auto lowAlpha = _mm_unpacklo_epi8(third, opaque);
+		auto highAlpha = _mm_unpackhi_epi8(third, opaque);
+
+		__m128i pixels[4] {
+			_mm_unpacklo_epi16(lowPairs, lowAlpha),
+			_mm_unpackhi_epi16(lowPairs, lowAlpha),
+			_mm_unpacklo_epi16(highPairs, highAlpha),
+			_mm_unpackhi_epi16(highPairs, highAlpha),
+		};
+
+		if (layout == Conversion::RgbLayout::RGB24) {
+			auto pack = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14,
+									  -1, -1, -1, -1);
+
+			for (auto i = 0; i < 4; ++i)
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(target + 12 * i),
+								 _mm_shuffle_epi8(pixels[i], pack));
+			return;
+		}
+
+		for (auto i = 0; i < 4; ++i)
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(target + 16 * i),
+							 pixels[i]);
+	}
+
+	/// Converts a YUV 4:2:0 row to RGB with AVX2.
+	/// \param[in]	luma	Luma row.
+	/// \param[in]	lower	Luma row below, when halving.
+	/// \param[in]	u		U row, or UV row if interleaved.
+	/// \param[in]	v		V row, ignored if interleaved.
+	/// \param[in]	chroma	Chroma layout.
+	/// \param[out]	target	Target row.
+	/// \param[in]	layout	Target byte order.
+	/// \param[in]	halve	Indicates whether the row is halved.
+	/// \param[in]	width	Target row width in pixels.
+	CONVERSION_TARGET_AVX2
+	void convertRowAvx2(const std::uint8_t* luma,
+						const std::uint8_t* lower,
+						const std::uint8_t* u,
+						const std::uint8_t* v,
+						Conversion::ChromaLayout chroma,
+						std::uint8_t* target,
+						Conversion::RgbLayout layout,
+						bool halve,
+						int width) noexcept {
+
+		auto interleaved = chroma == Conversion::ChromaLayout::Interleaved;
+		auto pixelSize = layout == Conversion::RgbLayout::RGB24 ? 3 : 4;
+		auto limit = layout == Conversion::RgbLayout::RGB24 ? width - 2 : width;
+		auto lowByte = _mm256_set1_epi16(0xFF);
+		auto x = 0;
+
+		for (; x + 16 <= limit; x += 16) {
+			__m256i y, blue, red;
+
+			if (halve) {
+				auto rows = _mm256_avg_epu8(
+					_mm256_loadu_si256(
+						reinterpret_cast<const __m256i*>(luma + 2 * x)),
+					_mm256_loadu_si256(
+						reinterpret_cast<const __m256i*>(lower + 2 * x)));
+				auto sums = _mm256_maddubs_epi16(rows, _mm256_set1_epi8(1));
+				y = _mm256_srli_epi16(
+					_mm256_add_epi16(sums, _mm256_set1_epi16(1)), 1);
+
+				if (interleaved) {
+					auto pairs = _mm256_loadu_si256(
+						reinterpret_cast<const __m256i*>(u + 2 * x));
+					blue = _mm256_and_si256(pairs, lowByte);
+					red = _mm256_srli_epi16(pairs, 8);
+				}
+				else {
+					blue = _mm256_cvtepu8_epi16(
+						_mm_loadu_si128(
+							reinterpret_cast<const __m128i*>(u + x)));
+					red = _mm256_cvtepu8_epi16(
+						_mm_loadu_si128(
+							reinterpret_cast<const __m128i*>(v + x)));
+				}
+			}
+			else {
+				y = _mm256_cvtepu8_epi16(
+					_mm_loadu_si128(
+						reinterpret_cast<const __m128i*>(luma + x)));
+
+				__m128i halfBlue, halfRed;
+
+				if (interleaved) {
+					auto pairs = _mm_loadu_si128(
+						reinterpret_cast<const __m128i*>(u + x));
+					halfBlue = _mm_and_si128(pairs, _mm_set1_epi16(0xFF));
+					halfRed = _mm_srli_epi16(pairs, 8);
+				}
+				else {
+					halfBlue = _mm_cvtepu8_epi16(
+						_mm_loadl_epi64(
+							reinterpret_cast<const __m128i*>(u + x / 2)));
+					halfRed = _mm_cvtepu8_epi16(
+						_mm_loadl_epi64(
+							reinterpret_cast<const __m128i*>(v + x / 2)));
+				}
+
+				blue = _mm256_inserti128_si256(
+					_mm256_castsi128_si256(
+						_mm_unpacklo_epi16(halfBlue, halfBlue)),
+					_mm_unpackhi_epi16(halfBlue, halfBlue), 1);
+				red = _mm256_inserti128_si256(
+					_mm256_castsi128_si256(
+						_mm_unpacklo_epi16(halfRed, halfRed)),
+					_mm_unpackhi_epi16(halfRed, halfRed), 1);
+			}
+
+			__m128i redBytes, greenBytes, blueBytes;
+			convertPixelsAvx2(y, blue, red, redBytes, greenBytes, blueBytes);
+			storePixelsAvx2(redBytes, greenBytes, blueBytes,
+							target + x * pixelSize, layout);
+		}
+
+		convertRowScalar(luma, lower, u, v, chroma, target, layout, halve,
+						 x, width);
+	}
+#endif
+}
+
+/// A namespace that contains classes and functions for pixel conversion.
+namespace Conversion {
+
+	/// Indicates whether AVX2 kernels can be used on this CPU.
+	/// \details Checks the CPU once and caches the result.
+	/// \retval true if AVX2 is supported.
+	/// \retval false if only scalar kernels can be used.
+	bool hasAvx2() noexcept {
+#if CONVERSION_X86 && (defined (__GNUC__) || defined (__clang__))
+		static const bool supported = __builtin_cpu_supports("avx2");
+		return supported;
+#elif CONVERSION_X86 && defined (_MSC_VER)
+		static const bool supported = [] {
+			int registers[4] { };
+			__cpuid(registers, 0);
+			if (registers[0] < 7) return false;
+
+			__cpuid(registers, 1);
+			auto osxsave = (registers[2] & (1 << 27)) != 0;
+			auto avx = (registers[2] & (1 << 28)) != 0;
+			if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) return false;
+
+			__cpuidex(registers, 7, 0);
+			return (registers[1] & (1 << 5)) != 0;
+		}();
+		return supported;
+#else
+		return false;
+#endif
+	}
+
+	/// Expands a limited range 8-bit luma plane to the full range.
+	/// \details Uses AVX2 when available, scalar code otherwise; both give
+	/// identical results.
+	/// \param[in]	source			Source plane.
+	/// \param[in]	sourceStride	Source stride in bytes.
+	/// \param[out]	target			Target plane.
+	/// \param[in]	targetStride	Target stride in bytes.
+	/// \param[in]	width			Plane width in pixels.
+	/// \param[in]	height			Plane height in pixels.
+	void expandGray8(const std::uint8_t* source,
+					 int sourceStride,
+					 std::uint8_t* target,
+					 int targetStride,
+					 int width,
+					 int height) noexcept {
+
+		auto avx2 = hasAvx2();
+
+		for (auto y = 0; y < height; ++y) {
+			auto sourceRow = source + y * sourceStride;
+			auto targetRow = target + y * targetStride;
+
+#if CONVERSION_X86
+			if (avx2) {
+				expandRowAvx2(sourceRow, targetRow, width);
+				continue;
+			}
+#endif
+			expandRowScalar(sourceRow, targetRow, 0, width);
+		}
+
+		static_cast<void>(avx2);
+	}
+
+	/// Widens an 8-bit grayscale plane to 16 bits.
+	/// \details Uses AVX2 when available, scalar code otherwise.
+	/// \param[in]	source			Source plane.
+	/// \param[in]	sourceStride	Source stride in bytes.
+	/// \param[out]	target			Target plane.
+	/// \param[in]	targetStride	Target stride in bytes.
+	/// \param[in]	width			Plane width in pixels.
+	/// \param[in]	height			Plane height in pixels.
+	/// \param[in]	limitedRange	Indicates whether the source is limited
+	///								range luma.
+	void widenGray8ToGray16(const std::uint8_t* source,
+							int sourceStride,
+							std::uint8_t* target,
+							int targetStride,
+							int width,
+							int height,
+							bool limitedRange) noexcept {
+
+		auto avx2 = hasAvx2();
+
+		for (auto y = 0; y < height; ++y) {
+			auto sourceRow = source + y * sourceStride;
+			auto targetRow = reinterpret_cast<std::uint16_t*>(
+				target + y * targetStride);
+
+#if CONVERSION_X86
+			if (avx2) {
+				widenRowAvx2(sourceRow, targetRow, width, limitedRange);
+				continue;
+			}
+#endif
+			widenRowScalar(sourceRow, targetRow, 0, width, limitedRange);
+		}
+
+		static_cast<void>(avx2);
+	}
+
+	/// Thresholds an 8-bit grayscale plane to a 1-bit plane.
+	/// \details Uses AVX2 when available, scalar code otherwise. Limited
+	/// range sources are not expanded; the threshold is moved to the
+	/// smallest value whose expansion reaches it instead, which sets the
+	/// same bits.
+	/// \param[in]	source			Source plane.
+	/// \param[in]	sourceStride	Source stride in bytes.
+	/// \param[out]	target			Target plane.
+	/// \param[in]	targetStride	Target stride in bytes.
+	/// \param[in]	width			Plane width in pixels.
+	/// \param[in]	height			Plane height in pixels.
+	/// \param[in]	threshold		Threshold value.
+	/// \param[in]	limitedRange	Indicates whether the source is limited
+	///								range luma.
+	void thresholdGray8ToMono(const std::uint8_t* source,
+							  int sourceStride,
+							  std::uint8_t* target,
+							  int targetStride,
+							  int width,
+							  int height,
+							  std::uint8_t threshold,
+							  bool limitedRange) noexcept {
+
+		if (limitedRange)
+			threshold = limitedThreshold(threshold);
+
+		auto avx2 = hasAvx2();
+
+		for (auto y = 0; y < height; ++y) {
+			auto sourceRow = source + y * sourceStride;
+			auto targetRow = target + y * targetStride;
+
+#if CONVERSION_X86
+			if (avx2) {
+				thresholdRowAvx2(sourceRow, targetRow, width, threshold);
+				continue;
+			}
+#endif
+			thresholdRowScalar(sourceRow, targetRow, 0, width, threshold);
+		}
+
+		static_cast<void>(avx2);
+	}
+
+	/// Converts a YUV 4:2:0 frame to RGB.
+	/// \details Uses limited range BT.601 coefficients, as swscale does by
+	/// default. Chroma is taken from the nearest sample without
+	/// interpolation. A halved target averages 2x2 luma blocks and takes
+	/// the chroma sample of each block; odd trailing rows and columns are
+	/// dropped. Uses AVX2 when available and allowed, scalar code
+	/// otherwise; both give identical results.
+	/// \param[in]	planes			Luma plane, then U and V planes or
+	///								the UV plane.
+	/// \param[in]	strides			Plane strides in bytes.
+	/// \param[in]	chroma			Chroma layout.
+	/// \param[in]	width			Frame width in pixels.
+	/// \param[in]	height			Frame height in pixels.
+	/// \param[out]	target			Target plane.
+	/// \param[in]	targetStride	Target stride in bytes.
+	/// \param[in]	layout			Target byte order.
+	/// \param[in]	halve			Indicates whether the target is half the
+	///								frame size.
+	/// \param[in]	avx2			Indicates whether AVX2 kernels may be
+	///								used.
+	void convertYuv420ToRgb(const std::uint8_t* const planes[],
+							const int strides[],
+							ChromaLayout chroma,
+							int width,
+							int height,
+							std::uint8_t* target,
+							int targetStride,
+							RgbLayout layout,
+							bool halve,
+							bool avx2) noexcept {
+
+		avx2 = avx2 && hasAvx2();
+
+		auto targetWidth = halve ? width / 2 : width;
+		auto targetHeight = halve ? height / 2 : height;
+		auto interleaved = chroma == ChromaLayout::Interleaved;
+
+		for (auto y = 0; y < targetHeight; ++y) {
+			auto lumaRow = halve ? 2 * y : y;
+			auto chromaRow = halve ? y : y / 2;
+
+			auto luma = planes[0] + lumaRow * strides[0];
+			auto lower = halve ? luma + strides[0] : luma;
+			auto u = planes[1] + chromaRow * strides[1];
+			auto v = interleaved ? u : planes[2] + chromaRow * strides[2];
+			auto targetRow = target + y * targetStride;
+
+#if CONVERSION_X86
+			if (avx2) {
+				convertRowAvx2(luma, lower, u, v, chroma, targetRow, layout,
+							   halve, targetWidth);
+				continue;
+			}
+#endif
+			convertRowScalar(luma, lower, u, v, chroma, targetRow, layout,
+							 halve, 0, targetWidth);
+		}
+
+		static_cast<void>(avx2);
+	}
+
+	/// Scales a plane of 32-bit pixels.
+	/// \details While the source is at least twice the target size in both
+	/// dimensions it is halved by averaging 2x2 blocks, then the rest is
+	/// resampled bilinearly with center aligned 8-bit weights. This gives
+	/// area-like quality on downscaling at bilinear cost. Channels are
+	/// treated alike, so any 32-bit layout works. Uses AVX2 when available,
+	/// scalar code otherwise; both give identical results. Scratch buffers
+	/// are kept per thread.
+	/// \param[in]	source			Source plane.
+	/// \param[in]	sourceStride	Source stride in bytes.
+	/// \param[in]	sourceWidth		Source width in pixels.
+	/// \param[in]	sourceHeight	Source height in pixels.
+	/// \param[out]	target			Target plane.
+	/// \param[in]	targetStride	Target stride in bytes.
+	/// \param[in]	targetWidth		Target width in pixels.
+	/// \param[in]	targetHeight	Target height in pixels.
+	void scalePlane32(const std::uint8_t* source,
+					  int sourceStride,
+					  int sourceWidth,
+					  int sourceHeight,
+					  std::uint8_t* target,
+					  int targetStride,
+					  int targetWidth,
+					  int targetHeight) {
+
+		if (sourceWidth <= 0 || sourceHeight <= 0 ||
+			targetWidth <= 0 || targetHeight <= 0)
+			return;
+
+		thread_local std::vector<std::uint8_t> halves[2];
+		thread_local std::vector<std::uint8_t> row;
+		thread_local std::vector<std::int32_t> lefts, rights, weights;
+
+		auto avx2 = hasAvx2();
+		auto plane = source;
+		auto stride = sourceStride;
+		auto width = sourceWidth;
+		auto height = sourceHeight;
+		auto half = 0;
+
+		while (width >= 2 * targetWidth && height >= 2 * targetHeight) {
+			auto& buffer = halves[half];
+			half ^= 1;
+
+			width /= 2;
+			height /= 2;
+			buffer.resize(static_cast<std::size_t>(width) * height * 4);
+
+			for (auto y = 0; y < height; ++y) {
+				auto top = plane + 2 * y * stride;
+				auto bottom = top + stride;
+				auto targetRow = buffer.data() + y * width * 4;
+
+#if CONVERSION_X86
+				if (avx2) {
+					halveRowAvx2(top, bottom, targetRow, width);
+					continue;
+				}
+#endif
+				halveRowScalar(top, bottom, targetRow, 0, width);
+			}
+
+			plane = buffer.data();
+			stride = width * 4;
+		}
+
+		if (width == targetWidth && height == targetHeight) {
+			for (auto y = 0; y < height; ++y)
+				std::memcpy(target + y * targetStride,
+							plane + y * stride,
+							static_cast<std::size_t>(width) * 4);
+			return;
+		}
+
+		lefts.resize(static_cast<std::size_t>(targetWidth));
+		rights.resize(static_cast<std::size_t>(targetWidth));
+		weights.resize(static_cast<std::size_t>(targetWidth));
+		row.resize(static_cast<std::size_t>(width) * 4);
+
+		// Positions are 16.16 fixed point, sampled at pixel centers.
+		auto position = [](int index, int sourceSize, int targetSize,
+						   int& first, int& second, int& weight) {
+
+			auto step =
+				(static_cast<std::int64_t>(sourceSize) << 16) / targetSize;
+			auto point = std::max<std::int64_t>(
+				0, index * step + step / 2 - 0x8000);
+
+			first = static_cast<int>(point >> 16);
+			weight = static_cast<int>((point >> 8) & 0xFF);
+
+			if (first >= sourceSize - 1) {
+				first = sourceSize - 1;
+				weight = 0;
+			}
+
+			second = std::min(first + 1, sourceSize - 1);
+		};
+
+		for (auto x = 0; x < targetWidth; ++x) {
+			int left, right, weight;
+			position(x, width, targetWidth, left, right, weight);
+
+			lefts[x] = left;
+			rights[x] = right;
+			weights[x] = weight;
+		}
+
+		for (auto y = 0; y < targetHeight; ++y) {
+			int top, bottom, weight;
+			position(y, height, targetHeight, top, bottom, weight);
+
+			auto sourceRow = plane + top * stride;
+			auto targetRow = target + y * targetStride;
+
+			if (weight != 0) {
+#if CONVERSION_X86
+				if (avx2)
+					blendRowsAvx2(sourceRow, plane + bottom * stride,
+								  row.data(), width * 4, weight);
+				else
+#endif
+					blendRowsScalar(sourceRow, plane + bottom * stride,
+									row.data(), 0, width * 4, weight);
+
+				sourceRow = row.data();
+			}
+
+#if CONVERSION_X86
+			if (avx2) {
+				blendColumnsAvx2(sourceRow, lefts.data(), rights.data(),
+								 weights.data(), targetRow, targetWidth);
+				continue;
+			}
+#endif
+			blendColumnsScalar(sourceRow, lefts.data(), rights.data(),
+							   weights.data(), targetRow, 0, targetWidth);
+		}
+
+		static_cast<void>(avx2);
+	}
+}
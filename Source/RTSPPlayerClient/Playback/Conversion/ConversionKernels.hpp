@@ -0,0 +1,136 @@
+/// \file ConversionKernels.hpp
+/// \brief Contains classes and functions declarations that provide pixel
+/// conversion kernels.
+/// \bug No known bugs.
+
+#ifndef CONVERSIONKERNELS_HPP
+#define CONVERSIONKERNELS_HPP
+
+#include <cstdint>
+
+/// A namespace that contains classes and functions for pixel conversion.
+namespace Conversion {
+
+	/// Chroma layouts of YUV 4:2:0 frames.
+	enum class ChromaLayout {
+		Planar		,	///< Separate U and V planes, as in YUV420P.
+		Interleaved	,	///< One plane of UV pairs, as in NV12.
+	};
+
+	/// Byte orders of RGB pixels.
+	enum class RgbLayout {
+		RGB24	,	///< Three bytes R, G, B.
+		RGBX	,	///< Four bytes R, G, B, 255.
+		BGRA	,	///< Four bytes B, G, R, 255.
+	};
+
+	/// Indicates whether AVX2 kernels can be used on this CPU.
+	/// \retval true if AVX2 is supported.
+	/// \retval false if only scalar kernels can be used.
+	bool hasAvx2() noexcept;
+
+	/// Expands a limited range 8-bit luma plane to the full range.
+	/// \details Maps 16 to 235 onto 0 to 255 with the luma scale of the
+	/// YUV to RGB conversion, so a gray picture gets the same values either
+	/// way. Values outside the limited range are clamped.
+	/// \param[in]	source			Source plane.
+	/// \param[in]	sourceStride	Source stride in bytes.
+	/// \param[out]	target			Target plane.
+	/// \param[in]	targetStride	Target stride in bytes.
+	/// \param[in]	width			Plane width in pixels.
+	/// \param[in]	height			Plane height in pixels.
+	void expandGray8(const std::uint8_t* source,
+					 int sourceStride,
+					 std::uint8_t* target,
+					 int targetStride,
+					 int width,
+					 int height) noexcept;
+
+	/// Widens an 8-bit grayscale plane to 16 bits.
+	/// \details Each value \c v becomes \c v * 257, so that the full 8-bit
+	/// range maps to the full 16-bit range. Limited range values are
+	/// expanded as by expandGray8() first.
+	/// \param[in]	source			Source plane.
+	/// \param[in]	sourceStride	Source stride in bytes.
+	/// \param[out]	target			Target plane.
+	/// \param[in]	targetStride	Target stride in bytes.
+	/// \param[in]	width			Plane width in pixels.
+	/// \param[in]	height			Plane height in pixels.
+	/// \param[in]	limitedRange	Indicates whether the source is limited
+	///								range luma.
+	void widenGray8ToGray16(const std::uint8_t* source,
+							int sourceStride,
+							std::uint8_t* target,
+							int targetStride,
+							int width,
+							int height,
+							bool limitedRange = false) noexcept;
+
+	/// Thresholds an 8-bit grayscale plane to a 1-bit plane.
+	/// \details Packs pixels most significant bit first; a bit is set when the
+	/// source value is greater than or equal to \a threshold. Limited range
+	/// values are compared as if expanded by expandGray8().
+	/// \param[in]	source			Source plane.
+	/// \param[in]	sourceStride	Source stride in bytes.
+	/// \param[out]	target			Target plane.
+	/// \param[in]	targetStride	Target stride in bytes.
+	/// \param[in]	width			Plane width in pixels.
+	/// \param[in]	height			Plane height in pixels.
+	/// \param[in]	threshold		Threshold value.
+	/// \param[in]	limitedRange	Indicates whether the source is limited
+	///								range luma.
+	void thresholdGray8ToMono(const std::uint8_t* source,
+							  int sourceStride,
+							  std::uint8_t* target,
+							  int targetStride,
+							  int width,
+							  int height,
+							  std::uint8_t threshold = 128,
+							  bool limitedRange = false) noexcept;
+
+	/// Converts a YUV 4:2:0 frame to RGB.
+	/// \param[in]	planes			Luma plane, then U and V planes or the UV
+	///								plane.
+	/// \param[in]	strides			Plane strides in bytes.
+	/// \param[in]	chroma			Chroma layout.
+	/// \param[in]	width			Frame width in pixels.
+	/// \param[in]	height			Frame height in pixels.
+	/// \param[out]	target			Target plane.
+	/// \param[in]	targetStride	Target stride in bytes.
+	/// \param[in]	layout			Target byte order.
+	/// \param[in]	halve			Indicates whether the target is half the
+	///								frame size.
+	/// \param[in]	avx2			Indicates whether AVX2 kernels may be used.
+	void convertYuv420ToRgb(const std::uint8_t* const planes[],
+							const int strides[],
+							ChromaLayout chroma,
+							int width,
+							int height,
+							std::uint8_t* target,
+							int targetStride,
+							RgbLayout layout,
+							bool halve = false,
+							bool avx2 = true) noexcept;
+
+	/// Scales a plane of 32-bit pixels.
+	/// \details Downscales by averaging 2x2 blocks while the source is at
+	/// least twice the target size, then resamples bilinearly.
+	/// \param[in]	source			Source plane.
+	/// \param[in]	sourceStride	Source stride in bytes.
+	/// \param[in]	sourceWidth		Source width in pixels.
+	/// \param[in]	sourceHeight	Source height in pixels.
+	/// \param[out]	target			Target plane.
+	/// \param[in]	targetStride	Target stride in bytes.
+	/// \param[in]	targetWidth		Target width in pixels.
+	/// \param[in]	targetHeight	Target height in pixels.
+	void scalePlane32(const std::uint8_t* source,
+					  int sourceStride,
+					  int sourceWidth,
+					  int sourceHeight,
+					  std::uint8_t* target,
+					  int targetStride,
+					  int targetWidth,
+					  int targetHeight);
+}
+
+#endif
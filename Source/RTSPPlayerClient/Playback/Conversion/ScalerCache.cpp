@@ -0,0 +1,153 @@
+/// \file ScalerCache.cpp
+/// \brief Contains classes and functions definitions that provide a shared
+/// cache of scaler contexts.
+/// \bug No known bugs.
+
+#include "ScalerCache.hpp"
+
+#include <algorithm>
+#include <iterator>
+
+extern "C" {
+	#include <libswscale/swscale.h>
+}
+
+/// A namespace that contains classes and functions for pixel conversion.
+namespace Conversion {
+
+	/// Compares two keys.
+	/// \param[in]	other	Other key.
+	/// \retval true if the keys describe the same scaler.
+	/// \retval false otherwise.
+	bool ScalerKey::operator==(const ScalerKey& other) const noexcept {
+		return inWidth == other.inWidth &&
+			   inHeight == other.inHeight &&
+			   inFormat == other.inFormat &&
+			   outWidth == other.outWidth &&
+			   outHeight == other.outHeight &&
+			   outFormat == other.outFormat &&
+			   flags == other.flags;
+	}
+
+	/// Returns the cache of the process.
+	/// \return Scaler cache.
+	ScalerCache& ScalerCache::instance() {
+		static ScalerCache cache;
+		return cache;
+	}
+
+	/// Destroys the cache, freeing idle scalers.
+	/// \details Scalers still lent are left to their holders.
+	ScalerCache::~ScalerCache() noexcept {
+		clear();
+	}
+
+	/// Lends a scaler.
+	/// \details Takes the most recently returned idle scaler with the key,
+	/// or creates one. Scalers are created outside the lock, as building
+	/// the filters takes a while.
+	/// \param[in]	key	Geometry and formats.
+	/// \return Scaler, or null if none can be created.
+	SwsContext* ScalerCache::acquire(const ScalerKey& key) noexcept {
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+
+			for (auto entry = idle_.rbegin(); entry != idle_.rend(); ++entry) {
+				if (!(entry->first == key)) continue;
+
+				auto context = entry->second;
+				idle_.erase(std::next(entry).base());
+				lent_.emplace_back(context, key);
+
+				++statistics_.reusedScalers;
+				return context;
+			}
+		}
+
+		auto context = sws_getContext(key.inWidth,
+									  key.inHeight,
+									  static_cast<AVPixelFormat>(key.inFormat),
+									  key.outWidth,
+									  key.outHeight,
+									  static_cast<AVPixelFormat>(key.outFormat),
+									  key.flags,
+									  nullptr,
+									  nullptr,
+									  nullptr);
+
+		if (!context) return nullptr;
+
+		std::lock_guard<std::mutex> lock(mutex_);
+		lent_.emplace_back(context, key);
+
+		++statistics_.createdScalers;
+		return context;
+	}
+
+	/// Takes back a scaler lent by acquire().
+	/// \details Scalers the cache did not lend are freed.
+	/// \param[in]	context	Scaler, null is ignored.
+	void ScalerCache::release(SwsContext* context) noexcept {
+		if (!context) return;
+
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		auto lentContext = [context](const auto& lent) {
+			return lent.first == context;
+		};
+
+		auto entry = std::find_if(lent_.begin(), lent_.end(), lentContext);
+
+		if (entry == lent_.end()) {
+			sws_freeContext(context);
+			return;
+		}
+
+		idle_.emplace_back(entry->second, context);
+		lent_.erase(entry);
+
+		trim();
+	}
+
+	/// Sets the maximum number of idle scalers kept.
+	/// \param[in]	count	Maximum number of idle scalers.
+	void ScalerCache::setMaximumIdle(int count) noexcept {
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		maximumIdle_ = std::max(0, count);
+		trim();
+	}
+
+	/// Frees all idle scalers.
+	void ScalerCache::clear() noexcept {
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		for (auto& entry : idle_) sws_freeContext(entry.second);
+		idle_.clear();
+	}
+
+	/// Returns cache statistics.
+	/// \return Cache statistics.
+	ScalerCache::Statistics ScalerCache::statistics() const noexcept {
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		auto statistics = statistics_;
+		statistics.lentScalers = lent_.size();
+		statistics.idleScalers = idle_.size();
+
+		return statistics;
+	}
+
+	/// Frees idle scalers beyond the maximum.
+	/// \details Expects the mutex to be held.
+	void ScalerCache::trim() noexcept {
+		auto excess = static_cast<int>(idle_.size()) - maximumIdle_;
+		if (excess <= 0) return;
+
+		for (auto entry = 0; entry < excess; ++entry)
+			sws_freeContext(idle_[static_cast<std::size_t>(entry)].second);
+
+		idle_.erase(idle_.begin(), idle_.begin() + excess);
+		statistics_.evictedScalers += static_cast<std::uint64_t>(excess);
+	}
+}
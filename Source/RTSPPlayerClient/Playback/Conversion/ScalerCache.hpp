@@ -0,0 +1,138 @@
+/// \file ScalerCache.hpp
+/// \brief Contains classes and functions declarations that provide a shared
+/// cache of scaler contexts.
+/// \bug No known bugs.
+
+#ifndef SCALERCACHE_HPP
+#define SCALERCACHE_HPP
+
+#include <cstdint>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+struct SwsContext;
+
+/// A namespace that contains classes and functions for pixel conversion.
+namespace Conversion {
+
+	/// A structure that identifies a scaler by geometry and formats.
+	struct ScalerKey final {
+
+		/// Source width in pixels.
+		int inWidth = 0;
+
+		/// Source height in pixels.
+		int inHeight = 0;
+
+		/// Source pixel format, an \c AVPixelFormat value.
+		int inFormat = -1;
+
+		/// Target width in pixels.
+		int outWidth = 0;
+
+		/// Target height in pixels.
+		int outHeight = 0;
+
+		/// Target pixel format, an \c AVPixelFormat value.
+		int outFormat = -1;
+
+		/// Scaler flags.
+		int flags = 0;
+
+		/// Compares two keys.
+		/// \param[in]	other	Other key.
+		/// \retval true if the keys describe the same scaler.
+		/// \retval false otherwise.
+		bool operator==(const ScalerKey& other) const noexcept;
+	};
+
+	/// A class that shares scaler contexts between streams.
+	/// \details Streams of the same geometry and formats get scalers from
+	/// one process wide cache instead of building their own filters. A
+	/// scaler is lent exclusively, as a context must not be used by two
+	/// threads at once; a returned scaler is kept idle for the next stream
+	/// with the same key, up to a maximum number of idle scalers, and the
+	/// least recently returned ones are freed first.
+	class ScalerCache final {
+	public:
+
+		/// A structure that contains cache statistics.
+		struct Statistics {
+
+			/// Number of created scalers.
+			std::uint64_t createdScalers = 0;
+
+			/// Number of loans served by an idle scaler.
+			std::uint64_t reusedScalers = 0;
+
+			/// Number of idle scalers freed to stay within the maximum.
+			std::uint64_t evictedScalers = 0;
+
+			/// Number of lent scalers.
+			std::uint64_t lentScalers = 0;
+
+			/// Number of idle scalers.
+			std::uint64_t idleScalers = 0;
+		};
+
+	public:
+
+		/// Returns the cache of the process.
+		/// \return Scaler cache.
+		static ScalerCache& instance();
+
+		/// Destroys the cache, freeing idle scalers.
+		~ScalerCache() noexcept;
+
+	public:
+
+		/// Lends a scaler.
+		/// \param[in]	key	Geometry and formats.
+		/// \return Scaler, or null if none can be created.
+		SwsContext* acquire(const ScalerKey& key) noexcept;
+
+		/// Takes back a scaler lent by acquire().
+		/// \param[in]	context	Scaler, null is ignored.
+		void release(SwsContext* context) noexcept;
+
+		/// Sets the maximum number of idle scalers kept.
+		/// \param[in]	count	Maximum number of idle scalers.
+		void setMaximumIdle(int count) noexcept;
+
+		/// Frees all idle scalers.
+		void clear() noexcept;
+
+		/// Returns cache statistics.
+		/// \return Cache statistics.
+		Statistics statistics() const noexcept;
+
+	private:
+
+		/// Constructs a scaler cache.
+		ScalerCache() = default;
+
+		/// Frees idle scalers beyond the maximum.
+		/// \details Expects the mutex to be held.
+		void trim() noexcept;
+
+	private:
+
+		/// Guards the scaler lists.
+		mutable std::mutex mutex_;
+
+		/// Idle scalers, least recently returned first.
+		std::vector<std::pair<ScalerKey, SwsContext*>> idle_;
+
+		/// Lent scalers with their keys.
+		std::vector<std::pair<SwsContext*, ScalerKey>> lent_;
+
+		/// Maximum number of idle scalers.
+		int maximumIdle_ = 32;
+
+		/// Cache statistics.
+		Statistics statistics_;
+	};
+}
+
+#endif
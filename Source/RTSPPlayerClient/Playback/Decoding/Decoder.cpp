@@ -4,17 +4,71 @@
 /// \bug No known bugs.
 
 #include "AudioDecoder.hpp"
+#include "NalUnitParser.hpp"
 #include "VideoDecoder.hpp"
+#include "Base/Utility/HugePageArena.hpp"
+#include "Base/Utility/MemoryBudget.hpp"
+#include "Base/Utility/ThreadAffinity.hpp"
+#include "Playback/Conversion/ConversionKernels.hpp"
+#include "Playback/Conversion/ScalerCache.hpp"
+
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 extern "C" {
 	#include <libavcodec/avcodec.h>
 	#include <libavutil/imgutils.h>
+	#include <libavutil/pixdesc.h>
 	#include <libswscale/swscale.h>
 	#include <libswresample/swresample.h>
 }
 
 namespace {
 
+	/// Row and buffer alignment of converted images in bytes.
+	/// \details Matches the widest SIMD stores of the scaler, so output rows
+	/// never need unaligned fixups.
+	constexpr int IMAGE_ALIGNMENT = 64;
+
+	/// Row alignment of conversion bands.
+	/// \details A multiple of every vertical chroma subsampling, so band
+	/// edges fall on chroma rows and unscaled conversions match the whole
+	/// frame exactly.
+	constexpr int BAND_ALIGNMENT = 16;
+
+	/// Number of pixels per band below which splitting a frame costs more
+	/// in thread handoff than it saves.
+	/// \details One 1080p frame, so automatic splitting starts above it.
+	constexpr qint64 MINIMUM_BAND_PIXELS = 1920 * 1080;
+
+	/// Maximum number of conversion bands.
+	constexpr int MAXIMUM_BANDS = 16;
+
+	/// Maximum number of times output images are halved in size.
+	constexpr int MAXIMUM_DOWNSCALE = 2;
+
+	/// Maximum number of concurrent MJPEG decoders.
+	constexpr int MAXIMUM_MJPEG_DECODERS = 16;
+
+	/// Number of MJPEG frames in flight per decoder.
+	/// \details Two keep every decoder busy while the oldest frame is
+	/// collected, and bound the added latency to a few frames.
+	constexpr int MJPEG_FRAMES_PER_DECODER = 2;
+
 	///
 	/// \details
 	enum class DecoderStatusCode {
@@ -84,18 +138,10 @@ namespace {
 		/// \details
 		AVPixelFormat outFormat;
 
-		///
-		/// \details
-		AVPixelFormat modifiedFormat;
-
 		///
 		/// \details
 		int flags;
 
-		///
-		/// \details
-		AVFrame* frame = nullptr;
-
 		///
 		/// \details
 		SwsContext* scalerContext = nullptr;
@@ -193,6 +239,12 @@ namespace {
 		case AV_PIX_FMT_RGB24:
 			result = QImage::Format_RGB888;
 			break;
+		case AV_PIX_FMT_RGBA:
+			result = QImage::Format_RGBX8888;
+			break;
+		case AV_PIX_FMT_RGB32:
+			result = QImage::Format_RGB32;
+			break;
 		default:
 			break;
 		}
@@ -220,6 +272,12 @@ namespace {
 		case Decoders::VideoDecoder::Format::RGB888:
 			result = AV_PIX_FMT_RGB24;
 			break;
+		case Decoders::VideoDecoder::Format::RGBX8888:
+			result = AV_PIX_FMT_RGBA;
+			break;
+		case Decoders::VideoDecoder::Format::BGRA8888:
+			result = AV_PIX_FMT_RGB32;
+			break;
 		default:
 			break;
 		}
@@ -266,14 +324,9 @@ namespace {
 	/// \details
 	/// \param[in,out]	scalerContext
 	auto destroy(ScalerContext& scalerContext) noexcept {
-		if (scalerContext.frame) {
-			av_freep(&scalerContext.frame->data[0]);
-		}
-
-		av_frame_free(&scalerContext.frame);
-		sws_freeContext(scalerContext.scalerContext);
+		auto& cache = Conversion::ScalerCache::instance();
+		cache.release(scalerContext.scalerContext);
 
-		scalerContext.frame = nullptr;
 		scalerContext.scalerContext = nullptr;
 	}
 
@@ -360,36 +413,19 @@ namespace {
 	auto initialize(ScalerContext& scalerContext) noexcept {
 		destroy(scalerContext);
 
-		scalerContext.scalerContext =
-			sws_getContext(scalerContext.inWidth,
-						   scalerContext.inHeight,
-						   scalerContext.inFormat,
-						   scalerContext.outWidth,
-						   scalerContext.outHeight,
-						   scalerContext.outFormat,
-						   scalerContext.flags,
-						   nullptr,
-						   nullptr,
-						   nullptr);
-
-		if (!scalerContext.scalerContext) {
-			destroy(scalerContext);
-			return false;
-		}
-
-		scalerContext.frame = av_frame_alloc();
+		Conversion::ScalerKey key;
+		key.inWidth = scalerContext.inWidth;
+		key.inHeight = scalerContext.inHeight;
+		key.inFormat = scalerContext.inFormat;
+		key.outWidth = scalerContext.outWidth;
+		key.outHeight = scalerContext.outHeight;
+		key.outFormat = scalerContext.outFormat;
+		key.flags = scalerContext.flags;
 
-		if (!scalerContext.frame) {
-			destroy(scalerContext);
-			return false;
-		}
+		auto& cache = Conversion::ScalerCache::instance();
+		scalerContext.scalerContext = cache.acquire(key);
 
-		if (av_image_alloc(scalerContext.frame->data,
-						   scalerContext.frame->linesize,
-						   scalerContext.outWidth,
-						   scalerContext.outHeight,
-						   scalerContext.outFormat,
-						   16) < 0) {
+		if (!scalerContext.scalerContext) {
 			destroy(scalerContext);
 			return false;
 		}
@@ -437,9 +473,14 @@ namespace {
 	/// \param[in]		data
 	/// \param[in]		size
 	/// \param[in,out]	packet
+	/// \param[in]		timestamp	Presentation and decoding timestamp.
 	/// \retval
 	/// \retval
-	auto setData(const char* data, int size, AVPacket* packet) noexcept {
+	auto setData(const char* data,
+				 int size,
+				 AVPacket* packet,
+				 int64_t timestamp = AV_NOPTS_VALUE) noexcept {
+
 		if (!packet) return false;
 
 		if (!data || size <= 0) {
@@ -460,6 +501,9 @@ namespace {
 
 		memcpy(packet->data, data, size);
 
+		packet->pts = timestamp;
+		packet->dts = timestamp;
+
 		return true;
 	}
 
@@ -520,6 +564,64 @@ namespace {
 		return true;
 	}
 
+	/// Applies error concealment flags and threading to the decoder.
+	/// \details Maps concealment flags to codec options and reopens the
+	/// decoder, since the thread count is only read on opening and every
+	/// decoding thread has to pick the flags up.
+	/// \param[in]		flags			Error concealment flags.
+	/// \param[in]		threadCount		Number of decoding threads, zero for
+	///									automatic selection.
+	/// \param[in,out]	decoderContext	Decoder context.
+	/// \retval true on success.
+	/// \retval false on error.
+	auto configure(Decoders::VideoDecoder::ConcealmentFlags flags,
+				   int threadCount,
+				   DecoderContext& decoderContext) noexcept {
+
+		using Concealment = Decoders::VideoDecoder::Concealment;
+
+		if (!decoderContext.codecContext)
+			return false;
+
+		auto codecContext = decoderContext.codecContext;
+
+		codecContext->error_concealment = 0;
+
+		if (flags.testFlag(Concealment::GuessMotionVectors))
+			codecContext->error_concealment |= FF_EC_GUESS_MVS;
+
+		if (flags.testFlag(Concealment::Deblock))
+			codecContext->error_concealment |= FF_EC_DEBLOCK;
+
+		if (flags.testFlag(Concealment::ShowCorrupted)) {
+			codecContext->flags |= AV_CODEC_FLAG_OUTPUT_CORRUPT;
+			codecContext->flags2 |= AV_CODEC_FLAG2_SHOW_ALL;
+		}
+		else {
+			codecContext->flags &= ~AV_CODEC_FLAG_OUTPUT_CORRUPT;
+			codecContext->flags2 &= ~AV_CODEC_FLAG2_SHOW_ALL;
+		}
+
+		codecContext->thread_count = threadCount;
+		codecContext->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+
+		avcodec_close(codecContext);
+
+		if (avcodec_open2(codecContext, decoderContext.codec, nullptr) < 0)
+			return false;
+
+		return true;
+	}
+
+	/// Indicates whether the decoded frame is corrupted.
+	/// \param[in]	frame	Decoded frame.
+	/// \retval true if the frame is corrupted.
+	/// \retval false if the frame is intact.
+	inline auto isCorrupted(const AVFrame* frame) noexcept {
+		return (frame->flags & AV_FRAME_FLAG_CORRUPT) ||
+			   frame->decode_error_flags != 0;
+	}
+
 	///
 	/// \details
 	/// \param[in]		codecContext
@@ -558,202 +660,2055 @@ namespace {
 		return DecoderStatusCode::FrameReceived;
 	}
 
+	/// Frees an image buffer allocated by allocateImage().
+	/// \param[in]	info	Buffer to free.
+	void freeImage(void* info) {
+		av_free(info);
+	}
+
+	/// Returns an image buffer allocated by allocateImage() to the arena.
+	/// \param[in]	info	Buffer to release.
+	void releaseImage(void* info) {
+		Common::Utility::HugePageArena::instance().release(info);
+	}
+
+	/// Allocates an image with aligned rows.
+	/// \details Rows start on IMAGE_ALIGNMENT boundaries, so scaler stores
+	/// are aligned and 32-bit rows can be uploaded in place with an unpack
+	/// row length. The buffer is freed with the last copy of the image.
+	/// Large images come from the huge page arena, so conversion writes and
+	/// uploads stream over few TLB entries and buffers are reused across
+	/// frames; the rest come from the heap. Monochrome images get a black
+	/// and white color table.
+	/// \param[in]		width	Image width.
+	/// \param[in]		height	Image height.
+	/// \param[in]		format	Image format.
+	/// \param[out]	image	Allocated image.
+	/// \retval true on success.
+	/// \retval false on error.
+	auto allocateImage(int width,
+					   int height,
+					   QImage::Format format,
+					   QImage& image) noexcept {
+
+		auto depth = QImage::toPixelFormat(format).bitsPerPixel();
+		if (width <= 0 || height <= 0 || depth == 0) return false;
+
+		auto rowSize = (static_cast<qint64>(width) * depth + 7) / 8;
+		auto stride = FFALIGN(rowSize, static_cast<qint64>(IMAGE_ALIGNMENT));
+		auto size = stride * height + IMAGE_ALIGNMENT;
+
+		if (stride > INT_MAX || size > INT_MAX) return false;
+
+		auto& arena = Common::Utility::HugePageArena::instance();
+		auto bytes = static_cast<size_t>(size);
+		auto buffer = static_cast<uint8_t*>(arena.allocate(bytes));
+		auto cleanup = releaseImage;
+
+		if (!buffer) {
+			buffer = static_cast<uint8_t*>(av_malloc(bytes));
+			cleanup = freeImage;
+		}
+
+		if (!buffer) return false;
+
+		auto offset = (IMAGE_ALIGNMENT -
+					   reinterpret_cast<quintptr>(buffer) % IMAGE_ALIGNMENT) %
+					  IMAGE_ALIGNMENT;
+
+		image = QImage(buffer + offset,
+					   width,
+					   height,
+					   static_cast<int>(stride),
+					   format,
+					   cleanup,
+					   buffer);
+
+		if (image.isNull()) {
+			cleanup(buffer);
+			return false;
+		}
+
+		if (format == QImage::Format_Mono)
+			image.setColorTable({ qRgb(0, 0, 0), qRgb(255, 255, 255) });
+
+		return true;
+	}
+
 	///
-	/// \details
+	/// \details Scales directly into a newly allocated image, so the result
+	/// does not share memory with the scaler. Rows are aligned to
+	/// IMAGE_ALIGNMENT.
 	/// \param[in]		inputFrame
-	/// \param[in,out]	outputFrame
+	/// \param[out]	outputImage
 	/// \param[in]		scalerContext
 	/// \retval
 	/// \retval
 	auto scale(const AVFrame* inputFrame,
-			   AVFrame* outputFrame,
-			   SwsContext* scalerContext) noexcept {
+			   QImage& outputImage,
+			   const ScalerContext& scalerContext) noexcept {
+
+		if (!inputFrame || !scalerContext.scalerContext)
+			return false;
 
-		if (!inputFrame || ! outputFrame || !scalerContext)
+		if (!allocateImage(scalerContext.outWidth,
+						   scalerContext.outHeight,
+						   convertFormat(scalerContext.outFormat),
+						   outputImage))
 			return false;
 
-		sws_scale(scalerContext,
+		uint8_t* data[4] { outputImage.bits() };
+		int linesize[4] { outputImage.bytesPerLine() };
+
+		sws_scale(scalerContext.scalerContext,
 				  inputFrame->data,
 				  inputFrame->linesize,
 				  0,
 				  inputFrame->height,
-				  outputFrame->data,
-				  outputFrame->linesize);
+				  data,
+				  linesize);
 
 		return true;
 	}
-}
 
-/// A namespace that contains classes and functions for decoding media.
-namespace Decoders {
+	/// Indicates whether the first plane of the format holds 8-bit luma.
+	/// \param[in]	format	Pixel format.
+	/// \retval true if the first plane is 8-bit luma.
+	/// \retval false otherwise.
+	inline auto hasLumaPlane(AVPixelFormat format) noexcept {
+		switch (adjustFormat(format)) {
+		case AV_PIX_FMT_YUV420P:
+		case AV_PIX_FMT_YUV422P:
+		case AV_PIX_FMT_YUV444P:
+		case AV_PIX_FMT_YUV440P:
+		case AV_PIX_FMT_YUV411P:
+		case AV_PIX_FMT_YUV410P:
+		case AV_PIX_FMT_NV12:
+		case AV_PIX_FMT_NV21:
+		case AV_PIX_FMT_GRAY8:
+			return true;
+		default:
+			return false;
+		}
+	}
 
-	///
-	/// \details
-	class VideoDecoder::VideoDecoderPrivate final {
+	/// Indicates whether the luma of a frame spans the full 8-bit range.
+	/// \details Frames in a YUVJ format or flagged with the JPEG range are
+	/// full range; all others are taken as limited range, as swscale does.
+	/// \param[in]	frame	Decoded frame.
+	/// \retval true if luma spans 0 to 255.
+	/// \retval false if luma spans 16 to 235.
+	inline auto hasFullRangeLuma(const AVFrame* frame) noexcept {
+		if (frame->color_range == AVCOL_RANGE_JPEG) return true;
+
+		switch (static_cast<AVPixelFormat>(frame->format)) {
+		case AV_PIX_FMT_YUVJ420P:
+		case AV_PIX_FMT_YUVJ422P:
+		case AV_PIX_FMT_YUVJ444P:
+		case AV_PIX_FMT_YUVJ440P:
+		case AV_PIX_FMT_YUVJ411P:
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	/// Finds the conversion kernel layouts of a pair of formats.
+	/// \param[in]	inFormat	Decoded format.
+	/// \param[in]	format		Output format.
+	/// \param[out]	chroma		Chroma layout of the decoded format.
+	/// \param[out]	layout		Byte order of the output format.
+	/// \retval true if the conversion kernel handles the pair.
+	/// \retval false if the scaler is needed.
+	inline auto findKernelLayouts(AVPixelFormat inFormat,
+								  AVPixelFormat format,
+								  Conversion::ChromaLayout& chroma,
+								  Conversion::RgbLayout& layout) noexcept {
+
+		switch (adjustFormat(inFormat)) {
+		case AV_PIX_FMT_YUV420P:
+			chroma = Conversion::ChromaLayout::Planar;
+			break;
+		case AV_PIX_FMT_NV12:
+			chroma = Conversion::ChromaLayout::Interleaved;
+			break;
+		default:
+			return false;
+		}
+
+		switch (format) {
+		case AV_PIX_FMT_RGB24:
+			layout = Conversion::RgbLayout::RGB24;
+			return true;
+		case AV_PIX_FMT_RGBA:
+			layout = Conversion::RgbLayout::RGBX;
+			return true;
+		case AV_PIX_FMT_BGRA:	// AV_PIX_FMT_RGB32 on little endian hosts.
+			layout = Conversion::RgbLayout::BGRA;
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	/// Releases a frame reference held by an image.
+	/// \param[in]	info	Frame to release.
+	void releaseFrame(void* info) {
+		auto frame = static_cast<AVFrame*>(info);
+		av_frame_free(&frame);
+	}
+
+	/// Wraps the luma plane of a frame into a grayscale image.
+	/// \details The image holds a reference to the decoded frame instead of
+	/// copying it, so the luma must be full range. Qt requires 32-bit
+	/// aligned rows, so other strides are rejected.
+	/// \param[in]		frame	Decoded frame.
+	/// \param[out]	image	Grayscale image.
+	/// \retval true on success.
+	/// \retval false if the plane cannot be wrapped.
+	auto wrapLumaPlane(const AVFrame* frame, QImage& image) noexcept {
+		auto data = frame->data[0];
+		auto stride = frame->linesize[0];
+
+		if (!data ||
+			stride < frame->width ||
+			stride % 4 != 0 ||
+			reinterpret_cast<quintptr>(data) % 4 != 0)
+			return false;
+
+		auto reference = av_frame_clone(frame);
+		if (!reference) return false;
+
+		image = QImage(static_cast<const uchar*>(reference->data[0]),
+					   frame->width,
+					   frame->height,
+					   stride,
+					   QImage::Format_Grayscale8,
+					   releaseFrame,
+					   reference);
+
+		if (image.isNull()) {
+			av_frame_free(&reference);
+			return false;
+		}
+
+		return true;
+	}
+
+	/// Expands the limited range luma plane of a frame into a grayscale
+	/// image.
+	/// \param[in]		frame	Decoded frame.
+	/// \param[out]	image	Grayscale image.
+	/// \retval true on success.
+	/// \retval false on error.
+	auto expandLumaPlane(const AVFrame* frame, QImage& image) noexcept {
+		image = QImage(frame->width, frame->height, QImage::Format_Grayscale8);
+		if (image.isNull()) return false;
+
+		Conversion::expandGray8(frame->data[0],
+								frame->linesize[0],
+								image.bits(),
+								image.bytesPerLine(),
+								frame->width,
+								frame->height);
+
+		return true;
+	}
+
+	/// Widens the luma plane of a frame into a 16-bit grayscale image.
+	/// \details Limited range luma is expanded to the full range.
+	/// \param[in]		frame	Decoded frame.
+	/// \param[out]	image	Grayscale image.
+	/// \retval true on success.
+	/// \retval false on error.
+	auto widenLumaPlane(const AVFrame* frame, QImage& image) noexcept {
+		image = QImage(frame->width, frame->height, QImage::Format_Grayscale16);
+		if (image.isNull()) return false;
+
+		Conversion::widenGray8ToGray16(frame->data[0],
+									   frame->linesize[0],
+									   image.bits(),
+									   image.bytesPerLine(),
+									   frame->width,
+									   frame->height,
+									   !hasFullRangeLuma(frame));
+
+		return true;
+	}
+
+	/// Thresholds the luma plane of a frame into a monochrome image.
+	/// \details Limited range luma is thresholded as if expanded to the
+	/// full range.
+	/// \param[in]		frame	Decoded frame.
+	/// \param[out]	image	Monochrome image.
+	/// \retval true on success.
+	/// \retval false on error.
+	auto thresholdLumaPlane(const AVFrame* frame, QImage& image) noexcept {
+		image = QImage(frame->width, frame->height, QImage::Format_Mono);
+		if (image.isNull()) return false;
+
+		image.setColorTable({ qRgb(0, 0, 0), qRgb(255, 255, 255) });
+
+		Conversion::thresholdGray8ToMono(frame->data[0],
+										 frame->linesize[0],
+										 image.bits(),
+										 image.bytesPerLine(),
+										 frame->width,
+										 frame->height,
+										 128,
+										 !hasFullRangeLuma(frame));
+
+		return true;
+	}
+
+	/// A structure that contains the bands of a frame being converted.
+	/// \details Bands are claimed by the converting thread and by pool
+	/// threads alike, so a busy pool only slows the conversion down. Pool
+	/// threads that start after all bands are claimed return at once.
+	struct BandWork final {
+
+		/// Converts a band.
+		std::function<void(int band)> convert;
+
+		/// Number of bands.
+		int count = 0;
+
+		/// Next unclaimed band.
+		std::atomic<int> next { 0 };
+
+		/// Guards the finished band count.
+		std::mutex mutex;
+
+		/// Signals that all bands are finished.
+		std::condition_variable finished;
+
+		/// Number of finished bands.
+		int done = 0;
+
+		/// Converts bands until none is left.
+		void run() {
+			for (auto band = next++; band < count; band = next++) {
+				convert(band);
+
+				std::lock_guard<std::mutex> lock(mutex);
+				if (++done == count) finished.notify_all();
+			}
+		}
+
+		/// Waits until all bands are finished.
+		void wait() {
+			std::unique_lock<std::mutex> lock(mutex);
+			finished.wait(lock, [this] { return done == count; });
+		}
+	};
+
+	/// A class that converts bands on a pool thread.
+	class BandRunnable final : public QRunnable {
 	public:
 
-		///
-		/// \details
-		VideoDecoderPrivate() noexcept {
+		/// Constructs a runnable.
+		/// \param[in]	work	Bands of the frame.
+		explicit BandRunnable(std::shared_ptr<BandWork> work) noexcept
+			: work_(std::move(work)) {
 
 		}
 
-		///
-		/// \details
-		virtual ~VideoDecoderPrivate() noexcept {
-			destroy();
+		/// Converts bands until none is left.
+		/// \details Band pool threads enter the decoding role once and leave
+		/// it when they exit. No other work runs on them.
+		void run() override {
+			static thread_local Common::Utility::ScopedThreadRole role(
+				Common::Utility::ThreadRole::Decoding);
+
+			work_->run();
 		}
 
+	private:
+
+		/// Bands of the frame.
+		std::shared_ptr<BandWork> work_;
+	};
+
+	/// Returns the pool band conversions run on.
+	/// \details Kept apart from the global pool, so its threads can stay in
+	/// the decoding role without placing threads of unrelated work.
+	/// \return Band pool.
+	QThreadPool& bandPool() {
+		static auto pool = [] {
+			auto pool = new QThreadPool;
+			pool->setMaxThreadCount(QThread::idealThreadCount());
+			return pool;
+		}();
+
+		return *pool;
+	}
+
+	/// A class that converts decoded frames to output images.
+	/// \details Shared by a decoder and the frames it emits unconverted, so
+	/// conversions on any thread are serialized and accounted in one place.
+	/// The scaler follows the size and format of each frame instead of the
+	/// codec context, as a deferred frame may be converted after the decoder
+	/// moved on.
+	class FrameConverter final {
 	public:
 
-		///
-		/// \details
-		/// \param[in]	codecID
-		/// \param[in]	format
-		/// \retval
-		/// \retval
-		bool initialize(AVCodecID codecID, AVPixelFormat format) noexcept {
-			return setFormat(format) && ::initialize(codecID, decoderContext_);
+		/// Destroys the converter.
+		~FrameConverter() noexcept {
+			destroyScalers();
 		}
 
-		///
-		/// \details
-		void destroy() noexcept {
-			::destroy(scalerContext_);
-			::destroy(decoderContext_);
+	public:
+
+		/// Converts a decoded frame and accounts the conversion time.
+		/// \param[in]		frame	Decoded frame.
+		/// \param[in]		format	Output format.
+		/// \param[out]	image	Output image.
+		/// \retval true on success.
+		/// \retval false on error.
+		bool convert(const AVFrame* frame,
+					 AVPixelFormat format,
+					 QImage& image) noexcept {
+
+			std::lock_guard<std::mutex> lock(mutex_);
+
+			auto startTime = std::chrono::steady_clock::now();
+			auto converted = convertFrame(frame, format, image);
+
+			convertedFrames_.fetch_add(1, relaxed);
+			convertTime_.fetch_add(static_cast<quint64>(
+				std::chrono::duration_cast<std::chrono::microseconds>(
+					std::chrono::steady_clock::now() - startTime).count()),
+				relaxed);
+
+			return converted;
 		}
 
-		///
-		/// \details
-		/// \return
-		const QImage& getFrame() const noexcept {
-			return lastFrame_;
+		/// Frees the scalers.
+		void reset() noexcept {
+			std::lock_guard<std::mutex> lock(mutex_);
+			destroyScalers();
 		}
 
-		///
-		/// \details
-		/// \return
-		QImage& getFrame() noexcept {
-			return lastFrame_;
+		/// Sets the number of bands frames are split into.
+		/// \param[in]	count	Number of bands, zero for automatic selection.
+		void setBandCount(int count) noexcept {
+			std::lock_guard<std::mutex> lock(mutex_);
+			bandCount_ = qBound(0, count, MAXIMUM_BANDS);
 		}
 
-		///
-		/// \details
-		/// \param[in]	format
-		/// \retval
-		/// \retval
-		bool setFormat(AVPixelFormat format) noexcept {
-			if (format == AV_PIX_FMT_NONE) return false;
+		/// Sets the number of times output images are halved in size.
+		/// \details Applies from the next conversion without waiting for a
+		/// running one.
+		/// \param[in]	downscale	Number of halvings, zero for full size.
+		void setDownscale(int downscale) noexcept {
+			downscale_.store(qBound(0, downscale, MAXIMUM_DOWNSCALE), relaxed);
+		}
 
-			scalerContext_.modifiedFormat = adjustFormat(format);
+		/// Sets the size output images are shown at.
+		/// \details Frames are halved for as long as the result still covers
+		/// the size in both dimensions. Applies from the next conversion
+		/// without waiting for a running one.
+		/// \param[in]	size	Size in device pixels, or an empty size for
+		///						full size.
+		void setTargetSize(const QSize& size) noexcept {
+			targetWidth_.store(size.isEmpty() ? 0 : size.width(), relaxed);
+			targetHeight_.store(size.isEmpty() ? 0 : size.height(), relaxed);
+		}
 
-			return true;
+		/// Returns the number of converted frames.
+		/// \return Number of converted frames.
+		quint64 getConvertedFrames() const noexcept {
+			return convertedFrames_.load(relaxed);
 		}
 
-		///
-		/// \details
-		/// \param[in]	data
-		/// \retval
-		/// \retval
-		bool setExtradata(const QByteArray& data) noexcept {
-			return ::setExtradata(data.data(), data.size(), decoderContext_);
+		/// Returns the conversion time.
+		/// \return Conversion time in microseconds.
+		quint64 getConvertTime() const noexcept {
+			return convertTime_.load(relaxed);
 		}
 
-		///
-		/// \details
-		/// \param[in]	data
-		/// \retval
-		/// \retval
-		bool decode(const QByteArray& data) noexcept {
-			if (!::setData(data.data(), data.size(), decoderContext_.packet))
-				return false;
+		/// Returns the number of frames converted in bands.
+		/// \return Number of split frames.
+		quint64 getSplitFrames() const noexcept {
+			return splitFrames_.load(relaxed);
+		}
 
-			auto statusCode = ::decode(decoderContext_.codecContext,
-									   decoderContext_.frame,
-									   decoderContext_.packet);
+		/// Returns the number of frames converted at reduced size.
+		/// \return Number of downscaled frames.
+		quint64 getDownscaledFrames() const noexcept {
+			return downscaledFrames_.load(relaxed);
+		}
 
-			if (statusCode == DecoderStatusCode::Error) {
-				return false;
+	private:
+
+		/// Converts a decoded frame to an output image.
+		/// \details Grayscale and monochrome output from YUV sources is
+		/// taken from the luma plane directly, wrapped without a copy when
+		/// it is full range and expanded otherwise, and YUV 4:2:0 to RGB goes
+		/// through the conversion kernel; everything else goes through the
+		/// scaler. Large frames are split into bands either way. Downscaled
+		/// frames are halved by the kernel or scaled whole by the scaler;
+		/// memory degradation and the target size each ask for a number of
+		/// halvings and the larger one applies.
+		/// \param[in]		frame	Decoded frame.
+		/// \param[in]		format	Output format.
+		/// \param[out]	image	Output image.
+		/// \retval true on success.
+		/// \retval false on error.
+		bool convertFrame(const AVFrame* frame,
+						  AVPixelFormat format,
+						  QImage& image) noexcept {
+
+			auto inFormat = static_cast<AVPixelFormat>(frame->format);
+
+			auto downscale = qMax(downscale_.load(relaxed),
+								  targetDownscale(frame));
+
+			if (downscale > 0) {
+				auto converted =
+					downscaleFrame(frame, format, downscale, image);
+				if (converted) downscaledFrames_.fetch_add(1, relaxed);
+
+				return converted;
 			}
-			else if (statusCode == DecoderStatusCode::DecoderFlushed ||
-					 statusCode == DecoderStatusCode::NeedMoreData) {
-				return true;
+
+			if (hasLumaPlane(inFormat) && frame->linesize[0] > 0) {
+				switch (format) {
+				case AV_PIX_FMT_GRAY8:
+					if (!::hasFullRangeLuma(frame))
+						return ::expandLumaPlane(frame, image);
+					if (::wrapLumaPlane(frame, image)) return true;
+					break;
+				case AV_PIX_FMT_GRAY16:
+					return ::widenLumaPlane(frame, image);
+				case AV_PIX_FMT_MONOBLACK:
+					return ::thresholdLumaPlane(frame, image);
+				default:
+					break;
+				}
 			}
 
-			while (statusCode == DecoderStatusCode::FrameReceived ||
-				   statusCode == DecoderStatusCode::ReceiveFrameFirst) {
+			auto bandHeight = findBandHeight(frame);
+			Conversion::ChromaLayout chroma;
+			Conversion::RgbLayout layout;
+
+			if (findKernelLayouts(inFormat, format, chroma, layout))
+				return convertKernel(frame,
+									 format,
+									 chroma,
+									 layout,
+									 bandHeight,
+									 false,
+									 image);
+
+			if (bandHeight < frame->height)
+				return scaleBands(frame, format, bandHeight, image);
+
+			return initializeScalerContext(scalerContext_,
+										   frame->width,
+										   frame->height,
+										   adjustFormat(inFormat),
+										   format) &&
+				   ::scale(frame, image, scalerContext_);
+		}
 
-				if (statusCode == DecoderStatusCode::FrameReceived &&
-					initializeScalerContext(decoderContext_.codecContext) &&
-					::scale(decoderContext_.frame, scalerContext_.frame,
-							scalerContext_.scalerContext)) {
+		/// Returns the number of halvings the target size allows.
+		/// \param[in]	frame	Decoded frame.
+		/// \return Number of halvings, zero without a target size.
+		int targetDownscale(const AVFrame* frame) const noexcept {
+			auto width = targetWidth_.load(relaxed);
+			auto height = targetHeight_.load(relaxed);
 
-					auto format = convertFormat(scalerContext_.outFormat);
+			if (width <= 0 || height <= 0) return 0;
 
-					lastFrame_ = QImage(scalerContext_.frame->data[0],
-										scalerContext_.outWidth,
-										scalerContext_.outHeight,
-                                        format);
-				}
+			auto downscale = 0;
+			while (downscale < MAXIMUM_DOWNSCALE &&
+				   (frame->width >> (downscale + 1)) >= width &&
+				   (frame->height >> (downscale + 1)) >= height)
+				++downscale;
 
-				statusCode = ::decode(decoderContext_.codecContext,
-									  decoderContext_.frame);
-			}
+			return downscale;
+		}
 
-			return statusCode != DecoderStatusCode::Error;
+		/// Converts a decoded frame to a reduced size output image.
+		/// \details Halving YUV 4:2:0 to RGB goes through the conversion
+		/// kernel, split into bands like a full size frame; everything else
+		/// goes through the scaler whole.
+		/// \param[in]		frame		Decoded frame.
+		/// \param[in]		format		Output format.
+		/// \param[in]		downscale	Number of times the image is halved
+		///								in size.
+		/// \param[out]	image		Output image.
+		/// \retval true on success.
+		/// \retval false on error.
+		bool downscaleFrame(const AVFrame* frame,
+							AVPixelFormat format,
+							int downscale,
+							QImage& image) noexcept {
+
+			auto inFormat = static_cast<AVPixelFormat>(frame->format);
+			Conversion::ChromaLayout chroma;
+			Conversion::RgbLayout layout;
+
+			if (downscale == 1 &&
+				frame->width >= 2 && frame->height >= 2 &&
+				findKernelLayouts(inFormat, format, chroma, layout))
+				return convertKernel(frame,
+									 format,
+									 chroma,
+									 layout,
+									 findBandHeight(frame),
+									 true,
+									 image);
+
+			return initializeScalerContext(scalerContext_,
+										   frame->width,
+										   frame->height,
+										   adjustFormat(inFormat),
+										   format,
+										   downscale) &&
+				   ::scale(frame, image, scalerContext_);
 		}
 
-	private:
+		/// Finds the height of the bands a frame is split into.
+		/// \details Automatic selection gives every band at least
+		/// MINIMUM_BAND_PIXELS and uses no more bands than processors.
+		/// Paletted and hardware formats are never split.
+		/// \param[in]	frame	Decoded frame.
+		/// \return Band height in rows, the frame height if not split.
+		int findBandHeight(const AVFrame* frame) const noexcept {
+			auto descriptor =
+				av_pix_fmt_desc_get(static_cast<AVPixelFormat>(frame->format));
+
+			if (!descriptor ||
+				descriptor->flags & (AV_PIX_FMT_FLAG_PAL |
+									 AV_PIX_FMT_FLAG_HWACCEL |
+									 AV_PIX_FMT_FLAG_BITSTREAM))
+				return frame->height;
+
+			auto bands = bandCount_;
+
+			if (bands == 0)
+				bands = static_cast<int>(qMin<qint64>(
+					QThread::idealThreadCount(),
+					static_cast<qint64>(frame->width) * frame->height /
+						MINIMUM_BAND_PIXELS));
+
+			bands = qMin(bands, frame->height / BAND_ALIGNMENT);
+			if (bands <= 1) return frame->height;
+
+			auto bandHeight = (frame->height + bands - 1) / bands;
+			return (bandHeight + BAND_ALIGNMENT - 1) / BAND_ALIGNMENT *
+				   BAND_ALIGNMENT;
+		}
 
-		///
-		/// \details
-		/// \retval
-		/// \retval
-		bool initializeScalerContext(AVCodecContext* codecContext) noexcept {
-			if (!codecContext) return false;
+		/// Converts a YUV 4:2:0 frame to RGB with the conversion kernel.
+		/// \details Bands start on even rows, so each band reads its own
+		/// chroma rows and the result matches the whole frame exactly. A
+		/// halved band fills half as many rows of the image.
+		/// \param[in]		frame		Decoded frame.
+		/// \param[in]		format		Output format.
+		/// \param[in]		chroma		Chroma layout of the frame.
+		/// \param[in]		layout		Byte order of the output format.
+		/// \param[in]		bandHeight	Band height in rows.
+		/// \param[in]		halve		Indicates whether the image is half
+		///								the frame size.
+		/// \param[out]	image		Output image.
+		/// \retval true on success.
+		/// \retval false on error.
+		bool convertKernel(const AVFrame* frame,
+						   AVPixelFormat format,
+						   Conversion::ChromaLayout chroma,
+						   Conversion::RgbLayout layout,
+						   int bandHeight,
+						   bool halve,
+						   QImage& image) noexcept {
+
+			auto shift = halve ? 1 : 0;
+
+			if (!allocateImage(frame->width >> shift,
+							   frame->height >> shift,
+							   convertFormat(format),
+							   image))
+				return false;
 
-			if (!scalerContext_.scalerContext ||
-				scalerContext_.inWidth != codecContext->width ||
-				scalerContext_.inHeight != codecContext->height ||
-				scalerContext_.inFormat != adjustFormat(codecContext->pix_fmt)||
-				scalerContext_.outFormat != scalerContext_.modifiedFormat) {
+			auto bits = image.bits();
+			auto bytesPerLine = image.bytesPerLine();
+			auto bands = (frame->height + bandHeight - 1) / bandHeight;
 
-				scalerContext_.inWidth = codecContext->width;
-				scalerContext_.inHeight = codecContext->height;
-				scalerContext_.inFormat = adjustFormat(codecContext->pix_fmt);
-				scalerContext_.outWidth = scalerContext_.inWidth;
-				scalerContext_.outHeight = scalerContext_.inHeight;
-				scalerContext_.outFormat = scalerContext_.modifiedFormat;
-				scalerContext_.flags = SWS_BICUBIC;
+			runBands(bands, [=](int band) {
+				auto top = band * bandHeight;
+				auto rows = qMin(bandHeight, frame->height - top);
+				const uint8_t* planes[3] { };
 
-				return ::initialize(scalerContext_);
-			}
+				for (auto plane = 0; plane < 3 && frame->data[plane]; ++plane) {
+					auto row = static_cast<std::ptrdiff_t>(
+						plane == 0 ? top : top / 2);
+
+					planes[plane] = frame->data[plane] +
+									row * frame->linesize[plane];
+				}
+
+				auto offset = static_cast<std::ptrdiff_t>(top >> shift) *
+							  bytesPerLine;
+
+				Conversion::convertYuv420ToRgb(planes,
+											   frame->linesize,
+											   chroma,
+											   frame->width,
+											   rows,
+											   bits + offset,
+											   bytesPerLine,
+											   layout,
+											   halve);
+			});
+
+			if (bands > 1)
+				splitFrames_.fetch_add(1, relaxed);
 
 			return true;
 		}
 
-	private:
+		/// Runs the bands of a frame on the band pool.
+		/// \details The calling thread converts bands too and returns once
+		/// all are done. A single band runs on the calling thread only.
+		/// \param[in]	bands	Number of bands.
+		/// \param[in]	convert	Converts a band.
+		void runBands(int bands, std::function<void(int band)> convert) {
+			if (bands <= 1) {
+				convert(0);
+				return;
+			}
 
-		///
-		/// \details
-		QImage lastFrame_;
+			auto work = std::make_shared<BandWork>();
+			work->count = bands;
+			work->convert = std::move(convert);
 
-		///
-		/// \details
-		DecoderContext decoderContext_;
+			auto& pool = bandPool();
 
-		///
-		/// \details
-		ScalerContext scalerContext_;
-	};
+			for (auto helper = 1; helper < bands; ++helper) {
+				auto runnable = new BandRunnable(work);
 
-	///
+				if (!pool.tryStart(runnable)) {
+					delete runnable;
+					break;
+				}
+			}
+
+			work->run();
+			work->wait();
+		}
+
+		/// Converts a frame in horizontal bands on the band pool.
+		/// \details Each band has its own scaler over its rows of the frame,
+		/// so bands convert independently into their rows of the image. The
+		/// calling thread converts bands too and returns once all are done.
+		/// Filters that reach across rows see the band edge as the frame
+		/// edge, so scaled chroma may differ slightly next to a band edge;
+		/// unscaled conversions match the whole frame exactly.
+		/// \param[in]		frame		Decoded frame.
+		/// \param[in]		format		Output format.
+		/// \param[in]		bandHeight	Band height in rows.
+		/// \param[out]	image		Output image.
+		/// \retval true on success.
+		/// \retval false on error.
+		bool scaleBands(const AVFrame* frame,
+						AVPixelFormat format,
+						int bandHeight,
+						QImage& image) noexcept {
+
+			auto inFormat =
+				adjustFormat(static_cast<AVPixelFormat>(frame->format));
+			auto descriptor = av_pix_fmt_desc_get(inFormat);
+			auto bands = (frame->height + bandHeight - 1) / bandHeight;
+
+			if (static_cast<int>(bandContexts_.size()) != bands) {
+				for (auto& bandContext : bandContexts_) ::destroy(bandContext);
+				bandContexts_.resize(static_cast<std::size_t>(bands));
+			}
+
+			for (auto band = 0; band < bands; ++band) {
+				auto rows = qMin(bandHeight, frame->height - band * bandHeight);
+
+				if (!initializeScalerContext(bandContexts_[band],
+											 frame->width,
+											 rows,
+											 inFormat,
+											 format))
+					return false;
+			}
+
+			if (!allocateImage(frame->width,
+							   frame->height,
+							   convertFormat(format),
+							   image))
+				return false;
+
+			auto bits = image.bits();
+			auto bytesPerLine = image.bytesPerLine();
+
+			runBands(bands, [=](int band) {
+				auto top = band * bandHeight;
+				const uint8_t* data[4] { };
+
+				for (auto plane = 0; plane < 4 && frame->data[plane]; ++plane) {
+					auto chroma = (plane == 1 || plane == 2) &&
+								  !(descriptor->flags & AV_PIX_FMT_FLAG_RGB);
+					auto row = static_cast<std::ptrdiff_t>(
+						chroma ? top >> descriptor->log2_chroma_h : top);
+
+					data[plane] = frame->data[plane] +
+								  row * frame->linesize[plane];
+				}
+
+				auto offset = static_cast<std::ptrdiff_t>(top) * bytesPerLine;
+				uint8_t* outData[4] { bits + offset };
+				int outLinesize[4] { bytesPerLine };
+
+				sws_scale(bandContexts_[band].scalerContext,
+						  data,
+						  frame->linesize,
+						  0,
+						  bandContexts_[band].inHeight,
+						  outData,
+						  outLinesize);
+			});
+
+			splitFrames_.fetch_add(1, relaxed);
+			return true;
+		}
+
+		/// Creates a scaler unless it matches the geometry and the formats.
+		/// \param[in,out]	scalerContext	Scaler.
+		/// \param[in]		width			Frame width.
+		/// \param[in]		height			Frame height.
+		/// \param[in]		inFormat		Decoded format.
+		/// \param[in]		format			Output format.
+		/// \param[in]		downscale		Number of times the output is
+		///									halved in size.
+		/// \retval true on success.
+		/// \retval false on error.
+		bool initializeScalerContext(ScalerContext& scalerContext,
+									 int width,
+									 int height,
+									 AVPixelFormat inFormat,
+									 AVPixelFormat format,
+									 int downscale = 0) noexcept {
+
+			auto outWidth = qMax(1, width >> downscale);
+			auto outHeight = qMax(1, height >> downscale);
+
+			if (!scalerContext.scalerContext ||
+				scalerContext.inWidth != width ||
+				scalerContext.inHeight != height ||
+				scalerContext.inFormat != inFormat ||
+				scalerContext.outWidth != outWidth ||
+				scalerContext.outHeight != outHeight ||
+				scalerContext.outFormat != format) {
+
+				scalerContext.inWidth = width;
+				scalerContext.inHeight = height;
+				scalerContext.inFormat = inFormat;
+				scalerContext.outWidth = outWidth;
+				scalerContext.outHeight = outHeight;
+				scalerContext.outFormat = format;
+				scalerContext.flags = SWS_BICUBIC;
+
+				return ::initialize(scalerContext);
+			}
+
+			return true;
+		}
+
+		/// Frees the scalers.
+		void destroyScalers() noexcept {
+			::destroy(scalerContext_);
+
+			for (auto& bandContext : bandContexts_) ::destroy(bandContext);
+			bandContexts_.clear();
+		}
+
+	private:
+
+		/// Memory order used by statistics counters.
+		static constexpr auto relaxed = std::memory_order_relaxed;
+
+		/// Serializes conversions.
+		std::mutex mutex_;
+
+		/// Scaler of the last frame converted whole.
+		ScalerContext scalerContext_;
+
+		/// Scalers of the bands of the last split frame.
+		std::vector<ScalerContext> bandContexts_;
+
+		/// Number of bands, zero for automatic selection.
+		int bandCount_ = 0;
+
+		/// Number of times output images are halved in size.
+		std::atomic<int> downscale_ { 0 };
+
+		/// Width output images are shown at, zero for full size.
+		std::atomic<int> targetWidth_ { 0 };
+
+		/// Height output images are shown at, zero for full size.
+		std::atomic<int> targetHeight_ { 0 };
+
+		/// Number of frames converted at reduced size.
+		std::atomic<quint64> downscaledFrames_ { 0 };
+
+		/// Number of frames converted in bands.
+		std::atomic<quint64> splitFrames_ { 0 };
+
+		/// Number of converted frames.
+		std::atomic<quint64> convertedFrames_ { 0 };
+
+		/// Conversion time in microseconds.
+		std::atomic<quint64> convertTime_ { 0 };
+	};
+
+	/// A class that decodes MJPEG frames concurrently.
+	/// \details MJPEG frames are independent, but the FFmpeg decoder has
+	/// neither frame nor slice threading. The pipeline keeps one decoder per
+	/// worker thread, hands consecutive frames to whichever worker is free
+	/// and returns the pictures in submission order. At most a window of
+	/// frames is in flight.
+	class MjpegPipeline final {
+	public:
+
+		/// A function that takes a decoded picture.
+		/// \details The frame is null if the picture failed to decode.
+		using FrameHandler = std::function<void(AVFrame* frame)>;
+
+	public:
+
+		/// Destroys the pipeline.
+		~MjpegPipeline() noexcept {
+			stop();
+		}
+
+	public:
+
+		/// Starts the workers.
+		/// \details Frames in flight of a previous start are dropped. Every
+		/// decoder gets the extradata of the decoder the pipeline replaces.
+		/// \param[in]	decoders	Number of decoders.
+		/// \param[in]	flags		Error concealment flags.
+		/// \param[in]	source		Codec context with the extradata.
+		/// \retval true on success.
+		/// \retval false on error.
+		bool start(int decoders,
+				   Decoders::VideoDecoder::ConcealmentFlags flags,
+				   const AVCodecContext* source) noexcept {
+
+			stop();
+
+			contexts_.resize(static_cast<std::size_t>(decoders));
+
+			for (auto& decoderContext : contexts_) {
+				if (!::initialize(AV_CODEC_ID_MJPEG, decoderContext) ||
+					!::configure(flags, 1, decoderContext)) {
+					stop();
+					return false;
+				}
+
+				if (source->extradata &&
+					!::setExtradata(reinterpret_cast<const char*>(
+										source->extradata),
+									source->extradata_size,
+									decoderContext)) {
+					stop();
+					return false;
+				}
+			}
+
+			window_ = decoders * MJPEG_FRAMES_PER_DECODER;
+			stopping_ = false;
+
+			for (auto& decoderContext : contexts_) {
+				workers_.emplace_back([this, &decoderContext] {
+					run(decoderContext);
+				});
+			}
+
+			return true;
+		}
+
+		/// Stops the workers and drops the frames in flight.
+		void stop() noexcept {
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				stopping_ = true;
+			}
+
+			jobAvailable_.notify_all();
+
+			for (auto& worker : workers_) worker.join();
+			workers_.clear();
+
+			for (auto& job : jobs_) av_packet_free(&job.packet);
+			jobs_.clear();
+
+			for (auto& finished : finished_) av_frame_free(&finished.second);
+			finished_.clear();
+
+			for (auto& decoderContext : contexts_) ::destroy(decoderContext);
+			contexts_.clear();
+
+			nextSequence_ = 0;
+			nextOutput_ = 0;
+		}
+
+		/// Indicates whether the workers run.
+		/// \retval true if frames are decoded concurrently.
+		/// \retval false otherwise.
+		bool isRunning() const noexcept {
+			return !workers_.empty();
+		}
+
+		/// Returns the number of frames in flight.
+		/// \return Window size in frames.
+		int getWindow() const noexcept {
+			return window_;
+		}
+
+		/// Queues a frame for decoding.
+		/// \details Copies the packet, as the caller reuses its buffer. The
+		/// window is not checked, so collect() should make room first.
+		/// \param[in]	packet	Encoded frame.
+		/// \param[in]	key		Reordered opaque value of the picture.
+		/// \retval true on success.
+		/// \retval false on error.
+		bool submit(const AVPacket* packet, int64_t key) noexcept {
+			auto copy = av_packet_alloc();
+			if (!copy) return false;
+
+			if (av_new_packet(copy, packet->size) < 0) {
+				av_packet_free(&copy);
+				return false;
+			}
+
+			memcpy(copy->data,
+				   packet->data,
+				   static_cast<std::size_t>(packet->size));
+			copy->pts = packet->pts;
+			copy->dts = packet->dts;
+
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				jobs_.push_back({ nextSequence_++, copy, key });
+			}
+
+			jobAvailable_.notify_one();
+			return true;
+		}
+
+		/// Takes decoded pictures in submission order.
+		/// \details Passes every finished picture that has no unfinished
+		/// predecessor, then waits for the oldest pictures until no more
+		/// than a number of frames is in flight. Handlers run on the
+		/// calling thread without the lock held.
+		/// \param[in]	handle		Takes each picture.
+		/// \param[in]	inFlight	Number of frames left in flight.
+		void collect(const FrameHandler& handle, int inFlight) noexcept {
+			std::unique_lock<std::mutex> lock(mutex_);
+
+			for (;;) {
+				auto finished = finished_.find(nextOutput_);
+
+				if (finished == finished_.end()) {
+					auto pending = nextSequence_ - nextOutput_;
+					if (pending <= static_cast<quint64>(inFlight)) return;
+
+					frameFinished_.wait(lock);
+					continue;
+				}
+
+				auto frame = finished->second;
+				finished_.erase(finished);
+				++nextOutput_;
+
+				lock.unlock();
+				handle(frame);
+				av_frame_free(&frame);
+				lock.lock();
+			}
+		}
+
+	private:
+
+		/// A structure that contains a frame waiting for a worker.
+		struct Job {
+
+			/// Submission order.
+			quint64 sequence;
+
+			/// Encoded frame.
+			AVPacket* packet;
+
+			/// Reordered opaque value of the picture.
+			int64_t key;
+		};
+
+	private:
+
+		/// Decodes queued frames until stopped.
+		/// \details Workers run in the decoding role.
+		/// \param[in,out]	decoderContext	Decoder of the worker.
+		void run(DecoderContext& decoderContext) noexcept {
+			Common::Utility::ScopedThreadRole role(
+				Common::Utility::ThreadRole::Decoding);
+
+			for (;;) {
+				Job job;
+
+				{
+					std::unique_lock<std::mutex> lock(mutex_);
+					jobAvailable_.wait(lock, [this] {
+						return stopping_ || !jobs_.empty();
+					});
+
+					if (stopping_) return;
+
+					job = jobs_.front();
+					jobs_.pop_front();
+				}
+
+				auto frame = av_frame_alloc();
+				decoderContext.codecContext->reordered_opaque = job.key;
+
+				auto statusCode = frame
+					? ::decode(decoderContext.codecContext, frame, job.packet)
+					: DecoderStatusCode::Error;
+
+				if (statusCode == DecoderStatusCode::FrameReceived)
+					frame->reordered_opaque = job.key;
+				else
+					av_frame_free(&frame);
+
+				av_packet_free(&job.packet);
+
+				{
+					std::lock_guard<std::mutex> lock(mutex_);
+					finished_[job.sequence] = frame;
+				}
+
+				frameFinished_.notify_all();
+			}
+		}
+
+	private:
+
+		/// Decoders, one per worker.
+		std::vector<DecoderContext> contexts_;
+
+		/// Worker threads.
+		std::vector<std::thread> workers_;
+
+		/// Guards the queues and the stop request.
+		std::mutex mutex_;
+
+		/// Signals that a frame was queued or the workers should stop.
+		std::condition_variable jobAvailable_;
+
+		/// Signals that a frame was decoded.
+		std::condition_variable frameFinished_;
+
+		/// Frames waiting for a worker.
+		std::deque<Job> jobs_;
+
+		/// Decoded pictures by submission order, null if decoding failed.
+		std::map<quint64, AVFrame*> finished_;
+
+		/// Submission order of the next frame.
+		quint64 nextSequence_ = 0;
+
+		/// Submission order of the next picture to collect.
+		quint64 nextOutput_ = 0;
+
+		/// Maximum number of frames in flight.
+		int window_ = 0;
+
+		/// Indicates whether the workers should stop.
+		bool stopping_ = false;
+	};
+}
+
+/// A namespace that contains classes and functions for decoding media.
+namespace Decoders {
+
+	/// A structure that contains the state of a decoded frame.
+	/// \details The decoded picture is released once it is converted.
+	struct VideoDecoder::DecodedFrame::Data final {
+
+		/// Destroys the frame state.
+		~Data() noexcept {
+			av_frame_free(&frame);
+		}
+
+		/// Decoded picture, or null once converted.
+		AVFrame* frame = nullptr;
+
+		/// Output format at decoding time.
+		AVPixelFormat format = AV_PIX_FMT_NONE;
+
+		/// Converter of the decoder.
+		std::shared_ptr<FrameConverter> converter;
+
+		/// Guards the picture and the image.
+		std::mutex mutex;
+
+		/// Converted picture.
+		QImage image;
+
+		/// Indicates whether the picture was converted.
+		bool converted = false;
+	};
+
+	///
+	/// \details
+	class VideoDecoder::VideoDecoderPrivate final {
+	public:
+
+		///
+		/// \details
+		VideoDecoderPrivate() noexcept {
+
+		}
+
+		///
+		/// \details
+		virtual ~VideoDecoderPrivate() noexcept {
+			destroy();
+		}
+
+	public:
+
+		///
+		/// \details
+		/// \param[in]	codecID
+		/// \param[in]	format
+		/// \retval
+		/// \retval
+		bool initialize(AVCodecID codecID, AVPixelFormat format) noexcept {
+			codecID_ = codecID;
+			lastNumber_ = -1;
+			lastKeyframeTime_ = 0;
+			referenceChainValid_ = false;
+
+			if (heldFrame_) av_frame_unref(heldFrame_);
+			lastDecodedFrame_ = VideoDecoder::DecodedFrame();
+
+			return setFormat(format) &&
+				   ::initialize(codecID, decoderContext_) &&
+				   ::configure(concealment_, threadCount_, decoderContext_) &&
+				   updatePipeline();
+		}
+
+		///
+		/// \details
+		void destroy() noexcept {
+			mjpegPipeline_.stop();
+			av_frame_free(&heldFrame_);
+			lastDecodedFrame_ = VideoDecoder::DecodedFrame();
+			converter_->reset();
+			::destroy(decoderContext_);
+			updateMemoryUsage();
+		}
+
+		///
+		/// \details
+		/// \return
+		const QImage& getFrame() const noexcept {
+			return lastFrame_;
+		}
+
+		///
+		/// \details
+		/// \return
+		QImage& getFrame() noexcept {
+			return lastFrame_;
+		}
+
+		/// Returns the last frame left unconverted.
+		/// \return Decoded frame.
+		const VideoDecoder::DecodedFrame& getDecodedFrame() const noexcept {
+			return lastDecodedFrame_;
+		}
+
+		/// Returns the identity of the last decoded frame.
+		/// \return Network frame identity.
+		const VideoDecoder::FrameInfo& getFrameInfo() const noexcept {
+			return lastFrameInfo_;
+		}
+
+		/// Indicates whether the last decoding call produced a new frame.
+		/// \retval true if a new frame is available.
+		/// \retval false if the last good frame is held.
+		bool isFrameUpdated() const noexcept {
+			return frameUpdated_;
+		}
+
+		/// Returns the decoding statistics.
+		/// \details Reads relaxed atomic counters, so the snapshot may be
+		/// slightly inconsistent across fields.
+		/// \return Decoding statistics.
+		VideoDecoder::Statistics getStatistics() const noexcept {
+			VideoDecoder::Statistics statistics;
+			statistics.decodedFrames = decodedFrames_.load(relaxed);
+			statistics.skippedFrames = skippedFrames_.load(relaxed);
+			statistics.skippedBytes = skippedBytes_.load(relaxed);
+			statistics.corruptedFrames = corruptedFrames_.load(relaxed);
+			statistics.frameGaps = frameGaps_.load(relaxed);
+			statistics.decodeTime = decodeTime_.load(relaxed);
+			statistics.wastedDecodeTime = wastedDecodeTime_.load(relaxed);
+			statistics.throttledFrames = throttledFrames_.load(relaxed);
+			statistics.disposedFrames = disposedFrames_.load(relaxed);
+			statistics.fullTime = fullTime_.load(relaxed);
+			statistics.decodeOnlyTime = decodeOnlyTime_.load(relaxed);
+			statistics.keyframesOnlyTime = keyframesOnlyTime_.load(relaxed);
+			statistics.receivedFrames = receivedFrames_.load(relaxed);
+			statistics.receivedBytes = receivedBytes_.load(relaxed);
+			statistics.convertedFrames = converter_->getConvertedFrames();
+			statistics.convertTime = converter_->getConvertTime();
+			statistics.supersededFrames = supersededFrames_.load(relaxed);
+			statistics.splitFrames = converter_->getSplitFrames();
+			statistics.concurrentFrames = concurrentFrames_.load(relaxed);
+			statistics.downscaledFrames = converter_->getDownscaledFrames();
+			return statistics;
+		}
+
+		///
+		/// \details
+		/// \param[in]	format
+		/// \retval
+		/// \retval
+		bool setFormat(AVPixelFormat format) noexcept {
+			if (format == AV_PIX_FMT_NONE) return false;
+
+			format_ = adjustFormat(format);
+
+			return true;
+		}
+
+		/// Indicates whether conversion is deferred.
+		/// \retval true if frames are left unconverted.
+		/// \retval false if frames are converted while decoding.
+		bool isDeferred() const noexcept {
+			return deferred_;
+		}
+
+		/// Enables or disables deferred conversion.
+		/// \param[in]	enabled	Indicates whether frames are left unconverted.
+		void setDeferred(bool enabled) noexcept {
+			deferred_ = enabled;
+		}
+
+		/// Sets whether disposable frames are dropped at full activity.
+		/// \param[in]	overloaded	Indicates whether the output is overloaded.
+		void setOverloaded(bool overloaded) noexcept {
+			overloaded_ = overloaded;
+		}
+
+		/// Sets the size frames are shown at.
+		/// \param[in]	size	Size in device pixels, or an empty size for
+		///						full size.
+		void setOutputSize(const QSize& size) noexcept {
+			converter_->setTargetSize(size);
+		}
+
+		/// Sets the account decoder memory is reported to.
+		/// \details The previous account is cleared. The stream counts as
+		/// hidden below full activity.
+		/// \param[in]	account	Memory account of the stream, or null.
+		void setMemoryAccount(
+			std::shared_ptr<Common::Utility::MemoryAccount> account) noexcept {
+
+			using Common::Utility::MemoryStage;
+
+			if (memoryAccount_) {
+				memoryAccount_->setUsage(MemoryStage::Decoding, 0);
+				memoryAccount_->setUsage(MemoryStage::Conversion, 0);
+			}
+
+			memoryAccount_ = std::move(account);
+			converter_->setDownscale(0);
+
+			if (!memoryAccount_) return;
+
+			evictionCount_ = memoryAccount_->evictionCount();
+			memoryAccount_->setHidden(
+				activity_ != VideoDecoder::Activity::Full);
+			updateMemoryUsage();
+		}
+
+		/// Sets the number of threads converting a frame.
+		/// \param[in]	count	Number of threads, zero for automatic selection.
+		/// \retval true on success.
+		/// \retval false on error.
+		bool setConversionThreadCount(int count) noexcept {
+			if (count < 0) return false;
+
+			converter_->setBandCount(count);
+			return true;
+		}
+
+		///
+		/// \details Concurrent MJPEG decoders are restarted with the new
+		/// extradata.
+		/// \param[in]	data
+		/// \retval
+		/// \retval
+		bool setExtradata(const QByteArray& data) noexcept {
+			if (!::setExtradata(data.data(), data.size(), decoderContext_))
+				return false;
+
+			return !mjpegPipeline_.isRunning() || updatePipeline();
+		}
+
+		/// Sets error concealment flags.
+		/// \details Flags are stored even if the decoder is not initialized
+		/// yet and applied on initialization.
+		/// \param[in]	flags	Error concealment flags.
+		/// \retval true on success.
+		/// \retval false on error.
+		bool setConcealment(VideoDecoder::ConcealmentFlags flags) noexcept {
+			concealment_ = flags;
+
+			if (!decoderContext_.codecContext)
+				return true;
+
+			return ::configure(flags, threadCount_, decoderContext_) &&
+				   updatePipeline();
+		}
+
+		/// Sets the number of decoding threads.
+		/// \details The count is stored even if the decoder is not
+		/// initialized yet and applied on initialization.
+		/// \param[in]	count	Number of threads, zero for automatic selection.
+		/// \retval true on success.
+		/// \retval false on error.
+		bool setThreadCount(int count) noexcept {
+			if (count < 0) return false;
+
+			threadCount_ = count;
+
+			if (!decoderContext_.codecContext)
+				return true;
+
+			return ::configure(concealment_, count, decoderContext_) &&
+				   updatePipeline();
+		}
+
+		/// Sets the decoding activity.
+		/// \details Returning to full activity publishes the held frame, so
+		/// the output shows a recent picture at once instead of waiting for
+		/// the next decoded frame.
+		/// \param[in]	activity	Decoding activity.
+		/// \retval true on success.
+		/// \retval false on error.
+		bool setActivity(VideoDecoder::Activity activity) noexcept {
+			frameUpdated_ = false;
+
+			if (activity == activity_) return true;
+			activity_ = activity;
+
+			if (memoryAccount_)
+				memoryAccount_->setHidden(
+					activity != VideoDecoder::Activity::Full);
+
+			if (activity != VideoDecoder::Activity::Full ||
+				!heldFrame_ || !heldFrame_->buf[0])
+				return true;
+
+			auto startTime = std::chrono::steady_clock::now();
+			auto converted = publishFrame();
+
+			auto elapsedTime = static_cast<quint64>(
+				std::chrono::duration_cast<std::chrono::microseconds>(
+					std::chrono::steady_clock::now() - startTime).count());
+
+			decodeTime_.fetch_add(elapsedTime, relaxed);
+			fullTime_.fetch_add(elapsedTime, relaxed);
+
+			return converted;
+		}
+
+		///
+		/// \details Frames that depend on a broken reference chain are
+		/// skipped before reaching the decoder unless corrupted output is
+		/// requested, so the last good frame is held until the next intra
+		/// frame arrives.
+		/// The frame identifier becomes the packet timestamp and the rest of
+		/// the identity is kept in a ring indexed by the reordered opaque
+		/// value, so it survives frame threading and reordering.
+		/// Only the newest usable frame of a call is published, as older ones
+		/// would be replaced before anyone saw them. Below full activity it is
+		/// held instead, and at keyframes only activity everything but one
+		/// intra frame per KEYFRAME_INTERVAL is dropped before decoding.
+		/// H.264 access units are classified from their NAL unit headers
+		/// first: parameter sets always reach the decoder, and disposable
+		/// frames dropped under overload or lowered activity leave the
+		/// reference chain intact.
+		/// With concurrent MJPEG decoding the frame is queued and the
+		/// pictures finished in order so far are taken instead.
+		/// \param[in]	data
+		/// \param[in]	info		Network frame identity.
+		/// \param[in]	numbered	Indicates whether the frame number is known.
+		/// \retval
+		/// \retval
+		bool decode(const QByteArray& data,
+					const VideoDecoder::FrameInfo& info = { },
+					bool numbered = false) noexcept {
+
+			frameUpdated_ = false;
+
+			if (!data.isEmpty()) {
+				receivedFrames_.fetch_add(1, relaxed);
+				receivedBytes_.fetch_add(data.size(), relaxed);
+			}
+
+			auto receiveTime = info.receiveTime;
+			if (receiveTime == 0)
+				receiveTime = static_cast<quint64>(
+					std::chrono::duration_cast<std::chrono::microseconds>(
+						std::chrono::steady_clock::now()
+							.time_since_epoch()).count());
+
+			NalUnitSummary summary;
+			if (codecID_ == AV_CODEC_ID_H264)
+				summary = parseNalUnits(data.constData(), data.size());
+
+			auto intra = codecID_ != AV_CODEC_ID_H264 || summary.intra;
+
+			if (!updateReferenceChain(intra, numbered ? info.number : -1) &&
+				!summary.parameterSets) {
+				skippedFrames_.fetch_add(1, relaxed);
+				skippedBytes_.fetch_add(data.size(), relaxed);
+				return true;
+			}
+
+			if (!data.isEmpty() && !isFrameDue(summary, intra, receiveTime)) {
+				if (summary.disposable)
+					disposedFrames_.fetch_add(1, relaxed);
+				else if (codecID_ == AV_CODEC_ID_H264)
+					referenceChainValid_ = false;
+
+				throttledFrames_.fetch_add(1, relaxed);
+				return true;
+			}
+
+			if (!::setData(data.data(), data.size(), decoderContext_.packet,
+						   numbered ? info.id : AV_NOPTS_VALUE))
+				return false;
+
+			if (!data.isEmpty()) {
+				auto key = nextFrameKey_++;
+				auto& pendingFrame = pendingFrames_[key % PENDING_FRAMES];
+
+				pendingFrame.key = key;
+				pendingFrame.info = info;
+				pendingFrame.info.receiveTime = receiveTime;
+
+				decoderContext_.codecContext->reordered_opaque = key;
+			}
+
+			auto showCorrupted =
+				concealment_.testFlag(VideoDecoder::Concealment::ShowCorrupted);
+			auto chainValid = referenceChainValid_;
+			auto usableFrames = 0, corruptedFrames = 0;
+			auto startTime = std::chrono::steady_clock::now();
+
+			auto takeFrame = [&](const AVFrame* frame) {
+				auto corrupted = isCorrupted(frame);
+				decodedFrames_.fetch_add(1, relaxed);
+
+				if (corrupted) {
+					++corruptedFrames;
+					if (codecID_ == AV_CODEC_ID_H264)
+						referenceChainValid_ = false;
+				}
+
+				if ((!corrupted || showCorrupted) && acceptFrame(frame))
+					++usableFrames;
+			};
+
+			auto statusCode = DecoderStatusCode::NeedMoreData;
+
+			if (mjpegPipeline_.isRunning()) {
+				auto failed = false;
+				auto takePicture = [&](AVFrame* frame) {
+					if (!frame) {
+						failed = true;
+						return;
+					}
+
+					concurrentFrames_.fetch_add(1, relaxed);
+					takeFrame(frame);
+				};
+
+				if (data.isEmpty()) {
+					mjpegPipeline_.collect(takePicture, 0);
+				}
+				else {
+					auto window = mjpegPipeline_.getWindow();
+					auto key = decoderContext_.codecContext->reordered_opaque;
+
+					mjpegPipeline_.collect(takePicture, window - 1);
+					if (!mjpegPipeline_.submit(decoderContext_.packet, key))
+						failed = true;
+
+					mjpegPipeline_.collect(takePicture, window);
+				}
+
+				if (failed) statusCode = DecoderStatusCode::Error;
+			}
+			else {
+				statusCode = ::decode(decoderContext_.codecContext,
+									  decoderContext_.frame,
+									  decoderContext_.packet);
+
+				while (statusCode == DecoderStatusCode::FrameReceived ||
+					   statusCode == DecoderStatusCode::ReceiveFrameFirst) {
+
+					if (statusCode == DecoderStatusCode::FrameReceived)
+						takeFrame(decoderContext_.frame);
+
+					statusCode = ::decode(decoderContext_.codecContext,
+										  decoderContext_.frame);
+				}
+			}
+
+			if (activity_ == VideoDecoder::Activity::Full &&
+				heldFrame_ && heldFrame_->buf[0] && !publishFrame())
+				usableFrames = 0;
+
+			auto elapsedTime = static_cast<quint64>(
+				std::chrono::duration_cast<std::chrono::microseconds>(
+					std::chrono::steady_clock::now() - startTime).count());
+
+			corruptedFrames_.fetch_add(corruptedFrames, relaxed);
+			decodeTime_.fetch_add(elapsedTime, relaxed);
+			activityTime(activity_).fetch_add(elapsedTime, relaxed);
+
+			if (usableFrames == 0 && (corruptedFrames > 0 || !chainValid))
+				wastedDecodeTime_.fetch_add(elapsedTime, relaxed);
+
+			updateMemoryUsage();
+
+			return statusCode != DecoderStatusCode::Error;
+		}
+
+	private:
+
+		/// Returns the decoding time counter of an activity.
+		/// \param[in]	activity	Decoding activity.
+		/// \return Decoding time counter.
+		std::atomic<quint64>& activityTime(
+			VideoDecoder::Activity activity) noexcept {
+
+			switch (activity) {
+			case VideoDecoder::Activity::DecodeOnly:
+				return decodeOnlyTime_;
+			case VideoDecoder::Activity::KeyframesOnly:
+				return keyframesOnlyTime_;
+			default:
+				return fullTime_;
+			}
+		}
+
+		/// Indicates whether a frame should be decoded at the current activity.
+		/// \details Disposable frames are dropped under overload and below
+		/// full activity, as nothing else depends on them. Parameter sets
+		/// are always decoded.
+		/// \param[in]	summary		NAL unit summary of the frame.
+		/// \param[in]	intra		Indicates whether the frame is intra coded.
+		/// \param[in]	receiveTime	Local receive timestamp in microseconds.
+		/// \retval true if the frame should be decoded.
+		/// \retval false if the frame should be dropped.
+		bool isFrameDue(const NalUnitSummary& summary,
+						bool intra,
+						quint64 receiveTime) noexcept {
+
+			if (summary.disposable &&
+				(overloaded_ || activity_ != VideoDecoder::Activity::Full))
+				return false;
+
+			if (activity_ != VideoDecoder::Activity::KeyframesOnly)
+				return true;
+
+			if (summary.parameterSets && summary.firstSliceNalType == 0)
+				return true;
+			if (!intra) return false;
+
+			if (lastKeyframeTime_ != 0 && receiveTime >= lastKeyframeTime_ &&
+				receiveTime - lastKeyframeTime_ < KEYFRAME_INTERVAL)
+				return false;
+
+			lastKeyframeTime_ = receiveTime;
+			return true;
+		}
+
+		/// Takes a usable decoded frame.
+		/// \details Keeps a reference to the newest frame, which is published
+		/// after the decoding call at full activity and on return to it
+		/// otherwise. A frame replaced within a call at full activity is
+		/// counted as superseded.
+		/// \param[in]	frame	Decoded frame.
+		/// \retval true on success.
+		/// \retval false on error.
+		bool acceptFrame(const AVFrame* frame) noexcept {
+			if (!heldFrame_) heldFrame_ = av_frame_alloc();
+			if (!heldFrame_) return false;
+
+			if (heldFrame_->buf[0] && activity_ == VideoDecoder::Activity::Full)
+				supersededFrames_.fetch_add(1, relaxed);
+
+			av_frame_unref(heldFrame_);
+			if (av_frame_ref(heldFrame_, frame) < 0) return false;
+
+			heldFrameInfo_ = findFrameInfo(frame);
+			return true;
+		}
+
+		/// Finds the identity of a decoded frame.
+		/// \details Falls back to the frame timestamp if the identity was
+		/// overwritten by newer frames.
+		/// \param[in]	frame	Decoded frame.
+		/// \return Network frame identity.
+		VideoDecoder::FrameInfo findFrameInfo(const AVFrame* frame) const {
+			auto key = frame->reordered_opaque;
+
+			if (key >= 0) {
+				const auto& pendingFrame = pendingFrames_[key % PENDING_FRAMES];
+				if (pendingFrame.key == key) return pendingFrame.info;
+			}
+
+			VideoDecoder::FrameInfo info;
+
+			if (frame->pts != AV_NOPTS_VALUE)
+				info.id = static_cast<quint32>(frame->pts);
+
+			return info;
+		}
+
+		/// Publishes the held frame as the output frame.
+		/// \details Converts the frame, or with deferred conversion moves it
+		/// into a decoded frame that converts on demand. Either way the held
+		/// frame is released. The conversion time is also part of the
+		/// decoding time.
+		/// \retval true on success.
+		/// \retval false on error.
+		bool publishFrame() noexcept {
+			if (deferred_) {
+				auto data =
+					std::make_shared<VideoDecoder::DecodedFrame::Data>();
+				data->frame = av_frame_alloc();
+				if (!data->frame) return false;
+
+				av_frame_move_ref(data->frame, heldFrame_);
+				data->format = format_;
+				data->converter = converter_;
+
+				lastDecodedFrame_ = VideoDecoder::DecodedFrame(std::move(data));
+			}
+			else {
+				auto converted =
+					converter_->convert(heldFrame_, format_, lastFrame_);
+				av_frame_unref(heldFrame_);
+
+				if (!converted) return false;
+			}
+
+			lastFrameInfo_ = heldFrameInfo_;
+			frameUpdated_ = true;
+			return true;
+		}
+
+		/// Reports the memory held by the decoder and applies the budget.
+		/// \details Decoder memory is estimated from the picture size: the
+		/// picture being decoded, its references, one picture per extra
+		/// frame decoding thread or MJPEG frame in flight, and the held and
+		/// last unconverted frames. Slice threads share one picture. The last
+		/// converted image counts as conversion memory, together with every
+		/// copy of it downstream. Evictions are handled below full activity,
+		/// and the degradation level sets the size of the next converted
+		/// frame.
+		void updateMemoryUsage() noexcept {
+			if (!memoryAccount_) return;
+
+			auto evictionCount = memoryAccount_->evictionCount();
+
+			if (evictionCount != evictionCount_) {
+				evictionCount_ = evictionCount;
+				if (activity_ != VideoDecoder::Activity::Full) evict();
+			}
+
+			converter_->setDownscale(memoryAccount_->degradation());
+
+			quint64 pictures = 0, pictureBytes = 0;
+			auto codecContext = decoderContext_.codecContext;
+
+			if (codecContext && codecContext->pix_fmt != AV_PIX_FMT_NONE) {
+				auto bytes = av_image_get_buffer_size(codecContext->pix_fmt,
+													  codecContext->width,
+													  codecContext->height,
+													  1);
+
+				if (bytes > 0) {
+					auto references = qMax(1, codecContext->refs);
+					auto frameThreads =
+						(codecContext->active_thread_type & FF_THREAD_FRAME)
+							? qMax(0, codecContext->thread_count - 1)
+							: 0;
+
+					pictureBytes = static_cast<quint64>(bytes);
+					pictures =
+						static_cast<quint64>(1 + references + frameThreads);
+				}
+			}
+
+			if (mjpegPipeline_.isRunning())
+				pictures += static_cast<quint64>(mjpegPipeline_.getWindow());
+
+			if (heldFrame_ && heldFrame_->buf[0]) ++pictures;
+			if (!lastDecodedFrame_.isNull()) ++pictures;
+
+			auto imageBytes = lastFrame_.isNull()
+				? 0
+				: static_cast<quint64>(lastFrame_.sizeInBytes());
+
+			memoryAccount_->setUsage(Common::Utility::MemoryStage::Decoding,
+									 pictures * pictureBytes);
+			memoryAccount_->setUsage(Common::Utility::MemoryStage::Conversion,
+									 imageBytes);
+		}
+
+		/// Drops what the decoder only keeps to resume quickly.
+		/// \details Releases the held frame, the last output frames and the
+		/// scalers. A stream shown again then waits for its next decoded
+		/// frame instead of showing the held one at once.
+		void evict() noexcept {
+			if (heldFrame_) av_frame_unref(heldFrame_);
+
+			lastFrame_ = QImage();
+			lastDecodedFrame_ = VideoDecoder::DecodedFrame();
+			converter_->reset();
+		}
+
+		/// Starts or stops concurrent MJPEG decoding.
+		/// \details MJPEG frames are decoded concurrently when more than one
+		/// decoding thread is requested, or with automatic selection on more
+		/// than one processor.
+		/// \retval true on success.
+		/// \retval false on error.
+		bool updatePipeline() noexcept {
+			auto decoders = threadCount_ > 0
+				? threadCount_
+				: QThread::idealThreadCount();
+			decoders = qMin(decoders, MAXIMUM_MJPEG_DECODERS);
+
+			if (codecID_ != AV_CODEC_ID_MJPEG || decoders <= 1) {
+				mjpegPipeline_.stop();
+				return true;
+			}
+
+			return mjpegPipeline_.start(decoders,
+										concealment_,
+										decoderContext_.codecContext);
+		}
+
+		/// Updates the reference chain state with the incoming frame.
+		/// \details A gap in frame numbers breaks the H.264 reference chain,
+		/// and an intra frame restores it. MJPEG frames are independent, so
+		/// only gaps are counted for them.
+		/// \param[in]	intra	Indicates whether the frame is an intra frame.
+		/// \param[in]	number	Network frame number, or -1 if unknown.
+		/// \retval true if the frame should be decoded.
+		/// \retval false if the frame should be skipped.
+		bool updateReferenceChain(bool intra, int number) noexcept {
+			if (number >= 0) {
+				if (lastNumber_ >= 0 &&
+					static_cast<quint16>(lastNumber_ + 1) != number) {
+
+					frameGaps_.fetch_add(1, relaxed);
+					referenceChainValid_ = false;
+				}
+
+				lastNumber_ = number;
+			}
+
+			if (codecID_ != AV_CODEC_ID_H264) {
+				referenceChainValid_ = true;
+				return true;
+			}
+
+			if (intra) referenceChainValid_ = true;
+
+			auto showCorrupted =
+				concealment_.testFlag(VideoDecoder::Concealment::ShowCorrupted);
+
+			return referenceChainValid_ || showCorrupted;
+		}
+
+	private:
+
+		/// A structure that keeps a frame identity while it is in flight.
+		struct PendingFrame {
+
+			/// Reordered opaque key, or -1 if the slot is empty.
+			int64_t key = -1;
+
+			/// Network frame identity.
+			VideoDecoder::FrameInfo info;
+		};
+
+		/// Memory order used by statistics counters.
+		static constexpr auto relaxed = std::memory_order_relaxed;
+
+		/// Number of frame identities kept while frames are in flight.
+		static constexpr int PENDING_FRAMES = 64;
+
+		/// Minimum interval between intra frames decoded at keyframes only
+		/// activity in microseconds.
+		static constexpr quint64 KEYFRAME_INTERVAL = 1000000;
+
+		///
+		/// \details
+		QImage lastFrame_;
+
+		/// Identity of the last decoded frame.
+		VideoDecoder::FrameInfo lastFrameInfo_;
+
+		/// Identities of frames inside the decoder.
+		std::array<PendingFrame, PENDING_FRAMES> pendingFrames_;
+
+		/// Next reordered opaque key.
+		int64_t nextFrameKey_ = 0;
+
+		///
+		/// \details
+		DecoderContext decoderContext_;
+
+		/// Concurrent MJPEG decoders, running only when enabled.
+		MjpegPipeline mjpegPipeline_;
+
+		/// Converter shared with deferred frames.
+		std::shared_ptr<FrameConverter> converter_ {
+			std::make_shared<FrameConverter>()
+		};
+
+		/// Output format.
+		AVPixelFormat format_ = AV_PIX_FMT_NONE;
+
+		/// Indicates whether frames are left unconverted.
+		bool deferred_ = false;
+
+		/// Indicates whether disposable frames are dropped at full activity.
+		bool overloaded_ = false;
+
+		/// Memory account of the stream, or null.
+		std::shared_ptr<Common::Utility::MemoryAccount> memoryAccount_;
+
+		/// Number of evictions already handled.
+		quint64 evictionCount_ = 0;
+
+		/// Last frame left unconverted.
+		VideoDecoder::DecodedFrame lastDecodedFrame_;
+
+		/// Decoder codec identifier.
+		AVCodecID codecID_ = AV_CODEC_ID_NONE;
+
+		/// Error concealment flags.
+		VideoDecoder::ConcealmentFlags concealment_ {
+			VideoDecoder::Concealment::GuessMotionVectors |
+			VideoDecoder::Concealment::Deblock
+		};
+
+		/// Number of decoding threads, zero for automatic selection.
+		int threadCount_ = 1;
+
+		/// Last network frame number, or -1 if none was received.
+		int lastNumber_ = -1;
+
+		/// Indicates whether the H.264 reference chain is intact.
+		bool referenceChainValid_ = false;
+
+		/// Indicates whether the last decoding call produced a new frame.
+		bool frameUpdated_ = false;
+
+		/// Decoding activity.
+		VideoDecoder::Activity activity_ = VideoDecoder::Activity::Full;
+
+		/// Newest usable frame not yet published.
+		AVFrame* heldFrame_ = nullptr;
+
+		/// Identity of the held frame.
+		VideoDecoder::FrameInfo heldFrameInfo_;
+
+		/// Receive timestamp of the last intra frame decoded at keyframes
+		/// only activity in microseconds.
+		quint64 lastKeyframeTime_ = 0;
+
+		/// Number of pictures the decoder produced.
+		std::atomic<quint64> decodedFrames_ { 0 };
+
+		/// Number of skipped frames.
+		std::atomic<quint64> skippedFrames_ { 0 };
+
+		/// Number of skipped bytes.
+		std::atomic<quint64> skippedBytes_ { 0 };
+
+		/// Number of corrupted frames.
+		std::atomic<quint64> corruptedFrames_ { 0 };
+
+		/// Number of frame number gaps.
+		std::atomic<quint64> frameGaps_ { 0 };
+
+		/// Total decoding time in microseconds.
+		std::atomic<quint64> decodeTime_ { 0 };
+
+		/// Decoding time spent on unusable frames in microseconds.
+		std::atomic<quint64> wastedDecodeTime_ { 0 };
+
+		/// Number of frames not decoded due to lowered activity.
+		std::atomic<quint64> throttledFrames_ { 0 };
+
+		/// Number of disposable frames not decoded.
+		std::atomic<quint64> disposedFrames_ { 0 };
+
+		/// Number of MJPEG frames decoded concurrently.
+		std::atomic<quint64> concurrentFrames_ { 0 };
+
+		/// Decoding time at full activity in microseconds.
+		std::atomic<quint64> fullTime_ { 0 };
+
+		/// Decoding time at decode only activity in microseconds.
+		std::atomic<quint64> decodeOnlyTime_ { 0 };
+
+		/// Decoding time at keyframes only activity in microseconds.
+		std::atomic<quint64> keyframesOnlyTime_ { 0 };
+
+		/// Number of non-empty frames passed to the decoder.
+		std::atomic<quint64> receivedFrames_ { 0 };
+
+		/// Number of bytes passed to the decoder.
+		std::atomic<quint64> receivedBytes_ { 0 };
+
+		/// Number of usable frames replaced before they were published.
+		std::atomic<quint64> supersededFrames_ { 0 };
+	};
+
+	///
 	/// \details
 	/// \param[in]	parent
 	VideoDecoder::VideoDecoder(QObject* parent)
 		: QObject(parent),
 		  private_(new VideoDecoderPrivate()) {
 
+		qRegisterMetaType<FrameInfo>();
+		qRegisterMetaType<DecodedFrame>();
+		qRegisterMetaType<Activity>();
 	}
 
 	///
@@ -794,12 +2749,187 @@ namespace Decoders {
 			emit onError(Error::ExtradataError);
 	}
 
+	/// Sets error concealment flags.
+	/// \details Reopens the decoder if it is already initialized.
+	/// \param[in]	flags	Error concealment flags.
+	void VideoDecoder::setConcealment(ConcealmentFlags flags) {
+		if (!private_->setConcealment(flags))
+			emit onError(Error::DecoderError);
+	}
+
+	/// Sets the number of decoding threads.
+	/// \details Reopens the decoder if it is already initialized. More
+	/// threads raise throughput at the cost of frame latency. MJPEG, which
+	/// FFmpeg decodes on one thread, gets one decoder per thread instead:
+	/// consecutive frames are decoded concurrently and emitted in order,
+	/// with up to two frames per thread in flight. Frames in flight are
+	/// dropped when the count changes, and an empty frame waits for all of
+	/// them. The decoding time then counts only the time the caller waits.
+	/// \param[in]	count	Number of threads, zero for automatic selection.
+	void VideoDecoder::setThreadCount(int count) {
+		if (!private_->setThreadCount(count))
+			emit onError(Error::DecoderError);
+	}
+
+	/// Sets the decoding activity.
+	/// \details Below full activity no frames are converted or emitted.
+	/// Decode only keeps the reference chain intact, so returning from it
+	/// continues without a gap; H.264 frames no other picture references
+	/// are dropped, as they are never shown. Keyframes only drops everything
+	/// but sparse intra frames and parameter sets; on return the newest
+	/// intra frame is emitted at once and H.264 motion resumes with the next
+	/// one.
+	/// \param[in]	activity	Decoding activity.
+	void VideoDecoder::setActivity(Activity activity) {
+		if (!private_->setActivity(activity))
+			emit onError(Error::DecoderError);
+		else
+			emitFrame();
+	}
+
+	/// Enables or disables deferred conversion.
+	/// \details With deferred conversion frames are emitted through
+	/// onDecodedFrame() instead of onFrame() and converted only when a
+	/// receiver asks for the image, so frames dropped before presentation
+	/// never pay for the conversion. Applies from the next emitted frame.
+	/// \param[in]	enabled	Indicates whether frames are emitted
+	///						unconverted through onDecodedFrame().
+	void VideoDecoder::setDeferredConversion(bool enabled) {
+		private_->setDeferred(enabled);
+	}
+
+	/// Sets whether the output is overloaded.
+	/// \details While overloaded, H.264 frames no other picture references
+	/// are dropped before decoding at full activity, lowering the frame
+	/// rate without breaking the reference chain. Other codecs are not
+	/// affected.
+	/// \param[in]	overloaded	Indicates whether the output is overloaded.
+	void VideoDecoder::setOverloaded(bool overloaded) {
+		private_->setOverloaded(overloaded);
+	}
+
+	/// Sets the size frames are shown at.
+	/// \details Converted images are halved, up to the memory degradation
+	/// limit, for as long as they still cover the size, so small tiles do
+	/// not pay for converting and uploading full size frames. Halving keeps
+	/// the aspect ratio, so the image may remain larger than the size.
+	/// Applies from the next conversion, deferred ones included.
+	/// \param[in]	size	Size in device pixels, or an empty size for
+	///						full size.
+	void VideoDecoder::setOutputSize(const QSize& size) {
+		private_->setOutputSize(size);
+	}
+
+	/// Sets the number of threads converting a frame.
+	/// \details Frames are split into horizontal bands converted at once
+	/// on a thread pool of their own. Automatic selection splits only frames
+	/// larger than 1080p, into bands of at least a 1080p frame each and no
+	/// more bands than processors. One thread converts frames whole. Applies
+	/// from the next converted frame.
+	/// \param[in]	count	Number of threads, zero for automatic selection.
+	void VideoDecoder::setConversionThreadCount(int count) {
+		if (!private_->setConversionThreadCount(count))
+			emit onError(Error::DecoderError);
+	}
+
+	/// Returns the decoding statistics.
+	/// \details Can be called from any thread.
+	/// \return Decoding statistics.
+	VideoDecoder::Statistics VideoDecoder::statistics() const {
+		return private_->getStatistics();
+	}
+
+	/// Sets the account decoder memory is reported to.
+	/// \details Decoded pictures and converted images are reported after
+	/// every decoding call. The stream counts as hidden below full activity,
+	/// so the budget evicts its held frame before degrading visible streams,
+	/// and a degraded stream converts frames at half or quarter size. Must
+	/// be called on the decoder thread.
+	/// \param[in]	account	Memory account of the stream, or null.
+	void VideoDecoder::setMemoryAccount(
+		std::shared_ptr<Common::Utility::MemoryAccount> account) {
+
+		private_->setMemoryAccount(std::move(account));
+	}
+
 	///
 	/// \details
 	/// \param[in]	data
 	void VideoDecoder::decode(const QByteArray& data) {
-		if (private_->decode(data))
-            emit onFrame(private_->getFrame().copy());
-		else emit onError(Error::DecoderError);
+		if (!private_->decode(data))
+			emit onError(Error::DecoderError);
+		else
+			emitFrame();
+	}
+
+	/// Decodes a frame, tracking the reference chain by frame number.
+	/// \details Emits a frame only when a usable one was decoded, holding
+	/// the last good frame otherwise. The emitted identity belongs to the
+	/// decoded picture, which may differ from \a info when the decoder
+	/// reorders or delays frames.
+	/// \param[in]	data	Frame data.
+	/// \param[in]	info	Network frame identity.
+	void VideoDecoder::decode(const QByteArray& data, const FrameInfo& info) {
+		if (!private_->decode(data, info, true))
+			emit onError(Error::DecoderError);
+		else
+			emitFrame();
+	}
+
+	/// Emits the frame of the last call if it produced one.
+	void VideoDecoder::emitFrame() {
+		if (!private_->isFrameUpdated()) return;
+
+		if (private_->isDeferred())
+			emit onDecodedFrame(private_->getDecodedFrame(),
+								private_->getFrameInfo());
+		else
+			emit onFrame(private_->getFrame(), private_->getFrameInfo());
+	}
+
+	/// Constructs a frame.
+	/// \param[in]	data	Frame state.
+	VideoDecoder::DecodedFrame::DecodedFrame(std::shared_ptr<Data> data)
+		: data_(std::move(data)) {
+
+	}
+
+	/// Indicates whether the frame holds no picture.
+	/// \retval true if the frame is null.
+	/// \retval false otherwise.
+	bool VideoDecoder::DecodedFrame::isNull() const {
+		return !data_;
+	}
+
+	/// Indicates whether the frame was converted.
+	/// \retval true if image() was called.
+	/// \retval false otherwise.
+	bool VideoDecoder::DecodedFrame::isConverted() const {
+		if (!data_) return false;
+
+		std::lock_guard<std::mutex> lock(data_->mutex);
+		return data_->converted;
+	}
+
+	/// Returns the converted picture.
+	/// \details Converts on the first call and releases the decoded
+	/// picture; later calls and copies return the same image.
+	/// \return Output image, null on error.
+	QImage VideoDecoder::DecodedFrame::image() const {
+		if (!data_) return QImage();
+
+		std::lock_guard<std::mutex> lock(data_->mutex);
+
+		if (!data_->converted) {
+			if (!data_->converter->convert(data_->frame,
+										   data_->format,
+										   data_->image))
+				data_->image = QImage();
+
+			av_frame_free(&data_->frame);
+			data_->converted = true;
+		}
+
+		return data_->image;
 	}
 }
@@ -4,8 +4,10 @@
 
 HEADERS			+=															\
 						$$PWD/AudioDecoder.hpp								\
+						$$PWD/NalUnitParser.hpp								\
 						$$PWD/VideoDecoder.hpp								\
 
 SOURCES			+=															\
 						$$PWD/Decoder.cpp									\
+						$$PWD/NalUnitParser.cpp								\
 
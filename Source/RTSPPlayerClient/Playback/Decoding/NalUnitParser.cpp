@@ -0,0 +1,232 @@
+/// \file NalUnitParser.cpp
+/// \brief Contains classes and functions definitions that provide H.264 NAL
+/// unit parsing.
+/// \bug No known bugs.
+
+#include "NalUnitParser.hpp"
+#include "Playback/Conversion/ConversionKernels.hpp"
+
+#include <cstdint>
+
+#if defined (__x86_64__) || defined (_M_X64) || \
+	defined (__i386__) || defined (_M_IX86)
+	#define NAL_X86 1
+	#include <immintrin.h>
+	#if defined (_MSC_VER)
+		#include <intrin.h>
+	#endif
+#else
+	#define NAL_X86 0
+#endif
+
+#if NAL_X86 && (defined (__GNUC__) || defined (__clang__))
+	#define NAL_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+	#define NAL_TARGET_AVX2
+#endif
+
+namespace {
+
+#if NAL_X86
+	/// Returns the index of the lowest set bit.
+	/// \param[in]	mask	Non-zero mask.
+	/// \return Bit index.
+	inline int findLowestBit(unsigned int mask) noexcept {
+#if defined (_MSC_VER)
+		unsigned long index;
+		_BitScanForward(&index, mask);
+		return static_cast<int>(index);
+#else
+		return __builtin_ctz(mask);
+#endif
+	}
+
+	/// Skips data without a start code with AVX2.
+	/// \details Compares 32 candidate positions at a time against the
+	/// \c 00 00 01 prefix and stops at the first block that holds one, or
+	/// where fewer than 34 bytes are left.
+	/// \param[in]	data	Data buffer.
+	/// \param[in]	offset	Search start offset.
+	/// \param[in]	size	Data size.
+	/// \return Offset of the first byte after the start code if found,
+	/// otherwise the negated offset the scalar search continues at.
+	NAL_TARGET_AVX2
+	int findStartCodeAvx2(const unsigned char* data,
+						  int offset,
+						  int size) noexcept {
+
+		auto zero = _mm256_setzero_si256();
+		auto one = _mm256_set1_epi8(1);
+		auto i = offset;
+
+		for (; i + 34 <= size; i += 32) {
+			auto first = _mm256_loadu_si256(
+				reinterpret_cast<const __m256i*>(data + i));
+			auto second = _mm256_loadu_si256(
+				reinterpret_cast<const __m256i*>(data + i + 1));
+			auto third = _mm256_loadu_si256(
+				reinterpret_cast<const __m256i*>(data + i + 2));
+
+			auto matches = _mm256_and_si256(
+				_mm256_and_si256(_mm256_cmpeq_epi8(first, zero),
+								 _mm256_cmpeq_epi8(second, zero)),
+				_mm256_cmpeq_epi8(third, one));
+
+			auto mask = static_cast<unsigned int>(
+				_mm256_movemask_epi8(matches));
+			if (mask != 0) return i + findLowestBit(mask) + 3;
+		}
+
+		return -i;
+	}
+#endif
+
+	/// Finds the next Annex-B start code.
+	/// \details Searches for the three-byte \c 00 00 01 prefix, which is also
+	/// the tail of the four-byte form. Slice data is scanned with AVX2 when
+	/// available, so only the last bytes are checked one at a time.
+	/// \param[in]	data	Data buffer.
+	/// \param[in]	offset	Search start offset.
+	/// \param[in]	size	Data size.
+	/// \return Offset of the first byte after the start code, or \a size if
+	/// no start code is found.
+	inline int findStartCode(const unsigned char* data,
+							 int offset,
+							 int size) noexcept {
+
+#if NAL_X86
+		if (Conversion::hasAvx2() && offset + 34 <= size) {
+			auto result = findStartCodeAvx2(data, offset, size);
+			if (result > 0) return result;
+
+			offset = -result;
+		}
+#endif
+
+		for (auto i = offset; i + 2 < size; ++i) {
+			if (data[i + 2] > 1) {
+				i += 2;
+			}
+			else if (data[i] == 0 && data[i + 1] == 0 && data[i + 2] == 1) {
+				return i + 3;
+			}
+		}
+
+		return size;
+	}
+
+	/// Reads the slice type from a slice header.
+	/// \details Strips emulation prevention bytes from the first bytes of the
+	/// slice header and decodes \c first_mb_in_slice and \c slice_type
+	/// Exp-Golomb codes.
+	/// \param[in]	data	Data buffer.
+	/// \param[in]	offset	Offset of the first byte after the NAL header.
+	/// \param[in]	size	Data size.
+	/// \return Slice type, or -1 if the header is truncated.
+	inline int readSliceType(const unsigned char* data,
+							 int offset,
+							 int size) noexcept {
+
+		std::uint64_t bits = 0;
+		auto count = 0, zeros = 0;
+
+		for (auto i = offset; i < size && count < 8; ++i) {
+			if (zeros >= 2 && data[i] == 0x03) {
+				zeros = 0;
+				continue;
+			}
+
+			zeros = data[i] == 0 ? zeros + 1 : 0;
+			bits = (bits << 8) | data[i], ++count;
+		}
+
+		if (count == 0) return -1;
+		if (count < 8) bits <<= (8 - count) * 8;
+
+		auto position = 0, limit = count * 8;
+
+		auto readExpGolomb = [&]() {
+			auto leadingZeros = 0;
+
+			while (position < limit && !((bits >> (63 - position)) & 1))
+				++leadingZeros, ++position;
+
+			if (leadingZeros > 31 || position + leadingZeros + 1 > limit)
+				return -1;
+
+			++position;
+
+			auto value = std::uint64_t { 0 };
+			if (leadingZeros > 0) {
+				value = (bits << position) >> (64 - leadingZeros);
+				position += leadingZeros;
+			}
+
+			return static_cast<int>((std::uint64_t { 1 } << leadingZeros) -
+									1 + value);
+		};
+
+		if (readExpGolomb() < 0) return -1;
+
+		return readExpGolomb();
+	}
+}
+
+/// A namespace that contains classes and functions for decoding media.
+namespace Decoders {
+
+	/// Parses Annex-B NAL unit headers of an access unit.
+	/// \details Reads the header byte after each start code to collect slice
+	/// types, reference indicators and parameter set presence. An access
+	/// unit is disposable when it has coded slices, all with a zero
+	/// \c nal_ref_idc, and no parameter sets.
+	/// \param[in]	data	Access unit data.
+	/// \param[in]	size	Access unit size.
+	/// \return NAL unit summary.
+	NalUnitSummary parseNalUnits(const char* data, int size) noexcept {
+		NalUnitSummary summary;
+		if (!data || size <= 0) return summary;
+
+		auto bytes = reinterpret_cast<const unsigned char*>(data);
+		auto offset = findStartCode(bytes, 0, size);
+
+		while (offset < size) {
+			auto header = bytes[offset];
+			auto type = header & 0x1F;
+			auto referenceIdc = (header >> 5) & 0x03;
+
+			++summary.nalUnits;
+
+			if (type == static_cast<int>(NalUnitType::NonIdrSlice) ||
+				type == static_cast<int>(NalUnitType::IdrSlice)) {
+
+				if (summary.firstSliceNalType == 0) {
+					auto sliceType = readSliceType(bytes, offset + 1, size);
+
+					summary.firstSliceNalType = type;
+					summary.intra = type == static_cast<int>(
+										NalUnitType::IdrSlice) ||
+									sliceType % 5 == 2 ||
+									sliceType % 5 == 4;
+				}
+
+				if (referenceIdc > summary.referenceIdc)
+					summary.referenceIdc = referenceIdc;
+				if (type == static_cast<int>(NalUnitType::IdrSlice))
+					summary.idr = true;
+			}
+			else if (type == static_cast<int>(NalUnitType::Sps) ||
+					 type == static_cast<int>(NalUnitType::Pps)) {
+				summary.parameterSets = true;
+			}
+
+			offset = findStartCode(bytes, offset + 1, size);
+		}
+
+		summary.disposable = summary.firstSliceNalType != 0 &&
+							 summary.referenceIdc == 0 &&
+							 !summary.parameterSets;
+
+		return summary;
+	}
+}
@@ -0,0 +1,57 @@
+/// \file NalUnitParser.hpp
+/// \brief Contains classes and functions declarations that provide H.264 NAL
+/// unit parsing.
+/// \bug No known bugs.
+
+#ifndef NALUNITPARSER_HPP
+#define NALUNITPARSER_HPP
+
+/// A namespace that contains classes and functions for decoding media.
+namespace Decoders {
+
+	/// H.264 NAL unit types used by the decoding pipeline.
+	enum class NalUnitType {
+		NonIdrSlice		= 1	,	///< Coded slice of a non-IDR picture.
+		IdrSlice		= 5	,	///< Coded slice of an IDR picture.
+		Sei				= 6	,	///< Supplemental enhancement information.
+		Sps				= 7	,	///< Sequence parameter set.
+		Pps				= 8	,	///< Picture parameter set.
+		AccessUnitDelimiter	= 9	,	///< Access unit delimiter.
+	};
+
+	/// A structure that summarizes NAL units of a single access unit.
+	struct NalUnitSummary {
+
+		/// Number of NAL units found.
+		int nalUnits = 0;
+
+		/// NAL unit type of the first coded slice, zero if there is none.
+		int firstSliceNalType = 0;
+
+		/// Highest \c nal_ref_idc among coded slices.
+		int referenceIdc = 0;
+
+		/// Indicates whether the access unit contains an IDR slice.
+		bool idr = false;
+
+		/// Indicates whether the first slice is intra coded.
+		/// \details Only the first slice header is read, so an access unit
+		/// mixing I and P slices is reported by its first slice alone.
+		bool intra = false;
+
+		/// Indicates whether the access unit contains SPS or PPS.
+		bool parameterSets = false;
+
+		/// Indicates whether no other picture references the access unit,
+		/// so it can be dropped without breaking the reference chain.
+		bool disposable = false;
+	};
+
+	/// Parses Annex-B NAL unit headers of an access unit.
+	/// \param[in]	data	Access unit data.
+	/// \param[in]	size	Access unit size.
+	/// \return NAL unit summary.
+	NalUnitSummary parseNalUnits(const char* data, int size) noexcept;
+}
+
+#endif
@@ -9,7 +9,15 @@
 #include <QImage>
 #include <QByteArray>
 #include <QLinkedList>
+#include <QMetaType>
 #include <QScopedPointer>
+#include <QSize>
+
+#include <memory>
+
+namespace Common::Utility {
+	class MemoryAccount;
+}
 
 /// A namespace that contains classes and functions for decoding media.
 namespace Decoders {
@@ -33,6 +41,8 @@ namespace Decoders {
 			Grayscale8		,	///<
 			Grayscale16		,	///<
 			RGB888			,	///<
+			RGBX8888		,	///< 32-bit RGB, bytes in R, G, B, 255 order.
+			BGRA8888		,	///< 32-bit RGB in QImage::Format_RGB32 order.
 		};
 
 		///
@@ -42,6 +52,157 @@ namespace Decoders {
 			DecoderError	,	///<
 		};
 
+		/// Error concealment flags.
+		enum class Concealment {
+			None				= 0x00	,	///< No concealment, freeze on loss.
+			GuessMotionVectors	= 0x01	,	///< Guess lost motion vectors.
+			Deblock				= 0x02	,	///< Deblock concealed areas.
+			ShowCorrupted		= 0x04	,	///< Decode and show broken frames.
+		};
+
+		Q_DECLARE_FLAGS(ConcealmentFlags, Concealment)
+
+		/// Decoding activity, lowered while the output is not visible.
+		enum class Activity {
+			Full			,	///< Decode, convert and emit every frame.
+			DecodeOnly		,	///< Decode reference frames, hold the newest.
+			KeyframesOnly	,	///< Decode sparse keyframes, hold the newest.
+		};
+
+		/// A structure that identifies the network frame a picture came from.
+		struct FrameInfo {
+
+			/// Network frame identifier, used as the presentation timestamp.
+			quint32 id = 0;
+
+			/// Network frame number.
+			quint16 number = 0;
+
+			/// Frame processing time reported by the sender.
+			quint16 time = 0;
+
+			/// Sender task identifier.
+			QString task;
+
+			/// Information flow identifier.
+			QString flow;
+
+			/// Local receive timestamp in microseconds.
+			quint64 receiveTime = 0;
+		};
+
+		/// A structure that contains decoding statistics.
+		struct Statistics {
+
+			/// Number of pictures the decoder produced.
+			quint64 decodedFrames = 0;
+
+			/// Number of frames skipped due to a broken reference chain.
+			quint64 skippedFrames = 0;
+
+			/// Number of bytes skipped due to a broken reference chain.
+			quint64 skippedBytes = 0;
+
+			/// Number of decoded frames that were corrupted.
+			quint64 corruptedFrames = 0;
+
+			/// Number of detected frame number gaps.
+			quint64 frameGaps = 0;
+
+			/// Total decoding time in microseconds.
+			quint64 decodeTime = 0;
+
+			/// Decoding time spent on unusable frames in microseconds.
+			quint64 wastedDecodeTime = 0;
+
+			/// Number of frames not decoded due to lowered activity.
+			quint64 throttledFrames = 0;
+
+			/// Number of H.264 frames no other picture references that were
+			/// not decoded, under overload or lowered activity. Dropping
+			/// them leaves the reference chain intact.
+			quint64 disposedFrames = 0;
+
+			/// Decoding time at full activity in microseconds.
+			quint64 fullTime = 0;
+
+			/// Decoding time at decode only activity in microseconds.
+			quint64 decodeOnlyTime = 0;
+
+			/// Decoding time at keyframes only activity in microseconds.
+			quint64 keyframesOnlyTime = 0;
+
+			/// Number of non-empty frames passed to the decoder.
+			quint64 receivedFrames = 0;
+
+			/// Number of bytes passed to the decoder.
+			quint64 receivedBytes = 0;
+
+			/// Number of frames converted to output images.
+			quint64 convertedFrames = 0;
+
+			/// Conversion time in microseconds, included in the decoding time
+			/// unless conversion is deferred.
+			quint64 convertTime = 0;
+
+			/// Number of usable frames never converted, because a newer frame
+			/// came out of the same decoding call.
+			quint64 supersededFrames = 0;
+
+			/// Number of frames converted in parallel bands.
+			quint64 splitFrames = 0;
+
+			/// Number of MJPEG frames decoded concurrently.
+			quint64 concurrentFrames = 0;
+
+			/// Number of frames converted at reduced size to stay within
+			/// the memory budget.
+			quint64 downscaledFrames = 0;
+		};
+
+		/// A class that holds a decoded frame by reference.
+		/// \details Keeps the decoded picture without converting it, so only
+		/// frames that are shown pay for the conversion. The conversion
+		/// happens on the first call to image(), on any thread, in the output
+		/// format of the decoder at decoding time. Copies share the frame,
+		/// which is released with the last copy.
+		class DecodedFrame {
+		public:
+
+			/// Frame state, defined by the decoder.
+			struct Data;
+
+		public:
+
+			/// Constructs a null frame.
+			DecodedFrame() = default;
+
+			/// Constructs a frame.
+			/// \param[in]	data	Frame state.
+			explicit DecodedFrame(std::shared_ptr<Data> data);
+
+		public:
+
+			/// Indicates whether the frame holds no picture.
+			/// \retval true if the frame is null.
+			/// \retval false otherwise.
+			bool isNull() const;
+
+			/// Indicates whether the frame was converted.
+			/// \retval true if image() was called.
+			/// \retval false otherwise.
+			bool isConverted() const;
+
+			/// Returns the converted picture.
+			/// \return Output image, null on error.
+			QImage image() const;
+
+		private:
+
+			/// Frame state.
+			std::shared_ptr<Data> data_;
+		};
+
 	public:
 
 		///
@@ -63,6 +224,16 @@ namespace Decoders {
 		///
 		void destroy();
 
+		/// Returns the decoding statistics.
+		/// \details Can be called from any thread.
+		/// \return Decoding statistics.
+		Statistics statistics() const;
+
+		/// Sets the account decoder memory is reported to.
+		/// \param[in]	account	Memory account of the stream, or null.
+		void setMemoryAccount(
+			std::shared_ptr<Common::Utility::MemoryAccount> account);
+
 	public slots:
 
 		///
@@ -73,22 +244,77 @@ namespace Decoders {
 		/// \param[in]	data
 		void setExtradata(const QByteArray& data);
 
+		/// Sets error concealment flags.
+		/// \param[in]	flags	Error concealment flags.
+		void setConcealment(Decoders::VideoDecoder::ConcealmentFlags flags);
+
+		/// Sets the number of decoding threads.
+		/// \param[in]	count	Number of threads, zero for automatic selection.
+		void setThreadCount(int count);
+
+		/// Sets the decoding activity.
+		/// \param[in]	activity	Decoding activity.
+		void setActivity(Decoders::VideoDecoder::Activity activity);
+
+		/// Enables or disables deferred conversion.
+		/// \param[in]	enabled	Indicates whether frames are emitted
+		///						unconverted through onDecodedFrame().
+		void setDeferredConversion(bool enabled);
+
+		/// Sets whether the output is overloaded.
+		/// \param[in]	overloaded	Indicates whether the output is overloaded.
+		void setOverloaded(bool overloaded);
+
+		/// Sets the size frames are shown at.
+		/// \param[in]	size	Size in device pixels, or an empty size for
+		///						full size.
+		void setOutputSize(const QSize& size);
+
+		/// Sets the number of threads converting a frame.
+		/// \param[in]	count	Number of threads, zero for automatic selection.
+		void setConversionThreadCount(int count);
+
 		///
 		/// \param[in]	data
 		void decode(const QByteArray& data);
 
+		/// Decodes a frame, tracking the reference chain by frame number.
+		/// \param[in]	data	Frame data.
+		/// \param[in]	info	Network frame identity.
+		void decode(const QByteArray& data,
+					const Decoders::VideoDecoder::FrameInfo& info);
+
 	signals:
 
 		///
 		/// \param[in]	error
 		void onError(Error error);
 
-		///
-		/// \param[in]	frame
-		void onFrame(const QImage& frame);
+		/// Signals a converted frame.
+		/// \details The signal carries the identity of the network frame
+		/// since the decoder tracks frames by number, which changed its
+		/// signature from onFrame(const QImage&). Receivers connected with
+		/// member function pointers may still take the frame alone, but
+		/// string based connections such as SIGNAL(onFrame(QImage)) no
+		/// longer match and must name both arguments.
+		/// \param[in]	frame	Converted frame.
+		/// \param[in]	info	Identity of the network frame the picture was
+		///						decoded from.
+		void onFrame(const QImage& frame,
+					 const Decoders::VideoDecoder::FrameInfo& info);
+
+		/// Signals an unconverted frame when conversion is deferred.
+		/// \param[in]	frame	Decoded frame.
+		/// \param[in]	info	Identity of the network frame the picture was
+		///						decoded from.
+		void onDecodedFrame(const Decoders::VideoDecoder::DecodedFrame& frame,
+							const Decoders::VideoDecoder::FrameInfo& info);
 
 	private:
 
+		/// Emits the frame of the last call if it produced one.
+		void emitFrame();
+
 		///
 		class VideoDecoderPrivate;
 
@@ -97,4 +323,9 @@ namespace Decoders {
 	};
 }
 
+Q_DECLARE_OPERATORS_FOR_FLAGS(Decoders::VideoDecoder::ConcealmentFlags)
+Q_DECLARE_METATYPE(Decoders::VideoDecoder::FrameInfo)
+Q_DECLARE_METATYPE(Decoders::VideoDecoder::DecodedFrame)
+Q_DECLARE_METATYPE(Decoders::VideoDecoder::Activity)
+
 #endif
@@ -0,0 +1,738 @@
+/// \file MosaicWidget.cpp
+/// \brief Contains classes and functions definitions that provide mosaic
+/// widget implementation.
+/// \bug No known bugs.
+
+#include "MosaicWidget.hpp"
+
+#include <QFile>
+#include <QOpenGLContext>
+#include <QPainter>
+#include <QSurfaceFormat>
+
+#include <cmath>
+
+#ifndef GL_BGRA
+#define GL_BGRA 0x80E1
+#endif
+
+///
+namespace Player {
+
+	///
+	namespace Playback {
+
+		///
+		/// \details
+		static constexpr char VERTEX_SHADER_FILENAME[] {
+			":/shaders/mosaic_vs.glsl"
+		};
+
+		///
+		/// \details
+		static constexpr char FRAGMENT_SHADER_FILENAME[] {
+			":/shaders/mosaic_fs.glsl"
+		};
+
+		///
+		/// \details
+		static constexpr char VERTEX_COORDINATE_ATTRIBUTE[] {
+			"vertex_coord_in"
+		};
+
+		///
+		/// \details
+		static constexpr char TILE_RECT_ATTRIBUTE[] {
+			"tile_rect_in"
+		};
+
+		///
+		/// \details
+		static constexpr char TILE_TEXTURE_ATTRIBUTE[] {
+			"tile_texture_in"
+		};
+
+		///
+		/// \details
+		static constexpr char TILES_UNIFORM[] {
+			"tiles"
+		};
+
+		/// Shader header for desktop OpenGL.
+		/// \details
+		static constexpr char DESKTOP_SHADER_HEADER[] {
+			"#version 330 core\n"
+		};
+
+		/// Shader header for OpenGL ES.
+		/// \details
+		static constexpr char ES_SHADER_HEADER[] {
+			"#version 300 es\n"
+			"precision mediump float;\n"
+			"precision mediump sampler2DArray;\n"
+		};
+
+		/// Unit quad drawn once per tile as a triangle strip.
+		/// \details
+		static constexpr float QUAD_VERTICES[] {
+			0.0f, 0.0f,
+			1.0f, 0.0f,
+			0.0f, 1.0f,
+			1.0f, 1.0f
+		};
+
+		/// Number of floats per tile instance.
+		/// \details Tile rectangle followed by texture scale and layer.
+		static constexpr int INSTANCE_COMPONENTS {
+			7
+		};
+
+		/// Default maximum texture layer size.
+		/// \details
+		static const QSize DEFAULT_MAXIMUM_LAYER_SIZE {
+			1920, 1080
+		};
+
+		/// Texture layer size granularity in pixels.
+		/// \details Small window resizes keep the allocated layers.
+		static constexpr int LAYER_ALIGNMENT {
+			32
+		};
+
+		/// Rounds a layer dimension up to the layer size granularity.
+		/// \param[in]	value	Layer dimension.
+		/// \return Aligned layer dimension.
+		static int alignLayer(int value) {
+			return (value + LAYER_ALIGNMENT - 1) / LAYER_ALIGNMENT
+				* LAYER_ALIGNMENT;
+		}
+
+		/// Reads a shader and prepends the version header of the context.
+		/// \details Texture arrays and instancing need GLSL 3.30 or
+		/// GLSL ES 3.00, the sources themselves are version neutral.
+		/// \param[in]	fileName	Shader file name.
+		/// \param[in]	context		Current context.
+		/// \return Shader source, empty on error.
+		static QByteArray readShader(const char* fileName,
+									 const QOpenGLContext* context) {
+
+			QFile file(fileName);
+			if (!file.open(QIODevice::ReadOnly)) return QByteArray();
+
+			return QByteArray(context->isOpenGLES() ? ES_SHADER_HEADER
+													: DESKTOP_SHADER_HEADER)
+				+ file.readAll();
+		}
+
+		/// Constructor.
+		/// \details Requests an OpenGL 3.3 core or OpenGL ES 3.0 surface.
+		/// \param[in]	parent	Parent object.
+		MosaicWidget::MosaicWidget(QWidget* parent)
+			: QOpenGLWidget(parent),
+			  clearColor_(Qt::black),
+			  maximumLayerSize_(DEFAULT_MAXIMUM_LAYER_SIZE),
+			  vertexBuffer_(QOpenGLBuffer::VertexBuffer),
+			  instanceBuffer_(QOpenGLBuffer::VertexBuffer),
+			  shaderProgram_(this) {
+
+			auto surfaceFormat = format();
+
+			if (QOpenGLContext::openGLModuleType() == QOpenGLContext::LibGLES) {
+				surfaceFormat.setRenderableType(QSurfaceFormat::OpenGLES);
+				surfaceFormat.setVersion(3, 0);
+			}
+			else {
+				surfaceFormat.setVersion(3, 3);
+				surfaceFormat.setProfile(QSurfaceFormat::CoreProfile);
+			}
+
+			setFormat(surfaceFormat);
+		}
+
+		/// Destructor.
+		/// \details
+		MosaicWidget::~MosaicWidget() {
+			destroyResources();
+		}
+
+		/// Returns the number of tiles.
+		/// \details
+		/// \return Number of tiles.
+		int MosaicWidget::tileCount() const {
+			return tiles_.size();
+		}
+
+		/// Sets the number of tiles.
+		/// \details Images of remaining tiles are kept.
+		/// \param[in]	count	Number of tiles.
+		void MosaicWidget::setTileCount(int count) {
+			count = qMax(0, count);
+			if (count == tiles_.size()) return;
+
+			tiles_.resize(count);
+			instancesDirty_ = true;
+			updateTileSize();
+			update();
+		}
+
+		/// Returns the maximum texture layer size.
+		/// \details
+		/// \return Maximum texture layer size.
+		QSize MosaicWidget::maximumLayerSize() const {
+			return maximumLayerSize_;
+		}
+
+		/// Sets the maximum texture layer size.
+		/// \details Applies from the next repaint.
+		/// \param[in]	size	Maximum texture layer size.
+		void MosaicWidget::setMaximumLayerSize(const QSize& size) {
+			if (!size.isValid()) return;
+
+			maximumLayerSize_ = size;
+			update();
+		}
+
+		/// Returns the size of a tile cell.
+		/// \details
+		/// \return Cell size in device pixels, or an empty size without
+		/// tiles.
+		QSize MosaicWidget::tileSize() const {
+			if (tiles_.isEmpty()) return QSize();
+
+			auto size = cellRect(0).size() * devicePixelRatioF();
+
+			return QSize(static_cast<int>(std::ceil(size.width())),
+						 static_cast<int>(std::ceil(size.height())));
+		}
+
+		/// Sets the image of a tile.
+		/// \details The image is uploaded on the next repaint, so several
+		/// images set between repaints cost a single upload each and a
+		/// single draw in total. The image is kept as is; images larger
+		/// than a layer are scaled down on upload by the GPU.
+		/// \param[in]	tile	Tile index.
+		/// \param[in]	image	Tile image.
+		void MosaicWidget::setImage(int tile, const QImage& image) {
+			if (tile < 0 || tile >= tiles_.size() || image.isNull()) return;
+
+			auto& target = tiles_[tile];
+			auto previousSize = target.image.size();
+
+			target.image = image;
+			target.dirty = true;
+
+			if (target.image.size() != previousSize)
+				instancesDirty_ = true;
+
+			update();
+		}
+
+		/// Sets the overlay of a tile.
+		/// \details
+		/// \param[in]	tile	Tile index.
+		/// \param[in]	overlay	Tile overlay.
+		void MosaicWidget::setOverlay(int tile, const Overlay& overlay) {
+			if (tile < 0 || tile >= tiles_.size()) return;
+
+			tiles_[tile].overlay = overlay;
+			update();
+		}
+
+		///
+		/// \details
+		void MosaicWidget::initializeGL() {
+			initializeOpenGLFunctions();
+			initializeResources();
+		}
+
+		/// Draws all tiles.
+		/// \details Uploads dirty tiles into their texture layers and draws
+		/// every tile with one instanced draw call.
+		void MosaicWidget::paintGL() {
+
+			glClearColor(clearColor_.redF	(),
+						 clearColor_.greenF	(),
+						 clearColor_.blueF	(),
+						 clearColor_.alphaF	());
+
+			glClear(GL_COLOR_BUFFER_BIT);
+
+			if (shaderProgram_.isLinked()) {
+				allocateLayers();
+				uploadTiles();
+
+				if (instancesDirty_)
+					updateInstances();
+
+				if (instanceCount_ > 0) {
+					shaderProgram_.bind();
+					vertexArray_.bind();
+
+					glActiveTexture(GL_TEXTURE0);
+					glBindTexture(GL_TEXTURE_2D_ARRAY, textureArray_);
+
+					glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4,
+										  instanceCount_);
+
+					glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+					vertexArray_.release();
+					shaderProgram_.release();
+				}
+			}
+
+			paintOverlays();
+		}
+
+		///
+		/// \details
+		/// \param[in]	width
+		/// \param[in]	height
+		void MosaicWidget::resizeGL(int width, int height) {
+			glViewport(0, 0, width, height);
+			instancesDirty_ = true;
+			updateTileSize();
+		}
+
+		/// Creates GL resources.
+		/// \details Leaves the program unlinked if the context lacks texture
+		/// arrays or instancing, in which case only overlays are drawn.
+		void MosaicWidget::initializeResources() {
+			auto currentContext = context();
+			auto version = currentContext->format().version();
+
+			if (version < qMakePair(3, currentContext->isOpenGLES() ? 0 : 3)) {
+				qWarning("MosaicWidget: OpenGL %d.%d is not supported",
+						 version.first, version.second);
+				return;
+			}
+
+			if (!shaderProgram_.addShaderFromSourceCode(
+					QOpenGLShader::Vertex,
+					readShader(VERTEX_SHADER_FILENAME, currentContext)) ||
+				!shaderProgram_.addShaderFromSourceCode(
+					QOpenGLShader::Fragment,
+					readShader(FRAGMENT_SHADER_FILENAME, currentContext)) ||
+				!shaderProgram_.link() ||
+				!shaderProgram_.bind() ||
+				!vertexArray_.create() ||
+				!vertexBuffer_.create() ||
+				!instanceBuffer_.create()) {
+				shaderProgram_.removeAllShaders();
+				return;
+			}
+
+			shaderProgram_.setUniformValue(TILES_UNIFORM, 0);
+
+			vertexArray_.bind();
+
+			vertexBuffer_.bind();
+			vertexBuffer_.allocate(QUAD_VERTICES, sizeof(QUAD_VERTICES));
+
+			shaderProgram_.enableAttributeArray(VERTEX_COORDINATE_ATTRIBUTE);
+			shaderProgram_.setAttributeBuffer(
+				VERTEX_COORDINATE_ATTRIBUTE,
+				GL_FLOAT,
+				0,
+				2,
+				2 * sizeof(GLfloat)
+			);
+
+			instanceBuffer_.setUsagePattern(QOpenGLBuffer::DynamicDraw);
+			instanceBuffer_.bind();
+
+			auto rectLocation =
+				shaderProgram_.attributeLocation(TILE_RECT_ATTRIBUTE);
+			auto textureLocation =
+				shaderProgram_.attributeLocation(TILE_TEXTURE_ATTRIBUTE);
+
+			shaderProgram_.enableAttributeArray(rectLocation);
+			shaderProgram_.setAttributeBuffer(
+				rectLocation,
+				GL_FLOAT,
+				0,
+				4,
+				INSTANCE_COMPONENTS * sizeof(GLfloat)
+			);
+
+			shaderProgram_.enableAttributeArray(textureLocation);
+			shaderProgram_.setAttributeBuffer(
+				textureLocation,
+				GL_FLOAT,
+				4 * sizeof(GLfloat),
+				3,
+				INSTANCE_COMPONENTS * sizeof(GLfloat)
+			);
+
+			glVertexAttribDivisor(static_cast<GLuint>(rectLocation), 1);
+			glVertexAttribDivisor(static_cast<GLuint>(textureLocation), 1);
+
+			vertexArray_.release();
+			shaderProgram_.release();
+
+			glGenTextures(1, &textureArray_);
+			glBindTexture(GL_TEXTURE_2D_ARRAY, textureArray_);
+			glTexParameteri(GL_TEXTURE_2D_ARRAY,
+							GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+			glTexParameteri(GL_TEXTURE_2D_ARRAY,
+							GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+			glTexParameteri(GL_TEXTURE_2D_ARRAY,
+							GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+			glTexParameteri(GL_TEXTURE_2D_ARRAY,
+							GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+			glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+			layerSize_ = QSize();
+			layerCount_ = 0;
+			instancesDirty_ = true;
+		}
+
+		///
+		/// \details
+		void MosaicWidget::destroyResources() {
+			makeCurrent();
+
+			if (textureArray_ != 0) {
+				glDeleteTextures(1, &textureArray_);
+				textureArray_ = 0;
+			}
+
+			if (stagingTexture_ != 0) {
+				glDeleteTextures(1, &stagingTexture_);
+				glDeleteFramebuffers(2, framebuffers_);
+				stagingTexture_ = 0;
+				stagingSize_ = QSize();
+			}
+
+			instanceBuffer_.destroy();
+			vertexBuffer_.destroy();
+			vertexArray_.destroy();
+
+			shaderProgram_.release();
+			shaderProgram_.removeAllShaders();
+
+			doneCurrent();
+		}
+
+		/// Reallocates the texture array if tiles do not fit in it.
+		/// \details Layers are as large as a tile cell in device pixels,
+		/// rounded up so small resizes keep them, and no larger than the
+		/// maximum layer size. The layer count grows to the tile count and
+		/// never shrinks. After a reallocation every tile is uploaded again.
+		void MosaicWidget::allocateLayers() {
+			auto size = tileSize();
+			if (size.isEmpty()) return;
+
+			auto width = qMin(alignLayer(size.width()),
+							  maximumLayerSize_.width());
+			auto height = qMin(alignLayer(size.height()),
+							   maximumLayerSize_.height());
+			auto count = qMax(layerCount_, tiles_.size());
+
+			if (width == layerSize_.width() &&
+				height == layerSize_.height() &&
+				count == layerCount_)
+				return;
+
+			layerSize_ = QSize(width, height);
+			layerCount_ = count;
+
+			glBindTexture(GL_TEXTURE_2D_ARRAY, textureArray_);
+			glTexImage3D(GL_TEXTURE_2D_ARRAY,
+						 0,
+						 GL_RGBA8,
+						 width,
+						 height,
+						 layerCount_,
+						 0,
+						 GL_RGBA,
+						 GL_UNSIGNED_BYTE,
+						 nullptr);
+			glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+			for (auto& tile : tiles_)
+				tile.dirty = !tile.image.isNull();
+
+			instancesDirty_ = true;
+		}
+
+		/// Uploads dirty tile images.
+		/// \details Rows are read in place through the unpack row length,
+		/// so padded scan lines need no packing copy. BGRA images are
+		/// uploaded as is on desktop OpenGL; OpenGL ES only takes them into
+		/// BGRA textures, so they are converted there.
+		void MosaicWidget::uploadTiles() {
+			if (layerCount_ == 0) return;
+
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+			auto bgraSupported = !context()->isOpenGLES();
+#else
+			auto bgraSupported = false;
+#endif
+
+			glBindTexture(GL_TEXTURE_2D_ARRAY, textureArray_);
+			glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+			for (auto index = 0; index < tiles_.size(); ++index) {
+				auto& tile = tiles_[index];
+				if (!tile.dirty) continue;
+
+				tile.dirty = false;
+
+				auto image = tile.image;
+				GLenum format = GL_RGBA;
+
+				if (bgraSupported &&
+					(image.format() == QImage::Format_RGB32 ||
+					 image.format() == QImage::Format_ARGB32)) {
+					format = GL_BGRA;
+				}
+				else if (image.format() != QImage::Format_RGBA8888 &&
+						 image.format() != QImage::Format_RGBX8888) {
+					image = image.convertToFormat(QImage::Format_RGBA8888);
+				}
+
+				auto size = image.size();
+
+				glPixelStorei(GL_UNPACK_ROW_LENGTH, image.bytesPerLine() / 4);
+
+				if (size.width() > layerSize_.width() ||
+					size.height() > layerSize_.height()) {
+					size = size.scaled(layerSize_, Qt::KeepAspectRatio)
+							   .expandedTo(QSize(1, 1));
+					uploadScaledTile(index, image, format, size);
+					glBindTexture(GL_TEXTURE_2D_ARRAY, textureArray_);
+				}
+				else {
+					glTexSubImage3D(GL_TEXTURE_2D_ARRAY,
+									0,
+									0,
+									0,
+									index,
+									size.width(),
+									size.height(),
+									1,
+									format,
+									GL_UNSIGNED_BYTE,
+									image.constBits());
+				}
+
+				if (tile.layerImageSize != size) {
+					tile.layerImageSize = size;
+					instancesDirty_ = true;
+				}
+			}
+
+			glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+			glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+		}
+
+		/// Uploads an image larger than a texture layer.
+		/// \details The image is uploaded into a staging texture and the GPU
+		/// scales it into the layer with a linear blit, so the GUI thread
+		/// never scales images. Only images that arrive larger than their
+		/// tile take this path. Expects the unpack row length of the image.
+		/// \param[in]	layer	Texture layer.
+		/// \param[in]	image	Tile image.
+		/// \param[in]	format	Pixel format of the image data.
+		/// \param[in]	size	Size of the image in the layer.
+		void MosaicWidget::uploadScaledTile(int layer,
+											const QImage& image,
+											GLenum format,
+											const QSize& size) {
+
+			if (stagingTexture_ == 0) {
+				glGenTextures(1, &stagingTexture_);
+				glGenFramebuffers(2, framebuffers_);
+
+				glBindTexture(GL_TEXTURE_2D, stagingTexture_);
+				glTexParameteri(GL_TEXTURE_2D,
+								GL_TEXTURE_MIN_FILTER,
+								GL_LINEAR);
+				glTexParameteri(GL_TEXTURE_2D,
+								GL_TEXTURE_MAG_FILTER,
+								GL_LINEAR);
+			}
+
+			glBindTexture(GL_TEXTURE_2D, stagingTexture_);
+
+			if (image.width() > stagingSize_.width() ||
+				image.height() > stagingSize_.height()) {
+				stagingSize_ = stagingSize_.expandedTo(image.size());
+
+				glTexImage2D(GL_TEXTURE_2D,
+							 0,
+							 GL_RGBA8,
+							 stagingSize_.width(),
+							 stagingSize_.height(),
+							 0,
+							 GL_RGBA,
+							 GL_UNSIGNED_BYTE,
+							 nullptr);
+			}
+
+			glTexSubImage2D(GL_TEXTURE_2D,
+							0,
+							0,
+							0,
+							image.width(),
+							image.height(),
+							format,
+							GL_UNSIGNED_BYTE,
+							image.constBits());
+			glBindTexture(GL_TEXTURE_2D, 0);
+
+			glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffers_[0]);
+			glFramebufferTexture2D(GL_READ_FRAMEBUFFER,
+								   GL_COLOR_ATTACHMENT0,
+								   GL_TEXTURE_2D,
+								   stagingTexture_,
+								   0);
+
+			glBindFramebuffer(GL_DRAW_FRAMEBUFFER, framebuffers_[1]);
+			glFramebufferTextureLayer(GL_DRAW_FRAMEBUFFER,
+									  GL_COLOR_ATTACHMENT0,
+									  textureArray_,
+									  0,
+									  layer);
+
+			glBlitFramebuffer(0,
+							  0,
+							  image.width(),
+							  image.height(),
+							  0,
+							  0,
+							  size.width(),
+							  size.height(),
+							  GL_COLOR_BUFFER_BIT,
+							  GL_LINEAR);
+
+			glBindFramebuffer(GL_FRAMEBUFFER, defaultFramebufferObject());
+		}
+
+		/// Emits tileSizeChanged() if the tile cells were resized.
+		/// \details
+		void MosaicWidget::updateTileSize() {
+			auto size = tileSize();
+			if (size == tileSize_) return;
+
+			tileSize_ = size;
+			emit tileSizeChanged(size);
+		}
+
+		/// Rebuilds per-instance tile data.
+		/// \details Tiles without an image are not drawn. The texture scale
+		/// marks where the image ends in its layer; the fragment shader
+		/// samples no closer than half a texel to that edge, so linear
+		/// filtering never blends in the uninitialized rest of the layer.
+		void MosaicWidget::updateInstances() {
+			instancesDirty_ = false;
+			instanceCount_ = 0;
+
+			if (layerCount_ == 0 || width() == 0 || height() == 0) return;
+
+			QVector<GLfloat> instances;
+			instances.reserve(tiles_.size() * INSTANCE_COMPONENTS);
+
+			auto viewWidth = static_cast<float>(width());
+			auto viewHeight = static_cast<float>(height());
+			auto layerWidth = static_cast<GLfloat>(layerSize_.width());
+			auto layerHeight = static_cast<GLfloat>(layerSize_.height());
+
+			for (auto index = 0; index < tiles_.size(); ++index) {
+				const auto& tile = tiles_[index];
+				if (tile.image.isNull() || tile.layerImageSize.isEmpty())
+					continue;
+
+				auto rect = imageRect(index);
+				auto left = 2.0 * rect.left() / viewWidth - 1.0;
+				auto bottom = 1.0 - 2.0 * rect.bottom() / viewHeight;
+				auto tileWidth = 2.0 * rect.width() / viewWidth;
+				auto tileHeight = 2.0 * rect.height() / viewHeight;
+
+				instances << static_cast<GLfloat>(left)
+						  << static_cast<GLfloat>(bottom)
+						  << static_cast<GLfloat>(tileWidth)
+						  << static_cast<GLfloat>(tileHeight)
+						  << tile.layerImageSize.width() / layerWidth
+						  << tile.layerImageSize.height() / layerHeight
+						  << static_cast<GLfloat>(index);
+
+				++instanceCount_;
+			}
+
+			instanceBuffer_.bind();
+			instanceBuffer_.allocate(
+				instances.constData(),
+				instances.size() * static_cast<int>(sizeof(GLfloat)));
+			instanceBuffer_.release();
+		}
+
+		/// Draws tile overlays.
+		/// \details Overlays are painted over the GL output of the same frame.
+		void MosaicWidget::paintOverlays() {
+			QPainter painter;
+			auto begun = false;
+
+			for (auto index = 0; index < tiles_.size(); ++index) {
+				const auto& overlay = tiles_[index].overlay;
+				if (overlay.text.isEmpty() && !overlay.borderColor.isValid())
+					continue;
+
+				if (!begun) {
+					painter.begin(this);
+					painter.setPen(Qt::white);
+					begun = true;
+				}
+
+				auto cell = cellRect(index);
+
+				if (overlay.borderColor.isValid()) {
+					painter.save();
+					painter.setPen(QPen(overlay.borderColor, 2));
+					painter.drawRect(cell.adjusted(1, 1, -1, -1));
+					painter.restore();
+				}
+
+				if (!overlay.text.isEmpty())
+					painter.drawText(cell.adjusted(6, 4, -6, -4),
+									 Qt::AlignLeft | Qt::AlignTop,
+									 overlay.text);
+			}
+		}
+
+		/// Returns the grid cell of a tile.
+		/// \details The grid has as many columns as the square root of the
+		/// tile count rounded up.
+		/// \param[in]	tile	Tile index.
+		/// \return Cell rectangle in widget coordinates.
+		QRectF MosaicWidget::cellRect(int tile) const {
+			auto count = tiles_.size();
+			auto columns = static_cast<int>(std::ceil(std::sqrt(count)));
+			auto rows = (count + columns - 1) / columns;
+
+			auto cellWidth = static_cast<qreal>(width()) / columns;
+			auto cellHeight = static_cast<qreal>(height()) / rows;
+
+			return QRectF((tile % columns) * cellWidth,
+						  (tile / columns) * cellHeight,
+						  cellWidth,
+						  cellHeight);
+		}
+
+		/// Returns the tile image rectangle inside its cell.
+		/// \details The image is centered and keeps its aspect ratio.
+		/// \param[in]	tile	Tile index.
+		/// \return Image rectangle in widget coordinates.
+		QRectF MosaicWidget::imageRect(int tile) const {
+			auto cell = cellRect(tile);
+			auto size = QSizeF(tiles_[tile].image.size())
+							.scaled(cell.size(), Qt::KeepAspectRatio);
+
+			return QRectF(cell.left() + (cell.width() - size.width()) / 2,
+						  cell.top() + (cell.height() - size.height()) / 2,
+						  size.width(),
+						  size.height());
+		}
+	}
+}
@@ -0,0 +1,224 @@
+/// \file MosaicWidget.hpp
+/// \brief Contains classes and functions declarations that provide mosaic
+/// widget implementation.
+/// \bug No known bugs.
+
+#ifndef MOSAICWIDGET_HPP
+#define MOSAICWIDGET_HPP
+
+#include <QColor>
+#include <QImage>
+#include <QOpenGLBuffer>
+#include <QOpenGLExtraFunctions>
+#include <QOpenGLShaderProgram>
+#include <QOpenGLVertexArrayObject>
+#include <QOpenGLWidget>
+#include <QVector>
+
+///
+namespace Player {
+
+	///
+	namespace Playback {
+
+		/// A class that renders many streams on a single GL surface.
+		/// \details Tiles are laid out in a grid. Every tile owns a layer of
+		/// one texture array and all tiles are drawn as instanced quads in a
+		/// single draw call. Layers are as large as a tile cell, so images
+		/// should arrive at about the tile size, see tileSize(). Requires
+		/// OpenGL 3.3 or OpenGL ES 3.0.
+		class MosaicWidget
+			: public QOpenGLWidget,
+			  protected QOpenGLExtraFunctions {
+
+			Q_OBJECT
+
+		public:
+
+			/// A structure that describes a tile overlay.
+			struct Overlay {
+
+				/// Text drawn in the top left corner of the tile.
+				QString text;
+
+				/// Tile border color, no border if invalid.
+				QColor borderColor;
+			};
+
+		public:
+
+			/// Constructor.
+			/// \param[in]	parent	Parent object.
+			explicit MosaicWidget(QWidget* parent = nullptr);
+
+			/// Destructor.
+			virtual ~MosaicWidget();
+
+		public:
+
+			/// Returns the number of tiles.
+			/// \return Number of tiles.
+			int tileCount() const;
+
+			/// Sets the number of tiles.
+			/// \param[in]	count	Number of tiles.
+			void setTileCount(int count);
+
+			/// Returns the maximum texture layer size.
+			/// \return Maximum texture layer size.
+			QSize maximumLayerSize() const;
+
+			/// Sets the maximum texture layer size.
+			/// \details Layers never grow beyond it, however large the tiles.
+			/// \param[in]	size	Maximum texture layer size.
+			void setMaximumLayerSize(const QSize& size);
+
+			/// Returns the size of a tile cell.
+			/// \return Cell size in device pixels, or an empty size without
+			/// tiles.
+			QSize tileSize() const;
+
+			/// Sets the image of a tile.
+			/// \param[in]	tile	Tile index.
+			/// \param[in]	image	Tile image.
+			void setImage(int tile, const QImage& image);
+
+			/// Sets the overlay of a tile.
+			/// \param[in]	tile	Tile index.
+			/// \param[in]	overlay	Tile overlay.
+			void setOverlay(int tile, const Overlay& overlay);
+
+		signals:
+
+			/// Signals that the tile cells were resized.
+			/// \param[in]	size	Cell size in device pixels.
+			void tileSizeChanged(const QSize& size);
+
+		protected:
+
+			///
+			void initializeGL() override;
+
+			///
+			void paintGL() override;
+
+			///
+			/// \param[in]	width
+			/// \param[in]	height
+			void resizeGL(int width, int height) override;
+
+		private:
+
+			/// A structure that describes a tile.
+			struct Tile {
+
+				/// Last image set for the tile.
+				QImage image;
+
+				/// Indicates whether the image has to be uploaded.
+				bool dirty = false;
+
+				/// Size of the image in its texture layer.
+				QSize layerImageSize;
+
+				/// Tile overlay.
+				Overlay overlay;
+			};
+
+		private:
+
+			///
+			void initializeResources();
+
+			///
+			void destroyResources();
+
+			/// Reallocates the texture array if tiles do not fit in it.
+			void allocateLayers();
+
+			/// Uploads dirty tile images.
+			void uploadTiles();
+
+			/// Uploads an image larger than a texture layer.
+			/// \param[in]	layer	Texture layer.
+			/// \param[in]	image	Tile image.
+			/// \param[in]	format	Pixel format of the image data.
+			/// \param[in]	size	Size of the image in the layer.
+			void uploadScaledTile(int layer,
+								  const QImage& image,
+								  GLenum format,
+								  const QSize& size);
+
+			/// Emits tileSizeChanged() if the tile cells were resized.
+			void updateTileSize();
+
+			/// Rebuilds per-instance tile data.
+			void updateInstances();
+
+			/// Draws tile overlays.
+			void paintOverlays();
+
+			/// Returns the grid cell of a tile.
+			/// \param[in]	tile	Tile index.
+			/// \return Cell rectangle in widget coordinates.
+			QRectF cellRect(int tile) const;
+
+			/// Returns the tile image rectangle inside its cell.
+			/// \param[in]	tile	Tile index.
+			/// \return Image rectangle in widget coordinates.
+			QRectF imageRect(int tile) const;
+
+		private:
+
+			///
+			QColor clearColor_;
+
+			/// Tiles.
+			QVector<Tile> tiles_;
+
+			/// Maximum texture layer size.
+			QSize maximumLayerSize_;
+
+			/// Allocated texture layer size.
+			QSize layerSize_;
+
+			/// Number of allocated texture layers.
+			int layerCount_ = 0;
+
+			/// Last signalled tile cell size.
+			QSize tileSize_;
+
+			/// Texture array identifier.
+			GLuint textureArray_ = 0;
+
+			/// Texture that images larger than a layer are scaled from.
+			GLuint stagingTexture_ = 0;
+
+			/// Allocated staging texture size.
+			QSize stagingSize_;
+
+			/// Framebuffers reading the staging texture and drawing a layer.
+			GLuint framebuffers_[2] { };
+
+			/// Number of tile instances to draw.
+			int instanceCount_ = 0;
+
+			/// Indicates whether instance data has to be rebuilt.
+			bool instancesDirty_ = true;
+
+			///
+			QOpenGLVertexArrayObject vertexArray_;
+
+			///
+			QOpenGLBuffer vertexBuffer_;
+
+			/// Per-instance tile data.
+			QOpenGLBuffer instanceBuffer_;
+
+			///
+			QOpenGLShaderProgram shaderProgram_;
+		};
+	}
+}
+
+#endif
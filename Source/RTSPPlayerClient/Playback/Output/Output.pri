@@ -4,8 +4,20 @@
 
 HEADERS			+=															\
 	$$PWD/PlaybackVideo.hpp \
+						$$PWD/MosaicWidget.hpp								\
 						$$PWD/PlaybackWidget.hpp							\
+						$$PWD/PresentationScheduler.hpp					\
+						$$PWD/RenderThread.hpp								\
+						$$PWD/ResourceCache.hpp								\
+						$$PWD/StreamCounters.hpp							\
+						$$PWD/TextureStream.hpp								\
 
 SOURCES			+=															\
 	$$PWD/PlaybackVideo.cpp \
+						$$PWD/MosaicWidget.cpp								\
 						$$PWD/PlaybackWidget.cpp							\
+						$$PWD/PresentationScheduler.cpp					\
+						$$PWD/RenderThread.cpp								\
+						$$PWD/ResourceCache.cpp								\
+						$$PWD/StreamCounters.cpp							\
+						$$PWD/TextureStream.cpp								\
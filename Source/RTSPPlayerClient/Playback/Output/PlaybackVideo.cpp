@@ -1,18 +1,65 @@
+/// \file PlaybackVideo.cpp
+/// \brief Contains classes and functions definitions that provide software
+/// playback output.
+/// \bug No known bugs.
+
 #include "PlaybackVideo.hpp"
-#include <QDebug>
+
+#include "Playback/Conversion/ConversionKernels.hpp"
+
+#include <QPainter>
 
 PlaybackVideo::PlaybackVideo(QWidget *parent) : QWidget(parent)
 {
-
+	// Every paint covers the whole widget, so the background is never erased.
+	setAttribute(Qt::WA_OpaquePaintEvent);
 }
 
 void PlaybackVideo::setImage(const QImage& image) {
 	image_ = image;
+	scaledImage_ = QImage();
+	update();
 }
 
 void PlaybackVideo::paintEvent(QPaintEvent *)
 {
-	qDebug() << "hehe";
 	QPainter painter(this);
-	painter.drawImage(rect(), image_);
+
+	if (image_.isNull()) {
+		painter.fillRect(rect(), Qt::black);
+		return;
+	}
+
+	auto ratio = devicePixelRatioF();
+	auto size = (QSizeF(this->size()) * ratio).toSize();
+
+	if (scaledImage_.size() != size)
+		updateScaledImage(size);
+
+	painter.drawImage(QPointF(0, 0), scaledImage_);
+}
+
+void PlaybackVideo::updateScaledImage(const QSize& size) {
+	if (size.isEmpty()) {
+		scaledImage_ = QImage();
+		return;
+	}
+
+	auto source = image_;
+
+	// The scaler treats channels alike, so any 32-bit layout scales as is.
+	if (source.depth() != 32)
+		source = source.convertToFormat(QImage::Format_RGB32);
+
+	scaledImage_ = QImage(size, source.format());
+	scaledImage_.setDevicePixelRatio(devicePixelRatioF());
+
+	Conversion::scalePlane32(source.constBits(),
+							 source.bytesPerLine(),
+							 source.width(),
+							 source.height(),
+							 scaledImage_.bits(),
+							 scaledImage_.bytesPerLine(),
+							 scaledImage_.width(),
+							 scaledImage_.height());
 }
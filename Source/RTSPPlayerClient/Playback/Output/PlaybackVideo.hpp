@@ -1,25 +1,41 @@
+/// \file PlaybackVideo.hpp
+/// \brief Contains classes and functions declarations that provide software
+/// playback output.
+/// \bug No known bugs.
+
 #ifndef PLAYBACKVIDEO_HPP
 #define PLAYBACKVIDEO_HPP
 
+#include <QImage>
 #include <QWidget>
-#include <QPainter>
 
+/// A class that shows frames without OpenGL.
+/// \details Frames are scaled to the widget size once, when they arrive or
+/// when the widget is resized, and every paint only blits the cached result.
 class PlaybackVideo : public QWidget
 {
 	Q_OBJECT
 public:
 	explicit PlaybackVideo(QWidget *parent = nullptr);
+
+	/// Sets the frame to show and schedules a repaint.
+	/// \param[in]	image	Frame image.
 	void setImage(const QImage& image);
 
 protected:
 	void paintEvent(QPaintEvent *) override;
 
-signals:
-
-public slots:
+private:
+	/// Scales the frame to the widget size.
+	/// \param[in]	size	Target size in device pixels.
+	void updateScaledImage(const QSize& size);
 
 private:
+	/// Last frame.
 	QImage image_;
+
+	/// Last frame scaled to the widget size.
+	QImage scaledImage_;
 };
 
 #endif
@@ -50,22 +50,30 @@ namespace Player {
 			+1.0f, +1.0f, -1.0f, +1.0f, +1.0f
 		};
 
+		/// Overlay distance from the widget corner in pixels.
+		/// \details
+		static constexpr int OVERLAY_MARGIN {
+			4
+		};
+
 		/// Constructor.
 		/// \details
 		/// \param[in]	parent	Parent object.
 		PlaybackWidget::PlaybackWidget(QWidget* parent)
 			: QOpenGLWidget(parent),
 			  clearColor_(Qt::black),
-			  vertexBuffer_(QOpenGLBuffer::VertexBuffer),
-			  colorTexture_(QOpenGLTexture::Target2D),
-			  shaderProgram_(this) {
+			  colorTexture_() {
 
 		}
 
 		/// Destructor.
 		/// \details
 		PlaybackWidget::~PlaybackWidget() {
+			setRenderThread(nullptr);
+
+			makeCurrent();
 			destroyResources();
+			doneCurrent();
 		}
 
 		///
@@ -78,8 +86,112 @@ namespace Player {
 			glEnable(GL_CULL_FACE);
 		}
 
-		void PlaybackWidget::setImage(const QImage &image) {
-			colorTexture_.setData(image);
+		/// Uploads an image into the widget texture and schedules a repaint.
+		/// \details Texture storage is kept between frames and reallocated
+		/// only when the image size or format changes. Images that arrive
+		/// before the GL context exists are dropped. Repaints requested
+		/// before the next paint are coalesced, pacing is left to the caller,
+		/// normally a presentation scheduler.
+		/// \param[in]	image	Image to upload.
+		void PlaybackWidget::setImage(const QImage& image) {
+			frameVisible_ = true;
+
+			if (renderThread_) {
+				renderThread_->submit(renderTarget_, image);
+				return;
+			}
+
+			if (!context()) return;
+
+			makeCurrent();
+			colorTexture_.upload(image);
+			doneCurrent();
+
+			if (counters_) {
+				counters_->addUpload(colorTexture_.statistics().lastUploadTime);
+				counters_->setMemoryUsage(
+					Common::Utility::MemoryStage::Texture,
+					colorTexture_.statistics().allocatedBytes);
+			}
+
+			update();
+		}
+
+		/// Shows the clear color until the next image arrives.
+		/// \details Keeps the texture and its storage, so a widget that is
+		/// reused for another stream neither shows the previous stream nor
+		/// reallocates for same sized frames.
+		void PlaybackWidget::clear() {
+			frameVisible_ = false;
+			update();
+		}
+
+		/// Moves uploads and drawing to a render thread.
+		/// \details The render thread draws frames into framebuffers at the
+		/// widget size and the GUI thread only composites the newest one, so
+		/// uploads never block the GUI thread. Repaints are requested when
+		/// a frame is ready.
+		/// \param[in]	renderThread	Render thread, or nullptr to render
+		///								on the GUI thread.
+		void PlaybackWidget::setRenderThread(RenderThread* renderThread) {
+			if (renderThread_ == renderThread) return;
+
+			if (renderThread_) {
+				renderThread_->removeTarget(renderTarget_);
+				renderTarget_ = -1;
+			}
+
+			renderThread_ = renderThread;
+
+			if (renderThread_) {
+				renderTarget_ = renderThread_->addTarget([this] {
+					QMetaObject::invokeMethod(this, [this] { update(); },
+											  Qt::QueuedConnection);
+				});
+
+				renderThread_->resize(renderTarget_,
+									  size() * devicePixelRatioF());
+				renderThread_->setCounters(renderTarget_, counters_);
+			}
+		}
+
+		/// Sets the counters uploads are reported to.
+		/// \details With a render thread, its render times are reported.
+		/// \param[in]	counters	Stream counters, or null.
+		void PlaybackWidget::setCounters(
+			std::shared_ptr<StreamCounters> counters) {
+			counters_ = std::move(counters);
+
+			if (renderThread_)
+				renderThread_->setCounters(renderTarget_, counters_);
+		}
+
+		/// Sets an image drawn over the top left corner of the frame.
+		/// \details The image is uploaded on the next paint and drawn in
+		/// the same pass as the frame, so a rarely changing overlay costs one
+		/// textured quad per paint. It is drawn at device pixel size.
+		/// \param[in]	overlay	Overlay image with premultiplied alpha,
+		///						or a null image to remove the overlay.
+		void PlaybackWidget::setOverlay(const QImage& overlay) {
+			overlay_ = overlay;
+			overlayChanged_ = true;
+			update();
+		}
+
+		/// Returns texture upload statistics.
+		/// \details Upload times include image conversion and row packing.
+		/// \return Texture upload statistics.
+		const TextureStream::Statistics&
+		PlaybackWidget::uploadStatistics() const {
+			return colorTexture_.statistics();
+		}
+
+		/// Returns render thread statistics.
+		/// \details Render times include the texture upload.
+		/// \return Render thread statistics, empty without a render thread.
+		RenderThread::Statistics PlaybackWidget::renderStatistics() const {
+			return renderThread_ ? renderThread_->statistics(renderTarget_)
+								 : RenderThread::Statistics();
 		}
 
 		///
@@ -93,16 +205,43 @@ namespace Player {
 
 			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-			if (shaderProgram_.isLinked()) {
+			if (shaderProgram_) {
 				QMatrix4x4 transformMatrix;
-				transformMatrix.ortho(-1.0f, +1.0f, +1.0f, -1.0f, 0.0f, 10.0f);
 
-				shaderProgram_.setUniformValue(MATRIX_UNIFORM, transformMatrix);
-
-				if (colorTexture_.isCreated())
-					colorTexture_.bind();
-
-				glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
+				if (renderThread_) {
+					// Framebuffers are already upright, they are only
+					// composited.
+					transformMatrix.ortho(-1.0f, +1.0f, -1.0f, +1.0f,
+										  0.0f, 10.0f);
+
+					shaderProgram_->setUniformValue(MATRIX_UNIFORM,
+													transformMatrix);
+
+					auto texture = renderThread_->acquire(renderTarget_);
+
+					if (texture != 0 && frameVisible_) {
+						// The unflipped projection reverses the quad winding.
+						glDisable(GL_CULL_FACE);
+						glBindTexture(GL_TEXTURE_2D, texture);
+						glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
+						glBindTexture(GL_TEXTURE_2D, 0);
+						glEnable(GL_CULL_FACE);
+					}
+				}
+				else {
+					transformMatrix.ortho(-1.0f, +1.0f, +1.0f, -1.0f,
+										  0.0f, 10.0f);
+
+					shaderProgram_->setUniformValue(MATRIX_UNIFORM,
+													transformMatrix);
+
+					if (colorTexture_.isValid() && frameVisible_) {
+						colorTexture_.bind();
+						glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
+					}
+				}
+
+				drawOverlay();
 			}
 		}
 
@@ -112,29 +251,42 @@ namespace Player {
 		/// \param[in]	height
 		void PlaybackWidget::resizeGL(int width, int height) {
 			glViewport(0, 0, width, height);
+
+			if (renderThread_)
+				renderThread_->resize(renderTarget_,
+									  size() * devicePixelRatioF());
 		}
 
 		///
-		/// \details
+		/// \details The program and the viewport quad come from the resource
+		/// cache, so only the first widget of a layout compiles and later
+		/// runs load the stored program binary. Both stay bound in the widget
+		/// context; attribute arrays are context state and are set here,
+		/// uniforms are program state and are set before every draw.
 		void PlaybackWidget::initializeResources() {
-			if (!shaderProgram_.addShaderFromSourceFile(
-					QOpenGLShader::Vertex, VERTEX_SHADER_FILENAME)		||
-				!shaderProgram_.addShaderFromSourceFile(
-					QOpenGLShader::Fragment, FRAGMENT_SHADER_FILENAME)	||
-				!shaderProgram_.link()									||
-				!shaderProgram_.bind()									||
-				!vertexBuffer_.create()									||
-				!vertexBuffer_.bind()) {
-				destroy();
-				return;
+			auto cache = ResourceCache::current();
+
+			if (cache) {
+				shaderProgram_ = cache->program(VERTEX_SHADER_FILENAME,
+												FRAGMENT_SHADER_FILENAME);
+				vertexBuffer_ = cache->vertexBuffer(VIEWPORT_VERTICES,
+													sizeof(VIEWPORT_VERTICES));
 			}
 
-			vertexBuffer_.allocate(VIEWPORT_VERTICES, sizeof(VIEWPORT_VERTICES));
+			if (!shaderProgram_											||
+				!vertexBuffer_											||
+				!shaderProgram_->bind()									||
+				!vertexBuffer_->bind()									||
+				!colorTexture_.initialize()								||
+				!overlayTexture_.initialize()) {
+				destroyResources();
+				return;
+			}
 
-			shaderProgram_.enableAttributeArray(VERTEX_COORDINATE_ATTRIBUTE);
-			shaderProgram_.enableAttributeArray(TEXTURE_COORDINATE_ATTRIBUTE);
+			shaderProgram_->enableAttributeArray(VERTEX_COORDINATE_ATTRIBUTE);
+			shaderProgram_->enableAttributeArray(TEXTURE_COORDINATE_ATTRIBUTE);
 
-			shaderProgram_.setAttributeBuffer(
+			shaderProgram_->setAttributeBuffer(
 				VERTEX_COORDINATE_ATTRIBUTE,
 				GL_FLOAT,
 				0,
@@ -142,7 +294,7 @@ namespace Player {
 				5 * sizeof(GLfloat)
 			);
 
-			shaderProgram_.setAttributeBuffer(
+			shaderProgram_->setAttributeBuffer(
 				TEXTURE_COORDINATE_ATTRIBUTE,
 				GL_FLOAT,
 				3 * sizeof(GLfloat),
@@ -152,24 +304,68 @@ namespace Player {
 
 		}
 
-		///
-		/// \details
+		/// Releases GL resources in the current context.
+		/// \details Shared resources stay in the cache for other widgets.
 		void PlaybackWidget::destroyResources() {
-			makeCurrent();
+			if (vertexBuffer_) {
+				vertexBuffer_->release();
+				vertexBuffer_.reset();
+			}
 
-			vertexBuffer_.release();
-			vertexBuffer_.destroy();
+			colorTexture_.release();
+			colorTexture_.destroy();
 
-			if (colorTexture_.isCreated() && colorTexture_.isBound())
-				colorTexture_.release();
+			overlayTexture_.release();
+			overlayTexture_.destroy();
 
-			if (colorTexture_.isCreated())
-				colorTexture_.destroy();
+			if (shaderProgram_) {
+				shaderProgram_->release();
+				shaderProgram_.reset();
+			}
+		}
 
-			shaderProgram_.release();
-			shaderProgram_.removeAllShaders();
+		/// Draws the overlay over the frame.
+		/// \details Uploads the overlay if it changed and draws it over the
+		/// top left corner. The overlay is blended with premultiplied alpha
+		/// and is always drawn over the frame, so the depth test is off.
+		void PlaybackWidget::drawOverlay() {
+			if (overlayChanged_) {
+				overlayChanged_ = false;
 
-			doneCurrent();
+				if (!overlay_.isNull())
+					overlayTexture_.upload(overlay_);
+			}
+
+			if (overlay_.isNull() || !overlayTexture_.isValid()) return;
+
+			const auto viewport = size() * devicePixelRatioF();
+			if (viewport.isEmpty()) return;
+
+			const auto width	= static_cast<float>(viewport.width	());
+			const auto height	= static_cast<float>(viewport.height());
+			const auto scaleX	= overlay_.width	() / width;
+			const auto scaleY	= overlay_.height	() / height;
+			const auto offsetX	= 2.0f * OVERLAY_MARGIN / width;
+			const auto offsetY	= 2.0f * OVERLAY_MARGIN / height;
+
+			QMatrix4x4 transformMatrix;
+			transformMatrix.ortho(-1.0f, +1.0f, +1.0f, -1.0f, 0.0f, 10.0f);
+			transformMatrix.translate(-1.0f + scaleX + offsetX,
+									  -1.0f + scaleY + offsetY);
+			transformMatrix.scale(scaleX, scaleY);
+
+			shaderProgram_->setUniformValue(MATRIX_UNIFORM, transformMatrix);
+
+			glDisable(GL_DEPTH_TEST);
+			glEnable(GL_BLEND);
+			glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+
+			overlayTexture_.bind();
+			glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
+			overlayTexture_.release();
+
+			glDisable(GL_BLEND);
+			glEnable(GL_DEPTH_TEST);
 		}
 	}
 }
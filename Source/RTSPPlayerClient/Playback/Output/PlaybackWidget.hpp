@@ -6,12 +6,18 @@
 #ifndef PLAYBACKWIDGET_HPP
 #define PLAYBACKWIDGET_HPP
 
+#include "RenderThread.hpp"
+#include "ResourceCache.hpp"
+#include "StreamCounters.hpp"
+#include "TextureStream.hpp"
+
 #include <QOpenGLBuffer>
-#include <QOpenGLTexture>
 #include <QOpenGLWidget>
 #include <QOpenGLShaderProgram>
 #include <QOpenGLFunctions>
 
+#include <memory>
+
 ///
 namespace Player {
 
@@ -36,8 +42,34 @@ namespace Player {
 
 		public:
 
+			/// Uploads an image into the widget texture and schedules a repaint.
+			/// \param[in]	image	Image to upload.
 			void setImage(const QImage& image);
 
+			/// Shows the clear color until the next image arrives.
+			void clear();
+
+			/// Moves uploads and drawing to a render thread.
+			/// \param[in]	renderThread	Render thread, or nullptr to render
+			///								on the GUI thread.
+			void setRenderThread(RenderThread* renderThread);
+
+			/// Sets the counters uploads are reported to.
+			/// \param[in]	counters	Stream counters, or null.
+			void setCounters(std::shared_ptr<StreamCounters> counters);
+
+			/// Sets an image drawn over the top left corner of the frame.
+			/// \param[in]	overlay	Overlay image with premultiplied alpha,
+			///						or a null image to remove the overlay.
+			void setOverlay(const QImage& overlay);
+
+			/// Returns texture upload statistics.
+			/// \return Texture upload statistics.
+			const TextureStream::Statistics& uploadStatistics() const;
+
+			/// Returns render thread statistics.
+			/// \return Render thread statistics, empty without a render thread.
+			RenderThread::Statistics renderStatistics() const;
 
 		protected:
 
@@ -57,22 +89,46 @@ namespace Player {
 			///
 			void initializeResources();
 
-			///
+			/// Releases GL resources in the current context.
 			void destroyResources();
 
+			/// Draws the overlay over the frame.
+			void drawOverlay();
+
 		private:
 
 			///
 			QColor clearColor_;
 
-			///
-			QOpenGLBuffer vertexBuffer_;
+			/// Viewport quad shared through the resource cache.
+			std::shared_ptr<QOpenGLBuffer> vertexBuffer_;
 
-			///
-			QOpenGLTexture colorTexture_;
+			/// Streaming color texture.
+			TextureStream colorTexture_;
 
-			///
-			QOpenGLShaderProgram shaderProgram_;
+			/// Render thread, or nullptr if rendering on the GUI thread.
+			RenderThread* renderThread_ = nullptr;
+
+			/// Render thread target identifier.
+			int renderTarget_ = -1;
+
+			/// Stream counters, or null.
+			std::shared_ptr<StreamCounters> counters_;
+
+			/// Indicates whether the last image is drawn.
+			bool frameVisible_ = true;
+
+			/// Overlay image.
+			QImage overlay_;
+
+			/// Indicates whether the overlay image changed since its upload.
+			bool overlayChanged_ = false;
+
+			/// Overlay texture.
+			TextureStream overlayTexture_;
+
+			/// Program shared through the resource cache.
+			std::shared_ptr<QOpenGLShaderProgram> shaderProgram_;
 		};
 	}
 }
@@ -0,0 +1,761 @@
+/// \file PresentationScheduler.cpp
+/// \brief Contains classes and functions definitions that provide frame
+/// presentation scheduling.
+/// \bug No known bugs.
+
+#include "PresentationScheduler.hpp"
+
+#include <QGuiApplication>
+#include <QScreen>
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iterator>
+
+namespace {
+
+	/// Default refresh rate in hertz.
+	/// \details Used if the screen does not report a refresh rate.
+	constexpr qreal DEFAULT_REFRESH_RATE {
+		60.0
+	};
+
+	/// Default playout delay in microseconds.
+	/// \details Absorbs network and decoding jitter.
+	constexpr qint64 DEFAULT_PLAYOUT_DELAY {
+		50000
+	};
+
+	/// Playout clock error that forces resynchronization in microseconds.
+	/// \details Covers stream restarts and timestamp jumps.
+	constexpr qint64 RESYNCHRONIZATION_THRESHOLD {
+		1000000
+	};
+
+	/// Maximum number of queued frames per stream.
+	/// \details Oldest frames are dropped on overflow.
+	constexpr std::size_t MAXIMUM_QUEUED_FRAMES {
+		8
+	};
+
+	/// Time after a refresh at which ticks wake in microseconds.
+	/// \details Keeps a tick from firing just before the refresh it targets.
+	constexpr qint64 TICK_MARGIN {
+		1000
+	};
+
+	/// Span of stream timestamps a sync clock window covers in microseconds.
+	/// \details The lowest transit of a window stands for the offset, so a
+	/// window should hold a few frames that were not delayed on the way.
+	constexpr qint64 SYNC_WINDOW {
+		2000000
+	};
+
+	/// Span of stream timestamps the drift is measured over in microseconds.
+	/// \details The lowest transit of a window is off by some jitter, so the
+	/// drift is taken between offsets far apart. The reference offset moves
+	/// by half the span once the span is reached.
+	constexpr qint64 DRIFT_BASELINE {
+		60000000
+	};
+
+	/// Weight of a new drift measurement.
+	constexpr double DRIFT_GAIN {
+		0.25
+	};
+
+	/// Largest accepted clock drift.
+	/// \details Crystal oscillators stay well within a thousand parts per
+	/// million; larger slopes come from transit changes.
+	constexpr double MAXIMUM_DRIFT {
+		0.001
+	};
+
+	/// Number of frames over which a lateness peak decays.
+	constexpr qint64 LATENESS_DECAY {
+		64
+	};
+
+	/// Decrease of the required delay that lowers a common playout delay in
+	/// microseconds.
+	/// \details Every change of the delay moves all streams of the group, so
+	/// small decreases are ignored.
+	constexpr qint64 SYNC_DELAY_HYSTERESIS {
+		10000
+	};
+
+	/// Returns the current time.
+	/// \return Steady clock time in microseconds.
+	qint64 currentTime() noexcept {
+		return std::chrono::duration_cast<std::chrono::microseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+}
+
+///
+namespace Player {
+
+	///
+	namespace Playback {
+
+		/// Constructor.
+		/// \details Takes the refresh rate of the primary screen.
+		/// \param[in]	parent	Parent object.
+		PresentationScheduler::PresentationScheduler(QObject* parent)
+			: QObject(parent),
+			  refreshPeriod_(
+				  static_cast<qint64>(1000000 / DEFAULT_REFRESH_RATE)),
+			  playoutDelay_(DEFAULT_PLAYOUT_DELAY),
+			  refreshPhase_(currentTime()) {
+
+			if (auto screen = QGuiApplication::primaryScreen())
+				setRefreshRate(screen->refreshRate());
+
+			timer_.setSingleShot(true);
+			timer_.setTimerType(Qt::PreciseTimer);
+
+			connect(&timer_, &QTimer::timeout,
+					this, &PresentationScheduler::tick);
+		}
+
+		/// Registers a stream.
+		/// \details Starts refresh ticks with the first stream.
+		/// \param[in]	presenter	Function that shows frames of the stream.
+		/// \return Stream identifier.
+		int PresentationScheduler::addStream(Presenter presenter) {
+			auto stream = nextStream_++;
+			streams_[stream].presenter = std::move(presenter);
+
+			if (!timer_.isActive()) scheduleTick();
+
+			return stream;
+		}
+
+		/// Unregisters a stream.
+		/// \details Queued frames are released and the stream leaves its
+		/// sync group. Must not be called from a presenter.
+		/// \param[in]	stream	Stream identifier.
+		void PresentationScheduler::removeStream(int stream) {
+			auto found = streams_.find(stream);
+			if (found == streams_.end()) return;
+
+			if (found->counters)
+				found->counters->setMemoryUsage(
+					Common::Utility::MemoryStage::Presentation, 0);
+
+			auto group = found->syncGroup;
+			streams_.erase(found);
+
+			if (group >= 0) {
+				auto syncGroup = syncGroups_.find(group);
+				syncGroup->statistics.streams = --syncGroup->streams;
+
+				if (syncGroup->streams == 0)
+					syncGroups_.erase(syncGroup);
+				else
+					updateSyncDelay(group);
+			}
+
+			if (streams_.isEmpty()) timer_.stop();
+		}
+
+		/// Replaces the function that shows frames of a stream.
+		/// \details Applies from the next presented frame, so a stream can
+		/// move between widgets without being registered again. Must not be
+		/// called from a presenter.
+		/// \param[in]	stream		Stream identifier.
+		/// \param[in]	presenter	Function that shows frames of the stream.
+		void PresentationScheduler::setPresenter(
+			int stream,
+			Presenter presenter) {
+
+			auto found = streams_.find(stream);
+			if (found != streams_.end())
+				found->presenter = std::move(presenter);
+		}
+
+		/// Returns presentation statistics of a stream.
+		/// \details
+		/// \param[in]	stream	Stream identifier.
+		/// \return Presentation statistics.
+		PresentationScheduler::Statistics
+		PresentationScheduler::statistics(int stream) const {
+			auto found = streams_.constFind(stream);
+			return found != streams_.cend() ? found->statistics : Statistics();
+		}
+
+		/// Sets the counters a stream reports to.
+		/// \details Queue depth, drops and presentations are reported, with
+		/// latency measured from the receive time given with each frame.
+		/// \param[in]	stream		Stream identifier.
+		/// \param[in]	counters	Stream counters, or null.
+		void PresentationScheduler::setCounters(
+			int stream,
+			std::shared_ptr<StreamCounters> counters) {
+
+			auto found = streams_.find(stream);
+			if (found != streams_.end()) found->counters = std::move(counters);
+		}
+
+		/// Returns the refresh period.
+		/// \details
+		/// \return Refresh period in microseconds.
+		qint64 PresentationScheduler::refreshPeriod() const {
+			return refreshPeriod_;
+		}
+
+		/// Sets the refresh rate.
+		/// \details Ignores rates that are not positive.
+		/// \param[in]	rate	Refresh rate in hertz.
+		void PresentationScheduler::setRefreshRate(qreal rate) {
+			if (rate > 0.0)
+				refreshPeriod_ =
+					static_cast<qint64>(std::llround(1000000 / rate));
+		}
+
+		/// Returns the playout delay.
+		/// \details
+		/// \return Playout delay in microseconds.
+		qint64 PresentationScheduler::playoutDelay() const {
+			return playoutDelay_;
+		}
+
+		/// Sets the playout delay.
+		/// \details Applies when a playout clock is set next. The common
+		/// delay of sync groups never falls below it.
+		/// \param[in]	delay	Playout delay in microseconds.
+		void PresentationScheduler::setPlayoutDelay(qint64 delay) {
+			playoutDelay_ = qMax<qint64>(0, delay);
+		}
+
+		/// Returns the sync group of a stream.
+		/// \details
+		/// \param[in]	stream	Stream identifier.
+		/// \return Sync group identifier, or -1 if the stream is in none.
+		int PresentationScheduler::syncGroup(int stream) const {
+			auto found = streams_.constFind(stream);
+			return found != streams_.cend() ? found->syncGroup : -1;
+		}
+
+		/// Moves a stream to a sync group.
+		/// \details Streams of a group are due at their capture time plus
+		/// the common playout delay of the group, instead of after the
+		/// playout delay from their own first frame. Capture times come from
+		/// the stream timestamps, which must be monotonic capture stamps of
+		/// the sender, through an offset and drift estimated from the lowest
+		/// transit times. Streams whose senders share a clock therefore line
+		/// up within the spread of their lowest network transit. Streams
+		/// stamped by one sender clock, like all flows of a server, should
+		/// share it: they take the lowest offset of the streams sharing it,
+		/// so that transit differences between them are compensated as well.
+		/// The clock of a moved stream is estimated anew.
+		/// \param[in]	stream		Stream identifier.
+		/// \param[in]	group		Sync group identifier chosen by the
+		///							caller, or a negative value to leave
+		///							the group.
+		/// \param[in]	sharedClock	Indicates whether the stream timestamps
+		///							come from the same clock as those of the
+		///							other streams of the group sharing it.
+		void PresentationScheduler::setSyncGroup(int stream,
+												 int group,
+												 bool sharedClock) {
+			auto found = streams_.find(stream);
+			if (found == streams_.end()) return;
+
+			group = qMax(-1, group);
+			found->sharedClock = group >= 0 && sharedClock;
+
+			auto previous = found->syncGroup;
+			if (previous == group) return;
+
+			found->syncGroup = group;
+			found->syncClock = SyncClock();
+			found->clockValid = false;
+
+			if (previous >= 0) {
+				auto syncGroup = syncGroups_.find(previous);
+				syncGroup->statistics.streams = --syncGroup->streams;
+
+				if (syncGroup->streams == 0)
+					syncGroups_.erase(syncGroup);
+				else
+					updateSyncDelay(previous);
+			}
+
+			if (group >= 0) {
+				auto& syncGroup = syncGroups_[group];
+				if (syncGroup.streams == 0)
+					syncGroup.playoutDelay = playoutDelay_;
+				syncGroup.statistics.streams = ++syncGroup.streams;
+				syncGroup.statistics.playoutDelay = syncGroup.playoutDelay;
+			}
+		}
+
+		/// Returns presentation statistics of a sync group.
+		/// \details
+		/// \param[in]	group	Sync group identifier.
+		/// \return Sync group statistics.
+		PresentationScheduler::SyncStatistics
+		PresentationScheduler::syncStatistics(int group) const {
+			auto found = syncGroups_.constFind(group);
+			return found != syncGroups_.cend() ? found->statistics
+											   : SyncStatistics();
+		}
+
+		/// Queues a frame whose image is produced on presentation.
+		/// \details Meant for decoded frames that are converted on demand:
+		/// only the presented frame calls its source, and dropped frames are
+		/// released unconverted. The queue holds at most
+		/// MAXIMUM_QUEUED_FRAMES frames per stream, each keeping its decoded
+		/// picture alive until it is presented or dropped. A source that
+		/// produces a null image presents nothing.
+		/// \param[in]	stream		Stream identifier.
+		/// \param[in]	source		Function that produces the frame image.
+		/// \param[in]	timestamp	Stream timestamp in microseconds.
+		/// \param[in]	receiveTime	Local receive time in microseconds, or
+		///							zero if unknown.
+		void PresentationScheduler::submitDeferred(int stream,
+												   FrameSource source,
+												   quint64 timestamp,
+												   quint64 receiveTime) {
+			if (source)
+				enqueue(stream, std::move(source), timestamp, receiveTime, 0);
+		}
+
+		/// Queues a frame for presentation.
+		/// \details The image is queued as it is, already converted.
+		/// \param[in]	stream		Stream identifier.
+		/// \param[in]	frame		Frame image.
+		/// \param[in]	timestamp	Stream timestamp in microseconds.
+		/// \param[in]	receiveTime	Local receive time in microseconds, or
+		///							zero if unknown.
+		void PresentationScheduler::submit(int stream,
+										   const QImage& frame,
+										   quint64 timestamp,
+										   quint64 receiveTime) {
+			if (!frame.isNull())
+				enqueue(stream,
+						[frame] { return frame; },
+						timestamp,
+						receiveTime,
+						static_cast<quint64>(frame.sizeInBytes()));
+		}
+
+		/// Aligns refresh ticks to a buffer swap.
+		/// \details Meant to be connected to a frame swap signal of a widget
+		/// that swaps with vertical synchronization.
+		void PresentationScheduler::synchronize() {
+			refreshPhase_ = currentTime();
+		}
+
+		/// Queues a frame of a stream.
+		/// \details The first frame of a stream sets its playout clock, so
+		/// that the frame is due after the playout delay. Later frames are
+		/// due relative to it by their timestamps. The clock is reset if a
+		/// frame lands far from the current time. The receive time must come
+		/// from the steady clock, like the decoder receive timestamps. Frames
+		/// of streams in a sync group are due by their estimated capture time
+		/// instead.
+		/// \param[in]	stream		Stream identifier.
+		/// \param[in]	source		Function that produces the frame image.
+		/// \param[in]	timestamp	Stream timestamp in microseconds.
+		/// \param[in]	receiveTime	Local receive time in microseconds, or
+		///							zero if unknown.
+		/// \param[in]	bytes		Bytes held by the image, zero if not
+		///							converted yet.
+		void PresentationScheduler::enqueue(int stream,
+											FrameSource source,
+											quint64 timestamp,
+											quint64 receiveTime,
+											quint64 bytes) {
+
+			auto found = streams_.find(stream);
+			if (found == streams_.end()) return;
+
+			auto& target = *found;
+			auto now = currentTime();
+			auto frameTimestamp = static_cast<qint64>(timestamp);
+
+			++target.statistics.submittedFrames;
+
+			if (target.submitted) {
+				auto delta = frameTimestamp - target.submittedTimestamp;
+
+				if (delta > 0 && delta < RESYNCHRONIZATION_THRESHOLD)
+					target.frameDuration = target.frameDuration > 0
+						? (target.frameDuration * 7 + delta) / 8
+						: delta;
+			}
+
+			target.submittedTimestamp = frameTimestamp;
+			target.submitted = true;
+
+			qint64 captureTime, dueTime;
+
+			if (target.syncGroup >= 0) {
+				captureTime = estimateCaptureTime(
+					target,
+					frameTimestamp,
+					receiveTime > 0 ? static_cast<qint64>(receiveTime) : now,
+					now);
+
+				updateSyncDelay(target.syncGroup);
+				dueTime =
+					captureTime + syncGroups_[target.syncGroup].playoutDelay;
+			}
+			else {
+				dueTime = frameTimestamp + target.clockOffset;
+
+				if (!target.clockValid ||
+					std::abs(dueTime - now) > RESYNCHRONIZATION_THRESHOLD) {
+
+					if (target.clockValid)
+						++target.statistics.resynchronizations;
+
+					target.clockOffset = now + playoutDelay_ - frameTimestamp;
+					target.clockValid = true;
+					dueTime = now + playoutDelay_;
+				}
+
+				captureTime = dueTime - playoutDelay_;
+			}
+
+			auto position = target.frames.end();
+			while (position != target.frames.begin() &&
+				   std::prev(position)->dueTime > dueTime)
+				--position;
+
+			target.frames.insert(position, Frame {
+				std::move(source),
+				frameTimestamp,
+				captureTime,
+				dueTime,
+				static_cast<qint64>(receiveTime),
+				bytes
+			});
+
+			while (target.frames.size() > MAXIMUM_QUEUED_FRAMES) {
+				target.frames.pop_front();
+				++target.statistics.droppedFrames;
+				if (target.counters) target.counters->addDropped(1);
+			}
+
+			reportQueue(target);
+		}
+
+		/// Presents due frames of all streams.
+		/// \details Frames chosen now are shown on the next refresh.
+		void PresentationScheduler::tick() {
+			auto now = currentTime();
+			auto refreshes = (now - refreshPhase_) / refreshPeriod_ + 1;
+			auto refreshTime = refreshPhase_ + refreshes * refreshPeriod_;
+
+			for (auto& stream : streams_)
+				present(stream, refreshTime);
+
+			if (!syncGroups_.isEmpty()) measureSkew();
+
+			scheduleTick();
+		}
+
+		/// Presents the due frame of a stream.
+		/// \details Picks the newest frame due closest to the refresh and
+		/// drops the ones before it, so only the picked frame produces its
+		/// image. Display durations of presented frames
+		/// are compared with their timestamp distances to measure judder.
+		/// \param[in]	stream		Stream.
+		/// \param[in]	refreshTime	Time of the next refresh.
+		void PresentationScheduler::present(Stream& stream,
+											qint64 refreshTime) {
+			auto halfPeriod = refreshPeriod_ / 2;
+			auto deadline = refreshTime + halfPeriod;
+			auto& statistics = stream.statistics;
+
+			auto due = stream.frames.begin();
+			while (due != stream.frames.end() &&
+				   std::next(due) != stream.frames.end() &&
+				   std::next(due)->dueTime <= deadline)
+				++due;
+
+			if (due == stream.frames.end() || due->dueTime > deadline) {
+				if (stream.presented &&
+					stream.frameDuration > 0 &&
+					refreshTime - halfPeriod > stream.expectedTime) {
+
+					++statistics.duplicatedFrames;
+					stream.expectedTime += stream.frameDuration;
+				}
+				return;
+			}
+
+			auto frame = std::move(*due);
+			auto dropped = std::distance(stream.frames.begin(), due);
+
+			stream.frames.erase(stream.frames.begin(), std::next(due));
+			statistics.droppedFrames += static_cast<quint64>(dropped);
+
+			if (frame.dueTime < refreshTime - refreshPeriod_)
+				++statistics.missedDeadlines;
+
+			if (stream.presented) {
+				auto shown = refreshTime - stream.presentedTime;
+				auto nominal = frame.timestamp - stream.presentedTimestamp;
+
+				if (nominal > 0) {
+					auto error = std::abs(shown - nominal);
+					statistics.judderTime += static_cast<quint64>(error);
+					if (error >= refreshPeriod_) ++statistics.judderFrames;
+				}
+			}
+
+			stream.presented = true;
+			stream.presentedTime = refreshTime;
+			stream.presentedTimestamp = frame.timestamp;
+			stream.presentedCaptureTime = frame.captureTime;
+			stream.expectedTime = stream.frames.empty()
+				? frame.dueTime + stream.frameDuration
+				: stream.frames.front().dueTime;
+
+			++statistics.presentedFrames;
+
+			if (stream.counters) {
+				stream.counters->addDropped(static_cast<quint64>(dropped));
+				reportQueue(stream);
+				stream.counters->addPresented(frame.receiveTime > 0
+					? qMax<qint64>(0, refreshTime - frame.receiveTime)
+					: -1);
+			}
+
+			if (stream.presenter) {
+				auto image = frame.source();
+				if (!image.isNull()) stream.presenter(image);
+			}
+		}
+
+		/// Returns the offset of a capture clock at a timestamp.
+		/// \details Extrapolates the offset at the anchor along the drift.
+		/// \param[in]	clock		Capture clock estimate.
+		/// \param[in]	timestamp	Stream timestamp in microseconds.
+		/// \return Offset from the timestamp to local time in microseconds.
+		qint64 PresentationScheduler::clockOffset(const SyncClock& clock,
+												  qint64 timestamp) {
+			auto elapsed = static_cast<double>(timestamp - clock.anchor);
+			return clock.offset + std::llround(clock.drift * elapsed);
+		}
+
+		/// Estimates the local capture time of a frame of a stream in a sync
+		/// group.
+		/// \details Transit, the arrival time minus the timestamp, is the
+		/// clock offset plus network and sender delay. The lowest transit of
+		/// each SYNC_WINDOW stands for the offset at its frame, and the slope
+		/// from an offset up to DRIFT_BASELINE earlier for the drift, so that
+		/// the offset between windows is extrapolated along it. Until the
+		/// first window completes, the lowest transit so far is used. The
+		/// estimate starts over when a frame lands far off it, as after a
+		/// stream restart. Streams sharing the clock of the group take the
+		/// lowest offset of them. Also tracks how late frames are queued after
+		/// their capture, which sets the common playout delay.
+		/// \param[in,out]	stream		Stream.
+		/// \param[in]		timestamp	Stream timestamp in microseconds.
+		/// \param[in]		arrival		Local arrival time in microseconds.
+		/// \param[in]		now			Current time in microseconds.
+		/// \return Local capture time in microseconds.
+		qint64 PresentationScheduler::estimateCaptureTime(Stream& stream,
+														  qint64 timestamp,
+														  qint64 arrival,
+														  qint64 now) {
+			auto& clock = stream.syncClock;
+			auto transit = arrival - timestamp;
+
+			if (clock.valid &&
+				std::abs(transit - clockOffset(clock, timestamp)) >
+					RESYNCHRONIZATION_THRESHOLD) {
+				++stream.statistics.resynchronizations;
+				clock = SyncClock();
+			}
+
+			if (!clock.valid) {
+				clock.valid = true;
+				clock.anchor = timestamp;
+				clock.offset = transit;
+				clock.windowStart = timestamp;
+			}
+
+			auto residual = transit - clockOffset(clock, timestamp);
+
+			if (!clock.estimated && residual < 0) {
+				clock.offset += residual;
+				residual = 0;
+			}
+
+			if (clock.windowFrames++ == 0 || residual <= clock.windowMinimum) {
+				clock.windowMinimum = residual;
+				clock.windowTimestamp = timestamp;
+			}
+
+			if (timestamp - clock.windowStart >= SYNC_WINDOW) {
+				auto measuredOffset =
+					clockOffset(clock, clock.windowTimestamp) +
+					clock.windowMinimum;
+				auto span = clock.windowTimestamp - clock.referenceTimestamp;
+
+				if (!clock.estimated) {
+					clock.referenceOffset = measuredOffset;
+					clock.referenceTimestamp = clock.windowTimestamp;
+				}
+				else if (span > 0) {
+					auto change = measuredOffset - clock.referenceOffset;
+					auto slope = static_cast<double>(change) /
+								 static_cast<double>(span);
+
+					clock.drift += (slope - clock.drift) * DRIFT_GAIN;
+					clock.drift =
+						qBound(-MAXIMUM_DRIFT, clock.drift, MAXIMUM_DRIFT);
+
+					if (!clock.halfway && span >= DRIFT_BASELINE / 2) {
+						clock.halfwayOffset = measuredOffset;
+						clock.halfwayTimestamp = clock.windowTimestamp;
+						clock.halfway = true;
+					}
+
+					if (span >= DRIFT_BASELINE) {
+						clock.referenceOffset = clock.halfwayOffset;
+						clock.referenceTimestamp = clock.halfwayTimestamp;
+						clock.halfway = false;
+					}
+				}
+
+				auto estimatedOffset =
+					clockOffset(clock, clock.windowTimestamp);
+
+				clock.offset = clock.estimated
+					? estimatedOffset + (measuredOffset - estimatedOffset) / 2
+					: measuredOffset;
+				clock.anchor = clock.windowTimestamp;
+				clock.estimated = true;
+				clock.windowStart = timestamp;
+				clock.windowFrames = 0;
+			}
+
+			auto offset = clockOffset(clock, timestamp);
+
+			if (stream.sharedClock) {
+				for (const auto& other : streams_)
+					if (other.syncGroup == stream.syncGroup &&
+						other.sharedClock &&
+						other.syncClock.valid)
+						offset = qMin(offset,
+									  clockOffset(other.syncClock, timestamp));
+			}
+
+			auto captureTime = timestamp + offset;
+			auto lateness = now - captureTime;
+
+			clock.lateness = lateness > clock.lateness
+				? lateness
+				: clock.lateness - (clock.lateness - lateness) / LATENESS_DECAY;
+
+			stream.statistics.clockOffset = offset;
+			stream.statistics.clockDrift = clock.drift * 1000000.0;
+
+			return captureTime;
+		}
+
+		/// Adapts the common playout delay of a sync group.
+		/// \details The delay covers the recent peak lateness of the latest
+		/// stream plus a refresh period, and never falls below the playout
+		/// delay. It rises at once and falls only by more than
+		/// SYNC_DELAY_HYSTERESIS. Queued frames of the group move with it.
+		/// \param[in]	group	Sync group identifier.
+		void PresentationScheduler::updateSyncDelay(int group) {
+			auto found = syncGroups_.find(group);
+			if (found == syncGroups_.end()) return;
+
+			qint64 lateness = 0;
+			for (const auto& stream : streams_)
+				if (stream.syncGroup == group && stream.syncClock.valid)
+					lateness = qMax(lateness, stream.syncClock.lateness);
+
+			auto delay = qMax(playoutDelay_, lateness + refreshPeriod_);
+			auto shift = delay - found->playoutDelay;
+
+			if (shift > 0 || shift < -SYNC_DELAY_HYSTERESIS) {
+				found->playoutDelay = delay;
+				found->statistics.playoutDelay = delay;
+
+				for (auto& stream : streams_)
+					if (stream.syncGroup == group)
+						for (auto& frame : stream.frames)
+							frame.dueTime += shift;
+			}
+		}
+
+		/// Measures the capture time spread of sync groups.
+		/// \details The spread is taken over the capture times of the frames
+		/// shown by the streams of a group once every stream has shown one.
+		/// It includes the frame interval of each stream, since a stream
+		/// keeps showing its frame until the next is due.
+		void PresentationScheduler::measureSkew() {
+			for (auto& group : syncGroups_)
+				group.shown = 0;
+
+			for (const auto& stream : streams_) {
+				if (stream.syncGroup < 0 || !stream.presented) continue;
+
+				auto& group = syncGroups_[stream.syncGroup];
+				auto captureTime = stream.presentedCaptureTime;
+
+				if (group.shown++ == 0) {
+					group.earliest = captureTime;
+					group.latest = captureTime;
+				}
+				else {
+					group.earliest = qMin(group.earliest, captureTime);
+					group.latest = qMax(group.latest, captureTime);
+				}
+			}
+
+			for (auto& group : syncGroups_) {
+				if (group.streams < 2 || group.shown < group.streams) continue;
+
+				auto& statistics = group.statistics;
+				statistics.skew = group.latest - group.earliest;
+				statistics.maximumSkew =
+					qMax(statistics.maximumSkew, statistics.skew);
+				statistics.skewTime += static_cast<quint64>(statistics.skew);
+				++statistics.skewSamples;
+			}
+		}
+
+		/// Reports the queue of a stream to its counters.
+		/// \details Reports the queue depth and the bytes held by queued
+		/// images. Frames queued unconverted have no image yet and hold only
+		/// their decoded picture.
+		/// \param[in]	stream	Stream.
+		void PresentationScheduler::reportQueue(const Stream& stream) {
+			if (!stream.counters) return;
+
+			quint64 bytes = 0;
+			for (const auto& frame : stream.frames) bytes += frame.bytes;
+
+			stream.counters->setQueued(stream.frames.size());
+			stream.counters->setMemoryUsage(
+				Common::Utility::MemoryStage::Presentation, bytes);
+		}
+
+		/// Schedules the next tick.
+		/// \details Ticks wake shortly after each refresh.
+		void PresentationScheduler::scheduleTick() {
+			if (streams_.isEmpty()) return;
+
+			auto now = currentTime();
+			auto refreshes = (now - refreshPhase_) / refreshPeriod_ + 1;
+			auto wakeTime =
+				refreshPhase_ + refreshes * refreshPeriod_ + TICK_MARGIN;
+			auto delay = (wakeTime - now + 999) / 1000;
+
+			timer_.start(static_cast<int>(qMax<qint64>(1, delay)));
+		}
+	}
+}
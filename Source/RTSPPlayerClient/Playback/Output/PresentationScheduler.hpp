@@ -0,0 +1,450 @@
+/// \file PresentationScheduler.hpp
+/// \brief Contains classes and functions declarations that provide frame
+/// presentation scheduling.
+/// \bug No known bugs.
+
+#ifndef PRESENTATIONSCHEDULER_HPP
+#define PRESENTATIONSCHEDULER_HPP
+
+#include "StreamCounters.hpp"
+
+#include <QHash>
+#include <QImage>
+#include <QObject>
+#include <QTimer>
+
+#include <deque>
+#include <functional>
+#include <memory>
+
+///
+namespace Player {
+
+	///
+	namespace Playback {
+
+		/// A class that paces frame presentation to the display refresh.
+		/// \details Wakes once per refresh period and picks, for every stream,
+		/// the newest frame due by the next refresh according to the playout
+		/// clock of the stream. Older frames are dropped, so a stream shows at
+		/// most one new frame and its widget repaints at most once per
+		/// refresh. Frames may be queued unconverted through a frame source,
+		/// so frames dropped before their refresh are never converted.
+		/// Streams of cameras that cover the same scene can join a sync
+		/// group, whose streams are presented by capture time with a common
+		/// playout delay. All methods must be called from the GUI thread.
+		class PresentationScheduler : public QObject {
+
+			Q_OBJECT
+
+		public:
+
+			/// A function that shows a frame.
+			using Presenter = std::function<void(const QImage& frame)>;
+
+			/// A function that produces the image of a queued frame.
+			/// \details Called at most once, when the frame is presented.
+			using FrameSource = std::function<QImage()>;
+
+			/// A structure that contains presentation statistics of a stream.
+			struct Statistics {
+
+				/// Number of submitted frames.
+				quint64 submittedFrames = 0;
+
+				/// Number of presented frames.
+				quint64 presentedFrames = 0;
+
+				/// Number of frames dropped without being presented.
+				quint64 droppedFrames = 0;
+
+				/// Number of refreshes that repeated a frame past its duration.
+				quint64 duplicatedFrames = 0;
+
+				/// Number of frames presented after their refresh.
+				quint64 missedDeadlines = 0;
+
+				/// Number of frames shown for a refresh longer or shorter than
+				/// their nominal duration.
+				quint64 judderFrames = 0;
+
+				/// Accumulated display duration error in microseconds.
+				quint64 judderTime = 0;
+
+				/// Number of playout clock resynchronizations.
+				quint64 resynchronizations = 0;
+
+				/// Estimated offset from stream timestamps to local capture
+				/// time in microseconds, in a sync group.
+				qint64 clockOffset = 0;
+
+				/// Estimated rate error of the stream clock against the local
+				/// clock in parts per million, in a sync group.
+				qreal clockDrift = 0.0;
+			};
+
+			/// A structure that contains presentation statistics of a sync
+			/// group.
+			struct SyncStatistics {
+
+				/// Number of streams in the group.
+				int streams = 0;
+
+				/// Common playout delay in microseconds.
+				qint64 playoutDelay = 0;
+
+				/// Capture time spread of the frames shown at the last
+				/// refresh in microseconds.
+				qint64 skew = 0;
+
+				/// Largest capture time spread in microseconds.
+				qint64 maximumSkew = 0;
+
+				/// Accumulated capture time spread in microseconds.
+				quint64 skewTime = 0;
+
+				/// Number of refreshes the spread was measured at.
+				quint64 skewSamples = 0;
+			};
+
+		public:
+
+			/// Constructor.
+			/// \param[in]	parent	Parent object.
+			explicit PresentationScheduler(QObject* parent = nullptr);
+
+			/// Destructor.
+			virtual ~PresentationScheduler() = default;
+
+		public:
+
+			/// Registers a stream.
+			/// \param[in]	presenter	Function that shows frames of the stream.
+			/// \return Stream identifier.
+			int addStream(Presenter presenter);
+
+			/// Unregisters a stream.
+			/// \param[in]	stream	Stream identifier.
+			void removeStream(int stream);
+
+			/// Replaces the function that shows frames of a stream.
+			/// \param[in]	stream		Stream identifier.
+			/// \param[in]	presenter	Function that shows frames of the stream.
+			void setPresenter(int stream, Presenter presenter);
+
+			/// Returns presentation statistics of a stream.
+			/// \param[in]	stream	Stream identifier.
+			/// \return Presentation statistics.
+			Statistics statistics(int stream) const;
+
+			/// Sets the counters a stream reports to.
+			/// \param[in]	stream		Stream identifier.
+			/// \param[in]	counters	Stream counters, or null.
+			void setCounters(int stream,
+							 std::shared_ptr<StreamCounters> counters);
+
+			/// Returns the refresh period.
+			/// \return Refresh period in microseconds.
+			qint64 refreshPeriod() const;
+
+			/// Sets the refresh rate.
+			/// \param[in]	rate	Refresh rate in hertz.
+			void setRefreshRate(qreal rate);
+
+			/// Returns the playout delay.
+			/// \return Playout delay in microseconds.
+			qint64 playoutDelay() const;
+
+			/// Sets the playout delay.
+			/// \param[in]	delay	Playout delay in microseconds.
+			void setPlayoutDelay(qint64 delay);
+
+			/// Returns the sync group of a stream.
+			/// \param[in]	stream	Stream identifier.
+			/// \return Sync group identifier, or -1 if the stream is in none.
+			int syncGroup(int stream) const;
+
+			/// Moves a stream to a sync group.
+			/// \param[in]	stream		Stream identifier.
+			/// \param[in]	group		Sync group identifier chosen by the
+			///							caller, or a negative value to leave
+			///							the group.
+			/// \param[in]	sharedClock	Indicates whether the stream timestamps
+			///							come from the same clock as those of the
+			///							other streams of the group sharing it.
+			void setSyncGroup(int stream, int group, bool sharedClock = false);
+
+			/// Returns presentation statistics of a sync group.
+			/// \param[in]	group	Sync group identifier.
+			/// \return Sync group statistics.
+			SyncStatistics syncStatistics(int group) const;
+
+			/// Queues a frame whose image is produced on presentation.
+			/// \param[in]	stream		Stream identifier.
+			/// \param[in]	source		Function that produces the frame image.
+			/// \param[in]	timestamp	Stream timestamp in microseconds.
+			/// \param[in]	receiveTime	Local receive time in microseconds, or
+			///							zero if unknown.
+			void submitDeferred(int stream,
+								FrameSource source,
+								quint64 timestamp,
+								quint64 receiveTime = 0);
+
+		public slots:
+
+			/// Queues a frame for presentation.
+			/// \param[in]	stream		Stream identifier.
+			/// \param[in]	frame		Frame image.
+			/// \param[in]	timestamp	Stream timestamp in microseconds.
+			/// \param[in]	receiveTime	Local receive time in microseconds, or
+			///							zero if unknown.
+			void submit(int stream,
+						const QImage& frame,
+						quint64 timestamp,
+						quint64 receiveTime = 0);
+
+			/// Aligns refresh ticks to a buffer swap.
+			void synchronize();
+
+		private:
+
+			/// A structure that describes a queued frame.
+			struct Frame {
+
+				/// Function that produces the frame image.
+				FrameSource source;
+
+				/// Stream timestamp in microseconds.
+				qint64 timestamp;
+
+				/// Local capture time in microseconds.
+				qint64 captureTime;
+
+				/// Local due time in microseconds.
+				qint64 dueTime;
+
+				/// Local receive time in microseconds, or zero if unknown.
+				qint64 receiveTime;
+
+				/// Bytes held by the image, zero if not converted yet.
+				quint64 bytes;
+			};
+
+			/// A structure that contains the capture clock estimate of a
+			/// stream in a sync group.
+			/// \details Models the offset from stream timestamps to local
+			/// time as a line through the lowest transit times seen in
+			/// consecutive windows.
+			struct SyncClock {
+
+				/// Indicates whether the clock has a sample.
+				bool valid = false;
+
+				/// Indicates whether a window has completed.
+				bool estimated = false;
+
+				/// Timestamp the offset is given at.
+				qint64 anchor = 0;
+
+				/// Offset from stream timestamps to local time at the anchor.
+				qint64 offset = 0;
+
+				/// Rate error of the stream clock against the local clock.
+				double drift = 0.0;
+
+				/// Timestamp of the first frame of the current window.
+				qint64 windowStart = 0;
+
+				/// Number of frames in the current window.
+				int windowFrames = 0;
+
+				/// Lowest transit of the window relative to the estimate.
+				qint64 windowMinimum = 0;
+
+				/// Timestamp of the frame with the lowest transit.
+				qint64 windowTimestamp = 0;
+
+				/// Offset the drift is measured from.
+				qint64 referenceOffset = 0;
+
+				/// Timestamp the reference offset was measured at.
+				qint64 referenceTimestamp = 0;
+
+				/// Offset that becomes the reference once the baseline is
+				/// reached.
+				qint64 halfwayOffset = 0;
+
+				/// Timestamp the halfway offset was measured at.
+				qint64 halfwayTimestamp = 0;
+
+				/// Indicates whether a halfway offset was measured.
+				bool halfway = false;
+
+				/// Recent peak of the time from capture to queueing in
+				/// microseconds.
+				qint64 lateness = 0;
+			};
+
+			/// A structure that describes a sync group.
+			struct SyncGroup {
+
+				/// Number of streams in the group.
+				int streams = 0;
+
+				/// Common playout delay in microseconds.
+				qint64 playoutDelay = 0;
+
+				/// Earliest capture time shown at the current refresh.
+				qint64 earliest = 0;
+
+				/// Latest capture time shown at the current refresh.
+				qint64 latest = 0;
+
+				/// Number of streams with a shown frame at the current
+				/// refresh.
+				int shown = 0;
+
+				/// Sync group statistics.
+				SyncStatistics statistics;
+			};
+
+			/// A structure that describes a stream.
+			struct Stream {
+
+				/// Function that shows frames.
+				Presenter presenter;
+
+				/// Queued frames ordered by due time.
+				std::deque<Frame> frames;
+
+				/// Offset from stream timestamps to local time.
+				qint64 clockOffset = 0;
+
+				/// Indicates whether the playout clock is set.
+				bool clockValid = false;
+
+				/// Nominal frame duration in microseconds.
+				qint64 frameDuration = 0;
+
+				/// Timestamp of the last submitted frame.
+				qint64 submittedTimestamp = 0;
+
+				/// Indicates whether a frame was submitted.
+				bool submitted = false;
+
+				/// Timestamp of the presented frame.
+				qint64 presentedTimestamp = 0;
+
+				/// Refresh time of the presented frame.
+				qint64 presentedTime = 0;
+
+				/// Capture time of the presented frame.
+				qint64 presentedCaptureTime = 0;
+
+				/// Time by which the next frame is expected.
+				qint64 expectedTime = 0;
+
+				/// Indicates whether a frame was presented.
+				bool presented = false;
+
+				/// Presentation statistics.
+				Statistics statistics;
+
+				/// Stream counters, or null.
+				std::shared_ptr<StreamCounters> counters;
+
+				/// Sync group identifier, or -1 if the stream is in none.
+				int syncGroup = -1;
+
+				/// Indicates whether the stream shares the clock of the group.
+				bool sharedClock = false;
+
+				/// Capture clock estimate in the sync group.
+				SyncClock syncClock;
+			};
+
+		private slots:
+
+			/// Presents due frames of all streams.
+			void tick();
+
+		private:
+
+			/// Queues a frame of a stream.
+			/// \param[in]	stream		Stream identifier.
+			/// \param[in]	source		Function that produces the frame image.
+			/// \param[in]	timestamp	Stream timestamp in microseconds.
+			/// \param[in]	receiveTime	Local receive time in microseconds, or
+			///							zero if unknown.
+			/// \param[in]	bytes		Bytes held by the image, zero if not
+			///							converted yet.
+			void enqueue(int stream,
+						 FrameSource source,
+						 quint64 timestamp,
+						 quint64 receiveTime,
+						 quint64 bytes);
+
+			/// Returns the offset of a capture clock at a timestamp.
+			/// \param[in]	clock		Capture clock estimate.
+			/// \param[in]	timestamp	Stream timestamp in microseconds.
+			/// \return Offset from the timestamp to local time in microseconds.
+			static qint64 clockOffset(const SyncClock& clock, qint64 timestamp);
+
+			/// Estimates the local capture time of a frame of a stream in a
+			/// sync group.
+			/// \param[in,out]	stream		Stream.
+			/// \param[in]		timestamp	Stream timestamp in microseconds.
+			/// \param[in]		arrival		Local arrival time in microseconds.
+			/// \param[in]		now			Current time in microseconds.
+			/// \return Local capture time in microseconds.
+			qint64 estimateCaptureTime(Stream& stream,
+									   qint64 timestamp,
+									   qint64 arrival,
+									   qint64 now);
+
+			/// Adapts the common playout delay of a sync group.
+			/// \param[in]	group	Sync group identifier.
+			void updateSyncDelay(int group);
+
+			/// Measures the capture time spread of sync groups.
+			void measureSkew();
+
+			/// Reports the queue of a stream to its counters.
+			/// \param[in]	stream	Stream.
+			void reportQueue(const Stream& stream);
+
+			/// Presents the due frame of a stream.
+			/// \param[in]	stream		Stream.
+			/// \param[in]	refreshTime	Time of the next refresh.
+			void present(Stream& stream, qint64 refreshTime);
+
+			/// Schedules the next tick.
+			void scheduleTick();
+
+		private:
+
+			/// Registered streams.
+			QHash<int, Stream> streams_;
+
+			/// Sync groups with at least one stream.
+			QHash<int, SyncGroup> syncGroups_;
+
+			/// Next stream identifier.
+			int nextStream_ = 0;
+
+			/// Refresh period in microseconds.
+			qint64 refreshPeriod_;
+
+			/// Playout delay in microseconds.
+			qint64 playoutDelay_;
+
+			/// Time of a refresh the ticks are aligned to.
+			qint64 refreshPhase_ = 0;
+
+			/// Tick timer.
+			QTimer timer_;
+		};
+	}
+}
+
+#endif
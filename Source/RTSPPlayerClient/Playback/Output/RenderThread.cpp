@@ -0,0 +1,676 @@
+/// \file RenderThread.cpp
+/// \brief Contains classes and functions definitions that provide off GUI
+/// thread rendering.
+/// \bug No known bugs.
+
+#include "RenderThread.hpp"
+#include "ResourceCache.hpp"
+#include "TextureStream.hpp"
+#include "Base/Utility/ThreadAffinity.hpp"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QMatrix4x4>
+#include <QMutexLocker>
+#include <QOffscreenSurface>
+#include <QOpenGLBuffer>
+#include <QOpenGLContext>
+#include <QOpenGLExtraFunctions>
+#include <QOpenGLFramebufferObject>
+#include <QOpenGLShaderProgram>
+
+#include <unordered_map>
+
+///
+namespace Player {
+
+	///
+	namespace Playback {
+
+		///
+		/// \details
+		static constexpr char VERTEX_SHADER_FILENAME[] {
+			":/shaders/vs.glsl"
+		};
+
+		///
+		/// \details
+		static constexpr char FRAGMENT_SHADER_FILENAME[] {
+			":/shaders/fs.glsl"
+		};
+
+		///
+		/// \details
+		static constexpr char VERTEX_COORDINATE_ATTRIBUTE[] {
+			"vertex_coord_in"
+		};
+
+		///
+		/// \details
+		static constexpr char TEXTURE_COORDINATE_ATTRIBUTE[] {
+			"texture_coord_in"
+		};
+
+		///
+		/// \details
+		static constexpr char MATRIX_UNIFORM[] {
+			"matrix"
+		};
+
+		///
+		/// \details
+		static constexpr float VIEWPORT_VERTICES[] {
+			+1.0f, -1.0f, -1.0f, +1.0f,  0.0f,
+			-1.0f, -1.0f, -1.0f,  0.0f,  0.0f,
+			-1.0f, +1.0f, -1.0f,  0.0f, +1.0f,
+			+1.0f, +1.0f, -1.0f, +1.0f, +1.0f
+		};
+
+		/// Number of framebuffers per target.
+		/// \details One drawn, one ready and one composited.
+		static constexpr int FRAMEBUFFER_COUNT {
+			3
+		};
+
+		/// Indicates whether a context supports fence sync objects.
+		/// \details Fences are core in OpenGL 3.2 and OpenGL ES 3.0.
+		/// \param[in]	context	OpenGL context.
+		/// \retval true if fences are supported.
+		/// \retval false otherwise.
+		static bool supportsFences(const QOpenGLContext* context) {
+			if (!context) return false;
+
+			auto version = context->format().version();
+
+			if (context->isOpenGLES())
+				return version >= qMakePair(3, 0);
+
+			return version >= qMakePair(3, 2) ||
+				   context->hasExtension("GL_ARB_sync");
+		}
+
+		/// A structure that describes target state shared between threads.
+		/// \details Guarded by the render thread mutex.
+		struct RenderThread::Target {
+
+			/// Function called when a frame is ready.
+			ReadyHandler ready;
+
+			/// Frame waiting to be rendered.
+			QImage pending;
+
+			/// Indicates whether a render call is queued.
+			bool scheduled = false;
+
+			/// Render size, the image size if invalid.
+			QSize size;
+
+			/// Framebuffer textures.
+			GLuint textures[FRAMEBUFFER_COUNT] { };
+
+			/// Index of the newest rendered framebuffer, or -1.
+			int readyIndex = -1;
+
+			/// Index of the framebuffer being composited, or -1.
+			int displayedIndex = -1;
+
+			/// Fences signalled once each framebuffer is drawn, or null.
+			GLsync drawFences[FRAMEBUFFER_COUNT] { };
+
+			/// Fences signalled once the GUI thread no longer samples each
+			/// framebuffer, or null.
+			GLsync releaseFences[FRAMEBUFFER_COUNT] { };
+
+			/// Render statistics.
+			Statistics statistics;
+
+			/// Stream counters, or null.
+			std::shared_ptr<StreamCounters> counters;
+		};
+
+		/// A structure that contains GL state of the render thread.
+		/// \details Created and destroyed with the render context current.
+		struct RenderThread::Renderer : protected QOpenGLExtraFunctions {
+
+			/// A structure that contains GL resources of a target.
+			struct Buffers {
+
+				/// Streaming frame texture.
+				TextureStream texture;
+
+				/// Framebuffers drawn in turn.
+				std::unique_ptr<QOpenGLFramebufferObject>
+					framebuffers[FRAMEBUFFER_COUNT];
+
+				/// Returns the bytes held by the texture and the framebuffers.
+				/// \details Framebuffers are counted at four bytes per pixel.
+				/// \return Number of bytes.
+				quint64 allocatedBytes() const {
+					auto bytes = texture.statistics().allocatedBytes;
+
+					for (const auto& framebuffer : framebuffers) {
+						if (framebuffer)
+							bytes += static_cast<quint64>(framebuffer->width()) *
+									 framebuffer->height() * 4;
+					}
+
+					return bytes;
+				}
+			};
+
+			/// Releases texture resources of all targets.
+			/// \details Framebuffers release themselves.
+			~Renderer() {
+				for (auto& resources : buffers)
+					resources.second->texture.destroy();
+			}
+
+			/// Creates GL resources in the current context.
+			/// \details The program and the quad come from the resource cache
+			/// of the render thread, so the program is loaded from a stored
+			/// binary when one exists.
+			/// \retval true on success.
+			/// \retval false on error.
+			bool initialize() {
+				initializeOpenGLFunctions();
+				fences = supportsFences(QOpenGLContext::currentContext());
+
+				auto cache = ResourceCache::current();
+				if (!cache) return false;
+
+				program = cache->program(VERTEX_SHADER_FILENAME,
+										 FRAGMENT_SHADER_FILENAME);
+				vertexBuffer = cache->vertexBuffer(VIEWPORT_VERTICES,
+												   sizeof(VIEWPORT_VERTICES));
+
+				return program && vertexBuffer;
+			}
+
+			/// Returns GL resources of a target, creating them if needed.
+			/// \param[in]	target	Target identifier.
+			/// \return Target resources.
+			Buffers& find(int target) {
+				auto& found = buffers[target];
+
+				if (!found) {
+					found.reset(new Buffers);
+					found->texture.initialize();
+				}
+
+				return *found;
+			}
+
+			/// Releases GL resources of a target.
+			/// \param[in]	target	Target identifier.
+			void remove(int target) {
+				auto found = buffers.find(target);
+				if (found == buffers.end()) return;
+
+				found->second->texture.destroy();
+				buffers.erase(found);
+			}
+
+			/// Makes the render context wait for a fence, then deletes it.
+			/// \details The wait is queued on the GPU, so the thread goes on
+			/// issuing commands.
+			/// \param[in]	fence	Fence, or null.
+			void wait(GLsync fence) {
+				if (!fence) return;
+
+				glWaitSync(fence, 0, GL_TIMEOUT_IGNORED);
+				glDeleteSync(fence);
+			}
+
+			/// Deletes a fence.
+			/// \param[in]	fence	Fence, or null.
+			void discard(GLsync fence) {
+				if (fence) glDeleteSync(fence);
+			}
+
+			/// Deletes the fences of a target.
+			/// \param[in]	state	Target state.
+			void discard(Target& state) {
+				for (auto index = 0; index < FRAMEBUFFER_COUNT; ++index) {
+					discard(state.drawFences[index]);
+					discard(state.releaseFences[index]);
+
+					state.drawFences[index] = nullptr;
+					state.releaseFences[index] = nullptr;
+				}
+			}
+
+			/// Draws a frame into a framebuffer.
+			/// \details Recreates the framebuffer if its size differs. The
+			/// returned fence is signalled once the drawing is complete, so
+			/// another context waits for it before sampling the texture.
+			/// Without fence support, waits for the GPU before returning.
+			/// \param[in]	resources	Target resources.
+			/// \param[in]	index		Framebuffer index.
+			/// \param[in]	size		Framebuffer size.
+			/// \param[out]	fence		Fence of the drawing, or null.
+			/// \return Framebuffer texture.
+			GLuint draw(Buffers& resources,
+						int index,
+						const QSize& size,
+						GLsync& fence) {
+				auto& framebuffer = resources.framebuffers[index];
+
+				if (!framebuffer || framebuffer->size() != size)
+					framebuffer.reset(new QOpenGLFramebufferObject(size));
+
+				framebuffer->bind();
+
+				glViewport(0, 0, size.width(), size.height());
+				glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+				glClear(GL_COLOR_BUFFER_BIT);
+
+				QMatrix4x4 transformMatrix;
+				transformMatrix.ortho(-1.0f, +1.0f, +1.0f, -1.0f, 0.0f, 10.0f);
+
+				program->bind();
+				program->setUniformValue(MATRIX_UNIFORM, transformMatrix);
+
+				vertexBuffer->bind();
+
+				program->enableAttributeArray(VERTEX_COORDINATE_ATTRIBUTE);
+				program->enableAttributeArray(TEXTURE_COORDINATE_ATTRIBUTE);
+
+				program->setAttributeBuffer(
+					VERTEX_COORDINATE_ATTRIBUTE,
+					GL_FLOAT,
+					0,
+					3,
+					5 * sizeof(GLfloat)
+				);
+
+				program->setAttributeBuffer(
+					TEXTURE_COORDINATE_ATTRIBUTE,
+					GL_FLOAT,
+					3 * sizeof(GLfloat),
+					2,
+					5 * sizeof(GLfloat)
+				);
+
+				resources.texture.bind();
+				glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
+				resources.texture.release();
+
+				vertexBuffer->release();
+				program->release();
+				framebuffer->release();
+
+				// The flush submits the fence, so that other contexts can
+				// see it signalled.
+				if (fences) {
+					fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+					glFlush();
+				}
+				else {
+					fence = nullptr;
+					glFinish();
+				}
+
+				return framebuffer->texture();
+			}
+
+			/// Indicates whether the render context supports fences.
+			bool fences = false;
+
+			/// Program shared through the resource cache.
+			std::shared_ptr<QOpenGLShaderProgram> program;
+
+			/// Viewport quad shared through the resource cache.
+			std::shared_ptr<QOpenGLBuffer> vertexBuffer;
+
+			/// Target resources.
+			std::unordered_map<int, std::unique_ptr<Buffers>> buffers;
+		};
+
+		/// Constructor.
+		/// \details The thread is started by start().
+		/// \param[in]	parent	Parent object.
+		RenderThread::RenderThread(QObject* parent)
+			: QObject(parent) {
+
+			thread_.setObjectName("RenderThread");
+		}
+
+		/// Destructor.
+		/// \details
+		RenderThread::~RenderThread() {
+			stop();
+		}
+
+		/// Creates the render context and starts the thread.
+		/// \details Must be called from the GUI thread after the application
+		/// object is created. The thread runs in the render role, so the
+		/// affinity policy can place it beside the GUI thread. Waits until
+		/// the thread has initialized its GL resources; if that fails, the
+		/// thread is stopped again, so widgets keep drawing on the GUI
+		/// thread.
+		/// \retval true on success.
+		/// \retval false on error.
+		bool RenderThread::start() {
+			if (thread_.isRunning()) return true;
+
+			auto shareContext = QOpenGLContext::globalShareContext();
+
+			context_.reset(new QOpenGLContext);
+			context_->setShareContext(shareContext);
+			context_->setFormat(shareContext ? shareContext->format()
+											 : QSurfaceFormat::defaultFormat());
+
+			if (!context_->create()) {
+				context_.reset();
+				return false;
+			}
+
+			surface_.reset(new QOffscreenSurface);
+			surface_->setFormat(context_->format());
+			surface_->create();
+
+			worker_.moveToThread(&thread_);
+			context_->moveToThread(&thread_);
+			thread_.start();
+
+			auto initialized = false;
+
+			QMetaObject::invokeMethod(&worker_, [this, &initialized] {
+				Common::Utility::ThreadAffinity::instance().enter(
+					Common::Utility::ThreadRole::Render);
+
+				renderer_.reset(new Renderer);
+
+				initialized = context_->makeCurrent(surface_.get()) &&
+							  renderer_->initialize();
+			}, Qt::BlockingQueuedConnection);
+
+			if (!initialized) {
+				qWarning("RenderThread: failed to initialize GL resources");
+				stop();
+				return false;
+			}
+
+			fences_ = renderer_->fences;
+			return true;
+		}
+
+		/// Releases GL resources and stops the thread.
+		/// \details Waits for the frame being rendered. Pending frames are
+		/// discarded.
+		void RenderThread::stop() {
+			if (!thread_.isRunning()) return;
+
+			auto mainThread = QCoreApplication::instance()->thread();
+
+			QMetaObject::invokeMethod(&worker_, [this, mainThread] {
+				if (renderer_) {
+					QMutexLocker locker(&mutex_);
+
+					for (auto& state : targets_)
+						renderer_->discard(*state);
+				}
+
+				renderer_.reset();
+				ResourceCache::release();
+				context_->doneCurrent();
+				context_->moveToThread(mainThread);
+				worker_.moveToThread(mainThread);
+
+				Common::Utility::ThreadAffinity::instance().leave();
+			}, Qt::BlockingQueuedConnection);
+
+			thread_.quit();
+			thread_.wait();
+
+			context_.reset();
+			surface_.reset();
+		}
+
+		/// Indicates whether the thread is running.
+		/// \details
+		/// \retval true if the thread is running.
+		/// \retval false otherwise.
+		bool RenderThread::isRunning() const {
+			return thread_.isRunning();
+		}
+
+		/// Registers a render target.
+		/// \details The handler is called on the render thread with the
+		/// target lock held, so it must only post work elsewhere.
+		/// \param[in]	ready	Function called when a frame is ready.
+		/// \return Target identifier.
+		int RenderThread::addTarget(ReadyHandler ready) {
+			QMutexLocker locker(&mutex_);
+
+			auto target = nextTarget_++;
+			auto state = std::make_shared<Target>();
+			state->ready = std::move(ready);
+			targets_.insert(target, state);
+
+			return target;
+		}
+
+		/// Unregisters a render target.
+		/// \details The ready handler is never called after this returns.
+		/// GL resources are released on the render thread.
+		/// \param[in]	target	Target identifier.
+		void RenderThread::removeTarget(int target) {
+			std::shared_ptr<Target> state;
+
+			{
+				QMutexLocker locker(&mutex_);
+				state = targets_.take(target);
+			}
+
+			post([this, target, state] {
+				if (!renderer_) return;
+
+				renderer_->remove(target);
+				if (state) renderer_->discard(*state);
+			});
+		}
+
+		/// Sets the size a target renders at.
+		/// \details Applies from the next rendered frame.
+		/// \param[in]	target	Target identifier.
+		/// \param[in]	size	Size in pixels.
+		void RenderThread::resize(int target, const QSize& size) {
+			QMutexLocker locker(&mutex_);
+
+			auto found = targets_.find(target);
+			if (found != targets_.end()) (*found)->size = size;
+		}
+
+		/// Sets the counters a target reports to.
+		/// \details Rendered frames count as uploads and coalesced frames as
+		/// drops.
+		/// \param[in]	target		Target identifier.
+		/// \param[in]	counters	Stream counters, or null.
+		void RenderThread::setCounters(int target,
+									   std::shared_ptr<StreamCounters> counters) {
+			QMutexLocker locker(&mutex_);
+
+			auto found = targets_.find(target);
+			if (found != targets_.end()) (*found)->counters = std::move(counters);
+		}
+
+		/// Queues a frame for rendering.
+		/// \details Replaces a frame that is still waiting, so a slow render
+		/// thread skips frames instead of building latency.
+		/// \param[in]	target	Target identifier.
+		/// \param[in]	image	Frame image.
+		void RenderThread::submit(int target, const QImage& image) {
+			if (image.isNull()) return;
+
+			{
+				QMutexLocker locker(&mutex_);
+
+				auto found = targets_.find(target);
+				if (found == targets_.end()) return;
+
+				auto& state = **found;
+
+				++state.statistics.submittedFrames;
+				if (!state.pending.isNull()) {
+					++state.statistics.coalescedFrames;
+					if (state.counters) state.counters->addDropped(1);
+				}
+
+				state.pending = image;
+
+				if (state.scheduled) return;
+				state.scheduled = true;
+			}
+
+			post([this, target] { render(target); });
+		}
+
+		/// Takes the newest rendered frame of a target.
+		/// \details Hands the ready framebuffer to the caller and returns the
+		/// previously taken one to the render thread. Must be called with
+		/// the compositing context current: the context waits on the GPU
+		/// for the drawing of the ready framebuffer, and fences its earlier
+		/// commands, so the render thread does not draw into the returned
+		/// framebuffer while it is still sampled.
+		/// \param[in]	target	Target identifier.
+		/// \return Texture identifier, or zero if nothing was rendered.
+		GLuint RenderThread::acquire(int target) {
+			QMutexLocker locker(&mutex_);
+
+			auto found = targets_.find(target);
+			if (found == targets_.end()) return 0;
+
+			auto& state = **found;
+
+			if (state.readyIndex >= 0) {
+				auto context = QOpenGLContext::currentContext();
+
+				if (fences_ && context) {
+					auto functions = context->extraFunctions();
+
+					if (state.displayedIndex >= 0) {
+						auto& released =
+							state.releaseFences[state.displayedIndex];
+						if (released) functions->glDeleteSync(released);
+
+						released = functions->glFenceSync(
+							GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+						functions->glFlush();
+					}
+
+					auto& drawn = state.drawFences[state.readyIndex];
+
+					if (drawn) {
+						functions->glWaitSync(drawn, 0, GL_TIMEOUT_IGNORED);
+						functions->glDeleteSync(drawn);
+						drawn = nullptr;
+					}
+				}
+
+				state.displayedIndex = state.readyIndex;
+				state.readyIndex = -1;
+			}
+
+			return state.displayedIndex >= 0
+				? state.textures[state.displayedIndex]
+				: 0;
+		}
+
+		/// Returns render statistics of a target.
+		/// \details
+		/// \param[in]	target	Target identifier.
+		/// \return Render statistics.
+		RenderThread::Statistics RenderThread::statistics(int target) const {
+			QMutexLocker locker(&mutex_);
+
+			auto found = targets_.constFind(target);
+			return found != targets_.cend() ? (*found)->statistics : Statistics();
+		}
+
+		/// Renders the pending frame of a target on the render thread.
+		/// \details Draws into a framebuffer that is neither ready nor
+		/// composited, then publishes it as ready with the fence of its
+		/// drawing. A framebuffer the GUI thread composited before is drawn
+		/// only after the fence of its release.
+		/// \param[in]	target	Target identifier.
+		void RenderThread::render(int target) {
+			std::shared_ptr<Target> state;
+			QImage image;
+			QSize size;
+			GLsync released = nullptr;
+			GLsync stale = nullptr;
+			int index = 0;
+
+			{
+				QMutexLocker locker(&mutex_);
+
+				auto found = targets_.find(target);
+				if (found == targets_.end()) return;
+
+				state = *found;
+				image = std::move(state->pending);
+				state->pending = QImage();
+				state->scheduled = false;
+				size = state->size;
+
+				while (index == state->readyIndex || index == state->displayedIndex)
+					++index;
+
+				if (!renderer_ || image.isNull()) return;
+
+				released = state->releaseFences[index];
+				stale = state->drawFences[index];
+				state->releaseFences[index] = nullptr;
+				state->drawFences[index] = nullptr;
+			}
+
+			QElapsedTimer timer;
+			timer.start();
+
+			renderer_->wait(released);
+			renderer_->discard(stale);
+
+			auto& resources = renderer_->find(target);
+			resources.texture.upload(image);
+
+			GLsync fence = nullptr;
+			auto texture = renderer_->draw(resources,
+										   index,
+										   size.isValid() && !size.isEmpty()
+											   ? size
+											   : image.size(),
+										   fence);
+
+			auto elapsed = static_cast<quint64>(timer.nsecsElapsed() / 1000);
+			auto allocatedBytes = resources.allocatedBytes();
+
+			QMutexLocker locker(&mutex_);
+
+			state->drawFences[index] = fence;
+
+			if (!targets_.contains(target)) return;
+
+			state->textures[index] = texture;
+			state->readyIndex = index;
+			++state->statistics.renderedFrames;
+			state->statistics.totalRenderTime += elapsed;
+
+			if (state->counters) {
+				state->counters->addUpload(elapsed);
+				state->counters->setMemoryUsage(
+					Common::Utility::MemoryStage::Texture, allocatedBytes);
+			}
+
+			if (state->ready) state->ready();
+		}
+
+		/// Posts a function to the render thread.
+		/// \details
+		/// \param[in]	function	Function to run.
+		void RenderThread::post(std::function<void()> function) {
+			QMetaObject::invokeMethod(&worker_, std::move(function),
+									  Qt::QueuedConnection);
+		}
+	}
+}
@@ -0,0 +1,179 @@
+/// \file RenderThread.hpp
+/// \brief Contains classes and functions declarations that provide off GUI
+/// thread rendering.
+/// \bug No known bugs.
+
+#ifndef RENDERTHREAD_HPP
+#define RENDERTHREAD_HPP
+
+#include "StreamCounters.hpp"
+
+#include <QHash>
+#include <QImage>
+#include <QMutex>
+#include <QObject>
+#include <QOpenGLFunctions>
+#include <QThread>
+
+#include <functional>
+#include <memory>
+
+class QOffscreenSurface;
+class QOpenGLContext;
+
+///
+namespace Player {
+
+	///
+	namespace Playback {
+
+		/// A class that uploads and draws stream frames on its own thread.
+		/// \details Owns a context shared with the global share context, so
+		/// that its textures can be sampled by every widget. Each target
+		/// renders into a ring of three framebuffers: one being drawn, one
+		/// ready and one being composited by the GUI thread, so neither side
+		/// ever waits for the other. Each framebuffer has fences for its
+		/// drawing and its release, which order the GPU work of the two
+		/// contexts without stalling either thread; contexts without fence
+		/// support finish every drawing instead. Frames submitted faster than
+		/// they are drawn are coalesced to the newest one. Requires the
+		/// Qt::AA_ShareOpenGLContexts attribute. All public methods are
+		/// thread safe.
+		class RenderThread : public QObject {
+
+			Q_OBJECT
+
+		public:
+
+			/// A function that is called when a target has a new frame.
+			/// \details Called on the render thread.
+			using ReadyHandler = std::function<void()>;
+
+			/// A structure that contains render statistics of a target.
+			struct Statistics {
+
+				/// Number of submitted frames.
+				quint64 submittedFrames = 0;
+
+				/// Number of rendered frames.
+				quint64 renderedFrames = 0;
+
+				/// Number of frames replaced before being rendered.
+				quint64 coalescedFrames = 0;
+
+				/// Total render time in microseconds, upload included.
+				quint64 totalRenderTime = 0;
+			};
+
+		public:
+
+			/// Constructor.
+			/// \param[in]	parent	Parent object.
+			explicit RenderThread(QObject* parent = nullptr);
+
+			/// Destructor.
+			virtual ~RenderThread();
+
+		public:
+
+			/// Creates the render context and starts the thread.
+			/// \retval true on success.
+			/// \retval false on error.
+			bool start();
+
+			/// Releases GL resources and stops the thread.
+			void stop();
+
+			/// Indicates whether the thread is running.
+			/// \retval true if the thread is running.
+			/// \retval false otherwise.
+			bool isRunning() const;
+
+			/// Registers a render target.
+			/// \param[in]	ready	Function called when a frame is ready.
+			/// \return Target identifier.
+			int addTarget(ReadyHandler ready);
+
+			/// Unregisters a render target.
+			/// \param[in]	target	Target identifier.
+			void removeTarget(int target);
+
+			/// Sets the size a target renders at.
+			/// \param[in]	target	Target identifier.
+			/// \param[in]	size	Size in pixels.
+			void resize(int target, const QSize& size);
+
+			/// Sets the counters a target reports to.
+			/// \param[in]	target		Target identifier.
+			/// \param[in]	counters	Stream counters, or null.
+			void setCounters(int target,
+							 std::shared_ptr<StreamCounters> counters);
+
+			/// Queues a frame for rendering.
+			/// \param[in]	target	Target identifier.
+			/// \param[in]	image	Frame image.
+			void submit(int target, const QImage& image);
+
+			/// Takes the newest rendered frame of a target.
+			/// \details The returned texture stays valid until the next call,
+			/// which must be made with the compositing context current.
+			/// \param[in]	target	Target identifier.
+			/// \return Texture identifier, or zero if nothing was rendered.
+			GLuint acquire(int target);
+
+			/// Returns render statistics of a target.
+			/// \param[in]	target	Target identifier.
+			/// \return Render statistics.
+			Statistics statistics(int target) const;
+
+		private:
+
+			/// A structure that describes target state shared between threads.
+			struct Target;
+
+			/// A structure that contains GL state of the render thread.
+			struct Renderer;
+
+		private:
+
+			/// Renders the pending frame of a target on the render thread.
+			/// \param[in]	target	Target identifier.
+			void render(int target);
+
+			/// Posts a function to the render thread.
+			/// \param[in]	function	Function to run.
+			void post(std::function<void()> function);
+
+		private:
+
+			/// Guards targets.
+			mutable QMutex mutex_;
+
+			/// Render targets.
+			QHash<int, std::shared_ptr<Target>> targets_;
+
+			/// Next target identifier.
+			int nextTarget_ = 0;
+
+			/// Indicates whether the contexts synchronize through fences.
+			bool fences_ = false;
+
+			/// Render thread.
+			QThread thread_;
+
+			/// Object that lives on the render thread.
+			QObject worker_;
+
+			/// Offscreen surface the context is made current on.
+			std::unique_ptr<QOffscreenSurface> surface_;
+
+			/// Render context.
+			std::unique_ptr<QOpenGLContext> context_;
+
+			/// GL state, accessed only on the render thread.
+			std::unique_ptr<Renderer> renderer_;
+		};
+	}
+}
+
+#endif
@@ -0,0 +1,416 @@
+/// \file ResourceCache.cpp
+/// \brief Contains classes and functions definitions that provide shared GL
+/// programs and buffers.
+/// \bug No known bugs.
+
+#include "ResourceCache.hpp"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QOpenGLContext>
+#include <QPair>
+#include <QSaveFile>
+#include <QSet>
+#include <QStandardPaths>
+#include <QThread>
+
+#include <cstring>
+
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#endif
+
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+
+///
+namespace Player {
+
+	///
+	namespace Playback {
+
+		/// Subdirectory of the cache location that holds program binaries.
+		/// \details
+		static constexpr char BINARY_SUBDIRECTORY[] {
+			"programs"
+		};
+
+		/// Extension of program binary files.
+		/// \details
+		static constexpr char BINARY_EXTENSION[] {
+			".bin"
+		};
+
+		namespace {
+
+			/// A structure that contains the caches of the process.
+			struct Registry {
+
+				/// Cache key made of the share group and the thread.
+				using Key = QPair<QOpenGLContextGroup*, QThread*>;
+
+				/// Guards all members.
+				QMutex mutex;
+
+				/// Caches by share group and thread.
+				QHash<Key, ResourceCache*> caches;
+
+				/// Share groups whose destruction is watched.
+				QSet<QOpenGLContextGroup*> groups;
+
+				/// Cache statistics.
+				ResourceCache::Statistics statistics;
+
+				/// Directory program binaries are stored in.
+				QString binaryDirectory;
+
+				/// Indicates whether the directory was set explicitly.
+				bool binaryDirectorySet = false;
+			};
+
+			/// Returns the caches of the process.
+			/// \return Registry.
+			Registry& registry() {
+				static Registry instance;
+				return instance;
+			}
+
+			/// Reads a shader file.
+			/// \param[in]	fileName	Shader file name.
+			/// \return Shader source, empty on error.
+			QByteArray readFile(const QString& fileName) {
+				QFile file(fileName);
+				if (!file.open(QIODevice::ReadOnly)) return QByteArray();
+				return file.readAll();
+			}
+		}
+
+		/// Returns the cache of the current context group and thread.
+		/// \details Creates the cache on first use. Caches of a share group
+		/// are dropped when the group is destroyed, that is when its last
+		/// context is.
+		/// \return Resource cache, or nullptr without a current context.
+		ResourceCache* ResourceCache::current() {
+			auto context = QOpenGLContext::currentContext();
+			if (!context) return nullptr;
+
+			auto group = context->shareGroup();
+			auto& state = registry();
+
+			QMutexLocker locker(&state.mutex);
+
+			auto key = qMakePair(group, QThread::currentThread());
+			auto& cache = state.caches[key];
+			if (!cache) cache = new ResourceCache;
+
+			if (!state.groups.contains(group)) {
+				state.groups.insert(group);
+
+				QObject::connect(group, &QObject::destroyed, [group] {
+					auto& state = registry();
+					QMutexLocker locker(&state.mutex);
+
+					for (auto it = state.caches.begin();
+						 it != state.caches.end(); ) {
+						if (it.key().first == group) {
+							delete it.value();
+							it = state.caches.erase(it);
+						}
+						else {
+							++it;
+						}
+					}
+
+					state.groups.remove(group);
+				});
+			}
+
+			return cache;
+		}
+
+		/// Releases the cache of the current context group and thread.
+		/// \details Programs and buffers still held elsewhere stay alive
+		/// until they are released there.
+		void ResourceCache::release() {
+			auto context = QOpenGLContext::currentContext();
+			if (!context) return;
+
+			auto& state = registry();
+			ResourceCache* cache = nullptr;
+
+			{
+				QMutexLocker locker(&state.mutex);
+				cache = state.caches.take(qMakePair(context->shareGroup(),
+													QThread::currentThread()));
+			}
+
+			delete cache;
+		}
+
+		/// Returns the directory program binaries are stored in.
+		/// \details Defaults to a subdirectory of the application cache
+		/// location.
+		/// \return Directory path, empty if binaries are not stored.
+		QString ResourceCache::binaryDirectory() {
+			auto& state = registry();
+			QMutexLocker locker(&state.mutex);
+
+			if (!state.binaryDirectorySet) {
+				auto location = QStandardPaths::writableLocation(
+					QStandardPaths::CacheLocation);
+
+				if (!location.isEmpty())
+					state.binaryDirectory =
+						location + '/' + BINARY_SUBDIRECTORY;
+
+				state.binaryDirectorySet = true;
+			}
+
+			return state.binaryDirectory;
+		}
+
+		/// Sets the directory program binaries are stored in.
+		/// \details Applies to programs created afterwards.
+		/// \param[in]	directory	Directory path, empty to disable.
+		void ResourceCache::setBinaryDirectory(const QString& directory) {
+			auto& state = registry();
+			QMutexLocker locker(&state.mutex);
+
+			state.binaryDirectory = directory;
+			state.binaryDirectorySet = true;
+		}
+
+		/// Returns cache statistics of the process.
+		/// \details
+		/// \return Cache statistics.
+		ResourceCache::Statistics ResourceCache::statistics() {
+			auto& state = registry();
+			QMutexLocker locker(&state.mutex);
+			return state.statistics;
+		}
+
+		/// Constructs a cache in the current context.
+		/// \details Program binaries need OpenGL 4.1, OpenGL ES 3.0 or
+		/// GL_ARB_get_program_binary, and a driver that offers at least one
+		/// binary format.
+		ResourceCache::ResourceCache() {
+			initializeOpenGLFunctions();
+
+			auto context = QOpenGLContext::currentContext();
+			auto version = context->format().version();
+
+			auto binaryFunctions =
+				context->isOpenGLES()
+					? version.first >= 3
+					: version >= qMakePair(4, 1) ||
+					  context->hasExtension("GL_ARB_get_program_binary");
+
+			if (binaryFunctions) {
+				GLint formats = 0;
+				glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+				binarySupported_ = formats > 0;
+			}
+
+			for (auto name : { GL_VENDOR, GL_RENDERER, GL_VERSION }) {
+				auto value = glGetString(name);
+				if (value) driver_ += reinterpret_cast<const char*>(value);
+				driver_ += '\n';
+			}
+		}
+
+		/// Returns a linked program built from shader files.
+		/// \details Programs are shared by file names. A new program is
+		/// loaded from a stored binary of the same sources and driver if one
+		/// exists, and compiled and linked otherwise. Callers set attribute
+		/// arrays and uniforms before every use, as both may have been
+		/// changed by other users.
+		/// \param[in]	vertexFileName		Vertex shader file name.
+		/// \param[in]	fragmentFileName	Fragment shader file name.
+		/// \return Linked program, or nullptr on error.
+		std::shared_ptr<QOpenGLShaderProgram> ResourceCache::program(
+			const QString& vertexFileName,
+			const QString& fragmentFileName) {
+
+			auto name = (vertexFileName + '\n' + fragmentFileName).toUtf8();
+
+			auto found = programs_.constFind(name);
+			if (found != programs_.cend()) {
+				QMutexLocker locker(&registry().mutex);
+				++registry().statistics.sharedPrograms;
+				return *found;
+			}
+
+			QElapsedTimer timer;
+			timer.start();
+
+			auto vertexSource = readFile(vertexFileName);
+			auto fragmentSource = readFile(fragmentFileName);
+
+			if (vertexSource.isEmpty() || fragmentSource.isEmpty())
+				return nullptr;
+
+			QCryptographicHash hash(QCryptographicHash::Sha1);
+			hash.addData(vertexSource);
+			hash.addData(fragmentSource);
+			hash.addData(driver_);
+			auto key = hash.result().toHex();
+
+			auto program = loadProgram(key);
+			auto loaded = program != nullptr;
+
+			if (!program) {
+				program.reset(new QOpenGLShaderProgram);
+
+				if (!program->addShaderFromSourceCode(QOpenGLShader::Vertex,
+													  vertexSource)		||
+					!program->addShaderFromSourceCode(QOpenGLShader::Fragment,
+													  fragmentSource))
+					return nullptr;
+
+				if (binarySupported_)
+					glProgramParameteri(program->programId(),
+										GL_PROGRAM_BINARY_RETRIEVABLE_HINT,
+										GL_TRUE);
+
+				if (!program->link()) return nullptr;
+
+				storeProgram(key, *program);
+			}
+
+			std::shared_ptr<QOpenGLShaderProgram> shared(std::move(program));
+			programs_.insert(name, shared);
+
+			QMutexLocker locker(&registry().mutex);
+			auto& statistics = registry().statistics;
+			if (loaded)
+				++statistics.loadedPrograms;
+			else
+				++statistics.compiledPrograms;
+			statistics.programTime +=
+				static_cast<quint64>(timer.nsecsElapsed() / 1000);
+
+			return shared;
+		}
+
+		/// Returns a static vertex buffer holding constant data.
+		/// \details Buffers are shared by data address, so the data must
+		/// never change.
+		/// \param[in]	data	Vertex data with static storage duration.
+		/// \param[in]	size	Data size in bytes.
+		/// \return Vertex buffer, or nullptr on error.
+		std::shared_ptr<QOpenGLBuffer> ResourceCache::vertexBuffer(
+			const void* data,
+			int size) {
+
+			auto found = buffers_.constFind(data);
+			if (found != buffers_.cend()) {
+				QMutexLocker locker(&registry().mutex);
+				++registry().statistics.sharedBuffers;
+				return *found;
+			}
+
+			auto buffer =
+				std::make_shared<QOpenGLBuffer>(QOpenGLBuffer::VertexBuffer);
+			buffer->setUsagePattern(QOpenGLBuffer::StaticDraw);
+
+			if (!buffer->create() || !buffer->bind()) return nullptr;
+
+			buffer->allocate(data, size);
+			buffer->release();
+
+			buffers_.insert(data, buffer);
+			return buffer;
+		}
+
+		/// Loads a program from a stored binary.
+		/// \details Binaries the driver rejects, for example after a driver
+		/// update that kept the version string, are removed.
+		/// \param[in]	key	Program key.
+		/// \return Linked program, or nullptr if no usable binary exists.
+		std::unique_ptr<QOpenGLShaderProgram> ResourceCache::loadProgram(
+			const QByteArray& key) {
+
+			if (!binarySupported_) return nullptr;
+
+			auto directory = binaryDirectory();
+			if (directory.isEmpty()) return nullptr;
+
+			QFile file(directory + '/' + key + BINARY_EXTENSION);
+			if (!file.open(QIODevice::ReadOnly)) return nullptr;
+
+			auto data = file.readAll();
+			file.close();
+
+			GLenum format = 0;
+			if (data.size() <= static_cast<int>(sizeof(format))) return nullptr;
+			std::memcpy(&format, data.constData(), sizeof(format));
+
+			std::unique_ptr<QOpenGLShaderProgram> program(
+				new QOpenGLShaderProgram);
+			if (!program->create()) return nullptr;
+
+			glProgramBinary(program->programId(),
+							format,
+							data.constData() + sizeof(format),
+							data.size() - static_cast<int>(sizeof(format)));
+
+			// Without shaders, link() only reads the link status.
+			if (!program->link()) {
+				file.remove();
+				return nullptr;
+			}
+
+			return program;
+		}
+
+		/// Stores the binary of a linked program.
+		/// \details The file starts with the binary format, followed by the
+		/// binary. Files are replaced atomically, so processes starting at
+		/// the same time never read partial binaries.
+		/// \param[in]	key		Program key.
+		/// \param[in]	program	Linked program.
+		void ResourceCache::storeProgram(const QByteArray& key,
+										 QOpenGLShaderProgram& program) {
+			if (!binarySupported_) return;
+
+			auto directory = binaryDirectory();
+			if (directory.isEmpty() || !QDir().mkpath(directory)) return;
+
+			GLint length = 0;
+			glGetProgramiv(program.programId(),
+						   GL_PROGRAM_BINARY_LENGTH,
+						   &length);
+			if (length <= 0) return;
+
+			GLenum format = 0;
+			QByteArray data(static_cast<int>(sizeof(format)) + length,
+							Qt::Uninitialized);
+
+			glGetProgramBinary(program.programId(),
+							   length,
+							   &length,
+							   &format,
+							   data.data() + sizeof(format));
+
+			if (length <= 0) return;
+
+			std::memcpy(data.data(), &format, sizeof(format));
+			data.resize(static_cast<int>(sizeof(format)) + length);
+
+			QSaveFile file(directory + '/' + key + BINARY_EXTENSION);
+			if (!file.open(QIODevice::WriteOnly)) return;
+
+			file.write(data);
+			file.commit();
+		}
+	}
+}
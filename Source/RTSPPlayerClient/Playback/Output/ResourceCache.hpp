@@ -0,0 +1,136 @@
+/// \file ResourceCache.hpp
+/// \brief Contains classes and functions declarations that provide shared GL
+/// programs and buffers.
+/// \bug No known bugs.
+
+#ifndef RESOURCECACHE_HPP
+#define RESOURCECACHE_HPP
+
+#include <QByteArray>
+#include <QHash>
+#include <QOpenGLBuffer>
+#include <QOpenGLExtraFunctions>
+#include <QOpenGLShaderProgram>
+#include <QString>
+
+#include <memory>
+
+///
+namespace Player {
+
+	///
+	namespace Playback {
+
+		/// A class that shares GL programs and static buffers between
+		/// contexts.
+		/// \details Programs and buffers are share group objects, so every
+		/// context that shares with the global share context can use the
+		/// ones created by another. One cache exists per share group and
+		/// thread: program uniforms are program state, so programs are not
+		/// used from two threads at once. Linked programs are stored with
+		/// glGetProgramBinary in the binary directory and loaded with
+		/// glProgramBinary on later runs, keyed by the sources and the
+		/// driver. All methods must be called with a context current.
+		class ResourceCache : protected QOpenGLExtraFunctions {
+		public:
+
+			/// A structure that contains cache statistics of the process.
+			struct Statistics {
+
+				/// Number of programs compiled and linked from sources.
+				quint64 compiledPrograms = 0;
+
+				/// Number of programs loaded from stored binaries.
+				quint64 loadedPrograms = 0;
+
+				/// Number of program requests served from the cache.
+				quint64 sharedPrograms = 0;
+
+				/// Number of buffer requests served from the cache.
+				quint64 sharedBuffers = 0;
+
+				/// Time spent creating programs in microseconds.
+				quint64 programTime = 0;
+			};
+
+		public:
+
+			/// Destroys the cache.
+			/// \details Share group objects are freed with their group.
+			virtual ~ResourceCache() = default;
+
+		public:
+
+			/// Returns the cache of the current context group and thread.
+			/// \return Resource cache, or nullptr without a current context.
+			static ResourceCache* current();
+
+			/// Releases the cache of the current context group and thread.
+			/// \details Must be called with the context current, for example
+			/// by threads that own a context and are about to stop.
+			static void release();
+
+			/// Returns the directory program binaries are stored in.
+			/// \return Directory path, empty if binaries are not stored.
+			static QString binaryDirectory();
+
+			/// Sets the directory program binaries are stored in.
+			/// \param[in]	directory	Directory path, empty to disable.
+			static void setBinaryDirectory(const QString& directory);
+
+			/// Returns cache statistics of the process.
+			/// \return Cache statistics.
+			static Statistics statistics();
+
+		public:
+
+			/// Returns a linked program built from shader files.
+			/// \param[in]	vertexFileName		Vertex shader file name.
+			/// \param[in]	fragmentFileName	Fragment shader file name.
+			/// \return Linked program, or nullptr on error.
+			std::shared_ptr<QOpenGLShaderProgram> program(
+				const QString& vertexFileName,
+				const QString& fragmentFileName);
+
+			/// Returns a static vertex buffer holding constant data.
+			/// \param[in]	data	Vertex data with static storage duration.
+			/// \param[in]	size	Data size in bytes.
+			/// \return Vertex buffer, or nullptr on error.
+			std::shared_ptr<QOpenGLBuffer> vertexBuffer(const void* data,
+														int size);
+
+		private:
+
+			/// Constructs a cache in the current context.
+			explicit ResourceCache();
+
+			/// Loads a program from a stored binary.
+			/// \param[in]	key	Program key.
+			/// \return Linked program, or nullptr if no usable binary exists.
+			std::unique_ptr<QOpenGLShaderProgram> loadProgram(
+				const QByteArray& key);
+
+			/// Stores the binary of a linked program.
+			/// \param[in]	key		Program key.
+			/// \param[in]	program	Linked program.
+			void storeProgram(const QByteArray& key,
+							  QOpenGLShaderProgram& program);
+
+		private:
+
+			/// Indicates whether program binaries can be retrieved and loaded.
+			bool binarySupported_ = false;
+
+			/// Driver identification that keys program binaries.
+			QByteArray driver_;
+
+			/// Programs by key.
+			QHash<QByteArray, std::shared_ptr<QOpenGLShaderProgram>> programs_;
+
+			/// Vertex buffers by data address.
+			QHash<const void*, std::shared_ptr<QOpenGLBuffer>> buffers_;
+		};
+	}
+}
+
+#endif
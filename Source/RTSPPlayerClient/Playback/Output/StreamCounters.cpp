@@ -0,0 +1,91 @@
+/// \file StreamCounters.cpp
+/// \brief Contains classes and functions definitions that provide lock free
+/// stream output counters.
+/// \bug No known bugs.
+
+#include "StreamCounters.hpp"
+
+///
+namespace Player {
+
+	///
+	namespace Playback {
+
+		/// Constructs stream counters.
+		/// \details The account is fixed for the lifetime of the counters,
+		/// so stages read it without synchronization.
+		/// \param[in]	memoryAccount	Memory account of the stream, or
+		///								null.
+		StreamCounters::StreamCounters(
+			std::shared_ptr<Common::Utility::MemoryAccount> memoryAccount)
+			: memoryAccount_(std::move(memoryAccount)) {
+
+		}
+
+		/// Counts an uploaded frame.
+		/// \details
+		/// \param[in]	time	Upload time in microseconds.
+		void StreamCounters::addUpload(quint64 time) noexcept {
+			uploadedFrames_.fetch_add(1, relaxed);
+			uploadTime_.fetch_add(time, relaxed);
+		}
+
+		/// Counts dropped frames.
+		/// \details
+		/// \param[in]	count	Number of dropped frames.
+		void StreamCounters::addDropped(quint64 count) noexcept {
+			if (count > 0) droppedFrames_.fetch_add(count, relaxed);
+		}
+
+		/// Sets the number of frames waiting for presentation.
+		/// \details
+		/// \param[in]	count	Number of queued frames.
+		void StreamCounters::setQueued(quint64 count) noexcept {
+			queuedFrames_.store(count, relaxed);
+		}
+
+		/// Counts a presented frame.
+		/// \details Negative latencies are not accumulated.
+		/// \param[in]	latency	Receive to presentation time in
+		///						microseconds, or -1 if unknown.
+		void StreamCounters::addPresented(qint64 latency) noexcept {
+			presentedFrames_.fetch_add(1, relaxed);
+
+			if (latency >= 0) {
+				latencyFrames_.fetch_add(1, relaxed);
+				latencyTime_.fetch_add(static_cast<quint64>(latency), relaxed);
+			}
+		}
+
+		/// Sets the memory held by a stage.
+		/// \details Does nothing without a memory account.
+		/// \param[in]	stage	Memory stage.
+		/// \param[in]	bytes	Number of bytes.
+		void StreamCounters::setMemoryUsage(Common::Utility::MemoryStage stage,
+											quint64 bytes) noexcept {
+			if (memoryAccount_) memoryAccount_->setUsage(stage, bytes);
+		}
+
+		/// Returns the memory account of the stream.
+		/// \return Memory account, or null.
+		const std::shared_ptr<Common::Utility::MemoryAccount>&
+		StreamCounters::memoryAccount() const noexcept {
+			return memoryAccount_;
+		}
+
+		/// Reads the counters.
+		/// \details
+		/// \return Counter values.
+		StreamCounters::Snapshot StreamCounters::snapshot() const noexcept {
+			Snapshot snapshot;
+			snapshot.uploadedFrames = uploadedFrames_.load(relaxed);
+			snapshot.uploadTime = uploadTime_.load(relaxed);
+			snapshot.queuedFrames = queuedFrames_.load(relaxed);
+			snapshot.droppedFrames = droppedFrames_.load(relaxed);
+			snapshot.presentedFrames = presentedFrames_.load(relaxed);
+			snapshot.latencyFrames = latencyFrames_.load(relaxed);
+			snapshot.latencyTime = latencyTime_.load(relaxed);
+			return snapshot;
+		}
+	}
+}
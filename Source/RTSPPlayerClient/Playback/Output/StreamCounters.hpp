@@ -0,0 +1,130 @@
+/// \file StreamCounters.hpp
+/// \brief Contains classes and functions declarations that provide lock free
+/// stream output counters.
+/// \bug No known bugs.
+
+#ifndef STREAMCOUNTERS_HPP
+#define STREAMCOUNTERS_HPP
+
+#include "Base/Utility/MemoryBudget.hpp"
+
+#include <QtGlobal>
+
+#include <atomic>
+#include <memory>
+
+///
+namespace Player {
+
+	///
+	namespace Playback {
+
+		/// A class that counts output events of a stream.
+		/// \details Written by the stages a frame passes after decoding, on
+		/// whatever thread they run, and read by monitors. All counters are
+		/// relaxed atomics, so neither side ever waits; a snapshot may be
+		/// slightly inconsistent across fields. Memory held by the stages
+		/// is reported to the memory account of the stream, if it has one.
+		class StreamCounters {
+		public:
+
+			/// A structure that contains counter values.
+			struct Snapshot {
+
+				/// Number of uploaded frames.
+				quint64 uploadedFrames = 0;
+
+				/// Total upload time in microseconds.
+				quint64 uploadTime = 0;
+
+				/// Number of frames waiting for presentation.
+				quint64 queuedFrames = 0;
+
+				/// Number of frames dropped before presentation.
+				quint64 droppedFrames = 0;
+
+				/// Number of presented frames.
+				quint64 presentedFrames = 0;
+
+				/// Number of presented frames with a known receive time.
+				quint64 latencyFrames = 0;
+
+				/// Total receive to presentation time in microseconds.
+				quint64 latencyTime = 0;
+			};
+
+		public:
+
+			/// Constructs stream counters.
+			/// \param[in]	memoryAccount	Memory account of the stream, or
+			///								null.
+			explicit StreamCounters(
+				std::shared_ptr<Common::Utility::MemoryAccount> memoryAccount = nullptr);
+
+		public:
+
+			/// Counts an uploaded frame.
+			/// \param[in]	time	Upload time in microseconds.
+			void addUpload(quint64 time) noexcept;
+
+			/// Counts dropped frames.
+			/// \param[in]	count	Number of dropped frames.
+			void addDropped(quint64 count) noexcept;
+
+			/// Sets the number of frames waiting for presentation.
+			/// \param[in]	count	Number of queued frames.
+			void setQueued(quint64 count) noexcept;
+
+			/// Counts a presented frame.
+			/// \param[in]	latency	Receive to presentation time in
+			///						microseconds, or -1 if unknown.
+			void addPresented(qint64 latency) noexcept;
+
+			/// Sets the memory held by a stage.
+			/// \param[in]	stage	Memory stage.
+			/// \param[in]	bytes	Number of bytes.
+			void setMemoryUsage(Common::Utility::MemoryStage stage,
+								quint64 bytes) noexcept;
+
+			/// Returns the memory account of the stream.
+			/// \return Memory account, or null.
+			const std::shared_ptr<Common::Utility::MemoryAccount>&
+			memoryAccount() const noexcept;
+
+			/// Reads the counters.
+			/// \return Counter values.
+			Snapshot snapshot() const noexcept;
+
+		private:
+
+			/// Memory order used by counters.
+			static constexpr auto relaxed = std::memory_order_relaxed;
+
+			/// Memory account of the stream, or null.
+			const std::shared_ptr<Common::Utility::MemoryAccount> memoryAccount_;
+
+			/// Number of uploaded frames.
+			std::atomic<quint64> uploadedFrames_ { 0 };
+
+			/// Total upload time in microseconds.
+			std::atomic<quint64> uploadTime_ { 0 };
+
+			/// Number of frames waiting for presentation.
+			std::atomic<quint64> queuedFrames_ { 0 };
+
+			/// Number of frames dropped before presentation.
+			std::atomic<quint64> droppedFrames_ { 0 };
+
+			/// Number of presented frames.
+			std::atomic<quint64> presentedFrames_ { 0 };
+
+			/// Number of presented frames with a known receive time.
+			std::atomic<quint64> latencyFrames_ { 0 };
+
+			/// Total receive to presentation time in microseconds.
+			std::atomic<quint64> latencyTime_ { 0 };
+		};
+	}
+}
+
+#endif
@@ -0,0 +1,438 @@
+/// \file TextureStream.cpp
+/// \brief Contains classes and functions definitions that provide streaming
+/// texture uploads.
+/// \bug No known bugs.
+
+#include "TextureStream.hpp"
+
+#include <QElapsedTimer>
+#include <QOpenGLContext>
+
+#include <cstring>
+#include <iterator>
+
+#ifndef GL_BGRA
+#define GL_BGRA 0x80E1
+#endif
+
+#ifndef GL_UNPACK_ROW_LENGTH
+#define GL_UNPACK_ROW_LENGTH 0x0CF2
+#endif
+
+namespace {
+
+	/// A structure that describes how an image maps to texture pixels.
+	struct PixelLayout {
+
+		/// Internal texture format.
+		GLenum internalFormat;
+
+		/// Pixel format.
+		GLenum format;
+
+		/// Pixel type.
+		GLenum type;
+
+		/// Bytes per pixel.
+		int bytesPerPixel;
+	};
+
+	/// Finds the texture pixel layout of an image format.
+	/// \details 32-bit Qt RGB formats hold BGRA bytes on little endian
+	/// hosts and are uploaded as BGRA where the context supports it.
+	/// \param[in]	format				Image format.
+	/// \param[in]	bgraInternalFormat	Internal format of BGRA textures,
+	///									zero if unsupported.
+	/// \param[out]	layout				Texture pixel layout.
+	/// \retval true if the format can be uploaded as is.
+	/// \retval false if the image has to be converted first.
+	bool findLayout(QImage::Format format,
+					GLenum bgraInternalFormat,
+					PixelLayout& layout) {
+
+		switch (format) {
+		case QImage::Format_Grayscale8:
+			layout = { GL_LUMINANCE, GL_LUMINANCE, GL_UNSIGNED_BYTE, 1 };
+			return true;
+		case QImage::Format_RGB888:
+			layout = { GL_RGB, GL_RGB, GL_UNSIGNED_BYTE, 3 };
+			return true;
+		case QImage::Format_RGBX8888:
+		case QImage::Format_RGBA8888:
+		case QImage::Format_RGBA8888_Premultiplied:
+			layout = { GL_RGBA, GL_RGBA, GL_UNSIGNED_BYTE, 4 };
+			return true;
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+		case QImage::Format_RGB32:
+		case QImage::Format_ARGB32:
+		case QImage::Format_ARGB32_Premultiplied:
+			if (bgraInternalFormat == 0) return false;
+			layout = { bgraInternalFormat, GL_BGRA, GL_UNSIGNED_BYTE, 4 };
+			return true;
+#endif
+		default:
+			return false;
+		}
+	}
+
+	/// Copies image rows into a buffer with a given row size.
+	/// \details Copies the whole image at once if the row sizes match.
+	/// \param[in]	image	Source image.
+	/// \param[in]	rowSize	Target row size in bytes.
+	/// \param[out]	target	Target buffer.
+	void copyRows(const QImage& image, int rowSize, uchar* target) {
+		auto sourceRowSize = image.bytesPerLine();
+
+		if (sourceRowSize == rowSize) {
+			std::memcpy(target, image.constBits(),
+						static_cast<size_t>(rowSize) * image.height());
+			return;
+		}
+
+		auto copySize = qMin(sourceRowSize, rowSize);
+
+		for (auto y = 0; y < image.height(); ++y)
+			std::memcpy(target + y * rowSize, image.constScanLine(y), copySize);
+	}
+}
+
+///
+namespace Player {
+
+	///
+	namespace Playback {
+
+		/// Constructs a texture stream.
+		/// \details GL resources are created later by initialize().
+		TextureStream::TextureStream()
+			: unpackBuffers_ {
+				  QOpenGLBuffer(QOpenGLBuffer::PixelUnpackBuffer),
+				  QOpenGLBuffer(QOpenGLBuffer::PixelUnpackBuffer)
+			  } {
+
+		}
+
+		/// Creates GL resources in the current context.
+		/// \details Pixel unpack buffers are used on desktop OpenGL 2.1 and
+		/// OpenGL ES 3.0 or newer. OpenGL ES needs version 3.0 or
+		/// GL_EXT_unpack_subimage for row lengths and
+		/// GL_EXT_texture_format_BGRA8888 for BGRA textures.
+		/// \retval true on success.
+		/// \retval false on error.
+		bool TextureStream::initialize() {
+			auto context = QOpenGLContext::currentContext();
+			if (!context) return false;
+
+			initializeOpenGLFunctions();
+
+			auto version = context->format().version();
+
+			streamingSupported_ =
+				context->isOpenGLES()
+					? version.first >= 3
+					: version >= qMakePair(2, 1) ||
+					  context->hasExtension("GL_ARB_pixel_buffer_object");
+
+			rowLengthSupported_ =
+				!context->isOpenGLES() ||
+				version.first >= 3 ||
+				context->hasExtension("GL_EXT_unpack_subimage");
+
+			if (!context->isOpenGLES())
+				bgraInternalFormat_ = GL_RGBA;
+			else if (context->hasExtension("GL_EXT_texture_format_BGRA8888"))
+				bgraInternalFormat_ = GL_BGRA;
+			else
+				bgraInternalFormat_ = 0;
+
+			glGenTextures(1, &texture_);
+			glBindTexture(GL_TEXTURE_2D, texture_);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+			glBindTexture(GL_TEXTURE_2D, 0);
+
+			for (auto& buffer : unpackBuffers_) {
+				buffer.setUsagePattern(QOpenGLBuffer::StreamDraw);
+				if (streamingSupported_ && !buffer.create())
+					streamingSupported_ = false;
+			}
+
+			size_ = QSize();
+			statistics_ = Statistics();
+
+			return texture_ != 0;
+		}
+
+		/// Releases GL resources in the current context.
+		/// \details Safe to call repeatedly.
+		void TextureStream::destroy() {
+			for (auto& buffer : unpackBuffers_)
+				buffer.destroy();
+
+			if (texture_ != 0) {
+				glDeleteTextures(1, &texture_);
+				texture_ = 0;
+			}
+
+			packedRows_ = Common::Utility::HugePageBuffer();
+			size_ = QSize();
+			statistics_.allocatedBytes = 0;
+		}
+
+		/// Indicates whether the texture holds an image.
+		/// \details Returns \c true after the first successful upload.
+		/// \retval true if the texture holds an image.
+		/// \retval false otherwise.
+		bool TextureStream::isValid() const {
+			return texture_ != 0 && size_.isValid();
+		}
+
+		/// Indicates whether pixel unpack buffers are used.
+		/// \details Buffers are used if they are both supported and enabled.
+		/// \retval true if uploads go through pixel unpack buffers.
+		/// \retval false if uploads read client memory.
+		bool TextureStream::isStreaming() const {
+			return streamingSupported_ && streamingEnabled_;
+		}
+
+		/// Enables or disables pixel unpack buffers.
+		/// \details Buffers are only used if the context supports them.
+		/// \param[in]	enabled	Indicates whether buffers are allowed.
+		void TextureStream::setStreamingEnabled(bool enabled) {
+			streamingEnabled_ = enabled;
+		}
+
+		/// Returns the texture size.
+		/// \details Returns an invalid size until the first upload.
+		/// \return Texture size.
+		QSize TextureStream::size() const {
+			return size_;
+		}
+
+		/// Returns upload statistics.
+		/// \details Times include image conversion and row packing.
+		/// \return Upload statistics.
+		const TextureStream::Statistics& TextureStream::statistics() const {
+			return statistics_;
+		}
+
+		/// Uploads an image into the texture.
+		/// \details Images in formats without a direct texture layout are
+		/// converted to RGBA first, keeping premultiplied alpha. Images with
+		/// 32-bit pixels and aligned rows are copied without any per row
+		/// work.
+		/// \param[in]	image	Image to upload.
+		/// \retval true on success.
+		/// \retval false on error.
+		bool TextureStream::upload(const QImage& image) {
+			if (texture_ == 0 || image.isNull()) return false;
+
+			QElapsedTimer timer;
+			timer.start();
+
+			PixelLayout layout;
+			auto source = image;
+
+			if (!findLayout(source.format(), bgraInternalFormat_, layout)) {
+				auto premultiplied = source.pixelFormat().premultiplied() ==
+									 QPixelFormat::Premultiplied;
+
+				source = source.convertToFormat(
+					premultiplied ? QImage::Format_RGBA8888_Premultiplied
+								  : QImage::Format_RGBA8888);
+				++statistics_.convertedFrames;
+			}
+
+			allocateStorage(source);
+
+			if (source.bytesPerLine() != rowSize_)
+				++statistics_.packedFrames;
+
+			if (!isStreaming() || !uploadBuffered(source))
+				uploadDirect(source);
+
+			auto elapsed = static_cast<quint64>(timer.nsecsElapsed() / 1000);
+
+			++statistics_.uploadedFrames;
+			statistics_.lastUploadTime = elapsed;
+			statistics_.totalUploadTime += elapsed;
+
+			return true;
+		}
+
+		/// Binds the texture to the active texture unit.
+		/// \details Does nothing if no texture was created.
+		void TextureStream::bind() {
+			if (texture_ != 0) glBindTexture(GL_TEXTURE_2D, texture_);
+		}
+
+		/// Releases the texture from the active texture unit.
+		/// \details Binds the default texture.
+		void TextureStream::release() {
+			if (texture_ != 0) glBindTexture(GL_TEXTURE_2D, 0);
+		}
+
+		/// Reallocates texture storage if the image layout changed.
+		/// \details Unpack buffers are resized together with the texture.
+		/// Rows keep the image stride if it is a whole number of pixels and
+		/// the row length can be set, and are packed to four-byte alignment
+		/// otherwise.
+		/// \param[in]	image	Image to upload.
+		void TextureStream::allocateStorage(const QImage& image) {
+			PixelLayout layout;
+			findLayout(image.format(), bgraInternalFormat_, layout);
+
+			auto stride = image.bytesPerLine();
+			auto rowLength = 0;
+			auto rowSize = (image.width() * layout.bytesPerPixel + 3) & ~3;
+
+			if (stride != rowSize &&
+				rowLengthSupported_ &&
+				stride % layout.bytesPerPixel == 0) {
+
+				rowLength = stride / layout.bytesPerPixel;
+				rowSize = stride;
+			}
+
+			if (size_ == image.size() &&
+				format_ == layout.format &&
+				type_ == layout.type &&
+				rowSize_ == rowSize)
+				return;
+
+			rowSize_ = rowSize;
+			rowLength_ = rowLength;
+
+			if (size_ != image.size() ||
+				format_ != layout.format ||
+				type_ != layout.type) {
+
+				size_ = image.size();
+				format_ = layout.format;
+				type_ = layout.type;
+
+				glBindTexture(GL_TEXTURE_2D, texture_);
+				glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+				glTexImage2D(GL_TEXTURE_2D,
+							 0,
+							 static_cast<GLint>(layout.internalFormat),
+							 size_.width(),
+							 size_.height(),
+							 0,
+							 format_,
+							 type_,
+							 nullptr);
+				glBindTexture(GL_TEXTURE_2D, 0);
+			}
+
+			statistics_.allocatedBytes =
+				static_cast<quint64>(size_.width()) * size_.height() *
+				static_cast<quint64>(layout.bytesPerPixel);
+
+			if (streamingSupported_) {
+				for (auto& buffer : unpackBuffers_) {
+					buffer.bind();
+					buffer.allocate(rowSize_ * size_.height());
+					buffer.release();
+				}
+
+				statistics_.allocatedBytes +=
+					static_cast<quint64>(rowSize_) * size_.height() *
+					std::size(unpackBuffers_);
+			}
+
+			++statistics_.reallocations;
+		}
+
+		/// Uploads an image through a pixel unpack buffer.
+		/// \details Buffers are used in turn and mapped with invalidation,
+		/// so the write never waits for the transfer of the previous frame.
+		/// \param[in]	image	Image to upload.
+		/// \retval true on success.
+		/// \retval false if the buffer cannot be mapped.
+		bool TextureStream::uploadBuffered(const QImage& image) {
+			auto& buffer = unpackBuffers_[bufferIndex_];
+			auto bufferSize = rowSize_ * size_.height();
+
+			bufferIndex_ ^= 1;
+
+			if (!buffer.bind()) return false;
+
+			auto data = static_cast<uchar*>(
+				buffer.mapRange(0,
+								bufferSize,
+								QOpenGLBuffer::RangeWrite |
+								QOpenGLBuffer::RangeInvalidateBuffer));
+
+			if (!data)
+				data = static_cast<uchar*>(buffer.map(QOpenGLBuffer::WriteOnly));
+
+			if (!data) {
+				buffer.release();
+				streamingSupported_ = false;
+				return false;
+			}
+
+			copyRows(image, rowSize_, data);
+			buffer.unmap();
+
+			transfer(nullptr);
+
+			buffer.release();
+
+			return true;
+		}
+
+		/// Uploads an image from client memory.
+		/// \details Rows with padding the row length cannot describe are
+		/// packed first, because OpenGL ES 2.0 has no unpack row length. The
+		/// packing buffer is kept for the next upload and comes from the huge
+		/// page arena when it is large.
+		/// \param[in]	image	Image to upload.
+		void TextureStream::uploadDirect(const QImage& image) {
+			auto pixels = image.constBits();
+
+			if (image.bytesPerLine() != rowSize_) {
+				auto packedSize = static_cast<std::size_t>(rowSize_) * size_.height();
+
+				if (packedRows_.size() < packedSize)
+					packedRows_ = Common::Utility::HugePageBuffer(packedSize);
+
+				copyRows(image, rowSize_, packedRows_.data());
+				pixels = packedRows_.data();
+			}
+
+			transfer(pixels);
+		}
+
+		/// Transfers pixels into the texture.
+		/// \details Sets the unpack row length for the transfer if rows are
+		/// padded.
+		/// \param[in]	pixels	Pixel data, or an offset into the bound pixel
+		///						unpack buffer.
+		void TextureStream::transfer(const void* pixels) {
+			glBindTexture(GL_TEXTURE_2D, texture_);
+			glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+			if (rowLength_ != 0)
+				glPixelStorei(GL_UNPACK_ROW_LENGTH, rowLength_);
+
+			glTexSubImage2D(GL_TEXTURE_2D,
+							0,
+							0,
+							0,
+							size_.width(),
+							size_.height(),
+							format_,
+							type_,
+							pixels);
+
+			if (rowLength_ != 0)
+				glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+
+			glBindTexture(GL_TEXTURE_2D, 0);
+		}
+	}
+}
@@ -0,0 +1,183 @@
+/// \file TextureStream.hpp
+/// \brief Contains classes and functions declarations that provide streaming
+/// texture uploads.
+/// \bug No known bugs.
+
+#ifndef TEXTURESTREAM_HPP
+#define TEXTURESTREAM_HPP
+
+#include "Base/Utility/HugePageArena.hpp"
+
+#include <QImage>
+#include <QOpenGLBuffer>
+#include <QOpenGLFunctions>
+
+///
+namespace Player {
+
+	///
+	namespace Playback {
+
+		/// A class that streams images into a persistent texture.
+		/// \details Texture storage is reallocated only when the image size or
+		/// format changes. Pixel data goes through a pair of pixel unpack
+		/// buffers used in turn, so writing the next frame does not wait for
+		/// the transfer of the previous one. 32-bit RGBX and BGRA images are
+		/// uploaded as is, and padded rows are described to the driver with
+		/// an unpack row length instead of being packed, where the context
+		/// supports it. All methods must be called with the owning context
+		/// current.
+		class TextureStream : protected QOpenGLFunctions {
+		public:
+
+			/// A structure that contains upload statistics.
+			struct Statistics {
+
+				/// Number of uploaded frames.
+				quint64 uploadedFrames = 0;
+
+				/// Number of texture storage reallocations.
+				quint64 reallocations = 0;
+
+				/// Number of frames whose rows were packed before the upload.
+				quint64 packedFrames = 0;
+
+				/// Number of frames converted to another format first.
+				quint64 convertedFrames = 0;
+
+				/// Last upload time in microseconds.
+				quint64 lastUploadTime = 0;
+
+				/// Total upload time in microseconds.
+				quint64 totalUploadTime = 0;
+
+				/// Bytes held by the texture and the pixel unpack buffers.
+				quint64 allocatedBytes = 0;
+			};
+
+		public:
+
+			/// Constructs a texture stream.
+			explicit TextureStream();
+
+			/// Destroys the texture stream.
+			/// \details Resources must be released with destroy() while the
+			/// context is still current.
+			virtual ~TextureStream() = default;
+
+		public:
+
+			/// Creates GL resources in the current context.
+			/// \retval true on success.
+			/// \retval false on error.
+			bool initialize();
+
+			/// Releases GL resources in the current context.
+			void destroy();
+
+			/// Indicates whether the texture holds an image.
+			/// \retval true if the texture holds an image.
+			/// \retval false otherwise.
+			bool isValid() const;
+
+			/// Indicates whether pixel unpack buffers are used.
+			/// \retval true if uploads go through pixel unpack buffers.
+			/// \retval false if uploads read client memory.
+			bool isStreaming() const;
+
+			/// Enables or disables pixel unpack buffers.
+			/// \details Buffers are only used if the context supports them.
+			/// \param[in]	enabled	Indicates whether buffers are allowed.
+			void setStreamingEnabled(bool enabled);
+
+			/// Returns the texture size.
+			/// \return Texture size.
+			QSize size() const;
+
+			/// Returns upload statistics.
+			/// \return Upload statistics.
+			const Statistics& statistics() const;
+
+			/// Uploads an image into the texture.
+			/// \param[in]	image	Image to upload.
+			/// \retval true on success.
+			/// \retval false on error.
+			bool upload(const QImage& image);
+
+			/// Binds the texture to the active texture unit.
+			void bind();
+
+			/// Releases the texture from the active texture unit.
+			void release();
+
+		private:
+
+			/// Reallocates texture storage if the image layout changed.
+			/// \param[in]	image	Image to upload.
+			void allocateStorage(const QImage& image);
+
+			/// Uploads an image through a pixel unpack buffer.
+			/// \param[in]	image	Image to upload.
+			/// \retval true on success.
+			/// \retval false if the buffer cannot be mapped.
+			bool uploadBuffered(const QImage& image);
+
+			/// Uploads an image from client memory.
+			/// \param[in]	image	Image to upload.
+			void uploadDirect(const QImage& image);
+
+			/// Transfers pixels into the texture.
+			/// \param[in]	pixels	Pixel data, or an offset into the bound pixel
+			///						unpack buffer.
+			void transfer(const void* pixels);
+
+		private:
+
+			/// Texture identifier.
+			GLuint texture_ = 0;
+
+			/// Texture size.
+			QSize size_;
+
+			/// Texture pixel format.
+			GLenum format_ = 0;
+
+			/// Texture pixel type.
+			GLenum type_ = 0;
+
+			/// Bytes per uploaded row, either the image stride or the row
+			/// size aligned to four bytes.
+			int rowSize_ = 0;
+
+			/// Unpack row length in pixels, zero for tightly packed rows.
+			int rowLength_ = 0;
+
+			/// Indicates whether pixel unpack buffers are supported.
+			bool streamingSupported_ = false;
+
+			/// Indicates whether the unpack row length can be set.
+			bool rowLengthSupported_ = false;
+
+			/// Internal format of BGRA textures, zero if BGRA pixels cannot
+			/// be uploaded.
+			GLenum bgraInternalFormat_ = 0;
+
+			/// Indicates whether pixel unpack buffers are allowed.
+			bool streamingEnabled_ = true;
+
+			/// Index of the next pixel unpack buffer.
+			int bufferIndex_ = 0;
+
+			/// Pixel unpack buffers used in turn.
+			QOpenGLBuffer unpackBuffers_[2];
+
+			/// Rows packed for uploads from client memory.
+			Common::Utility::HugePageBuffer packedRows_;
+
+			/// Upload statistics.
+			Statistics statistics_;
+		};
+	}
+}
+
+#endif
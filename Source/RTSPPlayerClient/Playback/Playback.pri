@@ -2,5 +2,6 @@
 #                            Project subdirectories                            #
 #------------------------------------------------------------------------------#
 
+include($$absolute_path(Conversion.pri, Conversion))
 include($$absolute_path(Decoding.pri, Decoding))
 include($$absolute_path(Output.pri, Output))